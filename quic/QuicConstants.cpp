@@ -73,6 +73,9 @@ QuicBatchingMode getQuicBatchingMode(uint32_t val) {
       return QuicBatchingMode::BATCHING_MODE_SENDMMSG;
     case static_cast<uint32_t>(QuicBatchingMode::BATCHING_MODE_SENDMMSG_GSO):
       return QuicBatchingMode::BATCHING_MODE_SENDMMSG_GSO;
+    case static_cast<uint32_t>(
+        QuicBatchingMode::BATCHING_MODE_WORKER_SENDMMSG_GSO):
+      return QuicBatchingMode::BATCHING_MODE_WORKER_SENDMMSG_GSO;
       // no default
   }
 
@@ -127,6 +130,8 @@ std::string writeDataReasonString(WriteDataReason reason) {
       return "Ping";
     case WriteDataReason::DATAGRAM:
       return "Datagram";
+    case WriteDataReason::PMTU_PROBE:
+      return "PmtuProbe";
     case WriteDataReason::NO_WRITE:
       return "NoWrite";
   }
@@ -70,6 +70,27 @@ constexpr uint16_t kDefaultMaxUDPPayload = 1452;
 // maximum QUIC packet size.
 constexpr uint16_t kMinMaxUDPPayload = 1200;
 
+// The largest value max_udp_payload_size may take (RFC 9000 Section 18.2), and
+// so the largest packet path MTU discovery will ever probe for.
+constexpr uint16_t kMaxUDPPayload = 65527;
+
+// The most a GSO batch may carry, since the kernel sends a UDP_SEGMENT batch
+// as a single UDP datagram before splitting it. This is the largest UDP
+// payload over IPv4, and so also fits over IPv6.
+constexpr size_t kMaxGsoBatchBytes = 65507;
+
+// Number of lost probes of the same size after which path MTU discovery
+// concludes the path cannot carry that size (MAX_PROBES in RFC 8899).
+constexpr uint8_t kDefaultPmtuMaxProbes = 3;
+
+// Path MTU discovery stops searching once the largest confirmed size is within
+// this many bytes of the smallest size known not to fit.
+constexpr uint16_t kDefaultPmtuSearchGranularity = 20;
+
+// Number of consecutive PTOs after which a raised packet size is suspected to
+// be black holed and path MTU discovery falls back to its base size.
+constexpr uint8_t kPmtuBlackHolePtoThreshold = 3;
+
 // How many bytes to reduce from udpSendPacketLen when socket write leads to
 // EMSGSIZE.
 constexpr uint16_t kDefaultMsgSizeBackOffSize = 50;
@@ -169,7 +190,8 @@ QUIC_ENUM(
     UNKNOWN_CID_VERSION,
     CANNOT_FORWARD_DATA,
     EGRESS_POLICER_DROP,
-    DUPLICATE_PACKET)
+    DUPLICATE_PACKET,
+    FORWARDING_RING_FULL)
 
 QUIC_ENUM(
     TransportKnobParamId,
@@ -454,10 +476,24 @@ enum class QuicBatchingMode : uint32_t {
   BATCHING_MODE_GSO = 1,
   BATCHING_MODE_SENDMMSG = 2,
   BATCHING_MODE_SENDMMSG_GSO = 3,
+  // Server only: packets from every connection of a QuicServerWorker are
+  // collected over one event loop iteration and sent together with a single
+  // sendmmsg, each message using GSO where possible. Elsewhere this behaves
+  // like BATCHING_MODE_SENDMMSG_GSO.
+  BATCHING_MODE_WORKER_SENDMMSG_GSO = 4,
 };
 
 QuicBatchingMode getQuicBatchingMode(uint32_t val);
 
+enum class PacingMode : uint8_t {
+  // The transport sleeps on the pacing timer between bursts.
+  Timer = 0,
+  // Packets are stamped with an earliest departure time (SO_TXTIME) and the
+  // kernel's fq qdisc holds them until then, so the transport only wakes up
+  // once per pacing horizon.
+  EarliestDepartureTime = 1,
+};
+
 // default QUIC batching size - currently used only
 // by BATCHING_MODE_GSO
 constexpr uint32_t kDefaultQuicMaxBatchSize = 16;
@@ -507,6 +543,8 @@ constexpr std::chrono::microseconds kDefaultPacingTickInterval{1000};
 // triggering the pacing callbacks. For pacing to work accurately, this should
 // be reasonably smaller than kDefaultPacingTickInterval.
 constexpr std::chrono::microseconds kDefaultPacingTimerResolution{100};
+// How far ahead of now EDT pacing may schedule packet departures.
+constexpr std::chrono::microseconds kDefaultEdtPacingHorizon{4000};
 // Fraction of RTT that is used to limit how long a write function can loop
 constexpr DurationRep kDefaultWriteLimitRttFraction = 25;
 
@@ -701,6 +739,10 @@ constexpr std::chrono::seconds kTimeToRetainZeroRttKeys = 20s;
 
 constexpr std::chrono::seconds kTimeToRetainLastCongestionAndRttState = 60s;
 
+// How long path MTU discovery waits after a completed search before probing
+// again for a larger size (PMTU_RAISE_TIMER in RFC 8899).
+constexpr std::chrono::seconds kDefaultPmtuRaiseTimer = 600s;
+
 // Amount of time for the server to keep previously used paths in the path
 // manager before dropping them. This allows the server to restore the path
 // state if the client migrates back to it.
@@ -817,6 +859,7 @@ enum class WriteDataReason {
   PATH_VALIDATION,
   PING,
   DATAGRAM,
+  PMTU_PROBE,
 };
 
 enum class NoWriteReason {
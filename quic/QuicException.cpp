@@ -56,6 +56,23 @@ bool isCryptoError(TransportErrorCode code) {
       static_cast<std::underlying_type<TransportErrorCode>::type>(code);
 }
 
+bool isNoError(const QuicErrorCode& code) {
+  switch (code.type()) {
+    case QuicErrorCode::Type::LocalErrorCode: {
+      LocalErrorCode localErrorCode = *code.asLocalErrorCode();
+      return localErrorCode == LocalErrorCode::NO_ERROR ||
+          localErrorCode == LocalErrorCode::IDLE_TIMEOUT ||
+          localErrorCode == LocalErrorCode::SHUTTING_DOWN;
+    }
+    case QuicErrorCode::Type::TransportErrorCode:
+      return *code.asTransportErrorCode() == TransportErrorCode::NO_ERROR;
+    case QuicErrorCode::Type::ApplicationErrorCode:
+      return *code.asApplicationErrorCode() ==
+          GenericApplicationErrorCode::NO_ERROR;
+  }
+  return false;
+}
+
 std::string toString(LocalErrorCode code) {
   switch (code) {
     case LocalErrorCode::NO_ERROR:
@@ -97,6 +97,12 @@ class QuicApplicationException : public std::runtime_error {
 
 bool isCryptoError(TransportErrorCode code);
 
+/**
+ * Whether the code ends a connection gracefully: a NO_ERROR of any kind, an
+ * idle timeout or a local shutdown.
+ */
+bool isNoError(const QuicErrorCode& code);
+
 /**
  * Convert the error code to a string.
  */
@@ -6,6 +6,8 @@
  */
 
 #include <quic/api/IoBufQuicBatch.h>
+#include <quic/api/QuicTransportFunctions.h>
+#include <quic/common/BufAccessor.h>
 #include <quic/common/MvfstLogging.h>
 #include <quic/common/SocketUtil.h>
 #include <quic/common/StringUtils.h>
@@ -49,6 +51,57 @@ quic::Expected<bool, QuicError> IOBufQuicBatch::write(
   return true;
 }
 
+quic::Expected<bool, QuicError> IOBufQuicBatch::write(
+    BufPtr&& buf,
+    size_t encodedSize,
+    const PendingHeaderProtection& header,
+    const PacketNumberCipher& headerCipher) {
+  if (pendingHeaderCipher_ != &headerCipher) {
+    auto finishResult = finishPendingPackets();
+    if (!finishResult.has_value()) {
+      return quic::make_unexpected(finishResult.error());
+    }
+    pendingHeaderCipher_ = &headerCipher;
+  }
+  // Registered before the write so that a flush the write triggers protects
+  // this packet too: in place writers may move it within their buffer.
+  pendingHeaders_.push_back(header);
+  if (batchWriter_->handsOffOnAppend()) {
+    auto protectResult = protectPendingHeaders();
+    if (!protectResult.has_value()) {
+      return quic::make_unexpected(protectResult.error());
+    }
+  }
+  return write(std::move(buf), encodedSize);
+}
+
+quic::Expected<bool, QuicError> IOBufQuicBatch::write(
+    size_t encodedSize,
+    const InplaceEncryptPacket& packet,
+    const Aead& aead,
+    const PacketNumberCipher& headerCipher,
+    BufAccessor& bufAccessor) {
+  if (pendingAead_ != &aead || pendingHeaderCipher_ != &headerCipher ||
+      pendingBufAccessor_ != &bufAccessor) {
+    auto finishResult = finishPendingPackets();
+    if (!finishResult.has_value()) {
+      return quic::make_unexpected(finishResult.error());
+    }
+    pendingAead_ = &aead;
+    pendingHeaderCipher_ = &headerCipher;
+    pendingBufAccessor_ = &bufAccessor;
+  }
+  // Registered before the write for the same reason as the header above.
+  pendingSeals_.push_back(packet);
+  if (batchWriter_->handsOffOnAppend()) {
+    auto finishResult = finishPendingPackets();
+    if (!finishResult.has_value()) {
+      return quic::make_unexpected(finishResult.error());
+    }
+  }
+  return write(nullptr /* no need to pass buf */, encodedSize);
+}
+
 quic::Expected<bool, QuicError> IOBufQuicBatch::flush() {
   auto ret = flushInternal();
   reset();
@@ -56,15 +109,67 @@ quic::Expected<bool, QuicError> IOBufQuicBatch::flush() {
   return ret;
 }
 
+quic::Expected<bool, QuicError> IOBufQuicBatch::setTxTime(
+    std::chrono::microseconds txTime) {
+  if (txTime == txTime_) {
+    return true;
+  }
+  auto ret = flush();
+  txTime_ = txTime;
+  batchWriter_->setTxTime(txTime);
+  return ret;
+}
+
 void IOBufQuicBatch::reset() {
   batchWriter_->reset();
 }
 
+quic::Expected<void, QuicError> IOBufQuicBatch::protectPendingHeaders() {
+  if (pendingHeaders_.empty()) {
+    return {};
+  }
+  auto result = pendingHeaderCipher_->encryptHeaders(
+      pendingHeaders_.data(), pendingHeaders_.size());
+  pendingHeaders_.clear();
+  return result;
+}
+
+quic::Expected<void, QuicError> IOBufQuicBatch::finishPendingPackets() {
+  if (pendingSeals_.empty()) {
+    return protectPendingHeaders();
+  }
+  auto buf = pendingBufAccessor_->obtain();
+  auto encryptResult = pendingAead_->inplaceEncryptBatch(
+      std::move(buf), pendingSeals_.data(), pendingSeals_.size());
+  if (!encryptResult.has_value()) {
+    pendingSeals_.clear();
+    return quic::make_unexpected(encryptResult.error());
+  }
+  buf = std::move(encryptResult.value());
+  auto cipherOverhead = pendingAead_->getCipherOverhead();
+  for (const auto& packet : pendingSeals_) {
+    auto header = buf->writableData() + packet.headerOffset;
+    pendingHeaders_.push_back(makePendingHeaderProtection(
+        getHeaderForm(*header),
+        header,
+        packet.headerLen,
+        header + packet.headerLen,
+        packet.payloadLen + cipherOverhead));
+  }
+  pendingSeals_.clear();
+  pendingBufAccessor_->release(std::move(buf));
+  return protectPendingHeaders();
+}
+
 bool IOBufQuicBatch::isRetriableError(int err) {
   return err == EAGAIN || err == EWOULDBLOCK || err == ENOBUFS;
 }
 
 quic::Expected<bool, QuicError> IOBufQuicBatch::flushInternal() {
+  auto finishResult = finishPendingPackets();
+  if (!finishResult.has_value()) {
+    return quic::make_unexpected(finishResult.error());
+  }
   if (batchWriter_->empty()) {
     return true;
   }
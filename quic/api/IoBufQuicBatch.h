@@ -9,10 +9,14 @@
 #include <quic/QuicException.h>
 #include <quic/api/QuicBatchWriter.h>
 #include <quic/client/state/ClientStateMachine.h>
+#include <quic/codec/PacketNumberCipher.h>
+#include <quic/handshake/Aead.h>
 #include <quic/state/QuicTransportStatsCallback.h>
 
 namespace quic {
 
+class BufAccessor;
+
 struct BufQuicBatchResult {
   uint64_t packetsSent{0};
   uint64_t bytesSent{0};
@@ -34,8 +38,42 @@ class IOBufQuicBatch {
       BufPtr&& buf,
       size_t encodedSize);
 
+  /**
+   * Like write(), for a packet whose header is not protected yet. The headers
+   * of the batched packets are protected together, with one mask computation
+   * for the whole batch, right before the batch is written out. buf may be
+   * null for packets written in place, like with the other write().
+   */
+  [[nodiscard]] quic::Expected<bool, QuicError> write(
+      BufPtr&& buf,
+      size_t encodedSize,
+      const PendingHeaderProtection& header,
+      const PacketNumberCipher& headerCipher);
+
+  /**
+   * Like write(), for a packet built in place in bufAccessor that is neither
+   * encrypted nor header protected yet. packet is relative to the data of
+   * bufAccessor and must have room for the tag after its payload. The batched
+   * packets are sealed together with one Aead::inplaceEncryptBatch() call,
+   * then header protected together, right before the batch is written out.
+   */
+  [[nodiscard]] quic::Expected<bool, QuicError> write(
+      size_t encodedSize,
+      const InplaceEncryptPacket& packet,
+      const Aead& aead,
+      const PacketNumberCipher& headerCipher,
+      BufAccessor& bufAccessor);
+
   [[nodiscard]] quic::Expected<bool, QuicError> flush();
 
+  /**
+   * Sets the departure time, relative to the socket write, of the packets
+   * written from now on. Packets already batched with a different time are
+   * flushed first. Returns like flush().
+   */
+  [[nodiscard]] quic::Expected<bool, QuicError> setTxTime(
+      std::chrono::microseconds txTime);
+
   FOLLY_ALWAYS_INLINE uint64_t getPktSent() const {
     return result_.packetsSent;
   }
@@ -54,6 +92,12 @@ class IOBufQuicBatch {
   // flushes the internal buffers
   [[nodiscard]] quic::Expected<bool, QuicError> flushInternal();
 
+  // applies header protection to every packet waiting for it
+  [[nodiscard]] quic::Expected<void, QuicError> protectPendingHeaders();
+
+  // seals, then header protects, every packet waiting for it
+  [[nodiscard]] quic::Expected<void, QuicError> finishPendingPackets();
+
   /**
    * Returns whether or not the errno can be retried later.
    */
@@ -66,6 +110,16 @@ class IOBufQuicBatch {
   QuicClientConnectionState::HappyEyeballsState* happyEyeballsState_;
   BufQuicBatchResult result_;
   int lastRetryableErrno_{};
+  std::chrono::microseconds txTime_{0};
+  // Headers of batched packets still waiting for header protection, all to be
+  // protected with pendingHeaderCipher_.
+  std::vector<PendingHeaderProtection> pendingHeaders_;
+  const PacketNumberCipher* pendingHeaderCipher_{nullptr};
+  // Packets in pendingBufAccessor_ still waiting to be sealed with
+  // pendingAead_. Their headers join pendingHeaders_ once they are.
+  std::vector<InplaceEncryptPacket> pendingSeals_;
+  const Aead* pendingAead_{nullptr};
+  BufAccessor* pendingBufAccessor_{nullptr};
 };
 
 } // namespace quic
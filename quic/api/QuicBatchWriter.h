@@ -38,6 +38,12 @@ class BatchWriter {
         << "setTxTime not supported for this batch writer implementation";
   }
 
+  // returns true if append() hands the packet on right away instead of
+  // holding it until write(), so it has to be final when appended
+  [[nodiscard]] virtual bool handsOffOnAppend() const {
+    return false;
+  }
+
   /* append returns true if the
    * writer needs to be flushed
    */
@@ -87,7 +87,10 @@ BatchWriterPtr BatchWriterFactory::makeBatchWriter(
           return BatchWriterPtr(
               new SendmmsgInplacePacketBatchWriter(conn, batchSize));
       }
-    case quic::QuicBatchingMode::BATCHING_MODE_SENDMMSG_GSO: {
+    case quic::QuicBatchingMode::BATCHING_MODE_SENDMMSG_GSO:
+    // Worker batching is provided by QuicServerWorker through the batch
+    // writer factory override. Without it, batch per connection instead.
+    case quic::QuicBatchingMode::BATCHING_MODE_WORKER_SENDMMSG_GSO: {
       if (gsoSupported) {
         if (dataPathType == DataPathType::ChainedMemory) {
           return makeSendmmsgGsoBatchWriter(batchSize);
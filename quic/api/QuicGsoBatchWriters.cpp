@@ -31,8 +31,11 @@ void GSOPacketBatchWriter::reset() {
 
 bool GSOPacketBatchWriter::needsFlush(size_t size) {
   // if we get a buffer with a size that is greater
-  // than the prev one we need to flush
-  return (prevSize_ && (size > prevSize_));
+  // than the prev one we need to flush. All buffers in a batch that is still
+  // open have the same size, so the batch also has to be flushed if this one
+  // would take it past the GSO limit, which large path MTUs can reach.
+  return prevSize_ &&
+      (size > prevSize_ || currBufs_ * prevSize_ + size > kMaxGsoBatchBytes);
 }
 
 bool GSOPacketBatchWriter::append(
@@ -97,7 +100,8 @@ void GSOInplacePacketBatchWriter::reset() {
 }
 
 bool GSOInplacePacketBatchWriter::needsFlush(size_t size) {
-  auto shouldFlush = prevSize_ && size > prevSize_;
+  auto shouldFlush = prevSize_ &&
+      (size > prevSize_ || numPackets_ * prevSize_ + size > kMaxGsoBatchBytes);
   if (shouldFlush) {
     nextPacketSize_ = size;
   }
@@ -235,6 +239,7 @@ void SendmmsgGSOPacketBatchWriter::reset() {
   bufs_.clear();
   options_.clear();
   prevSize_.clear();
+  bytes_.clear();
   addrs_.clear();
   addrMap_.clear();
 
@@ -254,12 +259,13 @@ bool SendmmsgGSOPacketBatchWriter::append(
 
   // try to see if we can append
   if (idx.valid()) {
-    if (size <= prevSize_[idx]) {
+    if (size <= prevSize_[idx] && bytes_[idx] + size <= kMaxGsoBatchBytes) {
       if ((options_[idx].gso == 0) ||
           (static_cast<size_t>(options_[idx].gso) == prevSize_[idx])) {
         // we can append
         options_[idx].gso = prevSize_[idx];
         prevSize_[idx] = size;
+        bytes_[idx] += size;
         bufs_[idx]->appendToChain(std::move(buf));
         currBufs_++;
 
@@ -278,8 +284,10 @@ bool SendmmsgGSOPacketBatchWriter::append(
   // set the gso_ value to 0 for now
   // this will change if we append to this chain
   QuicAsyncUDPSocket::WriteOptions options(0, false);
+  options.txTime = txTime_;
   options_.emplace_back(options);
   prevSize_.emplace_back(size);
+  bytes_.emplace_back(size);
   addrs_.emplace_back(addr);
 
   currBufs_++;
@@ -295,7 +303,8 @@ ssize_t SendmmsgGSOPacketBatchWriter::write(
   if (bufs_.size() == 1) {
     iovec vec[kNumIovecBufferChains];
     size_t iovec_len = fillIovec(bufs_[0], vec);
-    return (currBufs_ > 1)
+    // Only writeGSO carries a tx time.
+    return (currBufs_ > 1 || txTime_.count() > 0)
         ? sock.writeGSO(addrs_[0], vec, iovec_len, options_[0])
         : sock.write(addrs_[0], vec, iovec_len);
   }
@@ -368,7 +377,9 @@ bool SendmmsgGSOInplacePacketBatchWriter::append(
      * has a different size, MUST be smaller than the other packets. It
      * CANNOT be larger.
      */
-    if (size <= buffers_[index].back().iov_len) {
+    if (size <= buffers_[index].back().iov_len &&
+        buffers_[index].size() * buffers_[index].front().iov_len + size <=
+            kMaxGsoBatchBytes) {
       /*
        * It's okay for the last packet to be smaller, but we need to
        * check if the packets preceding it are all of the same size.
@@ -394,6 +405,7 @@ bool SendmmsgGSOInplacePacketBatchWriter::append(
   // For now, set GSO to 0. We'll set it to a non-zero value if we append
   // to this series
   indexToOptions_.emplace_back(0, false);
+  indexToOptions_.back().txTime = txTime_;
   buffers_.push_back({vec});
 
   // Flush if we reach maxBufs_
@@ -408,7 +420,8 @@ ssize_t SendmmsgGSOInplacePacketBatchWriter::write(
   int ret = 0;
 
   if (buffers_.size() == 1) {
-    ret = (currBufs_ > 1) ? sock.writeGSO(
+    // Only writeGSO carries a tx time.
+    ret = (currBufs_ > 1 || txTime_.count() > 0) ? sock.writeGSO(
                                 indexToAddr_[0],
                                 buffers_[0].data(),
                                 buffers_[0].size(),
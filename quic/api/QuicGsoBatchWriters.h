@@ -103,6 +103,10 @@ class SendmmsgGSOPacketBatchWriter : public BatchWriter {
   ssize_t write(QuicAsyncUDPSocket& sock, const quic::SocketAddress& address)
       override;
 
+  void setTxTime(std::chrono::microseconds txTime) override {
+    txTime_ = txTime;
+  }
+
  private:
   // max number of buffer chains we can accumulate before we need to flush
   size_t maxBufs_{1};
@@ -110,10 +114,14 @@ class SendmmsgGSOPacketBatchWriter : public BatchWriter {
   size_t currBufs_{0};
   // size of data in all the buffers
   size_t currSize_{0};
+  // tx time of the messages started from now on
+  std::chrono::microseconds txTime_{0us};
   // array of IOBufs
   std::vector<BufPtr> bufs_;
   std::vector<QuicAsyncUDPSocket::WriteOptions> options_;
   std::vector<size_t> prevSize_;
+  // size of data in each of bufs_, which the kernel sends as one datagram
+  std::vector<size_t> bytes_;
   std::vector<quic::SocketAddress> addrs_;
 
   struct Index {
@@ -156,11 +164,18 @@ class SendmmsgGSOInplacePacketBatchWriter : public BatchWriter {
   ssize_t write(QuicAsyncUDPSocket& sock, const quic::SocketAddress& address)
       override;
 
+  void setTxTime(std::chrono::microseconds txTime) override {
+    txTime_ = txTime;
+  }
+
  private:
   static constexpr size_t kMaxIovecs = 64;
 
   QuicConnectionStateBase& conn_;
 
+  // tx time of the messages started from now on
+  std::chrono::microseconds txTime_{0us};
+
   // The point at which the last packet written by this BatchWriter ended.
   // The reason we need this is so that we can shift any data that was later
   // written to the buffer to the beginning of the buffer once we perform a
@@ -1219,7 +1219,8 @@ CloningScheduler::scheduleFramesForPacket(
   std::move(builder).releaseOutputBuffer();
   // Look for an outstanding packet that's no larger than the writableBytes
   for (auto& outstandingPacket : conn_.outstandings.packets) {
-    if (outstandingPacket.declaredLost) {
+    // Path MTU probes carry nothing worth retransmitting.
+    if (outstandingPacket.declaredLost || outstandingPacket.isPmtuProbe) {
       continue;
     }
     auto opPnSpace = outstandingPacket.packet.header.getPacketNumberSpace();
@@ -1343,4 +1344,50 @@ folly::StringPiece CloningScheduler::name() const {
   return name_;
 }
 
+PmtuProbeScheduler::PmtuProbeScheduler(
+    const QuicConnectionStateBase& conn,
+    folly::StringPiece name,
+    uint64_t cipherOverhead,
+    uint64_t probeSize)
+    : conn_(conn),
+      name_(name),
+      cipherOverhead_(cipherOverhead),
+      probeSize_(probeSize) {}
+
+quic::Expected<SchedulingResult, QuicError>
+PmtuProbeScheduler::scheduleFramesForPacket(
+    PacketBuilderInterface&& builder,
+    uint32_t /* writableBytes */) {
+  MVCHECK(
+      conn_.transportSettings.dataPathType == DataPathType::ChainedMemory);
+  auto encodeRes = builder.encodePacketHeader();
+  if (!encodeRes.has_value()) {
+    return quic::make_unexpected(encodeRes.error());
+  }
+  // Only the PING is ack-eliciting, the rest of the probe is PADDING.
+  auto pingRes = writeFrame(PingFrame(), builder);
+  if (!pingRes.has_value()) {
+    return quic::make_unexpected(pingRes.error());
+  }
+  auto probePacket = std::move(builder).buildPacket();
+  RegularSizeEnforcedPacketBuilder sizeEnforcedBuilder(
+      std::move(probePacket), probeSize_, cipherOverhead_);
+  if (!sizeEnforcedBuilder.canBuildPacket()) {
+    return quic::make_unexpected(QuicError(
+        TransportErrorCode::INTERNAL_ERROR,
+        "Path MTU probe cannot be padded to the probe size"));
+  }
+  probeScheduled_ = true;
+  return SchedulingResult(
+      std::nullopt, std::move(sizeEnforcedBuilder).buildPacket(), 0);
+}
+
+bool PmtuProbeScheduler::hasData() const {
+  return !probeScheduled_;
+}
+
+folly::StringPiece PmtuProbeScheduler::name() const {
+  return name_;
+}
+
 } // namespace quic
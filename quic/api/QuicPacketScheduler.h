@@ -407,4 +407,34 @@ class CloningScheduler : public QuicPacketScheduler {
   uint64_t cipherOverhead_;
 };
 
+/**
+ * Schedules a single path MTU discovery probe: a PING frame padded out to the
+ * probe size, which is larger than udpSendPacketLen. Only supports the chained
+ * memory data path.
+ */
+class PmtuProbeScheduler : public QuicPacketScheduler {
+ public:
+  PmtuProbeScheduler(
+      const QuicConnectionStateBase& conn,
+      folly::StringPiece name,
+      uint64_t cipherOverhead,
+      uint64_t probeSize);
+
+  [[nodiscard]] quic::Expected<SchedulingResult, QuicError>
+  scheduleFramesForPacket(
+      PacketBuilderInterface&& builder,
+      uint32_t writableBytes) override;
+
+  [[nodiscard]] bool hasData() const override;
+
+  [[nodiscard]] folly::StringPiece name() const override;
+
+ private:
+  const QuicConnectionStateBase& conn_;
+  folly::StringPiece name_;
+  uint64_t cipherOverhead_;
+  uint64_t probeSize_;
+  bool probeScheduled_{false};
+};
+
 } // namespace quic
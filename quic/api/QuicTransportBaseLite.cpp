@@ -396,6 +396,10 @@ void QuicTransportBaseLite::onNetworkData(
     }
 
     auto packets = std::move(networkData).movePackets();
+    if (conn_->readCodec) {
+      // Unprotect the headers of a GRO or recvmmsg batch in one go.
+      conn_->readCodec->prepareShortHeaderMasks(packets);
+    }
     for (auto& packet : packets) {
       for (const auto& pp : conn_->packetProcessors) {
         pp->onPacketRead(packet);
@@ -1429,7 +1433,10 @@ void QuicTransportBaseLite::checkForClosedStream() {
     if (closeState_ == CloseState::CLOSED) {
       return;
     }
-    auto result = conn_->streamManager->removeClosedStream(*itr);
+    // Membership of the closed set lives in the stream state, so leave the
+    // set before the state is removed.
+    itr = conn_->streamManager->closedStreams().erase(itr);
+    auto result = conn_->streamManager->removeClosedStream(streamId);
     if (!result.has_value()) {
       exceptionCloseWhat_ = result.error().message;
       closeImpl(QuicError(
@@ -1440,7 +1447,6 @@ void QuicTransportBaseLite::checkForClosedStream() {
     if (readCbIt != readCallbacks_.end()) {
       readCallbacks_.erase(readCbIt);
     }
-    itr = conn_->streamManager->closedStreams().erase(itr);
   } // while
 
   if (closeState_ == CloseState::GRACEFUL_CLOSING &&
@@ -1763,6 +1769,7 @@ void QuicTransportBaseLite::closeImpl(
   MVVLOG_IF(4, isReset) << "Closing transport due to stateless reset " << *this;
   MVVLOG_IF(4, isAbandon) << "Closing transport due to abandoned connection "
                           << *this;
+  QLOG(*conn_, setConnectionCloseError, cancelCode.code);
   if (errorCode) {
     conn_->localConnectionError = errorCode;
     QLOG(
@@ -2633,26 +2640,7 @@ bool QuicTransportBaseLite::hasPeekCallback(StreamId /* id */) {
 void QuicTransportBaseLite::invokeDatagramCallbackIfSet() {}
 
 bool QuicTransportBaseLite::processCancelCode(const QuicError& cancelCode) {
-  bool noError = false;
-  switch (cancelCode.code.type()) {
-    case QuicErrorCode::Type::LocalErrorCode: {
-      LocalErrorCode localErrorCode = *cancelCode.code.asLocalErrorCode();
-      noError = localErrorCode == LocalErrorCode::NO_ERROR ||
-          localErrorCode == LocalErrorCode::IDLE_TIMEOUT ||
-          localErrorCode == LocalErrorCode::SHUTTING_DOWN;
-      break;
-    }
-    case QuicErrorCode::Type::TransportErrorCode: {
-      TransportErrorCode transportErrorCode =
-          *cancelCode.code.asTransportErrorCode();
-      noError = transportErrorCode == TransportErrorCode::NO_ERROR;
-      break;
-    }
-    case QuicErrorCode::Type::ApplicationErrorCode:
-      auto appErrorCode = *cancelCode.code.asApplicationErrorCode();
-      noError = appErrorCode == APP_NO_ERROR;
-  }
-  return noError;
+  return isNoError(cancelCode.code);
 }
 
 uint64_t QuicTransportBaseLite::maxWritableOnConn() const {
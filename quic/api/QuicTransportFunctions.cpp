@@ -25,6 +25,7 @@
 
 #include <quic/state/AckHandlers.h>
 #include <quic/state/ConnectionOopsFields.h>
+#include <quic/state/PmtuDiscoveryFunctions.h>
 #include <quic/state/QuicAckFrequencyFunctions.h>
 #include <quic/state/QuicStateFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
@@ -232,6 +233,23 @@ quic::Expected<WriteQuicDataResult, QuicError> writeQuicDataToSocketImpl(
   }
   packetsWritten += connectionDataResult->packetsWritten;
   bytesWritten += connectionDataResult->bytesWritten;
+  if (connectionDataResult->packetsWritten < packetLimit &&
+      canWritePmtuProbe(connection, Clock::now())) {
+    auto pmtuProbeResult = writePmtuProbeToSocket(
+        sock,
+        connection,
+        srcConnId,
+        dstConnId,
+        aead,
+        headerCipher,
+        version,
+        packetLimit - connectionDataResult->packetsWritten);
+    if (!pmtuProbeResult.has_value()) {
+      return quic::make_unexpected(pmtuProbeResult.error());
+    }
+    packetsWritten += pmtuProbeResult->packetsWritten;
+    bytesWritten += pmtuProbeResult->bytesWritten;
+  }
   MVVLOG_IF(10, packetsWritten || probesWritten)
       << nodeToString(connection.nodeType) << " written data "
       << (exceptCryptoStream ? "without crypto data " : "")
@@ -439,48 +457,50 @@ continuousMemoryBuildScheduleEncrypt(
   MVCHECK(
       packet->header.data() >= connection.bufAccessor->data() &&
       packet->header.tail() < connection.bufAccessor->tail());
-  // Trim off everything before the current packet, and the header length, so
-  // buf's data starts from the body part of buf.
-  connection.bufAccessor->trimStart(prevSize + headerLen);
-  // buf and packetBuf is actually the same.
-  auto buf = connection.bufAccessor->obtain();
-  auto encryptResult =
-      aead.inplaceEncrypt(std::move(buf), &packet->header, packetNum);
-  if (!encryptResult.has_value()) {
-    return quic::make_unexpected(encryptResult.error());
-  }
-  auto packetBuf = std::move(encryptResult.value());
-  MVCHECK(packetBuf->headroom() == headerLen + prevSize);
-  // Include header back.
-  packetBuf->prepend(headerLen);
-
-  HeaderForm headerForm = packet->packet.header.getHeaderForm();
-  auto headerEncryptResult = encryptPacketHeader(
-      headerForm,
-      packetBuf->writableData(),
-      headerLen,
-      packetBuf->data() + headerLen,
-      packetBuf->length() - headerLen,
-      headerCipher);
-  if (!headerEncryptResult.has_value()) {
-    return quic::make_unexpected(headerEncryptResult.error());
-  }
-  if (!headerEncryptResult.has_value()) {
-    return quic::make_unexpected(headerEncryptResult.error());
-  }
-  MVCHECK(!packetBuf->isChained());
-  auto encodedSize = packetBuf->length();
+  MVCHECK(packet->header.data() == connection.bufAccessor->data() + prevSize);
+  // Everything after the header is body.
+  auto bodyLen = connection.bufAccessor->length() - prevSize - headerLen;
+  // The tag goes right after the body. It is only written once ioBufBatch
+  // seals the batch, but its room is taken now so nothing else lands there.
+  if (connection.bufAccessor->tailroom() < cipherOverhead) {
+    return quic::make_unexpected(QuicError(
+        TransportErrorCode::INTERNAL_ERROR,
+        "No room for the cipher overhead in the write buffer"));
+  }
+  connection.bufAccessor->append(cipherOverhead);
+  InplaceEncryptPacket sealPacket;
+  sealPacket.headerOffset = prevSize;
+  sealPacket.headerLen = headerLen;
+  sealPacket.payloadLen = bodyLen;
+  sealPacket.seqNum = packetNum;
+  auto encodedSize = headerLen + bodyLen + cipherOverhead;
   auto encodedBodySize = encodedSize - headerLen;
-  // Include previous packets back.
-  packetBuf->prepend(prevSize);
-  if (connection.transportSettings.isPriming && packetBuf) {
+  if (connection.transportSettings.isPriming) {
+    auto packetBuf = connection.bufAccessor->obtain();
+    auto encryptResult =
+        aead.inplaceEncryptBatch(std::move(packetBuf), &sealPacket, 1);
+    if (!encryptResult.has_value()) {
+      return quic::make_unexpected(encryptResult.error());
+    }
+    packetBuf = std::move(encryptResult.value());
+    auto headerStart = packetBuf->writableData() + prevSize;
+    auto pendingHeader = makePendingHeaderProtection(
+        packet->packet.header.getHeaderForm(),
+        headerStart,
+        headerLen,
+        headerStart + headerLen,
+        encodedBodySize);
+    auto headerEncryptResult = headerCipher.encryptHeaders(&pendingHeader, 1);
+    if (!headerEncryptResult.has_value()) {
+      return quic::make_unexpected(headerEncryptResult.error());
+    }
+    MVCHECK(!packetBuf->isChained());
     packetBuf->coalesce();
     connection.bufAccessor->release(BufHelpers::create(packetBuf->capacity()));
     connection.primingData.emplace_back(std::move(packetBuf));
     return DataPathResult::makeWriteResult(
         true, std::move(result.value()), encodedSize, encodedBodySize);
   }
-  connection.bufAccessor->release(std::move(packetBuf));
 
   // Append SCONE flow indicator as the last 2 bytes of the datagram
   if (flowIndSize > 0) {
@@ -500,9 +520,10 @@ continuousMemoryBuildScheduleEncrypt(
     return DataPathResult::makeWriteResult(
         true, std::move(result.value()), encodedSize, encodedBodySize);
   }
-  // TODO: I think we should add an API that doesn't need a buffer.
-  auto writeResult =
-      ioBufBatch.write(nullptr /* no need to pass buf */, encodedSize);
+  // Sealing and header protection are left to ioBufBatch, which does them
+  // for the whole batch at once.
+  auto writeResult = ioBufBatch.write(
+      encodedSize, sealPacket, aead, headerCipher, *connection.bufAccessor);
   if (!writeResult.has_value()) {
     return quic::make_unexpected(writeResult.error());
   }
@@ -621,16 +642,19 @@ iobufChainBasedBuildScheduleEncrypt(
   MVCHECK(headerCursor.tryPull(packetBuf->writableData(), headerLen));
   packetBuf->append(headerLen + bodyLen + aead.getCipherOverhead());
 
-  HeaderForm headerForm = packet->packet.header.getHeaderForm();
-  auto headerEncryptResult = encryptPacketHeader(
-      headerForm,
+  // Header protection is left to ioBufBatch, which does it for the whole
+  // batch at once.
+  auto pendingHeader = makePendingHeaderProtection(
+      packet->packet.header.getHeaderForm(),
       packetBuf->writableData(),
       headerLen,
       packetBuf->data() + headerLen,
-      packetBuf->length() - headerLen,
-      headerCipher);
-  if (!headerEncryptResult.has_value()) {
-    return quic::make_unexpected(headerEncryptResult.error());
+      packetBuf->length() - headerLen);
+  if (connection.transportSettings.isPriming) {
+    auto headerEncryptResult = headerCipher.encryptHeaders(&pendingHeader, 1);
+    if (!headerEncryptResult.has_value()) {
+      return quic::make_unexpected(headerEncryptResult.error());
+    }
   }
   auto encodedSize = packetBuf->computeChainDataLength();
   auto encodedBodySize = encodedSize - headerLen;
@@ -679,7 +703,8 @@ iobufChainBasedBuildScheduleEncrypt(
     return DataPathResult::makeWriteResult(
         true, std::move(result.value()), encodedSize, encodedBodySize);
   }
-  auto writeResult = ioBufBatch.write(std::move(packetBuf), encodedSize);
+  auto writeResult = ioBufBatch.write(
+      std::move(packetBuf), encodedSize, pendingHeader, headerCipher);
   if (!writeResult.has_value()) {
     return quic::make_unexpected(writeResult.error());
   }
@@ -1721,6 +1746,28 @@ void writeShortClose(
       headerCipher);
 }
 
+PendingHeaderProtection makePendingHeaderProtection(
+    HeaderForm headerForm,
+    uint8_t* header,
+    size_t headerLen,
+    const uint8_t* encryptedBody,
+    size_t bodyLen) {
+  auto packetNumberLength = parsePacketNumberLength(*header);
+  PendingHeaderProtection pending;
+  size_t sampleBytesToUse = kMaxPacketNumEncodingSize - packetNumberLength;
+  // If there were less than 4 bytes in the packet number, some of the payload
+  // bytes will also be skipped during sampling.
+  MVCHECK_GE(bodyLen, sampleBytesToUse + pending.sample.size());
+  memcpy(
+      pending.sample.data(),
+      encryptedBody + sampleBytesToUse,
+      pending.sample.size());
+  pending.initialByte = header;
+  pending.packetNumber = header + headerLen - packetNumberLength;
+  pending.longHeader = headerForm == HeaderForm::Long;
+  return pending;
+}
+
 quic::Expected<void, QuicError> encryptPacketHeader(
     HeaderForm headerForm,
     uint8_t* header,
@@ -1962,6 +2009,8 @@ quic::Expected<WriteQuicDataResult, QuicError> writeConnectionDataToSocket(
   };
 
   quic::TimePoint sentTime = Clock::now();
+  // Pacers handing pacing to the kernel give every packet a departure time.
+  const bool stampTxTime = isConnectionPaced(connection);
 
   while (scheduler.hasData() && ioBufBatch.getPktSent() < packetLimit &&
          ((ioBufBatch.getPktSent() < batchSize) ||
@@ -1990,6 +2039,21 @@ quic::Expected<WriteQuicDataResult, QuicError> writeConnectionDataToSocket(
         ? iobufChainBasedBuildScheduleEncrypt
         : continuousMemoryBuildScheduleEncrypt;
 
+    if (stampTxTime) {
+      auto txTimeResult =
+          ioBufBatch.setTxTime(connection.pacer->getTxTimeOffset(sentTime));
+      if (!txTimeResult.has_value()) {
+        return quic::make_unexpected(txTimeResult.error());
+      }
+      if (!*txTimeResult) {
+        if (connection.loopDetectorCallback) {
+          connection.writeDebugState.noWriteReason =
+              NoWriteReason::SOCKET_FAILURE;
+        }
+        return WriteQuicDataResult{ioBufBatch.getPktSent(), 0, bytesWritten};
+      }
+    }
+
     auto ret = dataPlaneFunc(
         connection,
         std::move(header),
@@ -2318,6 +2382,9 @@ WriteDataReason hasNonAckDataToWrite(const QuicConnectionStateBase& conn) {
   if (conn.datagramState.flowManager.hasDatagramsToSend()) {
     return WriteDataReason::DATAGRAM;
   }
+  if (canWritePmtuProbe(conn, Clock::now())) {
+    return WriteDataReason::PMTU_PROBE;
+  }
   return WriteDataReason::NO_WRITE;
 }
 
@@ -2442,6 +2509,7 @@ void handshakeConfirmed(QuicConnectionStateBase& conn) {
   conn.readCodec->setHandshakeHeaderCipher(nullptr);
   implicitAckCryptoStream(conn, EncryptionLevel::Handshake);
   conn.ackStates.handshakeAckState.reset();
+  startPmtuDiscovery(conn, Clock::now());
 }
 
 bool hasInitialOrHandshakeCiphers(QuicConnectionStateBase& conn) {
@@ -2709,6 +2777,73 @@ void updateNegotiatedAckFeatures(QuicConnectionStateBase& conn) {
   }
 }
 
+bool canWritePmtuProbe(const QuicConnectionStateBase& conn, TimePoint now) {
+  if (!shouldSendPmtuProbe(conn, now)) {
+    return false;
+  }
+  // Probes are subject to congestion control like any other packet. Once the
+  // search is due, probeSize is the size of the next probe.
+  uint64_t writableBytes =
+      pathValidationWritableBytes(conn, conn.currentPathId);
+  if (conn.congestionController) {
+    writableBytes = std::min<uint64_t>(
+        writableBytes, conn.congestionController->getWritableBytes());
+  }
+  return writableBytes >= conn.pmtuDiscovery->probeSize;
+}
+
+quic::Expected<WriteQuicDataResult, QuicError> writePmtuProbeToSocket(
+    QuicAsyncUDPSocket& sock,
+    QuicConnectionStateBase& connection,
+    const ConnectionId& srcConnId,
+    const ConnectionId& dstConnId,
+    const Aead& aead,
+    const PacketNumberCipher& headerCipher,
+    QuicVersion version,
+    uint64_t packetLimit) {
+  auto now = Clock::now();
+  if (packetLimit == 0 || !canWritePmtuProbe(connection, now)) {
+    return WriteQuicDataResult{};
+  }
+  auto probeSize = nextPmtuProbeSize(connection, now);
+  auto packetNum = getNextPacketNum(connection, PacketNumberSpace::AppData);
+  PmtuProbeScheduler scheduler(
+      connection, "PmtuProbeScheduler", aead.getCipherOverhead(), probeSize);
+  auto result = writeConnectionDataToSocket(
+      sock,
+      connection,
+      connection.currentPathId,
+      srcConnId,
+      dstConnId,
+      ShortHeaderBuilder(connection.oneRttWritePhase),
+      PacketNumberSpace::AppData,
+      scheduler,
+      unlimitedWritableBytes,
+      1,
+      aead,
+      headerCipher,
+      version,
+      now);
+  if (!result.has_value()) {
+    return quic::make_unexpected(result.error());
+  }
+  if (result->packetsWritten == 0) {
+    return result;
+  }
+  auto probeIt = std::find_if(
+      connection.outstandings.packets.rbegin(),
+      connection.outstandings.packets.rend(),
+      [packetNum](const auto& packet) {
+        return packet.getPacketSequenceNum() == packetNum;
+      });
+  MVCHECK(probeIt != connection.outstandings.packets.rend());
+  probeIt->isPmtuProbe = true;
+  onPmtuProbeSent(connection, packetNum);
+  MVVLOG(4) << nodeToString(connection.nodeType)
+            << " sent path MTU probe size=" << probeSize << " " << connection;
+  return result;
+}
+
 quic::Expected<WriteQuicDataResult, QuicError>
 writePathValidationDataForAlternatePaths(
     QuicAsyncUDPSocket& sock,
@@ -117,6 +117,30 @@ writePathValidationDataForAlternatePaths(
     uint64_t packetLimit,
     TimePoint writeLoopBeginTime = Clock::now());
 
+/**
+ * Whether a path MTU discovery probe is due and the congestion window leaves
+ * room for it. The probe counts as one packet against a write loop's packet
+ * limit, whatever its size.
+ */
+[[nodiscard]] bool canWritePmtuProbe(
+    const QuicConnectionStateBase& conn,
+    TimePoint now);
+
+/**
+ * Writes a path MTU discovery probe if canWritePmtuProbe() and packetLimit
+ * leaves room for one more packet.
+ */
+[[nodiscard]] quic::Expected<WriteQuicDataResult, QuicError>
+writePmtuProbeToSocket(
+    QuicAsyncUDPSocket& sock,
+    QuicConnectionStateBase& connection,
+    const ConnectionId& srcConnId,
+    const ConnectionId& dstConnId,
+    const Aead& aead,
+    const PacketNumberCipher& headerCipher,
+    QuicVersion version,
+    uint64_t packetLimit);
+
 /**
  * Writes only the crypto and ack frames to the socket.
  *
@@ -286,6 +310,19 @@ void writeShortClose(
     const Aead& aead,
     const PacketNumberCipher& headerCipher);
 
+/**
+ * Takes the header protection sample of a packet, leaving the header itself
+ * untouched so that its protection can be batched with other packets, see
+ * PacketNumberCipher::encryptHeaders(). Like encryptPacketHeader(), it
+ * verifies via a CHECK that encryptedBody is long enough to sample.
+ */
+PendingHeaderProtection makePendingHeaderProtection(
+    HeaderForm headerForm,
+    uint8_t* header,
+    size_t headerLen,
+    const uint8_t* encryptedBody,
+    size_t bodyLen);
+
 /**
  * Encrypts the packet header for the header type.
  * This will overwrite the header with the encrypted header form. It will verify
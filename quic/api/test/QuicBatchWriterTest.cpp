@@ -660,6 +660,72 @@ TEST_F(QuicBatchWriterTest, TestBatchingSendmmsgGSOBatcBigSmallPacket) {
   }
 }
 
+TEST_F(QuicBatchWriterTest, TestBatchingGSOMaxBatchBytes) {
+  gsoSupported_ = true;
+  // Path MTU discovery can raise the packet size far enough that a batch hits
+  // the GSO byte limit well before maxBufs.
+  size_t packetSize = 16000;
+  auto batchWriter = quic::BatchWriterFactory::makeBatchWriter(
+      quic::QuicBatchingMode::BATCHING_MODE_GSO,
+      64,
+      DataPathType::ChainedMemory,
+      conn_,
+      gsoSupported_);
+  CHECK(batchWriter);
+  for (size_t i = 0; i < kMaxGsoBatchBytes / packetSize; i++) {
+    EXPECT_FALSE(batchWriter->needsFlush(packetSize));
+    EXPECT_FALSE(batchWriter->append(
+        folly::IOBuf::create(packetSize),
+        packetSize,
+        quic::SocketAddress(),
+        nullptr));
+  }
+  EXPECT_TRUE(batchWriter->needsFlush(packetSize));
+  EXPECT_LE(batchWriter->size(), kMaxGsoBatchBytes);
+}
+
+TEST_F(QuicBatchWriterTest, TestBatchingSendmmsgGSOMaxBatchBytes) {
+  gsoSupported_ = true;
+  size_t packetSize = 16000;
+  size_t numPackets = kMaxGsoBatchBytes / packetSize + 1;
+
+  folly::EventBase evb;
+  std::shared_ptr<FollyQuicEventBase> qEvb =
+      std::make_shared<FollyQuicEventBase>(&evb);
+  quic::test::MockAsyncUDPSocket sock(qEvb);
+
+  auto batchWriter = quic::BatchWriterFactory::makeBatchWriter(
+      quic::QuicBatchingMode::BATCHING_MODE_SENDMMSG_GSO,
+      64,
+      DataPathType::ChainedMemory,
+      conn_,
+      gsoSupported_);
+  CHECK(batchWriter);
+  for (size_t i = 0; i < numPackets; i++) {
+    EXPECT_FALSE(batchWriter->append(
+        folly::IOBuf::create(packetSize),
+        packetSize,
+        quic::SocketAddress(),
+        nullptr));
+  }
+
+  // The packet past the limit starts a second message to the same address.
+  EXPECT_CALL(sock, writemGSO(_, _, _, _))
+      .WillOnce(Invoke([&](folly::Range<quic::SocketAddress const*>,
+                           const std::unique_ptr<folly::IOBuf>* bufs,
+                           size_t count,
+                           const QuicAsyncUDPSocket::WriteOptions* options) {
+        EXPECT_EQ(count, 2);
+        EXPECT_EQ(options[0].gso, packetSize);
+        EXPECT_EQ(bufs[0]->countChainElements(), numPackets - 1);
+        EXPECT_EQ(options[1].gso, 0);
+        EXPECT_EQ(bufs[1]->countChainElements(), 1);
+        return 2;
+      }));
+  EXPECT_EQ(
+      batchWriter->write(sock, quic::SocketAddress()), packetSize * numPackets);
+}
+
 // Test the case where we send 5 packets, all of the same size, to the
 // same address.
 TEST_F(QuicBatchWriterTest, TestBatchingSendmmsgGSOInplaceSameSizeAll) {
@@ -1043,6 +1109,29 @@ TEST_F(QuicBatchWriterTest, InplaceWriterNeedsFlush) {
   EXPECT_TRUE(batchWriter->needsFlush(conn_.udpSendPacketLen));
 }
 
+TEST_F(QuicBatchWriterTest, InplaceWriterNeedsFlushAtMaxBatchBytes) {
+  gsoSupported_ = true;
+  size_t packetSize = 16000;
+  size_t numPackets = kMaxGsoBatchBytes / packetSize;
+  auto bufAccessor =
+      std::make_unique<BufAccessor>(packetSize * (numPackets + 1));
+  conn_.bufAccessor = bufAccessor.get();
+  auto batchWriter = quic::BatchWriterFactory::makeBatchWriter(
+      quic::QuicBatchingMode::BATCHING_MODE_GSO,
+      64,
+      DataPathType::ContinuousMemory,
+      conn_,
+      gsoSupported_);
+  CHECK(batchWriter);
+  for (size_t i = 0; i < numPackets; i++) {
+    EXPECT_FALSE(batchWriter->needsFlush(packetSize));
+    bufAccessor->append(packetSize);
+    EXPECT_FALSE(batchWriter->append(
+        nullptr, packetSize, quic::SocketAddress(), nullptr));
+  }
+  EXPECT_TRUE(batchWriter->needsFlush(packetSize));
+}
+
 TEST_F(QuicBatchWriterTest, InplaceWriterAppendLimit) {
   gsoSupported_ = true;
   uint32_t batchSize = 20;
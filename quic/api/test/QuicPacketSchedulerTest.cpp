@@ -734,6 +734,37 @@ TEST_P(QuicPacketSchedulerTest, CloningSchedulerTest) {
   EXPECT_EQ(packetNum, result->clonedPacketIdentifier->packetNumber);
 }
 
+TEST_P(QuicPacketSchedulerTest, CloningSchedulerSkipsPmtuProbe) {
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  FrameScheduler noopScheduler("frame", conn);
+  CloningScheduler cloningScheduler(noopScheduler, conn, "CopyCat", 0);
+  // Give the probe a retransmittable frame too, so only being a probe keeps
+  // it from being cloned.
+  addOutstandingPacket(conn);
+  conn.outstandings.packets.back().packet.frames.push_back(
+      MaxDataFrame(conn.flowControlState.advertisedMaxOffset));
+  conn.outstandings.packets.back().isPmtuProbe = true;
+  auto packetNum = addOutstandingPacket(conn);
+  conn.outstandings.packets.back().packet.frames.push_back(
+      MaxDataFrame(conn.flowControlState.advertisedMaxOffset));
+
+  ShortHeader header(
+      ProtectionType::KeyPhaseOne,
+      conn.clientConnectionId.value_or(getTestConnectionId()),
+      getNextPacketNum(conn, PacketNumberSpace::AppData));
+  RegularQuicPacketBuilder builder(
+      conn.udpSendPacketLen,
+      std::move(header),
+      conn.ackStates.appDataAckState.largestAckedByPeer.value_or(0));
+  auto result = cloningScheduler.scheduleFramesForPacket(
+      std::move(builder), kDefaultUDPSendPacketLen);
+  ASSERT_FALSE(result.hasError());
+  ASSERT_TRUE(
+      result->clonedPacketIdentifier.has_value() && result->packet.has_value());
+  EXPECT_EQ(packetNum, result->clonedPacketIdentifier->packetNumber);
+}
+
 TEST_P(QuicPacketSchedulerTest, WriteOnlyOutstandingPacketsTest) {
   QuicClientConnectionState conn(
       FizzClientQuicHandshakeContext::Builder().build());
@@ -21,6 +21,7 @@
 #include <quic/logging/FileQLogger.h>
 #include <quic/logging/QLoggerConstants.h>
 #include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/PmtuDiscoveryFunctions.h>
 #include <quic/state/test/MockQuicStats.h>
 #include <quic/state/test/Mocks.h>
 
@@ -3368,7 +3369,7 @@ TEST_F(QuicTransportFunctionsTest, NothingWritten) {
 }
 
 const QuicWriteFrame& getFirstFrameInOutstandingPackets(
-    const std::deque<OutstandingPacketWrapper>& outstandingPackets,
+    const OutstandingPacketContainer& outstandingPackets,
     QuicWriteFrame::Type frameType) {
   for (const auto& packet : outstandingPackets) {
     for (const auto& frame : packet.packet.frames) {
@@ -4170,6 +4171,171 @@ TEST_F(
   EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(*conn));
 }
 
+TEST_F(QuicTransportFunctionsTest, HasPmtuProbeToWrite) {
+  auto conn = createConn();
+  conn->udpSendPacketLen = 1200;
+  conn->oneRttWriteCipher = test::createNoOpAead();
+  conn->transportSettings.pmtuDiscoveryConfig.enabled = true;
+  conn->transportSettings.pmtuDiscoveryConfig.maxPacketSize = 1500;
+  maybeInitPmtuDiscovery(*conn, kMaxUDPPayload);
+  ASSERT_TRUE(conn->pmtuDiscovery.has_value());
+  auto mockCongestionController =
+      std::make_unique<NiceMock<MockCongestionController>>();
+  auto rawCongestionController = mockCongestionController.get();
+  conn->congestionController = std::move(mockCongestionController);
+  uint64_t writableBytes = 1500;
+  EXPECT_CALL(*rawCongestionController, getWritableBytes())
+      .WillRepeatedly(
+          InvokeWithoutArgs([&writableBytes]() { return writableBytes; }));
+
+  // Not before the handshake is confirmed.
+  EXPECT_EQ(WriteDataReason::NO_WRITE, hasNonAckDataToWrite(*conn));
+
+  startPmtuDiscovery(*conn, Clock::now());
+  EXPECT_EQ(WriteDataReason::PMTU_PROBE, hasNonAckDataToWrite(*conn));
+
+  // Not when the probe does not fit the congestion window.
+  writableBytes = 1499;
+  EXPECT_EQ(WriteDataReason::NO_WRITE, hasNonAckDataToWrite(*conn));
+
+  // Not while a probe is outstanding.
+  writableBytes = 1500;
+  onPmtuProbeSent(*conn, 1);
+  EXPECT_EQ(WriteDataReason::NO_WRITE, hasNonAckDataToWrite(*conn));
+}
+
+TEST_F(QuicTransportFunctionsTest, WritePmtuProbeToSocket) {
+  auto conn = createConn();
+  conn->udpSendPacketLen = 1200;
+  conn->transportSettings.pmtuDiscoveryConfig.enabled = true;
+  conn->transportSettings.pmtuDiscoveryConfig.maxPacketSize = 1500;
+  maybeInitPmtuDiscovery(*conn, kMaxUDPPayload);
+  ASSERT_TRUE(conn->pmtuDiscovery.has_value());
+  auto mockCongestionController =
+      std::make_unique<NiceMock<MockCongestionController>>();
+  auto rawCongestionController = mockCongestionController.get();
+  conn->congestionController = std::move(mockCongestionController);
+  uint64_t writableBytes = 10000;
+  EXPECT_CALL(*rawCongestionController, getWritableBytes())
+      .WillRepeatedly(
+          InvokeWithoutArgs([&writableBytes]() { return writableBytes; }));
+
+  EventBase evb;
+  std::shared_ptr<FollyQuicEventBase> qEvb =
+      std::make_shared<FollyQuicEventBase>(&evb);
+  auto socket =
+      std::make_unique<NiceMock<quic::test::MockAsyncUDPSocket>>(qEvb);
+  auto rawSocket = socket.get();
+  ON_CALL(*rawSocket, getGSO).WillByDefault(testing::Return(0));
+  auto writeProbe = [&](uint64_t packetLimit) {
+    auto res = writePmtuProbeToSocket(
+        *rawSocket,
+        *conn,
+        *conn->clientConnectionId,
+        *conn->serverConnectionId,
+        *aead,
+        *headerCipher,
+        getVersion(*conn),
+        packetLimit);
+    MVCHECK(!res.hasError());
+    return *res;
+  };
+
+  // Nothing before the search starts.
+  EXPECT_CALL(*rawSocket, write(_, _, _)).Times(0);
+  EXPECT_EQ(0, writeProbe(10).packetsWritten);
+
+  startPmtuDiscovery(*conn, Clock::now());
+  // Nor when the congestion window has no room for the probe or the packet
+  // limit is used up.
+  writableBytes = 1000;
+  EXPECT_EQ(0, writeProbe(10).packetsWritten);
+  writableBytes = 10000;
+  EXPECT_EQ(0, writeProbe(0).packetsWritten);
+  EXPECT_TRUE(conn->outstandings.packets.empty());
+
+  size_t probeLen = 0;
+  EXPECT_CALL(*rawSocket, write(_, _, _))
+      .WillOnce(Invoke(
+          [&](const SocketAddress&, const struct iovec* vec, size_t iovec_len) {
+            probeLen = getTotalIovecLen(vec, iovec_len);
+            return probeLen;
+          }));
+  // The probe counts as a single packet, however large.
+  auto res = writeProbe(1);
+  EXPECT_EQ(1, res.packetsWritten);
+  EXPECT_EQ(1500, probeLen);
+  EXPECT_EQ(probeLen, res.bytesWritten);
+
+  ASSERT_EQ(1, conn->outstandings.packets.size());
+  auto& probe = conn->outstandings.packets.back();
+  EXPECT_TRUE(probe.isPmtuProbe);
+  EXPECT_EQ(
+      probe.getPacketSequenceNum(), conn->pmtuDiscovery->outstandingProbe);
+  // The probe is a PING, padded to the probe size.
+  EXPECT_TRUE(std::any_of(
+      probe.packet.frames.begin(),
+      probe.packet.frames.end(),
+      [](const auto& frame) { return frame.asPingFrame() != nullptr; }));
+  EXPECT_FALSE(shouldSendPmtuProbe(*conn, Clock::now()));
+}
+
+TEST_F(QuicTransportFunctionsTest, WriteJumboPmtuProbe) {
+  auto conn = createConn();
+  conn->oneRttWriteCipher = test::createNoOpAead();
+  conn->transportSettings.pmtuDiscoveryConfig.enabled = true;
+  conn->transportSettings.pmtuDiscoveryConfig.maxPacketSize = 9000;
+  maybeInitPmtuDiscovery(*conn, kMaxUDPPayload);
+  ASSERT_TRUE(conn->pmtuDiscovery.has_value());
+  auto mockCongestionController =
+      std::make_unique<NiceMock<MockCongestionController>>();
+  auto rawCongestionController = mockCongestionController.get();
+  conn->congestionController = std::move(mockCongestionController);
+  EXPECT_CALL(*rawCongestionController, getWritableBytes())
+      .WillRepeatedly(Return(100000));
+
+  EventBase evb;
+  std::shared_ptr<FollyQuicEventBase> qEvb =
+      std::make_shared<FollyQuicEventBase>(&evb);
+  auto socket =
+      std::make_unique<NiceMock<quic::test::MockAsyncUDPSocket>>(qEvb);
+  auto rawSocket = socket.get();
+  ON_CALL(*rawSocket, getGSO).WillByDefault(testing::Return(0));
+
+  startPmtuDiscovery(*conn, Clock::now());
+  // The ceiling is well above what the default packet limit allows in
+  // udpSendPacketLen sized packets.
+  ASSERT_GT(
+      9000,
+      conn->transportSettings.writeConnectionDataPacketsLimit *
+          conn->udpSendPacketLen);
+  ASSERT_EQ(WriteDataReason::PMTU_PROBE, shouldWriteData(*conn));
+
+  size_t probeLen = 0;
+  EXPECT_CALL(*rawSocket, write(_, _, _))
+      .WillOnce(Invoke(
+          [&](const SocketAddress&, const struct iovec* vec, size_t iovec_len) {
+            probeLen = getTotalIovecLen(vec, iovec_len);
+            return probeLen;
+          }));
+  auto res = writeQuicDataToSocket(
+      *rawSocket,
+      *conn,
+      *conn->clientConnectionId,
+      *conn->serverConnectionId,
+      *aead,
+      *headerCipher,
+      getVersion(*conn),
+      conn->transportSettings.writeConnectionDataPacketsLimit);
+  ASSERT_FALSE(res.hasError());
+  EXPECT_EQ(1, res->packetsWritten);
+  EXPECT_EQ(9000, probeLen);
+  ASSERT_EQ(1, conn->outstandings.packets.size());
+  EXPECT_TRUE(conn->outstandings.packets.back().isPmtuProbe);
+  // With the probe in flight the write looper has nothing left to do.
+  EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(*conn));
+}
+
 TEST_F(
     QuicTransportFunctionsTest,
     HasAlternatePathValidationDataToWriteRequiresFullPacketBudget) {
@@ -5104,6 +5270,57 @@ TEST_F(QuicTransportFunctionsTest, WriteWithInplaceBuilderGSOMultiplePackets) {
   EXPECT_EQ(0, bufPtr->headroom());
 }
 
+TEST_F(QuicTransportFunctionsTest, WriteWithInplaceBuilderSealsBatchAtFlush) {
+  auto conn = createConn();
+  conn->transportSettings.dataPathType = DataPathType::ContinuousMemory;
+  auto bufAccessor = std::make_unique<BufAccessor>(conn->udpSendPacketLen * 16);
+  conn->bufAccessor = bufAccessor.get();
+  conn->transportSettings.batchingMode = QuicBatchingMode::BATCHING_MODE_GSO;
+  EventBase evb;
+  std::shared_ptr<FollyQuicEventBase> qEvb =
+      std::make_shared<FollyQuicEventBase>(&evb);
+  quic::test::MockAsyncUDPSocket mockSock(qEvb);
+  EXPECT_CALL(mockSock, getGSO()).WillRepeatedly(Return(true));
+  auto stream = conn->streamManager->createNextBidirectionalStream().value();
+  auto buf = buildRandomInputData(conn->udpSendPacketLen * 10);
+  ASSERT_FALSE(writeDataToQuicStream(*stream, buf->clone(), true).hasError());
+
+  constexpr size_t kCipherOverhead = 16;
+  auto sealingAead = createNoOpAead(kCipherOverhead);
+  size_t sealedPackets = 0;
+  size_t sealedBytes = 0;
+  EXPECT_CALL(*sealingAead, _inplaceEncrypt(_, _, _))
+      .WillRepeatedly(Invoke([&](auto& plaintext, const Buf* header, auto) {
+        sealedPackets++;
+        sealedBytes += header->length() + plaintext->length() + kCipherOverhead;
+        return std::move(plaintext);
+      }));
+  EXPECT_CALL(mockSock, writeGSO(_, _, _, _))
+      .Times(1)
+      .WillOnce(Invoke([&](const quic::SocketAddress&,
+                           const struct iovec* vec,
+                           size_t iovec_len,
+                           QuicAsyncUDPSocket::WriteOptions) {
+        // Every packet of the batch is sealed by the time it is written, tag
+        // included.
+        EXPECT_GT(sealedPackets, 1);
+        EXPECT_EQ(sealedPackets, conn->outstandings.packets.size());
+        EXPECT_EQ(sealedBytes, getTotalIovecLen(vec, iovec_len));
+        return getTotalIovecLen(vec, iovec_len);
+      }));
+  ASSERT_FALSE(writeQuicDataToSocket(
+                   mockSock,
+                   *conn,
+                   *conn->clientConnectionId,
+                   *conn->serverConnectionId,
+                   *sealingAead,
+                   *headerCipher,
+                   getVersion(*conn),
+                   conn->transportSettings.writeConnectionDataPacketsLimit)
+                   .hasError());
+  EXPECT_EQ(sealedPackets, conn->outstandings.packets.size());
+}
+
 TEST_F(QuicTransportFunctionsTest, WriteProbingWithInplaceBuilder) {
   auto conn = createConn();
   conn->transportSettings.dataPathType = DataPathType::ContinuousMemory;
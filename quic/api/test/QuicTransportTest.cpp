@@ -9,6 +9,7 @@
 #include <gtest/gtest.h>
 
 #include <folly/Random.h>
+#include <folly/portability/Filesystem.h>
 #include <quic/QuicConstants.h>
 #include <quic/api/QuicTransportBase.h>
 #include <quic/api/QuicTransportFunctions.h>
@@ -21,6 +22,8 @@
 #include <quic/congestion_control/EcnL4sTracker.h>
 #include <quic/congestion_control/StaticCwndCongestionController.h>
 #include <quic/handshake/test/Mocks.h>
+#include <quic/logging/FileQLogger.h>
+#include <quic/logging/FlightRecorderQLogger.h>
 #include <quic/logging/test/Mocks.h>
 #include <quic/priority/HTTPPriorityQueue.h>
 #include <quic/state/QuicStreamFunctions.h>
@@ -6173,4 +6176,61 @@ TEST_F(QuicTransportTest, ValidateL4SFailure) {
   }
 }
 
+class QuicTransportFlightRecorderTest : public QuicTransportTest {
+ public:
+  void SetUp() override {
+    QuicTransportTest::SetUp();
+    auto dcid = ConnectionId::createRandom(8).value();
+    jsonPath_ = fmt::format(
+        "{}/{}{}",
+        folly::fs::temp_directory_path().string(),
+        dcid.hex(),
+        FileQLogger::kQlogExtension);
+    qLogger_ = std::make_shared<FlightRecorderQLogger>(
+        VantagePoint::Client,
+        kHTTP3ProtocolType,
+        folly::fs::temp_directory_path().string(),
+        FlightRecorderQLogger::kDefaultMaxEvents,
+        FlightRecorderQLogger::kDefaultCapacityBytes,
+        FlightRecorderQLogger::kDefaultPtoCountThreshold,
+        true /* prettyJson */,
+        writer_);
+    qLogger_->setDcid(dcid);
+    transport_->getConnectionState().qLogger = qLogger_;
+  }
+
+  bool dumped() {
+    writer_->flush();
+    return folly::fs::exists(jsonPath_);
+  }
+
+  std::shared_ptr<BinaryQLogWriter> writer_{
+      std::make_shared<BinaryQLogWriter>()};
+  std::shared_ptr<FlightRecorderQLogger> qLogger_;
+  std::string jsonPath_;
+};
+
+TEST_F(QuicTransportFlightRecorderTest, NoDumpOnAppNoError) {
+  transport_->close(QuicError(
+      QuicErrorCode(GenericApplicationErrorCode::NO_ERROR),
+      toString(GenericApplicationErrorCode::NO_ERROR)));
+  EXPECT_EQ(qLogger_->numDumps(), 0);
+  EXPECT_FALSE(dumped());
+}
+
+TEST_F(QuicTransportFlightRecorderTest, NoDumpOnIdleTimeout) {
+  transport_->idleTimeout().timeoutExpired();
+  EXPECT_EQ(transport_->closeState(), CloseState::CLOSED);
+  EXPECT_EQ(qLogger_->numDumps(), 0);
+  EXPECT_FALSE(dumped());
+}
+
+TEST_F(QuicTransportFlightRecorderTest, DumpsOnError) {
+  transport_->close(QuicError(
+      QuicErrorCode(TransportErrorCode::PROTOCOL_VIOLATION),
+      std::string("protocol violation")));
+  EXPECT_EQ(qLogger_->numDumps(), 1);
+  EXPECT_TRUE(dumped());
+}
+
 } // namespace quic::test
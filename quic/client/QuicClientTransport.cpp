@@ -61,70 +61,6 @@ void QuicClientTransport::onNotifyDataAvailable(
   }
 }
 
-quic::Expected<void, QuicError> QuicClientTransport::readWithRecvmmsgWrapper(
-    QuicAsyncUDPSocket& sock,
-    uint64_t readBufferSize,
-    uint16_t numPackets) {
-  NetworkData networkData;
-  networkData.reserve(numPackets);
-  size_t totalData = 0;
-
-  const auto result = sock.recvmmsgNetworkData(
-      readBufferSize, numPackets, networkData, totalData);
-
-  if (!result.has_value()) {
-    return quic::make_unexpected(result.error());
-  }
-
-  // track the received packets
-  for (const auto& packet : networkData.getPackets()) {
-    if (packet.buf.empty()) {
-      continue;
-    }
-    auto len = packet.buf.chainLength();
-    maybeQlogDatagram(len);
-  }
-  trackDatagramsReceived(
-      networkData.getPackets().size(), networkData.getTotalData());
-
-  // Propagate errors
-  // TODO(bschlinker): Investigate generalization of loopDetectorCallback
-  // TODO(bschlinker): Consider merging this into ReadCallback
-  if (result->maybeNoReadReason) {
-    const auto& noReadReason = result->maybeNoReadReason.value();
-    switch (noReadReason) {
-      case NoReadReason::RETRIABLE_ERROR:
-        if (conn_->loopDetectorCallback) {
-          conn_->readDebugState.noReadReason = NoReadReason::RETRIABLE_ERROR;
-        }
-        break;
-      case NoReadReason::NONRETRIABLE_ERROR:
-        // If we got a non-retriable error, we might have received
-        // a packet that we could process, however let's just quit early.
-        sock.pauseRead();
-        if (conn_->loopDetectorCallback) {
-          conn_->readDebugState.noReadReason = NoReadReason::NONRETRIABLE_ERROR;
-        }
-        onReadError(
-            folly::AsyncSocketException(
-                folly::AsyncSocketException::INTERNAL_ERROR,
-                "::recvmmsg() failed",
-                errno));
-        break;
-      case NoReadReason::READ_OK:
-      case NoReadReason::EMPTY_DATA:
-      case NoReadReason::TRUNCATED:
-        break;
-    }
-  }
-  auto localAddressRes = sock.address();
-  if (FOLLY_UNLIKELY(localAddressRes.hasError())) {
-    return quic::make_unexpected(localAddressRes.error());
-  }
-
-  return processPackets(localAddressRes.value(), std::move(networkData));
-}
-
 quic::Expected<void, QuicError> QuicClientTransport::readWithRecvmmsg(
     QuicAsyncUDPSocket& sock,
     uint64_t readBufferSize,
@@ -141,11 +141,6 @@ class QuicClientTransport : public QuicTransportBase,
     return wrappedObserverContainer_.getPtr();
   }
 
-  [[nodiscard]] quic::Expected<void, QuicError> readWithRecvmmsgWrapper(
-      QuicAsyncUDPSocket& sock,
-      uint64_t readBufferSize,
-      uint16_t numPackets);
-
   [[nodiscard]] quic::Expected<void, QuicError> readWithRecvmmsg(
       QuicAsyncUDPSocket& sock,
       uint64_t readBufferSize,
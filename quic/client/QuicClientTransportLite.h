@@ -362,6 +362,14 @@ class QuicClientTransportLite
       QuicAsyncUDPSocket& sock,
       uint64_t readBufferSize);
 
+  // Reads a batch of up to numPackets datagrams with the socket's
+  // recvmmsgNetworkData(), whose per slot read buffers are kept until a
+  // datagram is received into them, and processes them together.
+  [[nodiscard]] quic::Expected<void, QuicError> readWithRecvmmsgWrapper(
+      QuicAsyncUDPSocket& sock,
+      uint64_t readBufferSize,
+      uint16_t numPackets);
+
   Optional<std::string> hostname_;
 
   QuicClientConnectionState* clientConn_;
@@ -17,6 +17,7 @@
 #include <quic/congestion_control/CongestionControllerFactory.h>
 #include <quic/flowcontrol/QuicFlowController.h>
 #include <quic/handshake/TransportParameters.h>
+#include <quic/state/PmtuDiscoveryFunctions.h>
 #include <quic/state/QuicStateFunctions.h>
 #include <quic/state/QuicStreamUtilities.h>
 #include <quic/state/StateData.h>
@@ -442,10 +443,12 @@ quic::Expected<void, QuicError> processServerInitialParams(
   if (minAckDelay.has_value()) {
     conn.peerMinAckDelay = std::chrono::microseconds(minAckDelay.value());
   }
+  auto pmtuCeiling = *packetSize;
   if (conn.transportSettings.canIgnorePathMTU) {
     *packetSize = std::min<uint64_t>(*packetSize, kDefaultMaxUDPPayload);
     conn.udpSendPacketLen = *packetSize;
   }
+  maybeInitPmtuDiscovery(conn, pmtuCeiling);
 
   conn.peerActiveConnectionIdLimit =
       activeConnectionIdLimit.value_or(kDefaultActiveConnectionIdLimit);
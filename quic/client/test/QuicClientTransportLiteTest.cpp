@@ -35,6 +35,8 @@ class QuicClientTransportLiteMock : public QuicClientTransportLite {
   }
 
   // Expose protected members for testing
+  using QuicClientTransportLite::onNotifyDataAvailable;
+
   quic::Expected<void, QuicError> testMaybeIssueConnectionIds() {
     return maybeIssueConnectionIds();
   }
@@ -42,6 +44,15 @@ class QuicClientTransportLiteMock : public QuicClientTransportLite {
   auto& getWriteLooper() {
     return writeLooper_;
   }
+
+  quic::Expected<void, QuicError> processPackets(
+      const quic::SocketAddress& /*localAddress*/,
+      NetworkData&& networkData) override {
+    networkDataVec_.push_back(std::move(networkData));
+    return {};
+  }
+
+  std::vector<NetworkData> networkDataVec_;
 };
 
 class QuicClientTransportLiteTest : public Test {
@@ -140,6 +151,34 @@ TEST_F(
       kPeerTimestampExponent);
 }
 
+TEST_F(QuicClientTransportLiteTest, RecvmmsgReadsWholeBatch) {
+  auto transportSettings = quicClient_->getTransportSettings();
+  transportSettings.shouldUseRecvmmsgForBatchRecv = true;
+  transportSettings.maxRecvBatchSize = 16;
+  quicClient_->setTransportSettings(std::move(transportSettings));
+
+  const quic::SocketAddress peer("127.0.0.1", 443);
+  const quic::SocketAddress local("127.0.0.1", 1234);
+  EXPECT_CALL(*sockPtr_, recvmsg(_, _)).Times(0);
+  EXPECT_CALL(*sockPtr_, recvmmsgNetworkData(_, 16, _, _))
+      .WillOnce([&](uint64_t, uint16_t, NetworkData& networkData, size_t&) {
+        for (int i = 0; i < 3; i++) {
+          auto& packet = networkData.emplacePacket(
+              folly::IOBuf::copyBuffer("packet"),
+              ReceivedUdpPacket::Timings(),
+              0 /* tos */);
+          packet.peerAddress = peer;
+        }
+        return QuicAsyncUDPSocket::RecvResult();
+      });
+  EXPECT_CALL(*sockPtr_, address()).WillRepeatedly(Return(local));
+
+  quicClient_->onNotifyDataAvailable(*sockPtr_);
+  ASSERT_EQ(quicClient_->networkDataVec_.size(), 1);
+  EXPECT_EQ(quicClient_->networkDataVec_[0].getPackets().size(), 3);
+  EXPECT_EQ(quicClient_->networkDataVec_[0].getPackets()[2].peerAddress, peer);
+}
+
 TEST_F(QuicClientTransportLiteTest, TestMaybeIssueConnectionIdsZeroLengthCid) {
   // Test: No action when clientConnectionId size is 0
   auto conn = quicClient_->getConn();
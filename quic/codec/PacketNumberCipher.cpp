@@ -15,6 +15,92 @@
 
 namespace quic {
 
+namespace {
+// Masks computed per maskBatch() call by encryptHeaders(), bounds the scratch
+// space it keeps on the stack.
+constexpr size_t kMaxHeaderProtectionBatch = 64;
+
+void unmaskHeader(
+    const HeaderProtectionMask& headerMask,
+    uint8_t* initialByte,
+    uint8_t* packetNumberBytes,
+    uint8_t initialByteMask) {
+  // The packet number length is only readable once the initial byte is
+  // unmasked.
+  initialByte[0] ^= headerMask[0] & initialByteMask;
+  size_t packetNumLength = parsePacketNumberLength(*initialByte);
+  for (size_t i = 0; i < packetNumLength; ++i) {
+    packetNumberBytes[i] ^= headerMask[i + 1];
+  }
+}
+
+void maskHeader(
+    const HeaderProtectionMask& headerMask,
+    uint8_t* initialByte,
+    uint8_t* packetNumberBytes,
+    uint8_t initialByteMask) {
+  size_t packetNumLength = parsePacketNumberLength(*initialByte);
+  initialByte[0] ^= headerMask[0] & initialByteMask;
+  for (size_t i = 0; i < packetNumLength; ++i) {
+    packetNumberBytes[i] ^= headerMask[i + 1];
+  }
+}
+} // namespace
+
+quic::Expected<void, QuicError> PacketNumberCipher::maskBatch(
+    const Sample* samples,
+    size_t count,
+    HeaderProtectionMask* masks) const {
+  for (size_t i = 0; i < count; ++i) {
+    auto maskResult = mask(ByteRange(samples[i].data(), samples[i].size()));
+    if (maskResult.hasError()) {
+      return quic::make_unexpected(maskResult.error());
+    }
+    masks[i] = maskResult.value();
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError> PacketNumberCipher::encryptHeaders(
+    const PendingHeaderProtection* headers,
+    size_t count) const {
+  std::array<Sample, kMaxHeaderProtectionBatch> samples;
+  std::array<HeaderProtectionMask, kMaxHeaderProtectionBatch> masks;
+  while (count > 0) {
+    size_t batchSize = std::min(count, kMaxHeaderProtectionBatch);
+    for (size_t i = 0; i < batchSize; ++i) {
+      samples[i] = headers[i].sample;
+    }
+    auto maskResult = maskBatch(samples.data(), batchSize, masks.data());
+    if (maskResult.hasError()) {
+      return quic::make_unexpected(maskResult.error());
+    }
+    for (size_t i = 0; i < batchSize; ++i) {
+      maskHeader(
+          masks[i],
+          headers[i].initialByte,
+          headers[i].packetNumber,
+          headers[i].longHeader ? LongHeader::kTypeBitsMask
+                                : ShortHeader::kTypeBitsMask);
+    }
+    headers += batchSize;
+    count -= batchSize;
+  }
+  return {};
+}
+
+void PacketNumberCipher::decryptShortHeaderWithMask(
+    const HeaderProtectionMask& headerMask,
+    MutableByteRange initialByte,
+    MutableByteRange packetNumberBytes) {
+  MVCHECK_EQ(packetNumberBytes.size(), kMaxPacketNumEncodingSize);
+  unmaskHeader(
+      headerMask,
+      initialByte.data(),
+      packetNumberBytes.data(),
+      ShortHeader::kTypeBitsMask);
+}
+
 quic::Expected<void, QuicError> PacketNumberCipher::decipherHeader(
     ByteRange sample,
     MutableByteRange initialByte,
@@ -39,11 +125,8 @@ quic::Expected<void, QuicError> PacketNumberCipher::decipherHeader(
       "quic_packet_number_cipher",
       "invariant_violation: packet number decrypt mask is too short");
   DCHECK_GE(headerMask.size(), 5);
-  initialByte.data()[0] ^= headerMask.data()[0] & initialByteMask;
-  size_t packetNumLength = parsePacketNumberLength(*initialByte.data());
-  for (size_t i = 0; i < packetNumLength; ++i) {
-    packetNumberBytes.data()[i] ^= headerMask.data()[i + 1];
-  }
+  unmaskHeader(
+      headerMask, initialByte.data(), packetNumberBytes.data(), initialByteMask);
   return {};
 }
 
@@ -65,11 +148,8 @@ quic::Expected<void, QuicError> PacketNumberCipher::cipherHeader(
       "quic_packet_number_cipher",
       "invariant_violation: packet number encrypt mask is too short");
   DCHECK_GE(headerMask.size(), kMaxPacketNumEncodingSize + 1);
-  size_t packetNumLength = parsePacketNumberLength(*initialByte.data());
-  initialByte.data()[0] ^= headerMask.data()[0] & initialByteMask;
-  for (size_t i = 0; i < packetNumLength; ++i) {
-    packetNumberBytes.data()[i] ^= headerMask.data()[i + 1];
-  }
+  maskHeader(
+      headerMask, initialByte.data(), packetNumberBytes.data(), initialByteMask);
   return {};
 }
 
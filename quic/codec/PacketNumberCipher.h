@@ -19,6 +19,18 @@ namespace quic {
 using HeaderProtectionMask = std::array<uint8_t, 16>;
 using Sample = std::array<uint8_t, 16>;
 
+/**
+ * The header of a packet waiting for header protection, along with the sample
+ * taken from its ciphertext. See PacketNumberCipher::encryptHeaders().
+ */
+struct PendingHeaderProtection {
+  Sample sample;
+  uint8_t* initialByte{nullptr};
+  // Start of the packet number, which is as long as the initial byte says.
+  uint8_t* packetNumber{nullptr};
+  bool longHeader{false};
+};
+
 class PacketNumberCipher {
  public:
   virtual ~PacketNumberCipher() = default;
@@ -29,6 +41,34 @@ class PacketNumberCipher {
   [[nodiscard]] virtual quic::Expected<HeaderProtectionMask, QuicError> mask(
       ByteRange sample) const = 0;
 
+  /**
+   * Computes the masks of count samples at once, masks[i] being the mask of
+   * samples[i]. The default computes them one by one with mask(),
+   * implementations that can pipeline several blocks should override it.
+   */
+  [[nodiscard]] virtual quic::Expected<void, QuicError> maskBatch(
+      const Sample* samples,
+      size_t count,
+      HeaderProtectionMask* masks) const;
+
+  /**
+   * Encrypts the headers of count packets, computing their masks in batches
+   * with maskBatch() instead of one mask() call per packet.
+   */
+  [[nodiscard]] quic::Expected<void, QuicError> encryptHeaders(
+      const PendingHeaderProtection* headers,
+      size_t count) const;
+
+  /**
+   * Decrypts a short header with a mask computed ahead of time, e.g. by
+   * maskBatch() for a batch of received packets.
+   * packetNumberBytes should be supplied with at least 4 bytes.
+   */
+  static void decryptShortHeaderWithMask(
+      const HeaderProtectionMask& headerMask,
+      MutableByteRange initialByte,
+      MutableByteRange packetNumberBytes);
+
   /**
    * Decrypts a long header from a sample.
    * sample should be 16 bytes long.
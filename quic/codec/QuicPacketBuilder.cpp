@@ -430,11 +430,12 @@ RegularSizeEnforcedPacketBuilder::RegularSizeEnforcedPacketBuilder(
       cipherOverhead_(cipherOverhead) {}
 
 bool RegularSizeEnforcedPacketBuilder::canBuildPacket() const noexcept {
-  // We only force size of packets with short header, because d6d probes always
-  // have short headers and there's no other situations for this type of builder
+  // We only force size of packets with short header, because path MTU probes
+  // always have short headers and there's no other situations for this type of
+  // builder
   const ShortHeader* shortHeader = packet_.header.asShort();
-  // We also don't want to send packets longer than kDefaultMaxUDPPayload
-  return shortHeader && enforcedSize_ <= kDefaultMaxUDPPayload &&
+  // We also don't want to send packets longer than a UDP payload can be
+  return shortHeader && enforcedSize_ <= kMaxUDPPayload &&
       (body_.computeChainDataLength() + header_.computeChainDataLength() +
            cipherOverhead_ <
        enforcedSize_);
@@ -473,7 +474,7 @@ bool InplaceSizeEnforcedPacketBuilder::canBuildPacket() const noexcept {
   size_t encryptedPacketSize =
       header_.length() + body_.length() + cipherOverhead_;
   size_t delta = enforcedSize_ - encryptedPacketSize;
-  return shortHeader && enforcedSize_ <= kDefaultMaxUDPPayload &&
+  return shortHeader && enforcedSize_ <= kMaxUDPPayload &&
       encryptedPacketSize < enforcedSize_ && iobuf_->tailroom() >= delta;
 }
 
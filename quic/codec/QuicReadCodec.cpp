@@ -301,11 +301,17 @@ quic::Expected<CodecResult, QuicError> QuicReadCodec::tryParseShortHeaderPacket(
       data->writableData() + packetNumberOffset, kMaxPacketNumEncodingSize);
   ByteRange sampleByteRange(data->writableData() + sampleOffset, sample.size());
 
-  auto decryptResult = oneRttHeaderCipher_->decryptShortHeader(
-      sampleByteRange, initialByteRange, packetNumberByteRange);
-  if (decryptResult.hasError()) {
-    MVVLOG(4) << "Failed to decrypt short header " << connIdToHex();
-    return quic::make_unexpected(decryptResult.error());
+  memcpy(sample.data(), sampleByteRange.data(), sample.size());
+  if (auto preparedMask = findPreparedShortHeaderMask(sample)) {
+    PacketNumberCipher::decryptShortHeaderWithMask(
+        *preparedMask, initialByteRange, packetNumberByteRange);
+  } else {
+    auto decryptResult = oneRttHeaderCipher_->decryptShortHeader(
+        sampleByteRange, initialByteRange, packetNumberByteRange);
+    if (decryptResult.hasError()) {
+      MVVLOG(4) << "Failed to decrypt short header " << connIdToHex();
+      return quic::make_unexpected(decryptResult.error());
+    }
   }
   std::pair<PacketNum, size_t> packetNum = parsePacketNumber(
       initialByteRange.data()[0], packetNumberByteRange, expectedNextPacketNum);
@@ -417,6 +423,51 @@ quic::Expected<CodecResult, QuicError> QuicReadCodec::tryParseShortHeaderPacket(
   return CodecResult(std::move(*packetRes));
 }
 
+void QuicReadCodec::prepareShortHeaderMasks(
+    const std::vector<ReceivedUdpPacket>& packets) {
+  preparedSamples_.clear();
+  preparedMasks_.clear();
+  nextPreparedMask_ = 0;
+  const auto& localConnId = nodeType_ == QuicNodeType::Server
+      ? serverConnectionId_
+      : clientConnectionId_;
+  if (packets.size() < 2 || !oneRttHeaderCipher_ || !localConnId) {
+    return;
+  }
+  size_t sampleOffset = 1 + localConnId->size() + kMaxPacketNumEncodingSize;
+  for (const auto& packet : packets) {
+    const auto* front = packet.buf.front();
+    if (!front || front->length() < sampleOffset + sizeof(Sample) ||
+        getHeaderForm(front->data()[0]) != HeaderForm::Short) {
+      continue;
+    }
+    auto& sample = preparedSamples_.emplace_back();
+    memcpy(sample.data(), front->data() + sampleOffset, sample.size());
+  }
+  preparedMasks_.resize(preparedSamples_.size());
+  auto maskResult = oneRttHeaderCipher_->maskBatch(
+      preparedSamples_.data(), preparedSamples_.size(), preparedMasks_.data());
+  if (maskResult.hasError()) {
+    // Every packet computes its own mask then, and fails on its own.
+    preparedSamples_.clear();
+    preparedMasks_.clear();
+  }
+}
+
+const HeaderProtectionMask* QuicReadCodec::findPreparedShortHeaderMask(
+    const Sample& sample) {
+  // Packets are parsed in the order they were prepared in, so the match is
+  // normally the next one. Datagrams dropped before reaching the codec are
+  // skipped over.
+  for (size_t i = nextPreparedMask_; i < preparedSamples_.size(); ++i) {
+    if (preparedSamples_[i] == sample) {
+      nextPreparedMask_ = i + 1;
+      return &preparedMasks_[i];
+    }
+  }
+  return nullptr;
+}
+
 CodecResult QuicReadCodec::parsePacket(
     BufQueue& queue,
     const AckStates& ackStates,
@@ -573,6 +624,10 @@ void QuicReadCodec::setInitialHeaderCipher(
 void QuicReadCodec::setOneRttHeaderCipher(
     std::unique_ptr<PacketNumberCipher> oneRttHeaderCipher) {
   oneRttHeaderCipher_ = std::move(oneRttHeaderCipher);
+  // Masks prepared with the previous key are no good anymore.
+  preparedSamples_.clear();
+  preparedMasks_.clear();
+  nextPreparedMask_ = 0;
 }
 
 void QuicReadCodec::setZeroRttHeaderCipher(
@@ -13,6 +13,7 @@
 #include <quic/codec/Types.h>
 #include <quic/common/BufUtil.h>
 #include <quic/common/ContiguousCursor.h>
+#include <quic/common/NetworkData.h>
 #include <quic/common/Optional.h>
 #include <quic/handshake/Aead.h>
 #include <quic/state/AckStates.h>
@@ -133,6 +134,14 @@ class QuicReadCodec {
       const AckStates& ackStates,
       size_t dstConnIdSize = kDefaultConnectionIdSize);
 
+  /**
+   * Computes the header protection masks of the short header packets in a
+   * batch of received datagrams, e.g. the segments of a GRO read, with a
+   * single call into the header cipher. The following parsePacket() calls use
+   * them instead of computing one mask per packet.
+   */
+  void prepareShortHeaderMasks(const std::vector<ReceivedUdpPacket>& packets);
+
   /**
    * Tries to parse the packet and returns whether or not
    * it is a version negotiation packet.
@@ -225,6 +234,9 @@ class QuicReadCodec {
 
   [[nodiscard]] std::string connIdToHex() const;
 
+  // Returns the mask prepareShortHeaderMasks() computed for sample, if any.
+  const HeaderProtectionMask* findPreparedShortHeaderMask(const Sample& sample);
+
   QuicNodeType nodeType_;
 
   CodecParameters params_;
@@ -251,6 +263,13 @@ class QuicReadCodec {
   std::unique_ptr<PacketNumberCipher> zeroRttHeaderCipher_;
   std::unique_ptr<PacketNumberCipher> handshakeHeaderCipher_;
 
+  // Samples and masks from the last prepareShortHeaderMasks(), in datagram
+  // order, and the first one not used yet. A mask only depends on the sample
+  // and the 1-RTT header key, so a matching sample is all it takes to use it.
+  std::vector<Sample> preparedSamples_;
+  std::vector<HeaderProtectionMask> preparedMasks_;
+  size_t nextPreparedMask_{0};
+
   Optional<StatelessResetToken> statelessResetToken_;
   CryptoEqualFn cryptoEqual_{nullptr};
   Optional<TimePoint> handshakeDoneTime_;
@@ -25,21 +25,6 @@ namespace {
 bool packetSpaceCheck(uint64_t limit, size_t require) {
   return (static_cast<uint64_t>(require) <= limit);
 }
-
-// Receive-time-descending, packet-number-descending order for received-packet
-// timestamps. Shared by the legacy and draft-02 receive-timestamp encoders: a
-// single named comparator type makes std::stable_sort instantiate once for the
-// whole TU instead of once per call-site lambda closure.
-struct RecvTimeDescComparator {
-  bool operator()(
-      const quic::WriteAckFrameState::ReceivedPacket* a,
-      const quic::WriteAckFrameState::ReceivedPacket* b) const {
-    if (a->timings.receiveTimePoint != b->timings.receiveTimePoint) {
-      return a->timings.receiveTimePoint > b->timings.receiveTimePoint;
-    }
-    return a->pktNum > b->pktNum;
-  }
-};
 } // namespace
 
 namespace quic {
@@ -229,63 +214,51 @@ quic::Expected<Optional<WriteCryptoFrame>, QuicError> writeCryptoFrame(
 /*
  * This function will fill the parameter ack frame with ack blocks from the
  * parameter ackBlocks until it runs out of space (bytesLimit). The largest
- * ack block should have been inserted by the caller.
+ * ack block should have been inserted by the caller. Block sizes come from
+ * encodedAckBlocks, which must be up to date with ackBlocks.
  */
 [[nodiscard]] static quic::Expected<size_t, QuicError> fillFrameWithAckBlocks(
     const AckBlocks& ackBlocks,
+    const WriteAckFrameState::EncodedAckBlocks& encodedAckBlocks,
     WriteAckFrame& ackFrame,
     uint64_t bytesLimit) {
-  PacketNum currentSeqNum = ackBlocks.crbegin()->start;
+  auto numBlocks = encodedAckBlocks.numAdditionalBlocks();
+  MVDCHECK_EQ(numBlocks + 1, ackBlocks.size());
+  auto allBlocksCountSizeRes = getQuicIntegerSize(numBlocks);
+  if (allBlocksCountSizeRes.hasError()) {
+    return quic::make_unexpected(allBlocksCountSizeRes.error());
+  }
+  // The block count was accounted for as a zero, which takes one byte.
+  if (bytesLimit >=
+      encodedAckBlocks.size() + allBlocksCountSizeRes.value() - 1) {
+    // Everything fits, which is the common case.
+    for (auto blockItr = ackBlocks.crbegin() + 1; blockItr != ackBlocks.crend();
+         ++blockItr) {
+      ackFrame.ackBlocks.emplace_back(blockItr->start, blockItr->end);
+    }
+    return numBlocks;
+  }
 
-  // starts off with 0 which is what we assumed the initial ack block to be for
-  // the largest acked.
   size_t numAdditionalAckBlocks = 0;
-  size_t previousNumAckBlocks = 0;
-
+  size_t previousNumAckBlocksSize = 1;
   // Skip the largest, as it has already been emplaced.
   for (auto blockItr = ackBlocks.crbegin() + 1; blockItr != ackBlocks.crend();
        ++blockItr) {
-    const auto& currBlock = *blockItr;
-    // These must be true because of the properties of the interval set.
-    MVCHECK_GE(currentSeqNum, currBlock.end + 2);
-    PacketNum gap = currentSeqNum - currBlock.end - 2;
-    PacketNum currBlockLen = currBlock.end - currBlock.start;
-
-    // TODO this is still extra work, as we end up duplicating these
-    // calculations in the caller, we could store the results so they
-    // can be reused by the caller when writing the frame.
-    auto gapSizeRes = getQuicIntegerSize(gap);
-    if (gapSizeRes.hasError()) {
-      return quic::make_unexpected(gapSizeRes.error());
-    }
-
-    auto currBlockLenSizeRes = getQuicIntegerSize(currBlockLen);
-    if (currBlockLenSizeRes.hasError()) {
-      return quic::make_unexpected(currBlockLenSizeRes.error());
-    }
-
     auto numAdditionalAckBlocksSizeRes =
         getQuicIntegerSize(numAdditionalAckBlocks + 1);
     if (numAdditionalAckBlocksSizeRes.hasError()) {
       return quic::make_unexpected(numAdditionalAckBlocksSizeRes.error());
     }
-
-    auto previousNumAckBlocksSizeRes = getQuicIntegerSize(previousNumAckBlocks);
-    if (previousNumAckBlocksSizeRes.hasError()) {
-      return quic::make_unexpected(previousNumAckBlocksSizeRes.error());
-    }
-
-    size_t additionalSize = gapSizeRes.value() + currBlockLenSizeRes.value() +
-        (numAdditionalAckBlocksSizeRes.value() -
-         previousNumAckBlocksSizeRes.value());
+    size_t additionalSize =
+        encodedAckBlocks.blockSize(numAdditionalAckBlocks) +
+        (numAdditionalAckBlocksSizeRes.value() - previousNumAckBlocksSize);
     if (bytesLimit < additionalSize) {
       break;
     }
     numAdditionalAckBlocks++;
     bytesLimit -= additionalSize;
-    previousNumAckBlocks = numAdditionalAckBlocks;
-    currentSeqNum = currBlock.start;
-    ackFrame.ackBlocks.emplace_back(currBlock.start, currBlock.end);
+    previousNumAckBlocksSize = numAdditionalAckBlocksSizeRes.value();
+    ackFrame.ackBlocks.emplace_back(blockItr->start, blockItr->end);
   }
   return numAdditionalAckBlocks;
 }
@@ -327,37 +300,27 @@ fillFrameWithPacketReceiveTimestamps(
     uint64_t spaceLeft,
     uint64_t receiveTimestampsExponent,
     uint64_t maxRecvTimestampsToSend) {
-  if (ackFrameMetaData.ackState.recvdPacketInfos.size() == 0) {
+  const auto& byReceiveTime =
+      ackFrameMetaData.ackState.recvdPacketInfos.byReceiveTime();
+  if (byReceiveTime.empty()) {
     return 0;
   }
   // Storage is in arrival order and may contain out-of-order packet numbers
   // AND out-of-order receive times. The legacy wire format requires monotonic
   // decreasing packet numbers AND non-negative inter-packet time deltas
-  // across the iteration. Sort by receive-time desc, then take the prefix
-  // whose pktNum stays strictly less than the last included.
-  std::vector<const WriteAckFrameState::ReceivedPacket*> legacyView;
-  legacyView.reserve(ackFrameMetaData.ackState.recvdPacketInfos.size());
-  {
-    std::vector<const WriteAckFrameState::ReceivedPacket*> sortedByTime;
-    sortedByTime.reserve(ackFrameMetaData.ackState.recvdPacketInfos.size());
-    for (const auto& rpi : ackFrameMetaData.ackState.recvdPacketInfos) {
-      sortedByTime.push_back(&rpi);
-    }
-    // Lexicographic (receiveTime desc, pktnum desc): without the pktnum
-    // tie-break, equal-time batches arrive in pktnum-ASCENDING order, the
-    // pktnum-monotonic filter picks pkt 1 first, and pkts 2..N are silently
-    // dropped because they fail the `pktnum < lastIncluded` check.
-    // std::ranges::stable_sort is unavailable on the arvr clang21 toolchain
-    // stdlib, so the portable std::stable_sort is used deliberately.
-    // NOLINTNEXTLINE(modernize-use-ranges,boost-use-ranges)
-    std::stable_sort(
-        sortedByTime.begin(), sortedByTime.end(), RecvTimeDescComparator{});
-    PacketNum lastIncludedPktNum = std::numeric_limits<PacketNum>::max();
-    for (auto* rpi : sortedByTime) {
-      if (rpi->pktNum < lastIncludedPktNum) {
-        legacyView.push_back(rpi);
-        lastIncludedPktNum = rpi->pktNum;
-      }
+  // across the iteration. Walk the receive-time index backwards, i.e.
+  // (receiveTime desc, pktnum desc), and take the prefix whose pktNum stays
+  // strictly less than the last included. The pktnum tie-break matters: with
+  // equal-time batches in pktnum-ascending order the filter would pick pkt 1
+  // first and drop pkts 2..N.
+  std::vector<const WriteAckFrameState::ReceivedPacketInfos::TimeIndexEntry*>
+      legacyView;
+  legacyView.reserve(byReceiveTime.size());
+  PacketNum lastIncludedPktNum = std::numeric_limits<PacketNum>::max();
+  for (auto it = byReceiveTime.crbegin(); it != byReceiveTime.crend(); ++it) {
+    if (it->pktNum < lastIncludedPktNum) {
+      legacyView.push_back(&*it);
+      lastIncludedPktNum = it->pktNum;
     }
   }
   if (legacyView.empty()) {
@@ -411,16 +374,15 @@ fillFrameWithPacketReceiveTimestamps(
            (*timestampIt)->pktNum <= timestampIntervalsIt->end) {
       std::chrono::microseconds deltaDuration;
       if (timestampIt == legacyView.cbegin()) {
-        deltaDuration = ((*timestampIt)->timings.receiveTimePoint >
-                         ackFrameMetaData.connTime)
+        deltaDuration =
+            ((*timestampIt)->receiveTimePoint > ackFrameMetaData.connTime)
             ? std::chrono::duration_cast<std::chrono::microseconds>(
-                  (*timestampIt)->timings.receiveTimePoint -
-                  ackFrameMetaData.connTime)
+                  (*timestampIt)->receiveTimePoint - ackFrameMetaData.connTime)
             : 0us;
       } else {
         deltaDuration = std::chrono::duration_cast<std::chrono::microseconds>(
-            (*(timestampIt - 1))->timings.receiveTimePoint -
-            (*timestampIt)->timings.receiveTimePoint);
+            (*(timestampIt - 1))->receiveTimePoint -
+            (*timestampIt)->receiveTimePoint);
       }
       auto delta = deltaDuration.count() >> receiveTimestampsExponent;
 
@@ -561,18 +523,26 @@ maybeWriteAckBaseFields(
   if (spaceLeft < headerSize) {
     return Optional<WriteAckFrame>(std::nullopt);
   }
+  // Only the blocks that changed since the last ACK are encoded again.
+  const auto& encodedAckBlocks = ackState.encodedAckBlocks;
+  auto updateResult = encodedAckBlocks.update(ackState.acks);
+  if (updateResult.hasError()) {
+    return quic::make_unexpected(updateResult.error());
+  }
+
   WriteAckFrame ackFrame;
   ackFrame.frameType = frameType;
 
   // Reserve the number of ack blocks we could fit in the remaining space.
-  ackFrame.ackBlocks.reserve(spaceLeft / 4);
+  ackFrame.ackBlocks.reserve(
+      std::min<uint64_t>(spaceLeft / 4, ackState.acks.size()));
 
   // Account for the header size
   spaceLeft -= headerSize;
 
   ackFrame.ackBlocks.push_back(ackState.acks.back());
-  auto numAdditionalAckBlocksResult =
-      fillFrameWithAckBlocks(ackState.acks, ackFrame, spaceLeft);
+  auto numAdditionalAckBlocksResult = fillFrameWithAckBlocks(
+      ackState.acks, encodedAckBlocks, ackFrame, spaceLeft);
   if (numAdditionalAckBlocksResult.hasError()) {
     return quic::make_unexpected(numAdditionalAckBlocksResult.error());
   }
@@ -584,18 +554,10 @@ maybeWriteAckBaseFields(
   builder.write(numAdditionalAckBlocksInt);
   builder.write(firstAckBlockLengthInt);
 
-  PacketNum currentSeqNum = ackState.acks.back().start;
-  for (auto it = ackFrame.ackBlocks.cbegin() + 1;
-       it != ackFrame.ackBlocks.cend();
-       ++it) {
-    MVCHECK_GE(currentSeqNum, it->end + 2);
-    PacketNum gap = currentSeqNum - it->end - 2;
-    PacketNum currBlockLen = it->end - it->start;
-    QuicInteger gapInt(gap);
-    QuicInteger currentBlockLenInt(currBlockLen);
-    builder.write(gapInt);
-    builder.write(currentBlockLenInt);
-    currentSeqNum = it->start;
+  auto encodedSize =
+      encodedAckBlocks.prefixSize(numAdditionalAckBlocksResult.value());
+  if (encodedSize > 0) {
+    builder.push(encodedAckBlocks.data(), encodedSize);
   }
   ackFrame.ackDelay = ackFrameMetaData.ackDelay;
 
@@ -890,8 +852,8 @@ computeDraft02ReceiveTimestampsMinimumSpace() {
 // the peer's max count and the available wire-byte budget. Returns the total
 // number of timestamps written (sum across all ranges).
 //
-// Traverses `recvdPacketInfos` in reverse order (newest receive time first)
-// so truncation drops oldest. Groups consecutive packets where
+// Walks the receive-time index of `recvdPacketInfos` newest first, so
+// truncation drops oldest. Groups consecutive packets where
 // `pktNum == expectedNextPkt` into one range; non-contiguous packet numbers
 // close the current range and open a new one with a fresh
 // `deltaLargestAcknowledged`.
@@ -905,8 +867,9 @@ quic::Expected<size_t, QuicError> fillFrameWithDraft02PacketReceiveTimestamps(
     uint64_t spaceLeft,
     uint64_t peerExponent,
     uint64_t peerMaxReceiveTimestampsPerAck) {
-  const auto& recvdPacketInfos = metaData.ackState.recvdPacketInfos;
-  if (recvdPacketInfos.empty() || peerMaxReceiveTimestampsPerAck == 0) {
+  const auto& byReceiveTime =
+      metaData.ackState.recvdPacketInfos.byReceiveTime();
+  if (byReceiveTime.empty() || peerMaxReceiveTimestampsPerAck == 0) {
     return 0;
   }
   const TimePoint basis = metaData.connTime;
@@ -915,24 +878,6 @@ quic::Expected<size_t, QuicError> fillFrameWithDraft02PacketReceiveTimestamps(
   // cap. Bound matches kDraft02MaxReceiveTimestampsExponent in QuicConstants.h.
   peerExponent = std::min(peerExponent, kDraft02MaxReceiveTimestampsExponent);
 
-  // Build a receive-time-descending view. Storage is in arrival order and may
-  // contain out-of-order receive times; sorting once here lets the inner walk
-  // assume monotonic non-increasing receive times across iterations, so
-  // chained deltas are always non-negative without a clamp. n is bounded by
-  // kMaxReceivedPktsTimestampsStored (default ~10), so O(n log n) is trivial.
-  std::vector<const WriteAckFrameState::ReceivedPacket*> sortedView;
-  sortedView.reserve(recvdPacketInfos.size());
-  for (const auto& rpi : recvdPacketInfos) {
-    sortedView.push_back(&rpi);
-  }
-  // Lexicographic (receiveTime desc, pktnum desc): the pktnum tie-break is
-  // required so equal-time batches sort into a single pktnum-monotonic run
-  // that the contiguity grouping can coalesce. Without it, stable_sort
-  // preserves arrival order on equal keys and the pktnum=N+1, N+2... follow-up
-  // packets break the expectedNext=N-1 chain.
-  std::stable_sort(
-      sortedView.begin(), sortedView.end(), RecvTimeDescComparator{});
-
   size_t totalTimestamps = 0;
   size_t cumUsedSpace = 0;
   // Range-count varint widens at 63->64, 16383->16384, etc.; charge the
@@ -941,38 +886,43 @@ quic::Expected<size_t, QuicError> fillFrameWithDraft02PacketReceiveTimestamps(
   TimePoint previousTimestamp{};
   bool firstDeltaOverall = true;
 
-  auto it = sortedView.cbegin();
-  while (it != sortedView.cend() &&
+  // The receive-time index walked backwards is (receiveTime desc, pktnum desc),
+  // so receive times are monotonic non-increasing across iterations and
+  // chained deltas are always non-negative without a clamp. The pktnum
+  // tie-break lets equal-time batches form a single pktnum-monotonic run
+  // that the contiguity grouping can coalesce.
+  auto it = byReceiveTime.crbegin();
+  while (it != byReceiveTime.crend() &&
          totalTimestamps < peerMaxReceiveTimestampsPerAck) {
     // `recvdPacketInfos` invariant: must not contain pkts above
     // `largestAcked` for this frame.
-    if ((*it)->pktNum > largestAcked) {
+    if (it->pktNum > largestAcked) {
       ++it;
       continue;
     }
     Draft02ReceiveTimestampsRange range;
-    range.deltaLargestAcknowledged = largestAcked - (*it)->pktNum;
+    range.deltaLargestAcknowledged = largestAcked - it->pktNum;
 
-    PacketNum expectedNext = (*it)->pktNum;
+    PacketNum expectedNext = it->pktNum;
     bool outOfSpace = false;
-    while (it != sortedView.cend() && (*it)->pktNum == expectedNext &&
+    while (it != byReceiveTime.crend() && it->pktNum == expectedNext &&
            totalTimestamps < peerMaxReceiveTimestampsPerAck) {
       uint64_t deltaUs = 0;
       if (firstDeltaOverall) {
         // Clamp to 0 when the receive time precedes connTime. MVDCHECK is a
         // no-op in opt builds, so an unclamped negative duration would cast to
         // a huge unsigned delta on the wire. Mirrors the legacy encoder.
-        deltaUs = ((*it)->timings.receiveTimePoint > basis)
+        deltaUs = (it->receiveTimePoint > basis)
             ? static_cast<uint64_t>(
                   std::chrono::duration_cast<std::chrono::microseconds>(
-                      (*it)->timings.receiveTimePoint - basis)
+                      it->receiveTimePoint - basis)
                       .count())
             : 0;
       } else {
-        MVDCHECK(previousTimestamp >= (*it)->timings.receiveTimePoint);
+        MVDCHECK(previousTimestamp >= it->receiveTimePoint);
         deltaUs = static_cast<uint64_t>(
             std::chrono::duration_cast<std::chrono::microseconds>(
-                previousTimestamp - (*it)->timings.receiveTimePoint)
+                previousTimestamp - it->receiveTimePoint)
                 .count());
       }
       const uint64_t scaledDelta = deltaUs >> peerExponent;
@@ -1022,10 +972,10 @@ quic::Expected<size_t, QuicError> fillFrameWithDraft02PacketReceiveTimestamps(
       if (rangeCountSizeDelta > 0) {
         chargedRangeCountSize += rangeCountSizeDelta;
       }
-      previousTimestamp = (*it)->timings.receiveTimePoint;
+      previousTimestamp = it->receiveTimePoint;
       firstDeltaOverall = false;
       totalTimestamps++;
-      expectedNext = (*it)->pktNum - 1;
+      expectedNext = it->pktNum - 1;
       ++it;
     }
     if (!range.deltas.empty()) {
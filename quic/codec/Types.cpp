@@ -6,9 +6,12 @@
  */
 
 #include <quic/QuicException.h>
+#include <quic/codec/QuicInteger.h>
 #include <quic/codec/Types.h>
 #include <quic/common/MvfstLogging.h>
 
+#include <algorithm>
+
 namespace quic {
 
 LongHeaderInvariant::LongHeaderInvariant(
@@ -517,4 +520,132 @@ std::string_view toString(TokenType type) {
   return "UNKNOWN";
 }
 
+namespace {
+bool receivedBefore(
+    const WriteAckFrameState::ReceivedPacketInfos::TimeIndexEntry& a,
+    const WriteAckFrameState::ReceivedPacketInfos::TimeIndexEntry& b) {
+  if (a.receiveTimePoint != b.receiveTimePoint) {
+    return a.receiveTimePoint < b.receiveTimePoint;
+  }
+  return a.pktNum < b.pktNum;
+}
+} // namespace
+
+WriteAckFrameState::ReceivedPacketInfos&
+WriteAckFrameState::ReceivedPacketInfos::operator=(Container packets) {
+  packets_ = std::move(packets);
+  byReceiveTime_.clear();
+  for (const auto& packet : packets_) {
+    addToIndex(packet);
+  }
+  return *this;
+}
+
+void WriteAckFrameState::ReceivedPacketInfos::pop_front() {
+  removeFromIndex(packets_.front());
+  packets_.pop_front();
+}
+
+WriteAckFrameState::ReceivedPacketInfos::const_iterator
+WriteAckFrameState::ReceivedPacketInfos::erase(const_iterator pos) {
+  removeFromIndex(*pos);
+  return packets_.erase(pos);
+}
+
+void WriteAckFrameState::ReceivedPacketInfos::clear() noexcept {
+  packets_.clear();
+  byReceiveTime_.clear();
+}
+
+void WriteAckFrameState::ReceivedPacketInfos::addToIndex(
+    const ReceivedPacket& packet) {
+  TimeIndexEntry entry{packet.timings.receiveTimePoint, packet.pktNum};
+  // Packets almost always arrive in receive time order, so look for the
+  // position from the back.
+  auto pos = byReceiveTime_.cend();
+  while (pos != byReceiveTime_.cbegin() && receivedBefore(entry, *(pos - 1))) {
+    --pos;
+  }
+  byReceiveTime_.emplace(pos, entry);
+}
+
+void WriteAckFrameState::ReceivedPacketInfos::removeFromIndex(
+    const ReceivedPacket& packet) {
+  TimeIndexEntry entry{packet.timings.receiveTimePoint, packet.pktNum};
+  auto pos = std::lower_bound(
+      byReceiveTime_.cbegin(),
+      byReceiveTime_.cend(),
+      entry,
+      receivedBefore);
+  MVDCHECK(pos != byReceiveTime_.cend() && pos->pktNum == packet.pktNum);
+  if (pos != byReceiveTime_.cend() && pos->pktNum == packet.pktNum) {
+    byReceiveTime_.erase(pos);
+  }
+}
+
+quic::Expected<void, QuicError>
+WriteAckFrameState::EncodedAckBlocks::update(const AckBlocks& acks) {
+  MVDCHECK(!acks.empty());
+  // Skip the blocks that did not change. The last of them keeps its encoding
+  // only if the first changed block still starts where it did.
+  size_t numValid = 0;
+  auto ackIt = acks.cbegin();
+  while (numValid < blocks_.size() && ackIt != acks.cend() &&
+         blocks_[numValid].start == ackIt->start &&
+         blocks_[numValid].end == ackIt->end) {
+    ++numValid;
+    ++ackIt;
+  }
+  if (numValid == blocks_.size() && ackIt == acks.cend()) {
+    return {};
+  }
+  if (numValid > 0 &&
+      (numValid == blocks_.size() || ackIt == acks.cend() ||
+       blocks_[numValid].start != ackIt->start)) {
+    --numValid;
+    --ackIt;
+  }
+  blocks_.resize(numValid);
+  size_t cumulativeSize = blocks_.empty() ? 0 : blocks_.back().cumulativeSize;
+  begin_ = buf_.size() - cumulativeSize;
+
+  // Make room in front for the largest possible encoding of the rest.
+  size_t maxSize = 2 * sizeof(uint64_t) * (acks.size() - numValid);
+  if (begin_ < maxSize) {
+    std::vector<uint8_t> grown(
+        std::max(2 * buf_.size(), cumulativeSize + maxSize));
+    std::copy(
+        buf_.cbegin() + begin_, buf_.cend(), grown.end() - cumulativeSize);
+    buf_ = std::move(grown);
+    begin_ = buf_.size() - cumulativeSize;
+  }
+
+  for (; ackIt != acks.cend(); ++ackIt) {
+    auto nextIt = std::next(ackIt);
+    if (nextIt != acks.cend()) {
+      // These must be true because of the properties of the interval set.
+      MVCHECK_GE(nextIt->start, ackIt->end + 2);
+      PacketNum gap = nextIt->start - ackIt->end - 2;
+      PacketNum blockLen = ackIt->end - ackIt->start;
+      auto gapSize = getQuicIntegerSize(gap);
+      auto blockLenSize = getQuicIntegerSize(blockLen);
+      if (gapSize.hasError() || blockLenSize.hasError()) {
+        blocks_.clear();
+        begin_ = buf_.size();
+        return quic::make_unexpected(
+            gapSize.hasError() ? gapSize.error() : blockLenSize.error());
+      }
+      size_t size = gapSize.value() + blockLenSize.value();
+      begin_ -= size;
+      cumulativeSize += size;
+      BufWriter writer(buf_.data() + begin_, size);
+      QuicInteger(gap).encode([&](auto val) { writer.writeBE(val); });
+      QuicInteger(blockLen).encode([&](auto val) { writer.writeBE(val); });
+    }
+    blocks_.push_back(
+        {ackIt->start, ackIt->end, static_cast<uint32_t>(cumulativeSize)});
+  }
+  return {};
+}
+
 } // namespace quic
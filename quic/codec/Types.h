@@ -273,6 +273,144 @@ struct WriteAckFrameState {
     ~ReceivedPacket() = default;
   };
 
+  /**
+   * Arrival-order storage of received packets, plus an index of the same
+   * packets ordered by (receive time, packet number) that is kept up to date
+   * on every insert and removal. The receive timestamp encoders walk the
+   * index newest first instead of sorting the storage on every ACK. Receive
+   * times are close to monotonic, so index updates land near its ends.
+   */
+  class ReceivedPacketInfos {
+   public:
+    using Container = CircularDeque<ReceivedPacket>;
+    using const_iterator = Container::const_iterator;
+
+    struct TimeIndexEntry {
+      TimePoint receiveTimePoint;
+      PacketNum pktNum;
+    };
+    using TimeIndex = CircularDeque<TimeIndexEntry>;
+
+    ReceivedPacketInfos() = default;
+
+    // Replaces the contents and rebuilds the index.
+    ReceivedPacketInfos& operator=(Container packets);
+
+    template <typename... Args>
+    const ReceivedPacket& emplace_back(Args&&... args) {
+      const auto& packet = packets_.emplace_back(std::forward<Args>(args)...);
+      addToIndex(packet);
+      return packet;
+    }
+
+    void pop_front();
+    const_iterator erase(const_iterator pos);
+    void clear() noexcept;
+
+    [[nodiscard]] size_t size() const noexcept {
+      return packets_.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+      return packets_.empty();
+    }
+
+    [[nodiscard]] const ReceivedPacket& front() const {
+      return packets_.front();
+    }
+
+    [[nodiscard]] const ReceivedPacket& back() const {
+      return packets_.back();
+    }
+
+    [[nodiscard]] const ReceivedPacket& operator[](size_t index) const {
+      return packets_[index];
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+      return packets_.begin();
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept {
+      return packets_.end();
+    }
+
+    // Ascending by receive time, then by packet number. Walk it in reverse
+    // for newest first.
+    [[nodiscard]] const TimeIndex& byReceiveTime() const noexcept {
+      return byReceiveTime_;
+    }
+
+   private:
+    void addToIndex(const ReceivedPacket& packet);
+    void removeFromIndex(const ReceivedPacket& packet);
+
+    Container packets_;
+    TimeIndex byReceiveTime_;
+  };
+
+  /**
+   * Wire encoding of the gap and length of every ACK block but the largest,
+   * largest block first, as of the last update() from an AckBlocks. A block's
+   * encoding only depends on the block itself and on the start of the next
+   * larger block, so update() keeps the encoding of the unchanged blocks at
+   * the bottom and only re-encodes the ones above them. In the common case of
+   * the largest block growing nothing is re-encoded.
+   */
+  class EncodedAckBlocks {
+   public:
+    // Brings the encoding in line with acks, which must not be empty.
+    [[nodiscard]] quic::Expected<void, QuicError> update(
+        const AckBlocks& acks);
+
+    // Number of blocks with an encoding, i.e. all but the largest.
+    [[nodiscard]] size_t numAdditionalBlocks() const noexcept {
+      return blocks_.empty() ? 0 : blocks_.size() - 1;
+    }
+
+    // Encoded size of the index-th additional block, largest first.
+    [[nodiscard]] size_t blockSize(size_t index) const {
+      auto pos = blocks_.size() - 2 - index;
+      return blocks_[pos].cumulativeSize -
+          (pos == 0 ? 0 : blocks_[pos - 1].cumulativeSize);
+    }
+
+    // Encoded size of the first n additional blocks, largest first.
+    [[nodiscard]] size_t prefixSize(size_t n) const {
+      if (n == 0) {
+        return 0;
+      }
+      auto last = blocks_.size() - 1 - n;
+      return blocks_[blocks_.size() - 2].cumulativeSize -
+          (last == 0 ? 0 : blocks_[last - 1].cumulativeSize);
+    }
+
+    // Encoding of all the additional blocks, largest first. The encoding of
+    // the first n blocks is a prefix of it.
+    [[nodiscard]] const uint8_t* data() const noexcept {
+      return buf_.data() + begin_;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+      return buf_.size() - begin_;
+    }
+
+   private:
+    struct Block {
+      PacketNum start;
+      PacketNum end;
+      // Encoded size of this block and all the smaller ones.
+      uint32_t cumulativeSize;
+    };
+
+    // Smallest block first, as in AckBlocks, including the largest one.
+    std::vector<Block> blocks_;
+    // The encoding is kept at the back, so that blocks can be re-encoded in
+    // front of the unchanged ones.
+    std::vector<uint8_t> buf_;
+    size_t begin_{0};
+  };
+
   AckBlocks acks;
 
   // Receive timestamp and packet number for the largest received packet.
@@ -292,13 +430,15 @@ struct WriteAckFrameState {
 
   // Bounded arrival-order storage of non-duplicate received packets. Packet
   // numbers AND receive times may both be non-monotonic; out-of-order receipt
-  // is supported per draft-ietf-quic-receive-ts-02. Encoders sort and filter
-  // this deque at write time to satisfy their wire-format constraints
+  // is supported per draft-ietf-quic-receive-ts-02. Encoders walk its
+  // receive-time index at write time to satisfy their wire-format constraints
   // (legacy keeps the strictly-decreasing-pktnum subsequence of the
-  // time-desc-sorted view; draft-02 sorts by receive-time desc then groups
-  // by pktnum contiguity). Bounded by
+  // time-desc view; draft-02 walks receive-time desc and groups by pktnum
+  // contiguity). Bounded by
   // `TransportSettings::maxReceiveTimestampsPerAckStored`.
-  CircularDeque<ReceivedPacket> recvdPacketInfos;
+  ReceivedPacketInfos recvdPacketInfos;
+  // Cache of the ACK blocks encoding, only used by the ACK writers.
+  mutable EncodedAckBlocks encodedAckBlocks;
   // The count of ECN marks seen on received packets.
   uint64_t ecnECT0CountReceived{0};
   uint64_t ecnECT1CountReceived{0};
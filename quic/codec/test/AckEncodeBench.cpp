@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <quic/codec/QuicPacketBuilder.h>
+#include <quic/codec/QuicWriteCodec.h>
+#include <quic/common/test/TestUtils.h>
+
+using namespace quic;
+using namespace quic::test;
+
+namespace {
+/**
+ * Writes an ACK frame for numRanges ranges of received packets per iteration.
+ * With growLargest set, a packet is added to the largest range before every
+ * write, as happens between two ACKs of a transfer with old losses.
+ */
+void runAckEncode(size_t iters, PacketNum numRanges, bool growLargest) {
+  WriteAckFrameState state;
+  TimePoint connTime = Clock::now();
+  BENCHMARK_SUSPEND {
+    for (PacketNum i = 0; i < numRanges; ++i) {
+      state.acks.insert(i * 4, i * 4 + 1);
+    }
+  }
+  PacketNum nextPacketNum = state.acks.back().end + 1;
+  WriteAckFrameMetaData metaData{
+      state, 100us, kDefaultAckDelayExponent, connTime};
+  for (size_t i = 0; i < iters; ++i) {
+    if (growLargest) {
+      state.acks.insert(nextPacketNum++);
+    }
+    RegularQuicPacketBuilder builder(
+        kDefaultUDPSendPacketLen,
+        ShortHeader(ProtectionType::KeyPhaseZero, getTestConnectionId(), 1),
+        0 /* largestAcked */);
+    MVCHECK(!builder.encodePacketHeader().hasError());
+    auto result = writeAckFrame(metaData, builder, FrameType::ACK);
+    MVCHECK(!result.hasError());
+    folly::doNotOptimizeAway(result);
+  }
+}
+} // namespace
+
+BENCHMARK(ack_encode_1_range, iters) {
+  runAckEncode(iters, 1, true);
+}
+
+BENCHMARK(ack_encode_32_ranges, iters) {
+  runAckEncode(iters, 32, true);
+}
+
+BENCHMARK(ack_encode_256_ranges, iters) {
+  runAckEncode(iters, 256, true);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(ack_encode_1_range_unchanged, iters) {
+  runAckEncode(iters, 1, false);
+}
+
+BENCHMARK(ack_encode_32_ranges_unchanged, iters) {
+  runAckEncode(iters, 32, false);
+}
+
+BENCHMARK(ack_encode_256_ranges_unchanged, iters) {
+  runAckEncode(iters, 256, false);
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
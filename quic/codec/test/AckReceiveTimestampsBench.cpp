@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <quic/codec/QuicPacketBuilder.h>
+#include <quic/codec/QuicWriteCodec.h>
+#include <quic/common/test/TestUtils.h>
+
+using namespace quic;
+using namespace quic::test;
+
+namespace {
+// A raised maxReceiveTimestampsPerAckStored, as used for low-latency video.
+constexpr PacketNum kNumStored = 256;
+
+/**
+ * Fills an ack state with kNumStored received packets, 10us apart. With
+ * reorderEvery set, every reorderEvery-th pair of packets arrives swapped.
+ */
+void fillAckState(
+    WriteAckFrameState& state,
+    TimePoint connTime,
+    PacketNum reorderEvery) {
+  state.acks.insert(0, kNumStored - 1);
+  for (PacketNum i = 0; i < kNumStored; ++i) {
+    PacketNum pktNum = i;
+    if (reorderEvery && i % reorderEvery == 0 && i + 1 < kNumStored) {
+      pktNum = i + 1;
+    } else if (reorderEvery && i % reorderEvery == 1) {
+      pktNum = i - 1;
+    }
+    ReceivedUdpPacket::Timings timings;
+    timings.receiveTimePoint = connTime + std::chrono::microseconds(10 * i);
+    state.recvdPacketInfos.emplace_back(pktNum, std::move(timings));
+  }
+}
+
+void runLegacyEncode(size_t iters, PacketNum reorderEvery) {
+  WriteAckFrameState state;
+  TimePoint connTime = Clock::now();
+  BENCHMARK_SUSPEND {
+    fillAckState(state, connTime, reorderEvery);
+  }
+  WriteAckFrameMetaData metaData{
+      state, 100us, kDefaultAckDelayExponent, connTime};
+  AckReceiveTimestampsConfig config{
+      .maxReceiveTimestampsPerAck = kNumStored,
+      .receiveTimestampsExponent = kDefaultReceiveTimestampsExponent};
+  for (size_t i = 0; i < iters; ++i) {
+    RegularQuicPacketBuilder builder(
+        kDefaultUDPSendPacketLen,
+        ShortHeader(ProtectionType::KeyPhaseZero, getTestConnectionId(), 1),
+        0 /* largestAcked */);
+    MVCHECK(!builder.encodePacketHeader().hasError());
+    auto result = writeAckFrame(
+        metaData,
+        builder,
+        FrameType::ACK_RECEIVE_TIMESTAMPS,
+        config,
+        kNumStored);
+    MVCHECK(!result.hasError());
+    folly::doNotOptimizeAway(result);
+  }
+}
+
+void runDraft02Encode(size_t iters, PacketNum reorderEvery) {
+  WriteAckFrameState state;
+  TimePoint connTime = Clock::now();
+  BENCHMARK_SUSPEND {
+    fillAckState(state, connTime, reorderEvery);
+  }
+  WriteAckFrameMetaData metaData{
+      state, 100us, kDefaultAckDelayExponent, connTime};
+  for (size_t i = 0; i < iters; ++i) {
+    RegularQuicPacketBuilder builder(
+        kDefaultUDPSendPacketLen,
+        ShortHeader(ProtectionType::KeyPhaseZero, getTestConnectionId(), 1),
+        0 /* largestAcked */);
+    MVCHECK(!builder.encodePacketHeader().hasError());
+    auto result = writeAckFrameDraft02(
+        metaData,
+        builder,
+        FrameType::ACK_RECEIVE_TIMESTAMPS_DRAFT_02,
+        kDefaultReceiveTimestampsExponent,
+        kNumStored);
+    MVCHECK(!result.hasError());
+    folly::doNotOptimizeAway(result);
+  }
+}
+} // namespace
+
+BENCHMARK(legacy_encode_in_order, iters) {
+  runLegacyEncode(iters, 0);
+}
+
+BENCHMARK(legacy_encode_reordered, iters) {
+  runLegacyEncode(iters, 8);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(draft02_encode_in_order, iters) {
+  runDraft02Encode(iters, 0);
+}
+
+BENCHMARK(draft02_encode_reordered, iters) {
+  runDraft02Encode(iters, 8);
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
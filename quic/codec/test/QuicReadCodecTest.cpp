@@ -293,6 +293,39 @@ TEST_F(QuicReadCodecTest, StreamWithShortHeader) {
   EXPECT_TRUE(parseSuccess(std::move(packet)));
 }
 
+TEST_F(QuicReadCodecTest, PreparedShortHeaderMasks) {
+  auto connId = getTestConnectionId();
+  auto codec = makeEncryptedCodec(connId, createNoOpAead());
+  codec->setServerConnectionId(connId);
+  auto headerCipher = createNoOpHeaderCipherNoThrow();
+  auto rawHeaderCipher = headerCipher.get();
+  codec->setOneRttHeaderCipher(std::move(headerCipher));
+
+  std::vector<ReceivedUdpPacket> packets;
+  for (PacketNum packetNum : {1, 2, 3}) {
+    auto data = folly::IOBuf::copyBuffer("hello");
+    auto streamPacket = createStreamPacket(
+        connId,
+        connId,
+        packetNum,
+        2 /* streamId */,
+        *data,
+        0 /* cipherOverhead */,
+        0 /* largestAcked */);
+    packets.push_back(packetToReceivedUdpPacket(streamPacket));
+  }
+  EXPECT_CALL(*rawHeaderCipher, mask(_)).Times(3);
+  codec->prepareShortHeaderMasks(packets);
+  Mock::VerifyAndClearExpectations(rawHeaderCipher);
+
+  // Parsing uses the prepared masks instead of computing its own.
+  EXPECT_CALL(*rawHeaderCipher, mask(_)).Times(0);
+  AckStates ackStates;
+  for (auto& packet : packets) {
+    EXPECT_TRUE(parseSuccess(codec->parsePacket(packet.buf, ackStates)));
+  }
+}
+
 TEST_F(QuicReadCodecTest, StreamWithShortHeaderOnlyHeader) {
   auto connId = getTestConnectionId();
   PacketNum packetNum = 12321;
@@ -300,4 +300,144 @@ TEST_F(PacketHeaderTest, ShortHeader) {
 
   EXPECT_EQ(readHeader.asShort()->getConnectionId(), connid);
 }
+
+class ReceivedPacketInfosTest : public Test {
+ public:
+  void add(PacketNum pktNum, std::chrono::microseconds sinceStart) {
+    ReceivedUdpPacket::Timings timings;
+    timings.receiveTimePoint = start_ + sinceStart;
+    infos_.emplace_back(pktNum, std::move(timings));
+  }
+
+  // Packet numbers newest first, as the ACK encoders walk the index.
+  std::vector<PacketNum> newestFirst() const {
+    std::vector<PacketNum> pktNums;
+    const auto& index = infos_.byReceiveTime();
+    for (auto it = index.crbegin(); it != index.crend(); ++it) {
+      pktNums.push_back(it->pktNum);
+    }
+    return pktNums;
+  }
+
+  TimePoint start_{Clock::now()};
+  WriteAckFrameState::ReceivedPacketInfos infos_;
+};
+
+TEST_F(ReceivedPacketInfosTest, IndexOrdersByReceiveTimeThenPacketNum) {
+  add(1, 10us);
+  add(3, 30us);
+  add(2, 20us);
+  // Same receive time as 3, e.g. a GRO batch.
+  add(4, 30us);
+  add(0, 5us);
+  EXPECT_EQ(newestFirst(), std::vector<PacketNum>({4, 3, 2, 1, 0}));
+  // Storage stays in arrival order.
+  EXPECT_EQ(infos_.front().pktNum, 1);
+  EXPECT_EQ(infos_[2].pktNum, 2);
+  EXPECT_EQ(infos_.back().pktNum, 0);
+}
+
+TEST_F(ReceivedPacketInfosTest, RemovalKeepsIndexInSync) {
+  for (PacketNum i = 0; i < 6; ++i) {
+    add(i, std::chrono::microseconds(100 - i * 10));
+  }
+  infos_.pop_front();
+  auto it = infos_.erase(infos_.begin() + 2);
+  EXPECT_EQ(it->pktNum, 4);
+  EXPECT_EQ(infos_.size(), 4);
+  EXPECT_EQ(infos_.byReceiveTime().size(), 4);
+  EXPECT_EQ(newestFirst(), std::vector<PacketNum>({1, 2, 4, 5}));
+
+  infos_.clear();
+  EXPECT_TRUE(infos_.byReceiveTime().empty());
+}
+
+TEST_F(ReceivedPacketInfosTest, AssignmentRebuildsIndex) {
+  add(9, 1us);
+  WriteAckFrameState::ReceivedPacketInfos::Container packets;
+  for (PacketNum i : {5, 7, 6}) {
+    ReceivedUdpPacket::Timings timings;
+    timings.receiveTimePoint = start_ + std::chrono::microseconds(i);
+    packets.emplace_back(i, std::move(timings));
+  }
+  infos_ = std::move(packets);
+  EXPECT_EQ(infos_.size(), 3);
+  EXPECT_EQ(newestFirst(), std::vector<PacketNum>({7, 6, 5}));
+}
+class EncodedAckBlocksTest : public Test {
+ public:
+  // Gap and length of every block but the largest, encoded from scratch.
+  static std::vector<uint8_t> encodeFromScratch(const AckBlocks& acks) {
+    std::vector<uint8_t> out;
+    auto append = [&](uint64_t value) {
+      QuicInteger(value).encode([&](auto val) {
+        auto bigEndian = folly::Endian::big(val);
+        auto bytes = reinterpret_cast<const uint8_t*>(&bigEndian);
+        out.insert(out.end(), bytes, bytes + sizeof(bigEndian));
+      });
+    };
+    PacketNum currentSeqNum = acks.crbegin()->start;
+    for (auto it = acks.crbegin() + 1; it != acks.crend(); ++it) {
+      append(currentSeqNum - it->end - 2);
+      append(it->end - it->start);
+      currentSeqNum = it->start;
+    }
+    return out;
+  }
+
+  void expectUpToDate() {
+    ASSERT_FALSE(encoded_.update(acks_).hasError());
+    EXPECT_EQ(encoded_.numAdditionalBlocks(), acks_.size() - 1);
+    EXPECT_EQ(
+        std::vector<uint8_t>(
+            encoded_.data(), encoded_.data() + encoded_.size()),
+        encodeFromScratch(acks_));
+    EXPECT_EQ(
+        encoded_.prefixSize(encoded_.numAdditionalBlocks()), encoded_.size());
+  }
+
+  AckBlocks acks_;
+  WriteAckFrameState::EncodedAckBlocks encoded_;
+};
+
+TEST_F(EncodedAckBlocksTest, FollowsChanges) {
+  acks_.insert(10, 20);
+  expectUpToDate();
+  for (PacketNum i = 0; i < 100; ++i) {
+    acks_.insert(30 + i * 3, 31 + i * 3);
+  }
+  expectUpToDate();
+  // The largest block grows.
+  acks_.insert(329, 340);
+  expectUpToDate();
+  // A new largest block, far enough away for a two byte gap.
+  acks_.insert(1000);
+  expectUpToDate();
+  // Filling a gap merges two blocks in the middle.
+  acks_.insert(32);
+  expectUpToDate();
+  acks_.withdraw({0, 40});
+  expectUpToDate();
+  acks_.withdraw({900, 2000});
+  expectUpToDate();
+  acks_.clear();
+  acks_.insert(5);
+  expectUpToDate();
+  EXPECT_EQ(encoded_.size(), 0);
+}
+
+TEST_F(EncodedAckBlocksTest, BlockSizes) {
+  acks_.insert(0);
+  acks_.insert(10);
+  acks_.insert(100, 200);
+  acks_.insert(1000);
+  expectUpToDate();
+  ASSERT_EQ(encoded_.numAdditionalBlocks(), 3);
+  // Gap of 798 and length of 100, both two bytes.
+  EXPECT_EQ(encoded_.blockSize(0), 4);
+  EXPECT_EQ(encoded_.blockSize(1), 3);
+  EXPECT_EQ(encoded_.blockSize(2), 2);
+  EXPECT_EQ(encoded_.prefixSize(0), 0);
+  EXPECT_EQ(encoded_.prefixSize(2), 7);
+}
 } // namespace quic::test
@@ -280,13 +280,15 @@ struct CircularDeque {
       if (n == 0) {
         return;
       }
+      auto maxSize = deque_->capacity_;
+      auto modulus = wrapped() ? maxSize : maxSize + 1;
       if (n > 0) {
-        auto maxSize = deque_->capacity_;
-        index_ = (index_ + n) % (wrapped() ? maxSize : maxSize + 1);
+        index_ = (index_ + n) % modulus;
       } else {
-        while (n++ != 0) {
-          decrement();
-        }
+        // Same wrap-around as repeated decrement(), but in constant time so
+        // that binary searches over reverse iterators stay logarithmic.
+        index_ = (index_ + modulus - static_cast<size_type>(-n) % modulus) %
+            modulus;
       }
     }
 
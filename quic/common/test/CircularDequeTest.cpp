@@ -774,6 +774,48 @@ TEST(CircularDequeTest, ReverseIterators) {
   EXPECT_TRUE(verifyStorageContent(cd, expected));
 }
 
+TEST(CircularDequeTest, IteratorCompoundAssignAcrossWrap) {
+  CircularDeque<int> cd = {1, 2, 3, 4, 5, 6, 7};
+  // Force a wrapped vector
+  cd.push_front(0);
+  cd.push_front(-1);
+  cd.push_front(-2);
+  std::vector expected = {-2, -1, 0, 1, 2, 3, 4, 5, 6, 7};
+  ASSERT_TRUE(verifyStorageContent(cd, expected));
+  auto size = static_cast<int>(cd.size());
+  // Every jump in both directions, checked against stepping one at a time.
+  for (int from = 0; from <= size; from++) {
+    for (int to = 0; to <= size; to++) {
+      auto stepped = cd.begin();
+      auto rstepped = cd.rbegin();
+      for (int i = 0; i < to; i++) {
+        ++stepped;
+        ++rstepped;
+      }
+      auto iter = cd.begin();
+      auto riter = cd.rbegin();
+      for (int i = 0; i < from; i++) {
+        ++iter;
+        ++riter;
+      }
+      auto iterMinus = iter;
+      auto riterMinus = riter;
+      iter += to - from;
+      iterMinus -= from - to;
+      riter += to - from;
+      riterMinus -= from - to;
+      EXPECT_EQ(iter, stepped) << from << " -> " << to;
+      EXPECT_EQ(iterMinus, stepped) << from << " -> " << to;
+      EXPECT_EQ(riter, rstepped) << from << " -> " << to;
+      EXPECT_EQ(riterMinus, rstepped) << from << " -> " << to;
+      if (to < size) {
+        EXPECT_EQ(*iter, expected[to]);
+        EXPECT_EQ(*riter, expected[size - 1 - to]);
+      }
+    }
+  }
+}
+
 TEST(CircularDequeTest, MoveOrCopyDoNotOverwrite) {
   CircularDeque<int> cd = {1, 2, 3, 4, 5, 6, 7};
   // erase 3, {1, 2} will be copied into the current position of {2, 3}.
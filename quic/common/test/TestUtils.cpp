@@ -128,7 +128,7 @@ RegularQuicPacketBuilder::Packet createAckPacket(
   return std::move(builder).build();
 }
 
-static std::shared_ptr<fizz::SelfCert> readCert() {
+std::shared_ptr<fizz::SelfCert> readCert() {
   auto certificate = fizz::test::getCert(fizz::test::kP256Certificate);
   auto privKey = fizz::test::getPrivateKey(fizz::test::kP256Key);
   std::vector<folly::ssl::X509UniquePtr> certs;
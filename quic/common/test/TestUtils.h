@@ -147,6 +147,9 @@ bool isState(const S& s) {
 
 std::shared_ptr<fizz::client::FizzClientContext> createClientCtx();
 
+// The P256 test certificate createServerCtx() serves.
+std::shared_ptr<fizz::SelfCert> readCert();
+
 std::shared_ptr<fizz::server::FizzServerContext> createServerCtx();
 
 void setupCtxWithTestCert(fizz::server::FizzServerContext& ctx);
@@ -195,7 +198,7 @@ template <typename Match>
 OutstandingPacketWrapper* findOutstandingPacket(
     QuicConnectionStateBase& conn,
     Match match) {
-  auto helper = [&](std::deque<OutstandingPacketWrapper>& packets)
+  auto helper = [&](OutstandingPacketContainer& packets)
       -> OutstandingPacketWrapper* {
     for (auto& packet : packets) {
       if (match(packet)) {
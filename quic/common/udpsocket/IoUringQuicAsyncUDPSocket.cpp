@@ -0,0 +1,1553 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/common/udpsocket/IoUringQuicAsyncUDPSocket.h>
+
+#if FOLLY_HAS_LIBURING
+
+#include <folly/ScopeGuard.h>
+#include <folly/container/F14Set.h>
+#include <folly/io/async/EventBaseLocal.h>
+#include <folly/io/async/EventHandler.h>
+#include <folly/io/async/IoUringBackend.h>
+#include <folly/lang/Align.h>
+#include <folly/lang/Bits.h>
+#include <quic/QuicException.h>
+#include <quic/common/MvfstLogging.h>
+#include <quic/common/StringUtils.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <liburing.h>
+#include <linux/net_tstamp.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+#endif // FOLLY_HAS_LIBURING
+
+namespace quic {
+
+#if FOLLY_HAS_LIBURING
+
+namespace {
+
+// All sockets of a ring select receive buffers from this group.
+constexpr uint16_t kRecvBufferGroup = 0;
+// Provided buffer ids are 16 bits and the kernel caps buffer rings at 32768.
+constexpr uint32_t kMaxRecvBuffers = 32768;
+
+// Every multishot recvmsg uses the same name and control lengths, which the
+// provided buffers are laid out for.
+constexpr socklen_t kRecvNameLen = sizeof(sockaddr_storage);
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+constexpr size_t kRecvControlLen =
+    QuicAsyncUDPSocket::ReadCallback::OnDataAvailableParams::kCmsgSpace;
+#else
+constexpr size_t kRecvControlLen = 0;
+#endif
+
+// Room for UDP_SEGMENT, SCM_TXTIME and the cmsgs set through setCmsgs and
+// setAdditionalCmsgsFunc.
+constexpr size_t kMaxSendIntCmsgs = 8;
+constexpr size_t kSendControlLen = CMSG_SPACE(sizeof(uint16_t)) +
+    CMSG_SPACE(sizeof(uint64_t)) + kMaxSendIntCmsgs * CMSG_SPACE(sizeof(int));
+
+// Send buffers are pooled in two sizes: one packet, or a whole GSO batch.
+constexpr size_t kSmallSendCapacity = 2048;
+constexpr size_t kLargeSendCapacity = 65536;
+constexpr size_t kMaxPooledSmallSends = 4096;
+constexpr size_t kMaxPooledLargeSends = 128;
+
+QuicError makeSocketError(const std::string& what, int errnoCopy) {
+  return QuicError(
+      QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+      what + ": " + quic::errnoStr(errnoCopy));
+}
+
+QuicError makeNotInitializedError(const char* func) {
+  return QuicError(
+      QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+      std::string("socket not initialized for ") + func);
+}
+
+} // namespace
+
+namespace detail {
+
+// Common header of everything whose address is used as io_uring user_data.
+// Cancel requests use user_data 0.
+struct IoUringQuicOp {
+  enum class Kind : uint8_t { Recv, Send };
+
+  explicit IoUringQuicOp(Kind kindIn) : kind(kindIn) {}
+
+  Kind kind;
+};
+
+} // namespace detail
+
+struct IoUringQuicAsyncUDPSocket::RecvOp : public detail::IoUringQuicOp {
+  RecvOp() : IoUringQuicOp(Kind::Recv) {
+    msg.msg_namelen = kRecvNameLen;
+    msg.msg_controllen = kRecvControlLen;
+  }
+
+  // Null once the socket is gone and the ring owns the op.
+  IoUringQuicAsyncUDPSocket* socket{nullptr};
+  // Layout template of the multishot recvmsg, only the lengths are used.
+  msghdr msg{};
+  // The kernel holds the op until it posts a CQE without IORING_CQE_F_MORE.
+  bool armed{false};
+  bool cancelling{false};
+};
+
+struct IoUringQuicAsyncUDPSocket::SendOp : public detail::IoUringQuicOp {
+  explicit SendOp(size_t capacityIn)
+      : IoUringQuicOp(Kind::Send),
+        data(new uint8_t[capacityIn]),
+        capacity(capacityIn) {}
+
+  // Null once the socket is gone.
+  IoUringQuicAsyncUDPSocket* socket{nullptr};
+  quic::SocketAddress dest;
+  msghdr msg{};
+  iovec iov{};
+  sockaddr_storage addr{};
+  alignas(cmsghdr) std::array<uint8_t, kSendControlLen> control{};
+  std::unique_ptr<uint8_t[]> data;
+  size_t capacity;
+  size_t len{0};
+  int gso{0};
+};
+
+/**
+ * The io_uring shared by the IoUringQuicAsyncUDPSockets of one EventBase.
+ *
+ * The ring fd is registered with the EventBase, which tells the ring to reap
+ * completions, and SQEs prepared during a loop iteration are submitted by a
+ * loop callback at the end of it. The ring owns the provided receive buffers
+ * and the pool of send buffers. It lives as long as any of its sockets.
+ */
+class IoUringQuicSocketRing
+    : public folly::EventHandler,
+      public folly::EventBase::LoopCallback,
+      public std::enable_shared_from_this<IoUringQuicSocketRing> {
+ public:
+  using Socket = IoUringQuicAsyncUDPSocket;
+
+  static std::shared_ptr<IoUringQuicSocketRing> get(
+      folly::EventBase* evb,
+      const IoUringQuicSocketOptions& options) {
+    static folly::EventBaseLocal<std::weak_ptr<IoUringQuicSocketRing>> rings;
+    auto& weakRing = rings.try_emplace(*evb);
+    if (auto ring = weakRing.lock()) {
+      return ring;
+    }
+    auto ring = std::make_shared<IoUringQuicSocketRing>(evb);
+    if (!ring->init(options)) {
+      return nullptr;
+    }
+    weakRing = ring;
+    return ring;
+  }
+
+  explicit IoUringQuicSocketRing(folly::EventBase* evb)
+      : folly::EventHandler(evb), evb_(evb) {}
+
+  ~IoUringQuicSocketRing() override {
+    cancelLoopCallback();
+    unregisterHandler();
+    if (ringInitialized_) {
+      if (bufRing_) {
+        io_uring_free_buf_ring(&ring_, bufRing_, numBuffers_, kRecvBufferGroup);
+      }
+      io_uring_queue_exit(&ring_);
+    }
+    // The kernel is done with everything once the ring is gone.
+    for (auto* op : inflightSends_) {
+      delete op;
+    }
+  }
+
+  IoUringQuicSocketRing(const IoUringQuicSocketRing&) = delete;
+  IoUringQuicSocketRing& operator=(const IoUringQuicSocketRing&) = delete;
+
+  /**
+   * Returns a free SQE, submitting what is queued first if the SQ is full.
+   */
+  io_uring_sqe* getSqe() {
+    auto* sqe = io_uring_get_sqe(&ring_);
+    if (!sqe) {
+      submitNow();
+      sqe = io_uring_get_sqe(&ring_);
+    }
+    return sqe;
+  }
+
+  void scheduleSubmit() {
+    if (!isLoopCallbackScheduled()) {
+      evb_->runInLoop(this, true /* thisIteration */);
+    }
+  }
+
+  void submitNow() {
+    int ret = io_uring_submit(&ring_);
+    if (ret < 0 && ret != -EBUSY && ret != -EAGAIN) {
+      MVLOG_ERROR << "io_uring_submit failed: " << quic::errnoStr(-ret);
+    }
+  }
+
+  // Asks the kernel to terminate op. The op posts its final CQE afterwards.
+  bool cancel(detail::IoUringQuicOp* op) {
+    auto* sqe = getSqe();
+    if (!sqe) {
+      return false;
+    }
+    io_uring_prep_cancel64(sqe, reinterpret_cast<uint64_t>(op), 0);
+    io_uring_sqe_set_data64(sqe, 0);
+    scheduleSubmit();
+    return true;
+  }
+
+  // Keeps op of a destroyed socket alive until the kernel releases it.
+  void adoptOrphan(std::unique_ptr<Socket::RecvOp> op) {
+    op->socket = nullptr;
+    orphans_.push_back(std::move(op));
+  }
+
+  Socket::SendOp* allocSend(size_t len) {
+    auto& pool = len <= kSmallSendCapacity ? smallSends_ : largeSends_;
+    std::unique_ptr<Socket::SendOp> op;
+    if (!pool.empty() && pool.back()->capacity >= len) {
+      op = std::move(pool.back());
+      pool.pop_back();
+    } else {
+      op = std::make_unique<Socket::SendOp>(
+          len <= kSmallSendCapacity ? kSmallSendCapacity
+                                    : std::max(len, kLargeSendCapacity));
+    }
+    auto* raw = op.release();
+    inflightSends_.insert(raw);
+    return raw;
+  }
+
+  void releaseSend(Socket::SendOp* op) {
+    inflightSends_.erase(op);
+    std::unique_ptr<Socket::SendOp> owned(op);
+    owned->socket = nullptr;
+    owned->dest = quic::SocketAddress();
+    if (owned->capacity == kSmallSendCapacity) {
+      if (smallSends_.size() < kMaxPooledSmallSends) {
+        smallSends_.push_back(std::move(owned));
+      }
+    } else if (
+        owned->capacity == kLargeSendCapacity &&
+        largeSends_.size() < kMaxPooledLargeSends) {
+      largeSends_.push_back(std::move(owned));
+    }
+  }
+
+  [[nodiscard]] uint8_t* buffer(uint16_t bufferId) const {
+    return buffers_.get() + size_t(bufferId) * bufferSize_;
+  }
+
+  void recycleBuffer(uint16_t bufferId) {
+    io_uring_buf_ring_add(
+        bufRing_,
+        buffer(bufferId),
+        bufferSize_,
+        bufferId,
+        io_uring_buf_ring_mask(numBuffers_),
+        0);
+    io_uring_buf_ring_advance(bufRing_, 1);
+    ++numFreeBuffers_;
+    if (!starved_.empty()) {
+      auto starved = std::move(starved_);
+      starved_.clear();
+      for (auto* sock : starved) {
+        sock->scheduleDeliver();
+      }
+    }
+  }
+
+  [[nodiscard]] bool hasFreeBuffers() const noexcept {
+    return numFreeBuffers_ > 0;
+  }
+
+  // sock is rearmed once a buffer is recycled.
+  void addStarved(Socket* sock) {
+    if (std::find(starved_.begin(), starved_.end(), sock) == starved_.end()) {
+      starved_.push_back(sock);
+    }
+  }
+
+  void detach(Socket* sock) {
+    starved_.erase(
+        std::remove(starved_.begin(), starved_.end(), sock), starved_.end());
+    for (auto* op : inflightSends_) {
+      if (op->socket == sock) {
+        op->socket = nullptr;
+      }
+    }
+  }
+
+ private:
+  bool init(const IoUringQuicSocketOptions& options) {
+    io_uring_params params{};
+    // Every multishot recvmsg posts a CQE per datagram.
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = options.ringEntries * 4;
+    int ret = io_uring_queue_init_params(options.ringEntries, &ring_, &params);
+    if (ret != 0) {
+      MVLOG_ERROR << "io_uring_queue_init failed: " << quic::errnoStr(-ret);
+      return false;
+    }
+    ringInitialized_ = true;
+
+    numBuffers_ = folly::nextPowTwo(std::min(
+        std::max<uint32_t>(options.numRecvBuffers, 1), kMaxRecvBuffers));
+    // Provided buffers hold the io_uring_recvmsg_out header, the peer
+    // address and the control messages ahead of the payload.
+    bufferSize_ = static_cast<uint32_t>(folly::alignCeil(
+        sizeof(io_uring_recvmsg_out) + kRecvNameLen + kRecvControlLen +
+            options.maxRecvPayloadSize,
+        alignof(std::max_align_t)));
+    buffers_.reset(new uint8_t[size_t(numBuffers_) * bufferSize_]);
+
+    bufRing_ = io_uring_setup_buf_ring(
+        &ring_, numBuffers_, kRecvBufferGroup, 0, &ret);
+    if (!bufRing_) {
+      MVLOG_ERROR << "io_uring_setup_buf_ring failed: "
+                  << quic::errnoStr(-ret);
+      return false;
+    }
+    auto mask = io_uring_buf_ring_mask(numBuffers_);
+    for (uint32_t i = 0; i < numBuffers_; ++i) {
+      io_uring_buf_ring_add(
+          bufRing_,
+          buffer(static_cast<uint16_t>(i)),
+          bufferSize_,
+          static_cast<uint16_t>(i),
+          mask,
+          static_cast<int>(i));
+    }
+    io_uring_buf_ring_advance(bufRing_, static_cast<int>(numBuffers_));
+    numFreeBuffers_ = numBuffers_;
+
+    changeHandlerFD(folly::NetworkSocket::fromFd(ring_.ring_fd));
+    registerHandler(folly::EventHandler::READ | folly::EventHandler::PERSIST);
+    return true;
+  }
+
+  void handlerReady(uint16_t /* events */) noexcept override {
+    // A socket callback may drop the last reference to the ring.
+    auto self = shared_from_this();
+    reap();
+  }
+
+  void runLoopCallback() noexcept override {
+    submitNow();
+  }
+
+  void reap() {
+    while (true) {
+      io_uring_cqe* cqe = nullptr;
+      unsigned head = 0;
+      unsigned count = 0;
+      io_uring_for_each_cqe(&ring_, head, cqe) {
+        ++count;
+        handleCompletion(cqe->user_data, cqe->res, cqe->flags);
+      }
+      io_uring_cq_advance(&ring_, count);
+      if (!io_uring_cq_has_overflow(&ring_)) {
+        break;
+      }
+      // Let the kernel move overflowed completions into the CQ.
+      io_uring_get_events(&ring_);
+    }
+  }
+
+  void handleCompletion(uint64_t userData, int res, uint32_t flags) {
+    if (userData == 0) {
+      // Result of a cancel request.
+      return;
+    }
+    auto* op = reinterpret_cast<detail::IoUringQuicOp*>(userData);
+    if (op->kind == detail::IoUringQuicOp::Kind::Send) {
+      auto* send = static_cast<Socket::SendOp*>(op);
+      if (send->socket) {
+        send->socket->onSendCompletion(send, res);
+      }
+      releaseSend(send);
+      return;
+    }
+    auto* recv = static_cast<Socket::RecvOp*>(op);
+    if (flags & IORING_CQE_F_BUFFER) {
+      --numFreeBuffers_;
+    }
+    if (recv->socket) {
+      recv->socket->onRecvCompletion(res, flags);
+      return;
+    }
+    if (flags & IORING_CQE_F_BUFFER) {
+      recycleBuffer(static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT));
+    }
+    if (!(flags & IORING_CQE_F_MORE)) {
+      orphans_.erase(
+          std::remove_if(
+              orphans_.begin(),
+              orphans_.end(),
+              [recv](const auto& orphan) { return orphan.get() == recv; }),
+          orphans_.end());
+    }
+  }
+
+  folly::EventBase* evb_;
+  io_uring ring_{};
+  bool ringInitialized_{false};
+
+  io_uring_buf_ring* bufRing_{nullptr};
+  std::unique_ptr<uint8_t[]> buffers_;
+  uint32_t numBuffers_{0};
+  uint32_t bufferSize_{0};
+  uint32_t numFreeBuffers_{0};
+  std::vector<Socket*> starved_;
+
+  std::vector<std::unique_ptr<Socket::RecvOp>> orphans_;
+  folly::F14FastSet<Socket::SendOp*> inflightSends_;
+  std::vector<std::unique_ptr<Socket::SendOp>> smallSends_;
+  std::vector<std::unique_ptr<Socket::SendOp>> largeSends_;
+};
+
+IoUringQuicAsyncUDPSocket::IoUringQuicAsyncUDPSocket(
+    std::shared_ptr<FollyQuicEventBase> evb,
+    const IoUringQuicSocketOptions& options)
+    : evb_(std::move(evb)),
+      maxInflightSends_(options.maxInflightSendsPerSocket) {
+  MVCHECK(evb_, "EventBase must be FollyQuicEventBase");
+  MVCHECK(evb_->isInEventBaseThread());
+  ring_ = IoUringQuicSocketRing::get(evb_->getBackingEventBase(), options);
+  MVCHECK(ring_, "io_uring is not available");
+  recvOp_ = std::make_unique<RecvOp>();
+  recvOp_->socket = this;
+}
+
+IoUringQuicAsyncUDPSocket::~IoUringQuicAsyncUDPSocket() {
+  if (fd_ != -1) {
+    auto closeResult = IoUringQuicAsyncUDPSocket::close();
+    if (closeResult.hasError()) {
+      MVLOG_ERROR << "Error closing socket in destructor: "
+                  << closeResult.error().message;
+    }
+  }
+  deliverCallback_.cancelLoopCallback();
+  for (const auto& datagram : pendingDatagrams_) {
+    ring_->recycleBuffer(datagram.bufferId);
+  }
+  pendingDatagrams_.clear();
+  ring_->detach(this);
+  if (recvOp_->armed) {
+    ring_->adoptOrphan(std::move(recvOp_));
+  }
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::init(
+    sa_family_t family) {
+  if (fd_ != -1) {
+    // Socket already initialized.
+    return {};
+  }
+
+  if (family != AF_INET && family != AF_INET6) {
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        "address family not supported"));
+  }
+
+  int fd = ::socket(family, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+  if (fd == -1) {
+    return quic::make_unexpected(
+        makeSocketError("error creating socket", errno));
+  }
+  auto fdGuard = folly::makeGuard([fd] { ::close(fd); });
+
+  int sockOptVal = 1;
+  if (reuseAddr_ &&
+      ::setsockopt(
+          fd, SOL_SOCKET, SO_REUSEADDR, &sockOptVal, sizeof(sockOptVal)) != 0) {
+    return quic::make_unexpected(
+        makeSocketError("error setting reuse address on socket", errno));
+  }
+  if (reusePort_ &&
+      ::setsockopt(
+          fd, SOL_SOCKET, SO_REUSEPORT, &sockOptVal, sizeof(sockOptVal)) != 0) {
+    return quic::make_unexpected(
+        makeSocketError("error setting reuse port on socket", errno));
+  }
+  if (rcvBuf_ > 0 &&
+      ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvBuf_, sizeof(rcvBuf_)) != 0) {
+    return quic::make_unexpected(
+        makeSocketError("failed to set SO_RCVBUF on the socket", errno));
+  }
+  if (sndBuf_ > 0 &&
+      ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndBuf_, sizeof(sndBuf_)) != 0) {
+    return quic::make_unexpected(
+        makeSocketError("failed to set SO_SNDBUF on the socket", errno));
+  }
+
+  fd_ = fd;
+  ownership_ = FDOwnership::OWNS;
+  fdGuard.dismiss();
+  onFdChanged();
+  return {};
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::bind(
+    const quic::SocketAddress& address) {
+  if (fd_ == -1) {
+    auto initResult = init(address.getFamily());
+    if (initResult.hasError()) {
+      return initResult;
+    }
+  }
+
+  sockaddr_storage addrStorage;
+  address.getAddress(&addrStorage);
+  if (::bind(
+          fd_,
+          reinterpret_cast<sockaddr*>(&addrStorage),
+          address.getActualSize()) != 0) {
+    return quic::make_unexpected(makeSocketError(
+        "error binding socket to " + address.describe(), errno));
+  }
+
+  memset(&addrStorage, 0, sizeof(addrStorage));
+  socklen_t len = sizeof(addrStorage);
+  if (::getsockname(fd_, reinterpret_cast<sockaddr*>(&addrStorage), &len) !=
+      0) {
+    return quic::make_unexpected(
+        makeSocketError("error retrieving local address", errno));
+  }
+  localAddress_.setFromSockaddr(reinterpret_cast<sockaddr*>(&addrStorage), len);
+  bound_ = true;
+  return {};
+}
+
+bool IoUringQuicAsyncUDPSocket::isBound() const {
+  return bound_;
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::connect(
+    const quic::SocketAddress& address) {
+  if (fd_ == -1) {
+    auto initResult = init(address.getFamily());
+    if (initResult.hasError()) {
+      return initResult;
+    }
+  }
+
+  sockaddr_storage addrStorage;
+  address.getAddress(&addrStorage);
+  if (::connect(
+          fd_,
+          reinterpret_cast<sockaddr*>(&addrStorage),
+          address.getActualSize()) != 0) {
+    return quic::make_unexpected(
+        makeSocketError("io_uring connect failed to " + address.describe(), errno));
+  }
+
+  connected_ = true;
+  connectedAddress_ = address;
+  bound_ = true;
+
+  if (!localAddress_.isInitialized()) {
+    memset(&addrStorage, 0, sizeof(addrStorage));
+    socklen_t len = sizeof(addrStorage);
+    if (::getsockname(fd_, reinterpret_cast<sockaddr*>(&addrStorage), &len) !=
+        0) {
+      return quic::make_unexpected(
+          makeSocketError("getsockname failed after connect", errno));
+    }
+    localAddress_.setFromSockaddr(
+        reinterpret_cast<sockaddr*>(&addrStorage), len);
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::close() {
+  MVCHECK(evb_->isInEventBaseThread());
+
+  if (readCallback_) {
+    auto cob = readCallback_;
+    readCallback_ = nullptr;
+
+    cob->onReadClosed();
+  }
+  writeCallback_ = nullptr;
+  cancelRecv();
+  for (const auto& datagram : pendingDatagrams_) {
+    ring_->recycleBuffer(datagram.bufferId);
+  }
+  pendingDatagrams_.clear();
+  recvError_ = 0;
+
+  if (fd_ != -1) {
+    // Queued operations refer to the fd by number, hand them to the kernel
+    // before the number can be closed or reused.
+    ring_->submitNow();
+  }
+  if (fd_ != -1 && ownership_ == FDOwnership::OWNS) {
+    if (::close(fd_) != 0) {
+      int errnoCopy = errno;
+      fd_ = -1;
+      return quic::make_unexpected(
+          makeSocketError("Failed to close socket", errnoCopy));
+    }
+  }
+
+  fd_ = -1;
+  bound_ = false;
+  connected_ = false;
+  return {};
+}
+
+void IoUringQuicAsyncUDPSocket::resumeRead(ReadCallback* cb) {
+  MVCHECK(!readCallback_, "A read callback is already installed");
+  MVCHECK_NE(
+      fd_, -1, "Socket must be initialized before a read callback is attached");
+  MVCHECK(cb, "A non-null callback is required to resume read");
+  readCallback_ = cb;
+  armRecv();
+  if (!pendingDatagrams_.empty()) {
+    scheduleDeliver();
+  }
+}
+
+void IoUringQuicAsyncUDPSocket::pauseRead() {
+  readCallback_ = nullptr;
+  cancelRecv();
+}
+
+bool IoUringQuicAsyncUDPSocket::isReadPaused() const {
+  return readCallback_ == nullptr;
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::resumeWrite(
+    WriteCallback* cob) {
+  MVCHECK(!writeCallback_, "A write callback is already installed");
+  if (fd_ == -1) {
+    return quic::make_unexpected(makeNotInitializedError(__func__));
+  }
+  writeCallback_ = cob;
+  scheduleDeliver();
+  return {};
+}
+
+void IoUringQuicAsyncUDPSocket::pauseWrite() {
+  writeCallback_ = nullptr;
+}
+
+bool IoUringQuicAsyncUDPSocket::isWritableCallbackSet() const {
+  return writeCallback_ != nullptr;
+}
+
+IoUringQuicAsyncUDPSocket::SendOp* IoUringQuicAsyncUDPSocket::prepareSend(
+    const quic::SocketAddress& address,
+    size_t len,
+    const WriteOptions& options) {
+  if (fd_ == -1) {
+    errno = EBADF;
+    return nullptr;
+  }
+  if (connected_ && address != connectedAddress_) {
+    errno = EINVAL;
+    return nullptr;
+  }
+  if (numInflightSends_ >= maxInflightSends_) {
+    errno = EAGAIN;
+    return nullptr;
+  }
+
+  const folly::SocketCmsgMap* cmsgs = &cmsgs_;
+  folly::SocketCmsgMap mergedCmsgs;
+  if (additionalCmsgsFunc_) {
+    if (auto additionalCmsgs = additionalCmsgsFunc_()) {
+      mergedCmsgs = cmsgs_;
+      for (const auto& [key, value] : *additionalCmsgs) {
+        mergedCmsgs[key] = value;
+      }
+      cmsgs = &mergedCmsgs;
+    }
+  }
+  if (cmsgs->size() > kMaxSendIntCmsgs) {
+    errno = EINVAL;
+    return nullptr;
+  }
+
+  auto* op = ring_->allocSend(len);
+  op->socket = this;
+  op->dest = address;
+  op->len = len;
+  op->gso = options.gso;
+  op->msg = {};
+  if (!connected_) {
+    address.getAddress(&op->addr);
+    op->msg.msg_name = &op->addr;
+    op->msg.msg_namelen = address.getActualSize();
+  }
+  op->iov.iov_base = op->data.get();
+  op->iov.iov_len = len;
+  op->msg.msg_iov = &op->iov;
+  op->msg.msg_iovlen = 1;
+
+  size_t controlLen = 0;
+  auto addCmsg = [&](int level, int type, const void* value, size_t size) {
+    auto* cm = reinterpret_cast<cmsghdr*>(op->control.data() + controlLen);
+    memset(cm, 0, CMSG_SPACE(size));
+    cm->cmsg_level = level;
+    cm->cmsg_type = type;
+    cm->cmsg_len = CMSG_LEN(size);
+    memcpy(CMSG_DATA(cm), value, size);
+    controlLen += CMSG_SPACE(size);
+  };
+  if (options.gso > 0) {
+    auto gsoLen = static_cast<uint16_t>(options.gso);
+    addCmsg(SOL_UDP, UDP_SEGMENT, &gsoLen, sizeof(gsoLen));
+  }
+#ifdef SCM_TXTIME
+  if (options.txTime.count() > 0 && txTimeClockId_ >= 0) {
+    // The kernel rejects SCM_TXTIME on sockets without SO_TXTIME, so the
+    // departure time is only attached when the fd has it enabled.
+    timespec now{};
+    ::clock_gettime(txTimeClockId_, &now);
+    uint64_t txTime = static_cast<uint64_t>(now.tv_sec) * 1000000000ULL +
+        now.tv_nsec +
+        std::chrono::duration_cast<std::chrono::nanoseconds>(options.txTime)
+            .count();
+    addCmsg(SOL_SOCKET, SCM_TXTIME, &txTime, sizeof(txTime));
+  }
+#endif
+  for (const auto& [key, value] : *cmsgs) {
+    addCmsg(key.level, key.optname, &value, sizeof(value));
+  }
+  if (controlLen > 0) {
+    op->msg.msg_control = op->control.data();
+    op->msg.msg_controllen = controlLen;
+  }
+  return op;
+}
+
+bool IoUringQuicAsyncUDPSocket::submitSend(SendOp* op) {
+  auto* sqe = ring_->getSqe();
+  if (!sqe) {
+    // The kernel did not take the queued SQEs, e.g. because its completion
+    // queue overflowed.
+    ring_->releaseSend(op);
+    errno = EAGAIN;
+    return false;
+  }
+  io_uring_prep_sendmsg(sqe, fd_, &op->msg, 0);
+  io_uring_sqe_set_data(sqe, static_cast<detail::IoUringQuicOp*>(op));
+  ++numInflightSends_;
+  ring_->scheduleSubmit();
+  return true;
+}
+
+ssize_t IoUringQuicAsyncUDPSocket::queueSend(
+    const quic::SocketAddress& address,
+    const struct iovec* vec,
+    size_t iovecLen,
+    const WriteOptions& options) {
+  size_t len = 0;
+  for (size_t i = 0; i < iovecLen; ++i) {
+    len += vec[i].iov_len;
+  }
+  auto* op = prepareSend(address, len, options);
+  if (!op) {
+    return -1;
+  }
+  size_t offset = 0;
+  for (size_t i = 0; i < iovecLen; ++i) {
+    memcpy(op->data.get() + offset, vec[i].iov_base, vec[i].iov_len);
+    offset += vec[i].iov_len;
+  }
+  if (!submitSend(op)) {
+    return -1;
+  }
+  return static_cast<ssize_t>(len);
+}
+
+ssize_t IoUringQuicAsyncUDPSocket::write(
+    const quic::SocketAddress& address,
+    const struct iovec* vec,
+    size_t iovec_len) {
+  return queueSend(address, vec, iovec_len, WriteOptions());
+}
+
+int IoUringQuicAsyncUDPSocket::writem(
+    AddressRange addrs,
+    iovec* iov,
+    size_t* numIovecsInBuffer,
+    size_t count) {
+  return writemGSO(addrs, iov, numIovecsInBuffer, count, nullptr);
+}
+
+ssize_t IoUringQuicAsyncUDPSocket::writeGSO(
+    const quic::SocketAddress& address,
+    const struct iovec* vec,
+    size_t iovec_len,
+    WriteOptions options) {
+  return queueSend(address, vec, iovec_len, options);
+}
+
+int IoUringQuicAsyncUDPSocket::writemGSO(
+    AddressRange addrs,
+    const BufPtr* bufs,
+    size_t count,
+    const WriteOptions* options) {
+  for (size_t i = 0; i < count; ++i) {
+    // A single address applies to all messages.
+    const auto& address = addrs.size() == 1 ? addrs[0] : addrs[i];
+    auto* op = prepareSend(
+        address,
+        bufs[i]->computeChainDataLength(),
+        options ? options[i] : WriteOptions());
+    if (!op) {
+      return i > 0 ? static_cast<int>(i) : -1;
+    }
+    size_t offset = 0;
+    for (auto range : *bufs[i]) {
+      memcpy(op->data.get() + offset, range.data(), range.size());
+      offset += range.size();
+    }
+    if (!submitSend(op)) {
+      return i > 0 ? static_cast<int>(i) : -1;
+    }
+  }
+  return static_cast<int>(count);
+}
+
+int IoUringQuicAsyncUDPSocket::writemGSO(
+    AddressRange addrs,
+    iovec* iov,
+    size_t* numIovecsInBuffer,
+    size_t count,
+    const WriteOptions* options) {
+  size_t iovOffset = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const auto& address = addrs.size() == 1 ? addrs[0] : addrs[i];
+    auto ret = queueSend(
+        address,
+        iov + iovOffset,
+        numIovecsInBuffer[i],
+        options ? options[i] : WriteOptions());
+    if (ret < 0) {
+      return i > 0 ? static_cast<int>(i) : -1;
+    }
+    iovOffset += numIovecsInBuffer[i];
+  }
+  return static_cast<int>(count);
+}
+
+void IoUringQuicAsyncUDPSocket::onSendCompletion(SendOp* op, int res) {
+  MVDCHECK_GT(numInflightSends_, 0);
+  --numInflightSends_;
+  if (writeCallback_ && numInflightSends_ + 1 == maxInflightSends_) {
+    scheduleDeliver();
+  }
+  if (res >= 0) {
+    return;
+  }
+  if (op->gso > 0 && (res == -EIO || res == -EINVAL || res == -EMSGSIZE)) {
+    // The kernel rejected UDP GSO although getsockopt(UDP_SEGMENT) works.
+    // Resend the segments one by one and have the transport stop using GSO,
+    // like LibevQuicAsyncUDPSocket::writeGSO does.
+    gso_ = -1;
+    for (size_t offset = 0; offset < op->len; offset += op->gso) {
+      iovec segment{
+          op->data.get() + offset,
+          std::min(static_cast<size_t>(op->gso), op->len - offset)};
+      if (queueSend(op->dest, &segment, 1, WriteOptions()) < 0) {
+        break;
+      }
+    }
+    return;
+  }
+  // Asynchronous send failures look like loss to the transport.
+  MVVLOG(4) << "io_uring sendmsg to " << op->dest.describe()
+            << " failed: " << quic::errnoStr(-res);
+}
+
+ssize_t IoUringQuicAsyncUDPSocket::recvmsg(struct msghdr* msg, int flags) {
+  while (!pendingDatagrams_.empty()) {
+    auto datagram = pendingDatagrams_.front();
+    pendingDatagrams_.pop_front();
+    SCOPE_EXIT {
+      ring_->recycleBuffer(datagram.bufferId);
+    };
+
+    auto* out = io_uring_recvmsg_validate(
+        ring_->buffer(datagram.bufferId), datagram.length, &recvOp_->msg);
+    if (!out) {
+      MVLOG_ERROR << "Malformed io_uring recvmsg buffer of "
+                  << datagram.length << " bytes";
+      continue;
+    }
+
+    if (msg->msg_name && msg->msg_namelen > 0) {
+      auto nameLen = std::min(out->namelen, kRecvNameLen);
+      memcpy(
+          msg->msg_name,
+          io_uring_recvmsg_name(out),
+          std::min<size_t>(nameLen, msg->msg_namelen));
+      msg->msg_namelen = nameLen;
+    }
+
+    auto* payload =
+        static_cast<uint8_t*>(io_uring_recvmsg_payload(out, &recvOp_->msg));
+    size_t payloadLen = io_uring_recvmsg_payload_length(
+        out, datagram.length, &recvOp_->msg);
+    size_t copied = 0;
+    for (size_t i = 0; i < msg->msg_iovlen && copied < payloadLen; ++i) {
+      auto len = std::min(msg->msg_iov[i].iov_len, payloadLen - copied);
+      memcpy(msg->msg_iov[i].iov_base, payload + copied, len);
+      copied += len;
+    }
+
+    msg->msg_flags = static_cast<int>(out->flags);
+    if (copied < out->payloadlen) {
+      msg->msg_flags |= MSG_TRUNC;
+    }
+    if (msg->msg_control && msg->msg_controllen > 0) {
+      // Control messages follow the name in the provided buffer.
+      auto* control = reinterpret_cast<uint8_t*>(out + 1) + kRecvNameLen;
+      size_t controlLen = std::min<size_t>(
+          std::min<size_t>(out->controllen, kRecvControlLen),
+          msg->msg_controllen);
+      memcpy(msg->msg_control, control, controlLen);
+      if (controlLen < out->controllen) {
+        msg->msg_flags |= MSG_CTRUNC;
+      }
+      msg->msg_controllen = controlLen;
+    } else {
+      msg->msg_controllen = 0;
+    }
+    return static_cast<ssize_t>((flags & MSG_TRUNC) ? out->payloadlen : copied);
+  }
+  if (recvError_ != 0) {
+    errno = std::exchange(recvError_, 0);
+  } else {
+    errno = EAGAIN;
+  }
+  return -1;
+}
+
+int IoUringQuicAsyncUDPSocket::recvmmsg(
+    struct mmsghdr* msgvec,
+    unsigned int vlen,
+    unsigned int flags,
+    struct timespec* /* timeout */) {
+  for (unsigned int i = 0; i < vlen; i++) {
+    ssize_t ret = recvmsg(&msgvec[i].msg_hdr, static_cast<int>(flags));
+    if (ret < 0) {
+      if (i) {
+        return static_cast<int>(i);
+      }
+      return static_cast<int>(ret);
+    }
+    msgvec[i].msg_len = static_cast<unsigned int>(ret);
+  }
+  return static_cast<int>(vlen);
+}
+
+void IoUringQuicAsyncUDPSocket::armRecv() {
+  if (fd_ == -1 || !readCallback_ || recvOp_->armed) {
+    return;
+  }
+  if (!ring_->hasFreeBuffers()) {
+    ring_->addStarved(this);
+    return;
+  }
+  auto* sqe = ring_->getSqe();
+  if (!sqe) {
+    scheduleDeliver();
+    return;
+  }
+  io_uring_prep_recvmsg_multishot(sqe, fd_, &recvOp_->msg, 0);
+  sqe->flags |= IOSQE_BUFFER_SELECT;
+  sqe->buf_group = kRecvBufferGroup;
+  io_uring_sqe_set_data(sqe, static_cast<detail::IoUringQuicOp*>(recvOp_.get()));
+  recvOp_->armed = true;
+  ring_->scheduleSubmit();
+}
+
+void IoUringQuicAsyncUDPSocket::cancelRecv() {
+  if (!recvOp_->armed || recvOp_->cancelling) {
+    return;
+  }
+  recvOp_->cancelling = ring_->cancel(recvOp_.get());
+}
+
+void IoUringQuicAsyncUDPSocket::onRecvCompletion(int res, uint32_t flags) {
+  if (!(flags & IORING_CQE_F_MORE)) {
+    recvOp_->armed = false;
+    recvOp_->cancelling = false;
+  }
+  if (flags & IORING_CQE_F_BUFFER) {
+    auto bufferId = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+    if (res > 0 && fd_ != -1) {
+      pendingDatagrams_.push_back({bufferId, static_cast<uint32_t>(res)});
+    } else {
+      ring_->recycleBuffer(bufferId);
+    }
+  } else if (res == -ENOBUFS) {
+    ring_->addStarved(this);
+  } else if (res < 0 && res != -ECANCELED) {
+    recvError_ = -res;
+  }
+  scheduleDeliver();
+}
+
+void IoUringQuicAsyncUDPSocket::scheduleDeliver() {
+  if (!deliverCallback_.isLoopCallbackScheduled()) {
+    evb_->runInLoop(&deliverCallback_);
+  }
+}
+
+void IoUringQuicAsyncUDPSocket::DeliverCallback::runLoopCallback() noexcept {
+  sock_.deliver();
+}
+
+void IoUringQuicAsyncUDPSocket::deliver() {
+  std::weak_ptr<bool> alive = alive_;
+  // Like the other sockets, pending socket errors are reported instead of,
+  // not in addition to, the read notification.
+  if (recvError_ != 0 && handleSocketErrors() > 0) {
+    recvError_ = 0;
+  }
+  if (alive.expired()) {
+    return;
+  }
+  if (readCallback_ && (!pendingDatagrams_.empty() || recvError_ != 0)) {
+    deliverRead();
+    if (alive.expired()) {
+      return;
+    }
+  }
+  if (writeCallback_ && numInflightSends_ < maxInflightSends_) {
+    writeCallback_->onSocketWritable();
+    if (alive.expired()) {
+      return;
+    }
+  }
+  armRecv();
+}
+
+void IoUringQuicAsyncUDPSocket::deliverRead() {
+  std::weak_ptr<bool> alive = alive_;
+  if (readCallback_->shouldOnlyNotify()) {
+    readCallback_->onNotifyDataAvailable(*this);
+    if (alive.expired()) {
+      return;
+    }
+  } else {
+    // Bound the work to what was queued when we started.
+    auto budget = pendingDatagrams_.size();
+    while (readCallback_ && budget-- > 0 && !pendingDatagrams_.empty()) {
+      void* buf = nullptr;
+      size_t len = 0;
+      readCallback_->getReadBuffer(&buf, &len);
+      if (!buf || len == 0) {
+        MVLOG_WARNING << "No read buffer for received datagram";
+        break;
+      }
+      sockaddr_storage addrStorage{};
+      alignas(cmsghdr) std::array<uint8_t, kRecvControlLen> control{};
+      iovec iov{buf, len};
+      msghdr msg{};
+      msg.msg_name = &addrStorage;
+      msg.msg_namelen = sizeof(addrStorage);
+      msg.msg_iov = &iov;
+      msg.msg_iovlen = 1;
+      msg.msg_control = control.data();
+      msg.msg_controllen = control.size();
+      auto ret = recvmsg(&msg, MSG_TRUNC);
+      if (ret < 0) {
+        break;
+      }
+      quic::SocketAddress peer;
+      peer.setFromSockaddr(
+          reinterpret_cast<sockaddr*>(&addrStorage), msg.msg_namelen);
+      ReadCallback::OnDataAvailableParams params;
+      fromMsg(params, msg);
+      bool truncated = static_cast<size_t>(ret) > len;
+      readCallback_->onDataAvailable(
+          peer, std::min(static_cast<size_t>(ret), len), truncated, params);
+      if (alive.expired()) {
+        return;
+      }
+    }
+    if (readCallback_ && pendingDatagrams_.empty() && recvError_ != 0) {
+      folly::AsyncSocketException ex(
+          folly::AsyncSocketException::INTERNAL_ERROR,
+          "io_uring recvmsg failed",
+          std::exchange(recvError_, 0));
+      readCallback_->onReadError(ex);
+      if (alive.expired()) {
+        return;
+      }
+    }
+  }
+  // Datagrams the callback left behind are offered again next iteration, as
+  // a level triggered read event would.
+  if (readCallback_ && !pendingDatagrams_.empty()) {
+    scheduleDeliver();
+  }
+}
+
+size_t IoUringQuicAsyncUDPSocket::handleSocketErrors() {
+#ifdef MSG_ERRQUEUE
+  if (errMessageCallback_ == nullptr) {
+    return 0;
+  }
+  std::array<uint8_t, 1024> ctrl;
+  unsigned char data;
+  struct msghdr msg;
+  iovec entry;
+
+  entry.iov_base = &data;
+  entry.iov_len = sizeof(data);
+  msg.msg_iov = &entry;
+  msg.msg_iovlen = 1;
+  msg.msg_name = nullptr;
+  msg.msg_namelen = 0;
+  msg.msg_control = ctrl.data();
+  msg.msg_controllen = sizeof(ctrl);
+  msg.msg_flags = 0;
+
+  size_t num = 0;
+  while (fd_ != -1 && errMessageCallback_) {
+    ssize_t ret = ::recvmsg(fd_, &msg, MSG_ERRQUEUE);
+    if (ret < 0) {
+      if (errno != EAGAIN) {
+        auto errnoCopy = errno;
+        MVLOG_ERROR << "::recvmsg exited with code " << ret
+                    << ", errno: " << errnoCopy;
+        folly::AsyncSocketException ex(
+            folly::AsyncSocketException::INTERNAL_ERROR,
+            "MSG_ERRQUEUE recvmsg() failed",
+            errnoCopy);
+        // We can't receive errors so unset the callback.
+        ErrMessageCallback* callback = errMessageCallback_;
+        errMessageCallback_ = nullptr;
+        callback->errMessageError(ex);
+      }
+      return num;
+    }
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+         cmsg != nullptr && cmsg->cmsg_len != 0;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      ++num;
+      errMessageCallback_->errMessage(*cmsg);
+      if (fd_ == -1 || !errMessageCallback_) {
+        // once the socket is closed there is no use for more read errors.
+        return num;
+      }
+    }
+  }
+  return num;
+#else
+  return 0;
+#endif
+}
+
+void IoUringQuicAsyncUDPSocket::onFdChanged() {
+  gso_ = 0;
+  gsoProbed_ = false;
+  txTimeClockId_ = -1;
+#ifdef SO_TXTIME
+  // SO_TXTIME reads back the clock but not whether it is enabled. Sockets
+  // start out with CLOCK_REALTIME, so only another clock proves it was set.
+  sock_txtime txTime{};
+  socklen_t optlen = sizeof(txTime);
+  if (fd_ != -1 &&
+      ::getsockopt(fd_, SOL_SOCKET, SO_TXTIME, &txTime, &optlen) == 0 &&
+      optlen == sizeof(txTime) && txTime.clockid != CLOCK_REALTIME) {
+    txTimeClockId_ = txTime.clockid;
+  }
+#endif
+  // A receive armed on a previous fd terminates first, its completion rearms
+  // on the new one.
+  cancelRecv();
+  armRecv();
+}
+
+quic::Expected<int, QuicError> IoUringQuicAsyncUDPSocket::getGSO() {
+  if (gso_ == -1) {
+    return gso_;
+  }
+  if (!gsoProbed_) {
+    gsoProbed_ = true;
+    if (fd_ == -1) {
+      gso_ = -1;
+      return gso_;
+    }
+    int gso = -1;
+    socklen_t optlen = sizeof(gso);
+    if (::getsockopt(fd_, SOL_UDP, UDP_SEGMENT, &gso, &optlen) == 0) {
+      gso_ = gso;
+    } else {
+      gso_ = -1;
+    }
+  }
+  return gso_;
+}
+
+quic::Expected<int, QuicError> IoUringQuicAsyncUDPSocket::getGRO() {
+  if (fd_ == -1) {
+    return quic::make_unexpected(makeNotInitializedError(__func__));
+  }
+  int gro = -1;
+  socklen_t optlen = sizeof(gro);
+  if (::getsockopt(fd_, SOL_UDP, UDP_GRO, &gro, &optlen) != 0) {
+    return -1;
+  }
+  return gro;
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::setGRO(bool bVal) {
+  if (fd_ == -1) {
+    return quic::make_unexpected(makeNotInitializedError(__func__));
+  }
+  int gro = bVal ? 1 : 0;
+  if (::setsockopt(fd_, SOL_UDP, UDP_GRO, &gro, sizeof(gro)) != 0) {
+    return quic::make_unexpected(makeSocketError("failed to set UDP_GRO", errno));
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::setRecvTos(
+    bool recvTos) {
+  if (fd_ == -1) {
+    return quic::make_unexpected(makeNotInitializedError(__func__));
+  }
+  int value = recvTos ? 1 : 0;
+  int level = localAddress_.getFamily() == AF_INET6 ? IPPROTO_IPV6 : IPPROTO_IP;
+  int optname = level == IPPROTO_IPV6 ? IPV6_RECVTCLASS : IP_RECVTOS;
+  if (::setsockopt(fd_, level, optname, &value, sizeof(value)) != 0) {
+    return quic::make_unexpected(
+        makeSocketError("failed to set receive TOS", errno));
+  }
+  recvTos_ = recvTos;
+  return {};
+}
+
+quic::Expected<bool, QuicError> IoUringQuicAsyncUDPSocket::getRecvTos() {
+  return recvTos_;
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::setTosOrTrafficClass(
+    uint8_t tos) {
+  if (fd_ == -1) {
+    return quic::make_unexpected(makeNotInitializedError(__func__));
+  }
+  int value = tos;
+  int level = localAddress_.getFamily() == AF_INET6 ? IPPROTO_IPV6 : IPPROTO_IP;
+  int optname = level == IPPROTO_IPV6 ? IPV6_TCLASS : IP_TOS;
+  if (::setsockopt(fd_, level, optname, &value, sizeof(value)) != 0) {
+    return quic::make_unexpected(
+        makeSocketError("failed to set TOS or traffic class", errno));
+  }
+  return {};
+}
+
+quic::Expected<quic::SocketAddress, QuicError>
+IoUringQuicAsyncUDPSocket::address() const {
+  if (!bound_) {
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        "socket is not bound"));
+  }
+  return localAddress_;
+}
+
+const quic::SocketAddress& IoUringQuicAsyncUDPSocket::addressRef() const {
+  LOG_IF(FATAL, !bound_) << "socket is not bound";
+  return localAddress_;
+}
+
+quic::Expected<sa_family_t, QuicError>
+IoUringQuicAsyncUDPSocket::getLocalAddressFamily() const {
+  if (!bound_) {
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        "socket is not bound"));
+  }
+  return localAddress_.getFamily();
+}
+
+void IoUringQuicAsyncUDPSocket::attachEventBase(
+    std::shared_ptr<QuicEventBase> /* evb */) {
+  MVCHECK(false, __func__ << " is not implemented in IoUringQuicAsyncUDPSocket");
+}
+
+void IoUringQuicAsyncUDPSocket::detachEventBase() {
+  MVCHECK(false, __func__ << " is not implemented in IoUringQuicAsyncUDPSocket");
+}
+
+std::shared_ptr<QuicEventBase> IoUringQuicAsyncUDPSocket::getEventBase() const {
+  return evb_;
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::setCmsgs(
+    const folly::SocketCmsgMap& cmsgs) {
+  cmsgs_ = cmsgs;
+  return {};
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::appendCmsgs(
+    const folly::SocketCmsgMap& cmsgs) {
+  for (const auto& [key, value] : cmsgs) {
+    cmsgs_[key] = value;
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError>
+IoUringQuicAsyncUDPSocket::setAdditionalCmsgsFunc(
+    std::function<Optional<folly::SocketCmsgMap>()>&& additionalCmsgsFunc) {
+  additionalCmsgsFunc_ = std::move(additionalCmsgsFunc);
+  return {};
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::setReuseAddr(
+    bool reuseAddr) {
+  reuseAddr_ = reuseAddr;
+  if (fd_ != -1) {
+    int sockOptVal = reuseAddr ? 1 : 0;
+    if (::setsockopt(
+            fd_, SOL_SOCKET, SO_REUSEADDR, &sockOptVal, sizeof(sockOptVal)) !=
+        0) {
+      return quic::make_unexpected(
+          makeSocketError("failed to set SO_REUSEADDR", errno));
+    }
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::setReusePort(
+    bool reusePort) {
+  reusePort_ = reusePort;
+  if (fd_ != -1) {
+    int sockOptVal = reusePort ? 1 : 0;
+    if (::setsockopt(
+            fd_, SOL_SOCKET, SO_REUSEPORT, &sockOptVal, sizeof(sockOptVal)) !=
+        0) {
+      return quic::make_unexpected(
+          makeSocketError("failed to set SO_REUSEPORT", errno));
+    }
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::setRcvBuf(
+    int rcvBuf) {
+  rcvBuf_ = rcvBuf;
+  if (fd_ != -1 &&
+      ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvBuf_, sizeof(rcvBuf_)) !=
+          0) {
+    return quic::make_unexpected(
+        makeSocketError("failed to set SO_RCVBUF", errno));
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::setSndBuf(
+    int sndBuf) {
+  sndBuf_ = sndBuf;
+  if (fd_ != -1 &&
+      ::setsockopt(fd_, SOL_SOCKET, SO_SNDBUF, &sndBuf_, sizeof(sndBuf_)) !=
+          0) {
+    return quic::make_unexpected(
+        makeSocketError("failed to set SO_SNDBUF", errno));
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError>
+IoUringQuicAsyncUDPSocket::setDFAndTurnOffPMTU() {
+  if (fd_ == -1) {
+    return quic::make_unexpected(makeNotInitializedError(__func__));
+  }
+  auto familyResult = getLocalAddressFamily();
+  if (familyResult.hasError()) {
+    return quic::make_unexpected(familyResult.error());
+  }
+#if defined(IP_MTU_DISCOVER) && defined(IP_PMTUDISC_PROBE)
+  if (*familyResult == AF_INET) {
+    int optval = IP_PMTUDISC_PROBE;
+    if (::setsockopt(
+            fd_, IPPROTO_IP, IP_MTU_DISCOVER, &optval, sizeof(optval))) {
+      return quic::make_unexpected(makeSocketError(
+          "failed to turn off PMTU discovery (IPv4)", errno));
+    }
+  }
+#endif
+#if defined(IPV6_MTU_DISCOVER) && defined(IPV6_PMTUDISC_PROBE)
+  if (*familyResult == AF_INET6) {
+    int optval = IPV6_PMTUDISC_PROBE;
+    if (::setsockopt(
+            fd_, IPPROTO_IPV6, IPV6_MTU_DISCOVER, &optval, sizeof(optval))) {
+      return quic::make_unexpected(makeSocketError(
+          "failed to turn off PMTU discovery (IPv6)", errno));
+    }
+  }
+#endif
+  return {};
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::setErrMessageCallback(
+    ErrMessageCallback* errMessageCallback) {
+  if (fd_ == -1) {
+    return quic::make_unexpected(makeNotInitializedError(__func__));
+  }
+  auto familyResult = getLocalAddressFamily();
+  if (familyResult.hasError()) {
+    return quic::make_unexpected(familyResult.error());
+  }
+  errMessageCallback_ = errMessageCallback;
+  int err = (errMessageCallback_ != nullptr);
+#if defined(IP_RECVERR)
+  if (*familyResult == AF_INET &&
+      ::setsockopt(fd_, IPPROTO_IP, IP_RECVERR, &err, sizeof(err))) {
+    return quic::make_unexpected(
+        makeSocketError("Failed to set IP_RECVERR", errno));
+  }
+#endif
+#if defined(IPV6_RECVERR)
+  if (*familyResult == AF_INET6 &&
+      ::setsockopt(fd_, IPPROTO_IPV6, IPV6_RECVERR, &err, sizeof(err))) {
+    return quic::make_unexpected(
+        makeSocketError("Failed to set IPV6_RECVERR", errno));
+  }
+#endif
+  return {};
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::applyOptions(
+    const folly::SocketOptionMap& options,
+    folly::SocketOptionKey::ApplyPos pos) {
+  if (fd_ == -1) {
+    return quic::make_unexpected(makeNotInitializedError(__func__));
+  }
+  for (const auto& opt : options) {
+    if (opt.first.applyPos_ == pos &&
+        ::setsockopt(
+            fd_,
+            opt.first.level,
+            opt.first.optname,
+            &opt.second,
+            sizeof(opt.second)) != 0) {
+      return quic::make_unexpected(
+          makeSocketError("failed to apply socket options", errno));
+    }
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError> IoUringQuicAsyncUDPSocket::setFD(
+    int fd,
+    FDOwnership ownership) {
+  if (fd_ != -1 && ownership_ == FDOwnership::OWNS) {
+    MVLOG_WARNING << "Closing existing owned FD in setFD";
+    auto closeRes = close();
+    if (closeRes.hasError()) {
+      MVLOG_ERROR << "Failed to close existing FD in setFD: "
+                  << closeRes.error().message;
+    }
+  }
+
+  fd_ = fd;
+  ownership_ = ownership;
+  connected_ = false;
+  bound_ = false;
+
+  // The fd usually comes already bound, e.g. from a server listener.
+  sockaddr_storage addrStorage{};
+  socklen_t len = sizeof(addrStorage);
+  if (::getsockname(fd_, reinterpret_cast<sockaddr*>(&addrStorage), &len) ==
+          0 &&
+      addrStorage.ss_family != AF_UNSPEC) {
+    localAddress_.setFromSockaddr(
+        reinterpret_cast<sockaddr*>(&addrStorage), len);
+    bound_ = localAddress_.getPort() != 0;
+  }
+  onFdChanged();
+  return {};
+}
+
+int IoUringQuicAsyncUDPSocket::getFD() {
+  return fd_;
+}
+
+#endif // FOLLY_HAS_LIBURING
+
+bool ioUringQuicAsyncUDPSocketSupported() {
+#if FOLLY_HAS_LIBURING
+  static const bool supported = [] {
+    // Multishot recvmsg implies provided buffer ring support.
+    if (!folly::IoUringBackend::kernelSupportsRecvmsgMultishot()) {
+      return false;
+    }
+    io_uring ring;
+    if (io_uring_queue_init(8, &ring, 0) != 0) {
+      return false;
+    }
+    int ret = 0;
+    auto* bufRing = io_uring_setup_buf_ring(&ring, 1, kRecvBufferGroup, 0, &ret);
+    if (bufRing) {
+      io_uring_free_buf_ring(&ring, bufRing, 1, kRecvBufferGroup);
+    }
+    io_uring_queue_exit(&ring);
+    return bufRing != nullptr;
+  }();
+  return supported;
+#else
+  return false;
+#endif
+}
+
+std::unique_ptr<QuicAsyncUDPSocket> makeIoUringQuicAsyncUDPSocket(
+    std::shared_ptr<FollyQuicEventBase> evb,
+    const IoUringQuicSocketOptions& options) {
+#if FOLLY_HAS_LIBURING
+  if (ioUringQuicAsyncUDPSocketSupported()) {
+    return std::make_unique<IoUringQuicAsyncUDPSocket>(
+        std::move(evb), options);
+  }
+#else
+  (void)evb;
+  (void)options;
+#endif
+  return nullptr;
+}
+
+} // namespace quic
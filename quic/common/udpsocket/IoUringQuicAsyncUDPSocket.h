@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/io/async/Liburing.h>
+#include <quic/QuicConstants.h>
+#include <quic/common/events/FollyQuicEventBase.h>
+#include <quic/common/udpsocket/QuicAsyncUDPSocketImpl.h>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+
+namespace quic {
+
+/**
+ * Configuration of the io_uring instance backing IoUringQuicAsyncUDPSockets.
+ * All sockets of an EventBase share one ring, which is created with the
+ * options of the first socket made on that EventBase.
+ */
+struct IoUringQuicSocketOptions {
+  // Submission queue size. Operations prepared in one loop iteration beyond
+  // this cause an early submit.
+  uint32_t ringEntries{1024};
+  // Number of provided receive buffers. Rounded up to a power of two.
+  uint32_t numRecvBuffers{1024};
+  // Largest datagram payload a provided receive buffer holds. Sockets using
+  // GRO need this to cover a whole GRO batch, longer datagrams are truncated.
+  uint32_t maxRecvPayloadSize{kDefaultUDPReadBufferSize};
+  // Sends a socket may have in flight before writes fail with EAGAIN.
+  uint32_t maxInflightSendsPerSocket{4096};
+};
+
+/**
+ * Whether IoUringQuicAsyncUDPSocket can be used: mvfst was built with
+ * liburing and the kernel supports provided buffer rings and multishot
+ * recvmsg.
+ */
+bool ioUringQuicAsyncUDPSocketSupported();
+
+/**
+ * Returns an IoUringQuicAsyncUDPSocket, or nullptr when they are not
+ * supported on this host.
+ */
+std::unique_ptr<QuicAsyncUDPSocket> makeIoUringQuicAsyncUDPSocket(
+    std::shared_ptr<FollyQuicEventBase> evb,
+    const IoUringQuicSocketOptions& options = IoUringQuicSocketOptions());
+
+#if FOLLY_HAS_LIBURING
+
+class IoUringQuicSocketRing;
+
+/**
+ * QuicAsyncUDPSocket doing its I/O through io_uring instead of readiness
+ * notifications and sendmsg/recvmsg syscalls.
+ *
+ * Sends are copied into ring-owned buffers and queued as sendmsg operations.
+ * Receives use a multishot recvmsg selecting from a provided buffer ring, so
+ * the kernel keeps filling buffers without being asked again. All sockets on
+ * an EventBase share one ring, and the operations queued by all of them in a
+ * loop iteration are submitted with a single io_uring_enter at the end of it.
+ *
+ * Writes complete asynchronously: they return the number of bytes queued and
+ * a send that later fails is dropped, which QUIC treats as loss. Received
+ * datagrams are queued on the socket and handed to the read callback either
+ * through recvmsg/recvmmsg (shouldOnlyNotify) or getReadBuffer and
+ * onDataAvailable.
+ *
+ * The socket is bound to its EventBase for its whole lifetime.
+ */
+class IoUringQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
+ public:
+  explicit IoUringQuicAsyncUDPSocket(
+      std::shared_ptr<FollyQuicEventBase> evb,
+      const IoUringQuicSocketOptions& options = IoUringQuicSocketOptions());
+
+  ~IoUringQuicAsyncUDPSocket() override;
+
+  IoUringQuicAsyncUDPSocket(const IoUringQuicAsyncUDPSocket&) = delete;
+  IoUringQuicAsyncUDPSocket& operator=(const IoUringQuicAsyncUDPSocket&) =
+      delete;
+
+  [[nodiscard]] quic::Expected<void, QuicError> init(
+      sa_family_t family) override;
+
+  [[nodiscard]] quic::Expected<void, QuicError> bind(
+      const quic::SocketAddress& address) override;
+
+  [[nodiscard]] bool isBound() const override;
+
+  quic::Expected<void, QuicError> connect(
+      const quic::SocketAddress& address) override;
+
+  quic::Expected<void, QuicError> close() override;
+
+  void resumeRead(ReadCallback* callback) override;
+
+  void pauseRead() override;
+
+  [[nodiscard]] bool isReadPaused() const override;
+
+  quic::Expected<void, QuicError> resumeWrite(WriteCallback* cob) override;
+
+  void pauseWrite() override;
+
+  [[nodiscard]] bool isWritableCallbackSet() const override;
+
+  ssize_t write(
+      const quic::SocketAddress& address,
+      const struct iovec* vec,
+      size_t iovec_len) override;
+
+  int writem(
+      AddressRange addrs,
+      iovec* iov,
+      size_t* numIovecsInBuffer,
+      size_t count) override;
+
+  ssize_t writeGSO(
+      const quic::SocketAddress& address,
+      const struct iovec* vec,
+      size_t iovec_len,
+      WriteOptions options) override;
+
+  int writemGSO(
+      AddressRange addrs,
+      const BufPtr* bufs,
+      size_t count,
+      const WriteOptions* options) override;
+
+  int writemGSO(
+      AddressRange addrs,
+      iovec* iov,
+      size_t* numIovecsInBuffer,
+      size_t count,
+      const WriteOptions* options) override;
+
+  /**
+   * Pops the oldest received datagram. Fails with EAGAIN when none is queued.
+   */
+  ssize_t recvmsg(struct msghdr* msg, int flags) override;
+
+  int recvmmsg(
+      struct mmsghdr* msgvec,
+      unsigned int vlen,
+      unsigned int flags,
+      struct timespec* timeout) override;
+
+  quic::Expected<int, QuicError> getGSO() override;
+
+  quic::Expected<int, QuicError> getGRO() override;
+  quic::Expected<void, QuicError> setGRO(bool bVal) override;
+
+  quic::Expected<void, QuicError> setRecvTos(bool recvTos) override;
+  quic::Expected<bool, QuicError> getRecvTos() override;
+
+  quic::Expected<void, QuicError> setTosOrTrafficClass(uint8_t tos) override;
+
+  [[nodiscard]] quic::Expected<quic::SocketAddress, QuicError> address()
+      const override;
+
+  [[nodiscard]] const quic::SocketAddress& addressRef() const override;
+
+  [[nodiscard]] quic::Expected<sa_family_t, QuicError> getLocalAddressFamily()
+      const override;
+
+  void attachEventBase(std::shared_ptr<QuicEventBase> evb) override;
+  void detachEventBase() override;
+  [[nodiscard]] std::shared_ptr<QuicEventBase> getEventBase() const override;
+
+  quic::Expected<void, QuicError> setCmsgs(
+      const folly::SocketCmsgMap& cmsgs) override;
+  quic::Expected<void, QuicError> appendCmsgs(
+      const folly::SocketCmsgMap& cmsgs) override;
+  quic::Expected<void, QuicError> setAdditionalCmsgsFunc(
+      std::function<Optional<folly::SocketCmsgMap>()>&& additionalCmsgsFunc)
+      override;
+
+  /*
+   * Packet timestamping is currently not supported.
+   */
+  quic::Expected<int, QuicError> getTimestamping() override {
+    return -1;
+  }
+
+  quic::Expected<void, QuicError> setReuseAddr(bool reuseAddr) override;
+
+  quic::Expected<void, QuicError> setReusePort(bool reusePort) override;
+
+  quic::Expected<void, QuicError> setRcvBuf(int rcvBuf) override;
+
+  quic::Expected<void, QuicError> setSndBuf(int sndBuf) override;
+
+  quic::Expected<void, QuicError> setDFAndTurnOffPMTU() override;
+
+  quic::Expected<void, QuicError> setErrMessageCallback(
+      ErrMessageCallback* errMessageCallback) override;
+
+  quic::Expected<void, QuicError> applyOptions(
+      const folly::SocketOptionMap& options,
+      folly::SocketOptionKey::ApplyPos pos) override;
+
+  /**
+   * Use an already bound file descriptor, e.g. the listening socket of a
+   * server worker. The local address is read back from the fd.
+   */
+  quic::Expected<void, QuicError> setFD(int fd, FDOwnership ownership) override;
+
+  int getFD() override;
+
+  // Number of sends handed to the kernel that have not completed yet.
+  [[nodiscard]] size_t numInflightSends() const noexcept {
+    return numInflightSends_;
+  }
+
+  // Number of received datagrams waiting to be read.
+  [[nodiscard]] size_t numPendingDatagrams() const noexcept {
+    return pendingDatagrams_.size();
+  }
+
+ private:
+  friend class IoUringQuicSocketRing;
+  struct SendOp;
+  struct RecvOp;
+
+  // A datagram sitting in a provided receive buffer.
+  struct PendingDatagram {
+    uint16_t bufferId;
+    uint32_t length;
+  };
+
+  // Hands completions to the callbacks at the end of the loop iteration in
+  // which the ring reaped them.
+  class DeliverCallback : public QuicEventBaseLoopCallback {
+   public:
+    explicit DeliverCallback(IoUringQuicAsyncUDPSocket& sock) : sock_(sock) {}
+
+    void runLoopCallback() noexcept override;
+
+   private:
+    IoUringQuicAsyncUDPSocket& sock_;
+  };
+
+  // Reserves a send of len bytes to address. Returns nullptr with errno set
+  // if it cannot be queued.
+  SendOp* prepareSend(
+      const quic::SocketAddress& address,
+      size_t len,
+      const WriteOptions& options);
+  // Copies vec into a SendOp, queues it and returns its length.
+  ssize_t queueSend(
+      const quic::SocketAddress& address,
+      const struct iovec* vec,
+      size_t iovecLen,
+      const WriteOptions& options);
+  // Queues op, or releases it and fails with EAGAIN.
+  bool submitSend(SendOp* op);
+
+  void armRecv();
+  void cancelRecv();
+
+  // Called by the ring while it reaps completions.
+  void onRecvCompletion(int res, uint32_t flags);
+  void onSendCompletion(SendOp* op, int res);
+  void scheduleDeliver();
+  void deliver();
+  void deliverRead();
+
+  size_t handleSocketErrors();
+  void onFdChanged();
+
+  std::shared_ptr<FollyQuicEventBase> evb_;
+  std::shared_ptr<IoUringQuicSocketRing> ring_;
+  uint32_t maxInflightSends_;
+
+  int fd_{-1};
+  FDOwnership ownership_{FDOwnership::OWNS};
+  quic::SocketAddress localAddress_;
+  quic::SocketAddress connectedAddress_;
+  bool bound_{false};
+  bool connected_{false};
+  bool reuseAddr_{false};
+  bool reusePort_{false};
+  int rcvBuf_{0};
+  int sndBuf_{0};
+  int gso_{0};
+  bool gsoProbed_{false};
+  bool recvTos_{false};
+  // Clock the fd's SO_TXTIME uses, or -1 when it is not enabled.
+  int txTimeClockId_{-1};
+
+  folly::SocketCmsgMap cmsgs_;
+  std::function<Optional<folly::SocketCmsgMap>()> additionalCmsgsFunc_;
+
+  ReadCallback* readCallback_{nullptr};
+  WriteCallback* writeCallback_{nullptr};
+  ErrMessageCallback* errMessageCallback_{nullptr};
+
+  std::unique_ptr<RecvOp> recvOp_;
+  std::deque<PendingDatagram> pendingDatagrams_;
+  // Error the multishot recvmsg ended with, reported by the next read once
+  // the queued datagrams are consumed.
+  int recvError_{0};
+  size_t numInflightSends_{0};
+  DeliverCallback deliverCallback_{*this};
+  // Expires when the socket is destroyed, so deliver() can tell whether a
+  // callback destroyed it.
+  std::shared_ptr<bool> alive_{std::make_shared<bool>(true)};
+};
+
+#endif // FOLLY_HAS_LIBURING
+
+} // namespace quic
@@ -22,7 +22,20 @@
 #ifndef UDP_SEGMENT
 #define UDP_SEGMENT 103
 #endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
 #endif
+#endif
+
+namespace {
+
+quic::QuicError makeSocketError(const char* what, int errnoCopy) {
+  return quic::QuicError(
+      quic::QuicErrorCode(quic::TransportErrorCode::INTERNAL_ERROR),
+      std::string(what) + ": " + quic::errnoStr(errnoCopy));
+}
+
+} // namespace
 
 namespace quic {
 
@@ -190,7 +203,7 @@ ssize_t LibevQuicAsyncUDPSocket::writeGSO(
   msg.msg_iov = const_cast<struct iovec*>(vec);
   msg.msg_iovlen = iovec_len;
 
-  char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint16_t))] = {};
   if (options.gso > 0) {
     msg.msg_control = control;
     msg.msg_controllen = sizeof(control);
@@ -274,11 +287,126 @@ ssize_t LibevQuicAsyncUDPSocket::writeGSO(
 }
 
 int LibevQuicAsyncUDPSocket::writem(
-    AddressRange /*addrs*/,
-    iovec* /*iov*/,
-    size_t* /*numIovecsInBuffer*/,
-    size_t /*count*/) {
-  MVCHECK(false, __func__ << "is not implemented in LibevQuicAsyncUDPSocket");
+    AddressRange addrs,
+    iovec* iov,
+    size_t* numIovecsInBuffer,
+    size_t count) {
+  return writemGSO(addrs, iov, numIovecsInBuffer, count, nullptr);
+}
+
+int LibevQuicAsyncUDPSocket::writemGSO(
+    AddressRange addrs,
+    const BufPtr* bufs,
+    size_t count,
+    const WriteOptions* options) {
+  size_t totalIovecs = 0;
+  for (size_t i = 0; i < count; i++) {
+    totalIovecs += bufs[i]->countChainElements();
+  }
+  sendIovecs_.resize(totalIovecs);
+  sendIovecCounts_.resize(count);
+  size_t iovOffset = 0;
+  for (size_t i = 0; i < count; i++) {
+    auto fillResult = bufs[i]->fillIov(
+        sendIovecs_.data() + iovOffset, totalIovecs - iovOffset);
+    sendIovecCounts_[i] = fillResult.numIovecs;
+    iovOffset += fillResult.numIovecs;
+  }
+  return writemGSO(
+      addrs, sendIovecs_.data(), sendIovecCounts_.data(), count, options);
+}
+
+int LibevQuicAsyncUDPSocket::writemGSO(
+    AddressRange addrs,
+    iovec* iov,
+    size_t* numIovecsInBuffer,
+    size_t count,
+    const WriteOptions* options) {
+  if (fd_ == -1) {
+    errno = EBADF;
+    MVLOG_ERROR
+        << "LibevQuicAsyncUDPSocket::writemGSO failed: socket not initialized";
+    return -1;
+  }
+  if (count == 0) {
+    return 0;
+  }
+#if defined(UDP_SEGMENT)
+  sendMsgs_.resize(count);
+  sendAddrs_.resize(connected_ ? 0 : addrs.size());
+  sendControl_.resize(options ? count : 0);
+  if (connected_) {
+    for (const auto& addr : addrs) {
+      if (connectedAddress_ != addr) {
+        errno = EINVAL;
+        MVLOG_ERROR
+            << "LibevQuicAsyncUDPSocket::writemGSO failed: wrong destination for connected socket";
+        return -1;
+      }
+    }
+  } else {
+    for (size_t i = 0; i < addrs.size(); i++) {
+      addrs[i].getAddress(&sendAddrs_[i]);
+    }
+  }
+
+  size_t iovOffset = 0;
+  for (size_t i = 0; i < count; i++) {
+    struct msghdr& msg = sendMsgs_[i].msg_hdr;
+    msg = {};
+    sendMsgs_[i].msg_len = 0;
+    if (!connected_) {
+      size_t addrIndex = addrs.size() == 1 ? 0 : i;
+      msg.msg_name = reinterpret_cast<void*>(&sendAddrs_[addrIndex]);
+      msg.msg_namelen = addrs[addrIndex].getActualSize();
+    }
+    msg.msg_iov = iov + iovOffset;
+    msg.msg_iovlen = numIovecsInBuffer[i];
+    iovOffset += numIovecsInBuffer[i];
+
+    if (options && options[i].gso > 0) {
+      auto& control = sendControl_[i].buf;
+      control.fill(0);
+      msg.msg_control = control.data();
+      msg.msg_controllen = control.size();
+      struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+      cm->cmsg_level = SOL_UDP;
+      cm->cmsg_type = UDP_SEGMENT;
+      cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      auto gsoLen = static_cast<uint16_t>(options[i].gso);
+      memcpy(CMSG_DATA(cm), &gsoLen, sizeof(gsoLen));
+    }
+  }
+
+  int ret = ::sendmmsg(fd_, sendMsgs_.data(), static_cast<unsigned>(count), 0);
+  if (ret < 0 && options && options[0].gso > 0) {
+    int errnoCopy = errno;
+    // sendmmsg() only fails when nothing was sent. If it is GSO the kernel
+    // rejected, writeGSO() sends the first message segment by segment and
+    // marks GSO unsupported, the caller retries the rest as a partial write.
+    if (errnoCopy == EIO || errnoCopy == EINVAL || errnoCopy == EMSGSIZE) {
+      if (writeGSO(addrs[0], iov, numIovecsInBuffer[0], options[0]) < 0) {
+        return -1;
+      }
+      return 1;
+    }
+    errno = errnoCopy;
+  }
+  return ret;
+#else
+  size_t iovOffset = 0;
+  for (size_t i = 0; i < count; i++) {
+    const auto& addr = addrs.size() == 1 ? addrs[0] : addrs[i];
+    ssize_t ret = options
+        ? writeGSO(addr, iov + iovOffset, numIovecsInBuffer[i], options[i])
+        : write(addr, iov + iovOffset, numIovecsInBuffer[i]);
+    if (ret < 0) {
+      return i > 0 ? static_cast<int>(i) : -1;
+    }
+    iovOffset += numIovecsInBuffer[i];
+  }
+  return static_cast<int>(count);
+#endif
 }
 
 quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setAdditionalCmsgsFunc(
@@ -473,6 +601,7 @@ quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::init(
   fd_ = fd;
   ownership_ = FDOwnership::OWNS;
   fdGuard.dismiss(); // Don't close the fd now that we've stored it
+  resetProbedOptions();
 
   // Update the watchers
   removeEvent(EV_READ | EV_WRITE);
@@ -670,7 +799,125 @@ quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setErrMessageCallback(
 }
 
 quic::Expected<int, QuicError> LibevQuicAsyncUDPSocket::getGRO() {
+#if defined(UDP_GRO)
+  if (!groProbed_ && fd_ != -1) {
+    groProbed_ = true;
+    int gro = -1;
+    socklen_t optlen = sizeof(gro);
+    if (::getsockopt(fd_, SOL_UDP, UDP_GRO, &gro, &optlen) == 0) {
+      gro_ = gro;
+    } else {
+      gro_ = -1;
+    }
+  }
+  return gro_;
+#else
   return -1;
+#endif
+}
+
+quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setGRO(bool bVal) {
+#if defined(UDP_GRO)
+  if (fd_ == -1) {
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        "socket not initialized for setGRO"));
+  }
+  int val = bVal ? 1 : 0;
+  if (::setsockopt(fd_, SOL_UDP, UDP_GRO, &val, sizeof(val)) != 0) {
+    return quic::make_unexpected(makeSocketError("setGRO failed", errno));
+  }
+  gro_ = val;
+  groProbed_ = true;
+  return {};
+#else
+  (void)bVal;
+  return quic::make_unexpected(QuicError(
+      QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+      "setGRO not supported"));
+#endif
+}
+
+quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setRecvTos(
+    bool recvTos) {
+  if (fd_ == -1) {
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        "socket not initialized for setRecvTos"));
+  }
+  int val = recvTos ? 1 : 0;
+  int level = getSocketFamily() == AF_INET6 ? IPPROTO_IPV6 : IPPROTO_IP;
+  int optname = level == IPPROTO_IPV6 ? IPV6_RECVTCLASS : IP_RECVTOS;
+  if (::setsockopt(fd_, level, optname, &val, sizeof(val)) != 0) {
+    return quic::make_unexpected(makeSocketError("setRecvTos failed", errno));
+  }
+  recvTos_ = recvTos;
+  return {};
+}
+
+quic::Expected<bool, QuicError> LibevQuicAsyncUDPSocket::getRecvTos() {
+  return recvTos_;
+}
+
+quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setTosOrTrafficClass(
+    uint8_t tos) {
+  if (fd_ == -1) {
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        "socket not initialized for setTosOrTrafficClass"));
+  }
+  int val = tos;
+  int ret = getSocketFamily() == AF_INET6
+      ? ::setsockopt(fd_, IPPROTO_IPV6, IPV6_TCLASS, &val, sizeof(val))
+      : ::setsockopt(fd_, IPPROTO_IP, IP_TOS, &val, sizeof(val));
+  if (ret != 0) {
+    return quic::make_unexpected(
+        makeSocketError("setTosOrTrafficClass failed", errno));
+  }
+  return {};
+}
+
+quic::Expected<int, QuicError> LibevQuicAsyncUDPSocket::getTimestamping() {
+#if defined(SO_TIMESTAMPING)
+  if (!timestampingProbed_ && fd_ != -1) {
+    timestampingProbed_ = true;
+    int flags = 0;
+    socklen_t optlen = sizeof(flags);
+    if (::getsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPING, &flags, &optlen) == 0 &&
+        flags > 0) {
+      timestamping_ = flags;
+    } else {
+      timestamping_ = -1;
+    }
+  }
+  return timestamping_;
+#else
+  return -1;
+#endif
+}
+
+sa_family_t LibevQuicAsyncUDPSocket::getSocketFamily() const {
+  if (bound_) {
+    return localAddress_.getFamily();
+  }
+  // An unbound socket still reports its family.
+  sockaddr_storage addrStorage = {};
+  socklen_t addrLen = sizeof(addrStorage);
+  if (::getsockname(
+          fd_, reinterpret_cast<sockaddr*>(&addrStorage), &addrLen) != 0) {
+    return AF_UNSPEC;
+  }
+  return addrStorage.ss_family;
+}
+
+void LibevQuicAsyncUDPSocket::resetProbedOptions() {
+  gso_ = 0;
+  gsoProbed_ = false;
+  gro_ = -1;
+  groProbed_ = false;
+  timestamping_ = -1;
+  timestampingProbed_ = false;
+  recvTos_ = false;
 }
 
 ssize_t LibevQuicAsyncUDPSocket::recvmsg(struct msghdr* msg, int flags) {
@@ -707,14 +954,6 @@ int LibevQuicAsyncUDPSocket::recvmmsg(
   return static_cast<int>(vlen);
 }
 
-quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setGRO(
-    bool /* bVal */) {
-  // Not supported, return error
-  return quic::make_unexpected(QuicError(
-      QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
-      "setGRO not supported"));
-}
-
 quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::applyOptions(
     const folly::SocketOptionMap& options,
     folly::SocketOptionKey::ApplyPos pos) {
@@ -738,6 +977,13 @@ quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::applyOptions(
             QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
             std::move(errorMsg)));
       }
+#if defined(SO_TIMESTAMPING)
+      if (opt.first.level == SOL_SOCKET &&
+          opt.first.optname == SO_TIMESTAMPING) {
+        timestamping_ = opt.second > 0 ? opt.second : -1;
+        timestampingProbed_ = true;
+      }
+#endif
     }
   }
   return {};
@@ -762,6 +1008,7 @@ quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setFD(
   ownership_ = ownership;
   bound_ = false; // Assume not bound until checked/bind called
   connected_ = false; // Assume not connected
+  resetProbedOptions();
 
   // Update the watchers
   removeEvent(EV_READ | EV_WRITE);
@@ -816,7 +1063,7 @@ size_t LibevQuicAsyncUDPSocket::handleSocketErrors() {
   if (errMessageCallback_ == nullptr) {
     return 0;
   }
-  std::array<uint8_t, 1024> ctrl;
+  alignas(cmsghdr) std::array<uint8_t, 1024> ctrl;
   unsigned char data;
   struct msghdr msg;
   iovec entry;
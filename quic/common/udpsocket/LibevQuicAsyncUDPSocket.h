@@ -15,6 +15,9 @@
 #include <quic/common/events/LibevQuicEventBase.h>
 #include <quic/common/udpsocket/QuicAsyncUDPSocketImpl.h>
 
+#include <array>
+#include <vector>
+
 namespace quic {
 
 class LibevQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
@@ -61,21 +64,19 @@ class LibevQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
       WriteOptions options) override;
 
   int writemGSO(
-      AddressRange /*addrs*/,
-      const BufPtr* /*bufs*/,
-      size_t /*count*/,
-      const WriteOptions* /*options*/) override {
-    MVCHECK(false, __func__ << " not supported in LibevQuicAsyncUDPSocket");
-  }
+      AddressRange addrs,
+      const BufPtr* bufs,
+      size_t count,
+      const WriteOptions* options) override;
 
+  // Sends all messages with one sendmmsg() on Linux, each with its own
+  // UDP_SEGMENT size when options are given.
   int writemGSO(
-      AddressRange /* addrs */,
-      iovec* /* iov */,
-      size_t* /* numIovecsInBuffer */,
-      size_t /* count */,
-      const WriteOptions* /* options */) override {
-    MVCHECK(false, __func__ << " not supported in LibevQuicAsyncUDPSocket");
-  }
+      AddressRange addrs,
+      iovec* iov,
+      size_t* numIovecsInBuffer,
+      size_t count,
+      const WriteOptions* options) override;
 
   ssize_t recvmsg(struct msghdr* msg, int flags) override;
 
@@ -97,20 +98,11 @@ class LibevQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
   // receive tos cmsgs
   // if true, the IPv6 Traffic Class/IPv4 Type of Service field should be
   // populated in OnDataAvailableParams.
-  quic::Expected<void, QuicError> setRecvTos(bool /*recvTos*/) override {
-    MVLOG_WARNING << __func__ << " not implemented in LibevQuicAsyncUDPSocket";
-    return {}; // Or return error if strictness needed
-  }
+  quic::Expected<void, QuicError> setRecvTos(bool recvTos) override;
 
-  quic::Expected<bool, QuicError> getRecvTos() override {
-    return false; // Not implemented, return default/false
-  }
+  quic::Expected<bool, QuicError> getRecvTos() override;
 
-  quic::Expected<void, QuicError> setTosOrTrafficClass(
-      uint8_t /*tos*/) override {
-    MVLOG_WARNING << __func__ << " not implemented in LibevQuicAsyncUDPSocket";
-    return {}; // Or return error if strictness needed
-  }
+  quic::Expected<void, QuicError> setTosOrTrafficClass(uint8_t tos) override;
 
   /**
    * Returns the socket address this socket is bound to and error otherwise.
@@ -145,11 +137,10 @@ class LibevQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
       override;
 
   /*
-   * Packet timestamping is currently not supported.
+   * Returns the SO_TIMESTAMPING flags of the socket, enabled through
+   * applyOptions(), or -1 when it has none.
    */
-  quic::Expected<int, QuicError> getTimestamping() override {
-    return -1; // Keep returning -1 for not supported
-  }
+  quic::Expected<int, QuicError> getTimestamping() override;
 
   /**
    * Set SO_REUSEADDR flag on the socket. Default is OFF.
@@ -234,6 +225,12 @@ class LibevQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
   void evHandleSocketWritable();
   size_t handleSocketErrors();
 
+  // Family of the socket, bound or not.
+  sa_family_t getSocketFamily() const;
+
+  // Forgets what was probed about a previous fd.
+  void resetProbedOptions();
+
   int fd_{-1};
   quic::SocketAddress localAddress_;
   quic::SocketAddress connectedAddress_;
@@ -248,6 +245,13 @@ class LibevQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
   bool connected_{false};
   int gso_{0};
   bool gsoProbed_{false};
+  // GRO and timestamping are checked on every read, so they are only asked
+  // from the kernel once per fd and tracked through the setters after that.
+  int gro_{-1};
+  bool groProbed_{false};
+  int timestamping_{-1};
+  bool timestampingProbed_{false};
+  bool recvTos_{false};
   bool reuseAddr_{false};
   bool reusePort_{false};
   int rcvBuf_{0};
@@ -256,5 +260,18 @@ class LibevQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
   ReadCallback* readCallback_{nullptr};
   WriteCallback* writeCallback_{nullptr};
   ErrMessageCallback* errMessageCallback_{nullptr};
+
+  // Scratch space of writemGSO(), kept across calls.
+  static constexpr size_t kGsoCmsgSpace = CMSG_SPACE(sizeof(uint16_t));
+  // CMSG_FIRSTHDR() hands the buffer out as a cmsghdr, so it must be aligned
+  // like one.
+  struct alignas(cmsghdr) GsoControl {
+    std::array<uint8_t, kGsoCmsgSpace> buf;
+  };
+  std::vector<struct mmsghdr> sendMsgs_;
+  std::vector<sockaddr_storage> sendAddrs_;
+  std::vector<GsoControl> sendControl_;
+  std::vector<iovec> sendIovecs_;
+  std::vector<size_t> sendIovecCounts_;
 };
 } // namespace quic
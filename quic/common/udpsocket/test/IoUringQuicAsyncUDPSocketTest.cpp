@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/io/async/EventBase.h>
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+#include <quic/common/udpsocket/IoUringQuicAsyncUDPSocket.h>
+#include <quic/common/udpsocket/test/QuicAsyncUDPSocketMock.h>
+
+using namespace ::testing;
+
+namespace quic::test {
+
+class IoUringQuicAsyncUDPSocketTest : public Test {
+ public:
+  void SetUp() override {
+    if (!ioUringQuicAsyncUDPSocketSupported()) {
+      GTEST_SKIP() << "io_uring is not supported";
+    }
+    qEvb_ = std::make_shared<FollyQuicEventBase>(&evb_);
+    sender_ = makeIoUringQuicAsyncUDPSocket(qEvb_);
+    receiver_ = makeIoUringQuicAsyncUDPSocket(qEvb_);
+    ASSERT_TRUE(sender_ && receiver_);
+    ASSERT_FALSE(sender_->bind(quic::SocketAddress("127.0.0.1", 0)).hasError());
+    ASSERT_FALSE(
+        receiver_->bind(quic::SocketAddress("127.0.0.1", 0)).hasError());
+  }
+
+  void TearDown() override {
+    sender_.reset();
+    receiver_.reset();
+  }
+
+  void send(const std::string& data) {
+    iovec vec{const_cast<char*>(data.data()), data.size()};
+    EXPECT_EQ(
+        sender_->write(receiver_->addressRef(), &vec, 1),
+        static_cast<ssize_t>(data.size()));
+  }
+
+  // Runs the loop until done is set or a second has passed.
+  void loopUntil(const bool& done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!done && std::chrono::steady_clock::now() < deadline) {
+      evb_.loopOnce(EVLOOP_NONBLOCK);
+    }
+  }
+
+  std::string readOne(QuicAsyncUDPSocket& sock, quic::SocketAddress* peer) {
+    std::array<char, 2048> buf{};
+    sockaddr_storage addr{};
+    iovec vec{buf.data(), buf.size()};
+    msghdr msg{};
+    msg.msg_name = &addr;
+    msg.msg_namelen = sizeof(addr);
+    msg.msg_iov = &vec;
+    msg.msg_iovlen = 1;
+    auto ret = sock.recvmsg(&msg, 0);
+    if (ret < 0) {
+      return "";
+    }
+    if (peer) {
+      peer->setFromSockaddr(
+          reinterpret_cast<sockaddr*>(&addr), msg.msg_namelen);
+    }
+    return std::string(buf.data(), ret);
+  }
+
+ protected:
+  folly::EventBase evb_;
+  std::shared_ptr<FollyQuicEventBase> qEvb_;
+  std::unique_ptr<QuicAsyncUDPSocket> sender_;
+  std::unique_ptr<QuicAsyncUDPSocket> receiver_;
+  MockUDPReadCallback readCb_;
+  MockErrMessageCallback errCb_;
+};
+
+TEST_F(IoUringQuicAsyncUDPSocketTest, NotifyAndRecvmsg) {
+  EXPECT_CALL(readCb_, shouldOnlyNotify()).WillRepeatedly(Return(true));
+  std::vector<std::string> received;
+  quic::SocketAddress peer;
+  bool done = false;
+  EXPECT_CALL(readCb_, onNotifyDataAvailable_(_))
+      .WillRepeatedly([&](QuicAsyncUDPSocket& sock) {
+        while (true) {
+          auto data = readOne(sock, &peer);
+          if (data.empty()) {
+            break;
+          }
+          received.push_back(std::move(data));
+        }
+        done = received.size() == 3;
+      });
+  receiver_->resumeRead(&readCb_);
+  send("one");
+  send("two");
+  send("three");
+  loopUntil(done);
+  EXPECT_THAT(received, ElementsAre("one", "two", "three"));
+  EXPECT_EQ(peer, sender_->addressRef());
+
+  EXPECT_CALL(readCb_, onReadClosed_());
+  ASSERT_FALSE(receiver_->close().hasError());
+}
+
+TEST_F(IoUringQuicAsyncUDPSocketTest, LeftoverDatagramsNotifyAgain) {
+  EXPECT_CALL(readCb_, shouldOnlyNotify()).WillRepeatedly(Return(true));
+  std::vector<std::string> received;
+  bool done = false;
+  // Read only one datagram per notification.
+  EXPECT_CALL(readCb_, onNotifyDataAvailable_(_))
+      .WillRepeatedly([&](QuicAsyncUDPSocket& sock) {
+        received.push_back(readOne(sock, nullptr));
+        done = received.size() == 2;
+      });
+  receiver_->resumeRead(&readCb_);
+  send("a");
+  send("b");
+  loopUntil(done);
+  EXPECT_THAT(received, ElementsAre("a", "b"));
+}
+
+TEST_F(IoUringQuicAsyncUDPSocketTest, DataAvailable) {
+  EXPECT_CALL(readCb_, shouldOnlyNotify()).WillRepeatedly(Return(false));
+  std::array<char, 2048> buf{};
+  EXPECT_CALL(readCb_, getReadBuffer_(_, _))
+      .WillRepeatedly([&](void** data, size_t* len) {
+        *data = buf.data();
+        *len = buf.size();
+      });
+  bool done = false;
+  EXPECT_CALL(readCb_, onDataAvailable_(_, 5, false, _))
+      .WillOnce([&](const quic::SocketAddress& peer, size_t len, bool, auto) {
+        EXPECT_EQ(peer, sender_->addressRef());
+        EXPECT_EQ(std::string(buf.data(), len), "hello");
+        done = true;
+      });
+  receiver_->resumeRead(&readCb_);
+  send("hello");
+  loopUntil(done);
+  EXPECT_TRUE(done);
+}
+
+TEST_F(IoUringQuicAsyncUDPSocketTest, WritemGSOSegments) {
+  auto gso = sender_->getGSO();
+  if (gso.hasError() || *gso < 0) {
+    GTEST_SKIP() << "UDP GSO is not supported";
+  }
+  EXPECT_CALL(readCb_, shouldOnlyNotify()).WillRepeatedly(Return(true));
+  std::vector<std::string> received;
+  bool done = false;
+  EXPECT_CALL(readCb_, onNotifyDataAvailable_(_))
+      .WillRepeatedly([&](QuicAsyncUDPSocket& sock) {
+        while (true) {
+          auto data = readOne(sock, nullptr);
+          if (data.empty()) {
+            break;
+          }
+          received.push_back(std::move(data));
+        }
+        done = received.size() == 4;
+      });
+  receiver_->resumeRead(&readCb_);
+
+  // One GSO message of three 100 byte segments and a plain datagram.
+  std::array<BufPtr, 2> bufs = {
+      BufHelpers::copyBuffer(std::string(300, 'x')),
+      BufHelpers::copyBuffer(std::string("tail"))};
+  std::array<QuicAsyncUDPSocket::WriteOptions, 2> options = {
+      QuicAsyncUDPSocket::WriteOptions(100, false),
+      QuicAsyncUDPSocket::WriteOptions()};
+  auto dest = receiver_->addressRef();
+  EXPECT_EQ(
+      sender_->writemGSO(
+          AddressRange(&dest, 1), bufs.data(), bufs.size(), options.data()),
+      2);
+  loopUntil(done);
+  ASSERT_EQ(received.size(), 4);
+  EXPECT_EQ(received[0], std::string(100, 'x'));
+  EXPECT_EQ(received[2], std::string(100, 'x'));
+  EXPECT_EQ(received[3], "tail");
+}
+
+TEST_F(IoUringQuicAsyncUDPSocketTest, ErrToNonExistentServer) {
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  EXPECT_CALL(readCb_, shouldOnlyNotify()).WillRepeatedly(Return(true));
+  sender_->resumeRead(&readCb_);
+  ASSERT_FALSE(sender_->setErrMessageCallback(&errCb_).hasError());
+  bool done = false;
+  EXPECT_CALL(errCb_, errMessage_(_)).WillOnce([&](auto&) { done = true; });
+  // Errors are reported instead of a read notification.
+  EXPECT_CALL(readCb_, onNotifyDataAvailable_(_)).Times(0);
+
+  std::string data("hey");
+  iovec vec{data.data(), data.size()};
+  sender_->write(quic::SocketAddress("127.0.0.1", 10000), &vec, 1);
+  loopUntil(done);
+  EXPECT_TRUE(done);
+#else // !FOLLY_HAVE_MSG_ERRQUEUE
+  GTEST_SKIP();
+#endif
+}
+
+#if FOLLY_HAS_LIBURING
+TEST_F(IoUringQuicAsyncUDPSocketTest, DestroyWithQueuedDatagrams) {
+  EXPECT_CALL(readCb_, shouldOnlyNotify()).WillRepeatedly(Return(true));
+  bool notified = false;
+  EXPECT_CALL(readCb_, onNotifyDataAvailable_(_))
+      .WillOnce([&](QuicAsyncUDPSocket&) { notified = true; });
+  receiver_->resumeRead(&readCb_);
+  send("dropped");
+  loopUntil(notified);
+  ASSERT_TRUE(notified);
+  EXPECT_EQ(
+      static_cast<IoUringQuicAsyncUDPSocket*>(receiver_.get())
+          ->numPendingDatagrams(),
+      1);
+  EXPECT_CALL(readCb_, onReadClosed_());
+  receiver_.reset();
+  // The ring outlives the socket and must not deliver to it anymore.
+  send("late");
+  evb_.loopOnce(EVLOOP_NONBLOCK);
+}
+#endif // FOLLY_HAS_LIBURING
+
+} // namespace quic::test
@@ -7,6 +7,7 @@
 
 #include <ev.h>
 #include <folly/portability/GTest.h>
+#include <poll.h>
 #include <quic/common/udpsocket/LibevQuicAsyncUDPSocket.h>
 #include <quic/common/udpsocket/test/QuicAsyncUDPSocketTestBase.h>
 
@@ -45,3 +46,132 @@ INSTANTIATE_TYPED_TEST_SUITE_P(
     LibevQuicAsyncUDPSocketTest, // Instance name
     QuicAsyncUDPSocketTest, // Test case name
     LibevQuicAsyncUDPSocketType); // Type list
+
+class LibevQuicAsyncUDPSocketOffloadTest : public Test {
+ public:
+  void SetUp() override {
+    auto evb =
+        std::make_shared<quic::LibevQuicEventBase>(std::make_unique<EvLoop>());
+    sender_ = std::make_unique<quic::LibevQuicAsyncUDPSocket>(evb);
+    receiver_ = std::make_unique<quic::LibevQuicAsyncUDPSocket>(evb);
+    ASSERT_FALSE(sender_->bind(quic::SocketAddress("127.0.0.1", 0)).hasError());
+    ASSERT_FALSE(
+        receiver_->bind(quic::SocketAddress("127.0.0.1", 0)).hasError());
+  }
+
+  // Reads everything queued on the receiver, waiting up to a second for the
+  // first datagram.
+  quic::NetworkData receive(uint64_t readBufferSize) {
+    pollfd pfd{receiver_->getFD(), POLLIN, 0};
+    EXPECT_EQ(::poll(&pfd, 1, 1000), 1);
+    quic::NetworkData networkData;
+    size_t totalData = 0;
+    auto result = receiver_->recvmmsgNetworkData(
+        readBufferSize, 16, networkData, totalData);
+    EXPECT_FALSE(result.hasError());
+    return networkData;
+  }
+
+  static std::string toString(const quic::ReceivedUdpPacket& packet) {
+    auto* buf = packet.buf.front();
+    return std::string(
+        reinterpret_cast<const char*>(buf->data()), buf->length());
+  }
+
+ protected:
+  std::unique_ptr<quic::LibevQuicAsyncUDPSocket> sender_;
+  std::unique_ptr<quic::LibevQuicAsyncUDPSocket> receiver_;
+};
+
+TEST_F(LibevQuicAsyncUDPSocketOffloadTest, Writem) {
+  std::string one = "one";
+  std::string two = "two";
+  std::array<iovec, 2> iov = {
+      iovec{one.data(), one.size()}, iovec{two.data(), two.size()}};
+  std::array<size_t, 2> numIovecs = {1, 1};
+  auto dest = receiver_->addressRef();
+  EXPECT_EQ(
+      sender_->writem(
+          quic::AddressRange(&dest, 1), iov.data(), numIovecs.data(), 2),
+      2);
+
+  auto networkData = receive(1500);
+  ASSERT_EQ(networkData.getPackets().size(), 2);
+  EXPECT_EQ(toString(networkData.getPackets()[0]), "one");
+  EXPECT_EQ(toString(networkData.getPackets()[1]), "two");
+  EXPECT_EQ(networkData.getPackets()[0].peerAddress, sender_->addressRef());
+}
+
+TEST_F(LibevQuicAsyncUDPSocketOffloadTest, WritemGSOSegments) {
+  auto gso = sender_->getGSO();
+  if (gso.hasError() || *gso < 0) {
+    GTEST_SKIP() << "UDP GSO is not supported";
+  }
+  // One GSO message of three 100 byte segments and a plain datagram.
+  std::array<quic::BufPtr, 2> bufs = {
+      quic::BufHelpers::copyBuffer(std::string(300, 'x')),
+      quic::BufHelpers::copyBuffer(std::string("tail"))};
+  std::array<quic::QuicAsyncUDPSocket::WriteOptions, 2> options = {
+      quic::QuicAsyncUDPSocket::WriteOptions(100, false),
+      quic::QuicAsyncUDPSocket::WriteOptions()};
+  auto dest = receiver_->addressRef();
+  EXPECT_EQ(
+      sender_->writemGSO(
+          quic::AddressRange(&dest, 1),
+          bufs.data(),
+          bufs.size(),
+          options.data()),
+      2);
+
+  auto networkData = receive(1500);
+  ASSERT_EQ(networkData.getPackets().size(), 4);
+  EXPECT_EQ(toString(networkData.getPackets()[0]), std::string(100, 'x'));
+  EXPECT_EQ(toString(networkData.getPackets()[2]), std::string(100, 'x'));
+  EXPECT_EQ(toString(networkData.getPackets()[3]), "tail");
+}
+
+TEST_F(LibevQuicAsyncUDPSocketOffloadTest, GROSplitsCoalescedDatagrams) {
+  auto gso = sender_->getGSO();
+  if (gso.hasError() || *gso < 0 || receiver_->setGRO(true).hasError()) {
+    GTEST_SKIP() << "UDP GSO/GRO is not supported";
+  }
+  auto gro = receiver_->getGRO();
+  ASSERT_FALSE(gro.hasError());
+  EXPECT_GT(*gro, 0);
+
+  std::string data(400, 'y');
+  iovec vec{data.data(), data.size()};
+  EXPECT_EQ(
+      sender_->writeGSO(
+          receiver_->addressRef(),
+          &vec,
+          1,
+          quic::QuicAsyncUDPSocket::WriteOptions(100, false)),
+      400);
+
+  // Whether the kernel coalesces or not, the transport sees 100 byte packets.
+  auto networkData = receive(1500 * 4);
+  ASSERT_EQ(networkData.getPackets().size(), 4);
+  for (const auto& packet : networkData.getPackets()) {
+    EXPECT_EQ(toString(packet), std::string(100, 'y'));
+    EXPECT_EQ(packet.peerAddress, sender_->addressRef());
+  }
+}
+
+TEST_F(LibevQuicAsyncUDPSocketOffloadTest, RecvTos) {
+  ASSERT_FALSE(receiver_->setRecvTos(true).hasError());
+  auto recvTos = receiver_->getRecvTos();
+  ASSERT_FALSE(recvTos.hasError());
+  EXPECT_TRUE(*recvTos);
+  ASSERT_FALSE(sender_->setTosOrTrafficClass(0x02).hasError());
+
+  std::string data = "ect0";
+  iovec vec{data.data(), data.size()};
+  EXPECT_EQ(
+      sender_->write(receiver_->addressRef(), &vec, 1),
+      static_cast<ssize_t>(data.size()));
+
+  auto networkData = receive(1500);
+  ASSERT_EQ(networkData.getPackets().size(), 1);
+  EXPECT_EQ(networkData.getPackets()[0].tosValue, 0x02);
+}
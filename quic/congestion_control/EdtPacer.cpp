@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/congestion_control/EdtPacer.h>
+
+namespace quic {
+
+EdtPacer::EdtPacer(const QuicConnectionStateBase& conn, uint64_t minCwndInMss)
+    : TokenlessPacer(conn, minCwndInMss), conn_(conn) {}
+
+std::chrono::microseconds EdtPacer::getTimeUntilNextWrite(
+    TimePoint currentTime) const {
+  if (!nextDepartureTime_) {
+    return TokenlessPacer::getTimeUntilNextWrite(currentTime);
+  }
+  // Refill once the packets handed to the kernel cover less than half of the
+  // horizon, so the queue never runs dry between wakeups.
+  auto refillTime =
+      *nextDepartureTime_ - conn_.transportSettings.edtPacingHorizon / 2;
+  if (refillTime <= currentTime) {
+    return 0us;
+  }
+  return std::max(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          refillTime - currentTime),
+      conn_.transportSettings.pacingTickInterval);
+}
+
+uint64_t EdtPacer::updateAndGetWriteBatchSize(TimePoint currentTime) {
+  auto writeInterval = getWriteInterval();
+  auto burstSize = getCachedWriteBatchSize();
+  if (writeInterval == 0us || burstSize == 0) {
+    // Either not pacing at all or not sending at all, neither needs
+    // departure times.
+    nextDepartureTime_.reset();
+    packetsInBurst_ = 0;
+    return TokenlessPacer::updateAndGetWriteBatchSize(currentTime);
+  }
+  if (!nextDepartureTime_ || *nextDepartureTime_ < currentTime) {
+    // Departures are never scheduled in the past. After an idle or a late
+    // write the next burst leaves now.
+    nextDepartureTime_ = currentTime;
+    packetsInBurst_ = 0;
+  }
+  auto horizonEnd = currentTime + conn_.transportSettings.edtPacingHorizon;
+  if (*nextDepartureTime_ > horizonEnd) {
+    return 0;
+  }
+  uint64_t numBursts = (horizonEnd - *nextDepartureTime_) / writeInterval + 1;
+  return numBursts * burstSize - packetsInBurst_;
+}
+
+std::chrono::microseconds EdtPacer::getTxTimeOffset(TimePoint writeTime) const {
+  if (!nextDepartureTime_ || *nextDepartureTime_ <= writeTime) {
+    return 0us;
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      *nextDepartureTime_ - writeTime);
+}
+
+void EdtPacer::onPacketSent() {
+  if (!nextDepartureTime_) {
+    return;
+  }
+  if (++packetsInBurst_ >= std::max<uint64_t>(getCachedWriteBatchSize(), 1)) {
+    *nextDepartureTime_ += getWriteInterval();
+    packetsInBurst_ = 0;
+  }
+}
+
+} // namespace quic
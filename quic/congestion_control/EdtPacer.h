@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/congestion_control/TokenlessPacer.h>
+
+namespace quic {
+
+/*
+ * Pacer for PacingMode::EarliestDepartureTime. It computes the same bursts and
+ * intervals as TokenlessPacer, but instead of waiting for each burst's
+ * interval it hands out every burst that departs within the pacing horizon at
+ * once, each stamped with its departure time. The kernel's fq qdisc then
+ * releases the packets on schedule, and the transport only wakes up again
+ * once half of the horizon has drained.
+ */
+class EdtPacer : public TokenlessPacer {
+ public:
+  EdtPacer(const QuicConnectionStateBase& conn, uint64_t minCwndInMss);
+
+  [[nodiscard]] std::chrono::microseconds getTimeUntilNextWrite(
+      TimePoint currentTime = Clock::now()) const override;
+
+  uint64_t updateAndGetWriteBatchSize(TimePoint currentTime) override;
+
+  [[nodiscard]] std::chrono::microseconds getTxTimeOffset(
+      TimePoint writeTime) const override;
+
+  void onPacketSent() override;
+
+ private:
+  const QuicConnectionStateBase& conn_;
+  // Departure time of the burst the next packet belongs to. Unset while the
+  // connection is not being paced.
+  Optional<TimePoint> nextDepartureTime_;
+  // Packets already stamped with nextDepartureTime_.
+  uint64_t packetsInBurst_{0};
+};
+
+} // namespace quic
@@ -7,13 +7,41 @@
 
 #include <quic/congestion_control/PacerFactory.h>
 
+#include <quic/congestion_control/EdtPacer.h>
 #include <quic/congestion_control/TokenlessPacer.h>
 
 namespace quic {
 
+namespace {
+
+// Departure times travel with the writes of the GSO batch writers only, and
+// only the server worker enables SO_TXTIME on its sockets.
+bool canUseEdtPacing(const QuicConnectionStateBase& conn) {
+  if (conn.nodeType != QuicNodeType::Server) {
+    return false;
+  }
+  switch (conn.transportSettings.batchingMode) {
+    case QuicBatchingMode::BATCHING_MODE_GSO:
+    case QuicBatchingMode::BATCHING_MODE_SENDMMSG_GSO:
+    case QuicBatchingMode::BATCHING_MODE_WORKER_SENDMMSG_GSO:
+      return true;
+    case QuicBatchingMode::BATCHING_MODE_NONE:
+    case QuicBatchingMode::BATCHING_MODE_SENDMMSG:
+      return false;
+  }
+  return false;
+}
+
+} // namespace
+
 std::unique_ptr<Pacer> createPacer(
     const QuicConnectionStateBase& conn,
     uint64_t minCwndInMss) {
+  if (conn.transportSettings.pacingMode ==
+          PacingMode::EarliestDepartureTime &&
+      canUseEdtPacing(conn)) {
+    return std::make_unique<EdtPacer>(conn, minCwndInMss);
+  }
   return std::make_unique<TokenlessPacer>(conn, minCwndInMss);
 }
 
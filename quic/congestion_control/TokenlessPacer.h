@@ -46,6 +46,11 @@ class TokenlessPacer : public Pacer {
   void onPacketSent() override;
   void onPacketsLoss() override;
 
+ protected:
+  [[nodiscard]] std::chrono::microseconds getWriteInterval() const {
+    return writeInterval_;
+  }
+
  private:
   void maybeNotifyObservers();
 
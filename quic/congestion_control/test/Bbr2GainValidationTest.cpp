@@ -61,7 +61,7 @@ class Bbr2FloatUBReproTest : public Test {
     ackEvent.totalBytesAcked = numAck * packetSize;
     ackEvent.largestNewlyAckedPacket = nextPn_ + numAck - 1;
     for (int i = 0; i < numAck; i++) {
-      auto& pkt = conn_->outstandings.packets.at(i);
+      auto& pkt = conn_->outstandings.packets[i];
       auto ackPkt =
           CongestionController::AckEvent::AckPacket::Builder()
               .setPacketNum(pkt.getPacketSequenceNum())
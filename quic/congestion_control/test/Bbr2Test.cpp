@@ -123,7 +123,7 @@ TEST_F(Bbr2Test, StartupCwndGrowthBasic) {
   ackEvent.totalBytesAcked = 5000;
   ackEvent.largestNewlyAckedPacket = 4;
   for (int i = 0; i < 5; i++) {
-    auto& pkt = conn_->outstandings.packets.at(i);
+    auto& pkt = conn_->outstandings.packets[i];
     auto ackPkt =
         CongestionController::AckEvent::AckPacket::Builder()
             .setPacketNum(pkt.getPacketSequenceNum())
@@ -8,6 +8,7 @@
 #include <quic/congestion_control/Pacer.h>
 
 #include <folly/portability/GTest.h>
+#include <quic/congestion_control/EdtPacer.h>
 #include <quic/congestion_control/TokenlessPacer.h>
 #include <quic/logging/test/Mocks.h>
 #include <quic/state/test/MockQuicStats.h>
@@ -511,4 +512,98 @@ TEST_F(TokenlessPacerTest, SetPacingRateQlogNotifiedWhenChanged) {
   pacer.setPacingRate(10000000);
 }
 
+class EdtPacerTest : public Test {
+ public:
+  void SetUp() override {
+    conn.transportSettings.pacingTickInterval = 1us;
+    conn.transportSettings.edtPacingHorizon = 4000us;
+    pacer.setPacingRateCalculator([](const QuicConnectionStateBase&,
+                                     uint64_t,
+                                     uint64_t,
+                                     std::chrono::microseconds) {
+      return PacingRate::Builder().setInterval(1000us).setBurstSize(10).build();
+    });
+    pacer.refreshPacingRate(20, 100us); // These two values do not matter here
+  }
+
+  // Sends n packets and returns the tx time offset of each, relative to now.
+  std::vector<std::chrono::microseconds> sendPackets(
+      uint64_t n,
+      TimePoint now) {
+    std::vector<std::chrono::microseconds> offsets;
+    for (uint64_t i = 0; i < n; ++i) {
+      offsets.push_back(pacer.getTxTimeOffset(now));
+      pacer.onPacketSent();
+    }
+    return offsets;
+  }
+
+ protected:
+  QuicConnectionStateBase conn{QuicNodeType::Server};
+  EdtPacer pacer{conn, conn.transportSettings.minCwndInMss};
+};
+
+TEST_F(EdtPacerTest, FillsHorizon) {
+  auto now = Clock::now();
+  EXPECT_EQ(0us, pacer.getTimeUntilNextWrite(now));
+  // Bursts leaving at 0, 1, 2, 3 and 4ms fit into the horizon.
+  EXPECT_EQ(50, pacer.updateAndGetWriteBatchSize(now));
+  auto offsets = sendPackets(50, now);
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    EXPECT_EQ(std::chrono::microseconds(1000 * (i / 10)), offsets[i]);
+  }
+  // The next burst leaves at 5ms, write again once 2ms are left.
+  EXPECT_EQ(3000us, pacer.getTimeUntilNextWrite(now));
+  EXPECT_EQ(0us, pacer.getTimeUntilNextWrite(now + 3000us));
+}
+
+TEST_F(EdtPacerTest, RefillContinuesSchedule) {
+  auto now = Clock::now();
+  EXPECT_EQ(50, pacer.updateAndGetWriteBatchSize(now));
+  sendPackets(50, now);
+  auto later = now + 3000us;
+  // Bursts at 5, 6 and 7ms fit into the new horizon ending at 7ms.
+  EXPECT_EQ(30, pacer.updateAndGetWriteBatchSize(later));
+  auto offsets = sendPackets(30, later);
+  EXPECT_EQ(2000us, offsets.front());
+  EXPECT_EQ(4000us, offsets.back());
+}
+
+TEST_F(EdtPacerTest, PartialBurst) {
+  auto now = Clock::now();
+  EXPECT_EQ(50, pacer.updateAndGetWriteBatchSize(now));
+  // The connection ran out of data in the middle of the third burst.
+  sendPackets(25, now);
+  EXPECT_EQ(2000us, pacer.getTxTimeOffset(now));
+  // The rest of that burst keeps its departure time.
+  EXPECT_EQ(25, pacer.updateAndGetWriteBatchSize(now + 10us));
+  EXPECT_EQ(1990us, pacer.getTxTimeOffset(now + 10us));
+}
+
+TEST_F(EdtPacerTest, NoDeparturesInThePast) {
+  auto now = Clock::now();
+  EXPECT_EQ(50, pacer.updateAndGetWriteBatchSize(now));
+  sendPackets(10, now);
+  // After an idle period the schedule starts over at the time of the write.
+  auto later = now + 100ms;
+  EXPECT_EQ(0us, pacer.getTimeUntilNextWrite(later));
+  EXPECT_EQ(50, pacer.updateAndGetWriteBatchSize(later));
+  EXPECT_EQ(0us, pacer.getTxTimeOffset(later));
+}
+
+TEST_F(EdtPacerTest, UnpacedRate) {
+  pacer.setPacingRateCalculator([](const QuicConnectionStateBase&,
+                                   uint64_t,
+                                   uint64_t,
+                                   std::chrono::microseconds) {
+    return PacingRate::Builder().setInterval(0us).setBurstSize(7).build();
+  });
+  pacer.refreshPacingRate(20, 100us);
+  auto now = Clock::now();
+  EXPECT_EQ(7, pacer.updateAndGetWriteBatchSize(now));
+  sendPackets(7, now);
+  EXPECT_EQ(0us, pacer.getTxTimeOffset(now));
+  EXPECT_EQ(0us, pacer.getTimeUntilNextWrite(now));
+}
+
 } // namespace quic::test
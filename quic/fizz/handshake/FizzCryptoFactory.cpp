@@ -128,6 +128,36 @@ FizzCryptoFactory::makePacketNumberCipher(ByteRange baseSecret) const {
   return pnCipher;
 }
 
+quic::Expected<std::unique_ptr<Aead>, QuicError>
+FizzCryptoFactory::makeInitialAeadFromKey(const TrafficKey& key) const {
+  std::unique_ptr<fizz::Aead> aead;
+  fizz::Error err;
+  FIZZ_THROW_ON_ERROR(
+      fizzFactory_->makeAead(
+          aead, err, fizz::CipherSuite::TLS_AES_128_GCM_SHA256),
+      err);
+  fizz::TrafficKey trafficKey;
+  trafficKey.key = key.key->clone();
+  trafficKey.iv = key.iv->clone();
+  FIZZ_THROW_ON_ERROR(aead->setKey(err, std::move(trafficKey)), err);
+  return QUIC_DEFAULT_AEAD::wrap(std::move(aead));
+}
+
+quic::Expected<std::unique_ptr<PacketNumberCipher>, QuicError>
+FizzCryptoFactory::makeInitialHeaderCipherFromKey(ByteRange key) const {
+  auto pnCipherResult =
+      makePacketNumberCipher(fizz::CipherSuite::TLS_AES_128_GCM_SHA256);
+  if (!pnCipherResult.has_value()) {
+    return quic::make_unexpected(pnCipherResult.error());
+  }
+  auto pnCipher = std::move(pnCipherResult.value());
+  auto setKeyResult = pnCipher->setKey(key);
+  if (!setKeyResult.has_value()) {
+    return quic::make_unexpected(setKeyResult.error());
+  }
+  return pnCipher;
+}
+
 quic::Expected<std::unique_ptr<PacketNumberCipher>, QuicError>
 FizzCryptoFactory::makePacketNumberCipher(fizz::CipherSuite cipher) const {
   switch (cipher) {
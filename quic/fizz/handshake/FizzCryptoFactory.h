@@ -30,6 +30,12 @@ class FizzCryptoFactory : public CryptoFactory {
   [[nodiscard]] quic::Expected<std::unique_ptr<PacketNumberCipher>, QuicError>
   makePacketNumberCipher(ByteRange baseSecret) const override;
 
+  [[nodiscard]] quic::Expected<std::unique_ptr<Aead>, QuicError>
+  makeInitialAeadFromKey(const TrafficKey& key) const override;
+
+  [[nodiscard]] quic::Expected<std::unique_ptr<PacketNumberCipher>, QuicError>
+  makeInitialHeaderCipherFromKey(ByteRange key) const override;
+
   [[nodiscard]] virtual quic::
       Expected<std::unique_ptr<PacketNumberCipher>, QuicError>
       makePacketNumberCipher(fizz::CipherSuite cipher) const;
@@ -24,6 +24,11 @@ class FizzOpenSSLAes128PacketNumberCipher : public PacketNumberCipher {
   [[nodiscard]] quic::Expected<HeaderProtectionMask, QuicError> mask(
       ByteRange sample) const override;
 
+  [[nodiscard]] quic::Expected<void, QuicError> maskBatch(
+      const Sample* samples,
+      size_t count,
+      HeaderProtectionMask* masks) const override;
+
   [[nodiscard]] size_t keyLength() const override;
 
  private:
@@ -43,6 +48,11 @@ class FizzOpenSSLAes256PacketNumberCipher : public PacketNumberCipher {
   [[nodiscard]] quic::Expected<HeaderProtectionMask, QuicError> mask(
       ByteRange sample) const override;
 
+  [[nodiscard]] quic::Expected<void, QuicError> maskBatch(
+      const Sample* samples,
+      size_t count,
+      HeaderProtectionMask* masks) const override;
+
   [[nodiscard]] size_t keyLength() const override;
 
  private:
@@ -124,4 +124,62 @@ TEST_F(FizzCryptoFactoryTest, TestPacketEncryptionKey) {
   EXPECT_EQ(secretHex2, expectedKey2);
 }
 
+TEST_F(FizzCryptoFactoryTest, InplaceEncryptBatchMatchesInplaceEncrypt) {
+  FizzCryptoFactory cryptoFactory;
+  auto aead = cryptoFactory
+                  .makeInitialAead(
+                      kClientInitialLabel,
+                      getTestConnectionId(),
+                      QuicVersion::QUIC_V1)
+                  .value();
+  auto overhead = aead->getCipherOverhead();
+  constexpr size_t kHeaderLen = 20;
+  constexpr std::array<size_t, 3> kPayloadLens = {100, 1200, 1};
+
+  auto batchBuf = folly::IOBuf::create(4096);
+  std::vector<InplaceEncryptPacket> packets;
+  for (size_t i = 0; i < kPayloadLens.size(); ++i) {
+    InplaceEncryptPacket packet;
+    packet.headerOffset = batchBuf->length();
+    packet.headerLen = kHeaderLen;
+    packet.payloadLen = kPayloadLens[i];
+    packet.seqNum = 7 + i;
+    memset(
+        batchBuf->writableTail(),
+        static_cast<int>(i + 1),
+        kHeaderLen + kPayloadLens[i]);
+    batchBuf->append(kHeaderLen + kPayloadLens[i] + overhead);
+    packets.push_back(packet);
+  }
+  auto expectedLength = batchBuf->length();
+  auto expectedData = batchBuf->data();
+
+  std::vector<BufPtr> expected;
+  for (const auto& packet : packets) {
+    auto header = folly::IOBuf::copyBuffer(
+        batchBuf->data() + packet.headerOffset, packet.headerLen);
+    auto payload = folly::IOBuf::copyBuffer(
+        batchBuf->data() + packet.headerOffset + packet.headerLen,
+        packet.payloadLen,
+        0,
+        overhead);
+    expected.push_back(
+        aead->inplaceEncrypt(std::move(payload), header.get(), packet.seqNum)
+            .value());
+  }
+
+  auto result = aead->inplaceEncryptBatch(
+      std::move(batchBuf), packets.data(), packets.size());
+  ASSERT_FALSE(result.hasError());
+  batchBuf = std::move(result.value());
+  EXPECT_EQ(batchBuf->data(), expectedData);
+  EXPECT_EQ(batchBuf->length(), expectedLength);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    auto sealed = folly::IOBuf::wrapBuffer(
+        batchBuf->data() + packets[i].headerOffset + packets[i].headerLen,
+        packets[i].payloadLen + overhead);
+    EXPECT_TRUE(folly::IOBufEqualTo()(*sealed, *expected[i]));
+  }
+}
+
 } // namespace quic::test
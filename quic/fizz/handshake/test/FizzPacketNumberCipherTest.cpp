@@ -157,4 +157,89 @@ INSTANTIATE_TEST_SUITE_P(
             folly::StringPiece{"772aa701"},
             folly::StringPiece{"ce"}}));
 
+class BatchedPacketNumberCipherTest
+    : public TestWithParam<fizz::CipherSuite> {
+ public:
+  void SetUp() override {
+    FizzCryptoFactory cryptoFactory;
+    auto cipherResult = cryptoFactory.makePacketNumberCipher(GetParam());
+    ASSERT_FALSE(cipherResult.hasError());
+    cipher_ = std::move(cipherResult.value());
+    std::string key(cipher_->keyLength(), 'k');
+    ASSERT_FALSE(cipher_
+                     ->setKey(quic::ByteRange(
+                         reinterpret_cast<const uint8_t*>(key.data()),
+                         key.size()))
+                     .hasError());
+    for (size_t i = 0; i < samples_.size(); ++i) {
+      for (size_t j = 0; j < samples_[i].size(); ++j) {
+        samples_[i][j] = static_cast<uint8_t>(i * 31 + j);
+      }
+    }
+  }
+
+ protected:
+  std::unique_ptr<PacketNumberCipher> cipher_;
+  // More than one internal batch of encryptHeaders().
+  std::array<Sample, 100> samples_{};
+};
+
+TEST_P(BatchedPacketNumberCipherTest, MaskBatchMatchesMask) {
+  std::array<HeaderProtectionMask, 100> masks{};
+  ASSERT_FALSE(
+      cipher_->maskBatch(samples_.data(), samples_.size(), masks.data())
+          .hasError());
+  for (size_t i = 0; i < samples_.size(); ++i) {
+    auto mask = cipher_->mask(
+        quic::ByteRange(samples_[i].data(), samples_[i].size()));
+    ASSERT_FALSE(mask.hasError());
+    EXPECT_EQ(masks[i], mask.value()) << "sample " << i;
+  }
+}
+
+TEST_P(BatchedPacketNumberCipherTest, EncryptHeadersMatchesEncryptHeader) {
+  struct Header {
+    std::array<uint8_t, 1> initial;
+    PacketNumberBytes packetNumber;
+  };
+  std::array<Header, 100> batched{};
+  std::array<Header, 100> single{};
+  std::array<PendingHeaderProtection, 100> pending{};
+  for (size_t i = 0; i < batched.size(); ++i) {
+    // Mix short and long headers and all packet number lengths.
+    bool longHeader = i % 2 == 1;
+    batched[i].initial[0] =
+        static_cast<uint8_t>((longHeader ? 0xc0 : 0x40) | (i % 4));
+    batched[i].packetNumber = {0x01, 0x02, 0x03, static_cast<uint8_t>(i)};
+    single[i] = batched[i];
+    pending[i].sample = samples_[i];
+    pending[i].initialByte = batched[i].initial.data();
+    pending[i].packetNumber = batched[i].packetNumber.data();
+    pending[i].longHeader = longHeader;
+
+    auto sample = quic::ByteRange(samples_[i].data(), samples_[i].size());
+    auto initialByte = quic::MutableByteRange(single[i].initial.data(), 1);
+    auto packetNumber = quic::MutableByteRange(
+        single[i].packetNumber.data(), single[i].packetNumber.size());
+    auto result = longHeader
+        ? cipher_->encryptLongHeader(sample, initialByte, packetNumber)
+        : cipher_->encryptShortHeader(sample, initialByte, packetNumber);
+    ASSERT_FALSE(result.hasError());
+  }
+  ASSERT_FALSE(
+      cipher_->encryptHeaders(pending.data(), pending.size()).hasError());
+  for (size_t i = 0; i < batched.size(); ++i) {
+    EXPECT_EQ(batched[i].initial, single[i].initial) << "header " << i;
+    EXPECT_EQ(batched[i].packetNumber, single[i].packetNumber)
+        << "header " << i;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BatchedPacketNumberCipherTests,
+    BatchedPacketNumberCipherTest,
+    ::testing::Values(
+        fizz::CipherSuite::TLS_AES_128_GCM_SHA256,
+        fizz::CipherSuite::TLS_AES_256_GCM_SHA384));
+
 } // namespace quic::test
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <quic/common/MvfstLogging.h>
+#include <quic/fizz/handshake/FizzPacketNumberCipher.h>
+
+#include <vector>
+
+using namespace quic;
+
+namespace {
+// Packets in a typical GSO write batch.
+constexpr size_t kBatchSize = 44;
+
+struct Headers {
+  std::vector<std::array<uint8_t, 1>> initialBytes;
+  std::vector<std::array<uint8_t, 4>> packetNumbers;
+  std::vector<Sample> samples;
+  std::vector<PendingHeaderProtection> pending;
+};
+
+template <typename Cipher>
+std::unique_ptr<PacketNumberCipher> makeCipher() {
+  auto cipher = std::make_unique<Cipher>();
+  std::string key(cipher->keyLength(), 'k');
+  auto setKeyResult = cipher->setKey(
+      ByteRange(reinterpret_cast<const uint8_t*>(key.data()), key.size()));
+  MVCHECK(!setKeyResult.hasError());
+  return cipher;
+}
+
+Headers makeHeaders() {
+  Headers headers;
+  headers.initialBytes.resize(kBatchSize, {0x43});
+  headers.packetNumbers.resize(kBatchSize);
+  headers.samples.resize(kBatchSize);
+  for (size_t i = 0; i < kBatchSize; ++i) {
+    headers.samples[i].fill(static_cast<uint8_t>(i));
+    PendingHeaderProtection pending;
+    pending.sample = headers.samples[i];
+    pending.initialByte = headers.initialBytes[i].data();
+    pending.packetNumber = headers.packetNumbers[i].data();
+    headers.pending.push_back(pending);
+  }
+  return headers;
+}
+
+/**
+ * What encryptPacketHeader() does for every packet of a write batch: one mask
+ * computation per packet.
+ */
+void runPerPacket(const PacketNumberCipher& cipher, size_t iters) {
+  auto headers = makeHeaders();
+  for (size_t iter = 0; iter < iters; ++iter) {
+    for (size_t i = 0; i < kBatchSize; ++i) {
+      auto result = cipher.encryptShortHeader(
+          ByteRange(headers.samples[i].data(), headers.samples[i].size()),
+          MutableByteRange(headers.initialBytes[i].data(), 1),
+          MutableByteRange(headers.packetNumbers[i].data(), 4));
+      folly::doNotOptimizeAway(result);
+    }
+  }
+}
+
+/**
+ * What IOBufQuicBatch does for a write batch: the masks of all the packets in
+ * one maskBatch() call.
+ */
+void runBatched(const PacketNumberCipher& cipher, size_t iters) {
+  auto headers = makeHeaders();
+  for (size_t iter = 0; iter < iters; ++iter) {
+    auto result =
+        cipher.encryptHeaders(headers.pending.data(), headers.pending.size());
+    folly::doNotOptimizeAway(result);
+  }
+}
+} // namespace
+
+BENCHMARK(aes128_per_packet, iters) {
+  std::unique_ptr<PacketNumberCipher> cipher;
+  BENCHMARK_SUSPEND {
+    cipher = makeCipher<Aes128PacketNumberCipher>();
+  }
+  runPerPacket(*cipher, iters);
+}
+
+BENCHMARK_RELATIVE(aes128_batched, iters) {
+  std::unique_ptr<PacketNumberCipher> cipher;
+  BENCHMARK_SUSPEND {
+    cipher = makeCipher<Aes128PacketNumberCipher>();
+  }
+  runBatched(*cipher, iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(aes256_per_packet, iters) {
+  std::unique_ptr<PacketNumberCipher> cipher;
+  BENCHMARK_SUSPEND {
+    cipher = makeCipher<Aes256PacketNumberCipher>();
+  }
+  runPerPacket(*cipher, iters);
+}
+
+BENCHMARK_RELATIVE(aes256_batched, iters) {
+  std::unique_ptr<PacketNumberCipher> cipher;
+  BENCHMARK_SUSPEND {
+    cipher = makeCipher<Aes256PacketNumberCipher>();
+  }
+  runBatched(*cipher, iters);
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
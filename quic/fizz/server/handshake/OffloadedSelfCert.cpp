@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/fizz/server/handshake/OffloadedSelfCert.h>
+
+#include <folly/futures/Future.h>
+#include <quic/common/MvfstLogging.h>
+
+namespace quic {
+
+OffloadedSelfCert::OffloadedSelfCert(
+    std::shared_ptr<const fizz::SelfCert> cert,
+    folly::Executor::KeepAlive<> executor)
+    : cert_(std::move(cert)), executor_(std::move(executor)) {
+  MVCHECK(cert_);
+  MVCHECK(executor_);
+}
+
+std::string OffloadedSelfCert::getIdentity() const {
+  return cert_->getIdentity();
+}
+
+std::optional<std::string> OffloadedSelfCert::getDER() const {
+  return cert_->getDER();
+}
+
+std::vector<std::string> OffloadedSelfCert::getAltIdentities() const {
+  return cert_->getAltIdentities();
+}
+
+std::vector<fizz::SignatureScheme> OffloadedSelfCert::getSigSchemes() const {
+  return cert_->getSigSchemes();
+}
+
+fizz::CertificateMsg OffloadedSelfCert::getCertMessage(
+    fizz::Buf certificateRequestContext) const {
+  return cert_->getCertMessage(std::move(certificateRequestContext));
+}
+
+fizz::CompressedCertificate OffloadedSelfCert::getCompressedCert(
+    fizz::CertificateCompressionAlgorithm algo) const {
+  return cert_->getCompressedCert(algo);
+}
+
+fizz::Buf OffloadedSelfCert::sign(
+    fizz::SignatureScheme scheme,
+    fizz::CertificateVerifyContext context,
+    folly::ByteRange toBeSigned) const {
+  return cert_->sign(scheme, context, toBeSigned);
+}
+
+folly::SemiFuture<std::optional<fizz::Buf>> OffloadedSelfCert::signFuture(
+    fizz::SignatureScheme scheme,
+    fizz::CertificateVerifyContext context,
+    std::unique_ptr<folly::IOBuf> data) const {
+  // The lambda holds its own reference to the certificate, so it can outlive
+  // both this wrapper and the connection that asked for the signature.
+  return folly::via(
+             executor_,
+             [cert = cert_, scheme, context, data = std::move(data)]() mutable
+                 -> std::optional<fizz::Buf> {
+               return cert->sign(scheme, context, data->coalesce());
+             })
+      .semi();
+}
+
+} // namespace quic
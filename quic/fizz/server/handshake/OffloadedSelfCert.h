@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/server/AsyncSelfCert.h>
+#include <folly/Executor.h>
+
+namespace quic {
+
+/**
+ * A certificate whose CertificateVerify signatures are computed on a
+ * separate executor, typically a thread pool shared by all server workers.
+ *
+ * Fizz hands the handshake an asynchronous action for an AsyncSelfCert, and
+ * ServerHandshake resumes it on the worker's EventBase once the signature is
+ * ready. Packets of other connections on that worker are processed in the
+ * meantime instead of waiting for the private key operation.
+ *
+ * Add it to the FizzServerContext's CertManager in place of the wrapped
+ * certificate.
+ */
+class OffloadedSelfCert : public fizz::server::AsyncSelfCert {
+ public:
+  OffloadedSelfCert(
+      std::shared_ptr<const fizz::SelfCert> cert,
+      folly::Executor::KeepAlive<> executor);
+
+  [[nodiscard]] std::string getIdentity() const override;
+
+  [[nodiscard]] std::optional<std::string> getDER() const override;
+
+  [[nodiscard]] std::vector<std::string> getAltIdentities() const override;
+
+  [[nodiscard]] std::vector<fizz::SignatureScheme> getSigSchemes()
+      const override;
+
+  [[nodiscard]] fizz::CertificateMsg getCertMessage(
+      fizz::Buf certificateRequestContext) const override;
+
+  [[nodiscard]] fizz::CompressedCertificate getCompressedCert(
+      fizz::CertificateCompressionAlgorithm algo) const override;
+
+  // Signs inline, for callers that need the signature synchronously.
+  [[nodiscard]] fizz::Buf sign(
+      fizz::SignatureScheme scheme,
+      fizz::CertificateVerifyContext context,
+      folly::ByteRange toBeSigned) const override;
+
+  [[nodiscard]] folly::SemiFuture<std::optional<fizz::Buf>> signFuture(
+      fizz::SignatureScheme scheme,
+      fizz::CertificateVerifyContext context,
+      std::unique_ptr<folly::IOBuf> data) const override;
+
+ private:
+  std::shared_ptr<const fizz::SelfCert> cert_;
+  folly::Executor::KeepAlive<> executor_;
+};
+
+} // namespace quic
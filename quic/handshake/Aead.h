@@ -19,6 +19,19 @@ struct TrafficKey {
   BufPtr iv;
 };
 
+/**
+ * One packet of an inplaceEncryptBatch() call. Offsets are relative to the
+ * data of the buffer passed to it. The header is the associated data and the
+ * payloadLen bytes right after it are encrypted, with the tag written over the
+ * getCipherOverhead() bytes following the payload.
+ */
+struct InplaceEncryptPacket {
+  size_t headerOffset{0};
+  size_t headerLen{0};
+  size_t payloadLen{0};
+  uint64_t seqNum{0};
+};
+
 /**
  * Interface for aead algorithms (RFC 5116).
  */
@@ -37,6 +50,44 @@ class Aead {
       const Buf* associatedData,
       uint64_t seqNum) const = 0;
 
+  /**
+   * Encrypts count packets laid out back to back in buf, inplace. Every packet
+   * must have room for its tag after its payload. Returns buf with its data
+   * and length unchanged, or an error. The default encrypts the packets one at
+   * a time with inplaceEncrypt(). Implementations that own their cipher
+   * context can override it to key the context once and only set the nonce
+   * per packet. There is no batched counterpart for decryption, the read
+   * codec opens packets one at a time.
+   */
+  [[nodiscard]] virtual quic::Expected<BufPtr, QuicError> inplaceEncryptBatch(
+      BufPtr&& buf,
+      const InplaceEncryptPacket* packets,
+      size_t count) const {
+    auto length = buf->length();
+    for (size_t i = 0; i < count; ++i) {
+      const auto& packet = packets[i];
+      auto payloadOffset = packet.headerOffset + packet.headerLen;
+      auto payload = buf->writableData() + payloadOffset;
+      auto header = BufHelpers::wrapBufferAsValue(
+          payload - packet.headerLen, packet.headerLen);
+      buf->trimStart(payloadOffset);
+      buf->trimEnd(buf->length() - packet.payloadLen);
+      auto result = inplaceEncrypt(std::move(buf), &header, packet.seqNum);
+      if (!result.has_value()) {
+        return quic::make_unexpected(result.error());
+      }
+      buf = std::move(result.value());
+      if (buf->data() != payload) {
+        return quic::make_unexpected(QuicError(
+            TransportErrorCode::INTERNAL_ERROR,
+            "Batched packet not encrypted in place"));
+      }
+      buf->prepend(payloadOffset);
+      buf->append(length - buf->length());
+    }
+    return std::move(buf);
+  }
+
   /**
    * Decrypt ciphertext. Will throw if the ciphertext does not decrypt
    * successfully.
@@ -75,6 +75,21 @@ class CryptoFactory {
       Expected<std::unique_ptr<PacketNumberCipher>, QuicError>
       makePacketNumberCipher(ByteRange baseSecret) const = 0;
 
+  /**
+   * Makes an Initial aead from the key of one made by makeInitialAead(),
+   * without deriving it again.
+   */
+  [[nodiscard]] virtual quic::Expected<std::unique_ptr<Aead>, QuicError>
+  makeInitialAeadFromKey(const TrafficKey& key) const = 0;
+
+  /**
+   * Makes an Initial header cipher from the key of one made by
+   * makePacketNumberCipher(), without deriving it again.
+   */
+  [[nodiscard]] virtual quic::
+      Expected<std::unique_ptr<PacketNumberCipher>, QuicError>
+      makeInitialHeaderCipherFromKey(ByteRange key) const = 0;
+
   // Type alias for constant-time comparison function pointer.
   // Raw function pointer is used instead of std::function since all
   // implementations are stateless (no captured state).
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Range.h>
+
+#include <array>
+#include <cstdint>
+
+/**
+ * On-disk layout of the binary qlog written by BinaryQLogger.
+ *
+ * A file starts with kBinaryQLogMagic and is followed by records:
+ *
+ *   | type (8) | payload length (32, big endian) | payload ... |
+ *
+ * Every record type has a fixed field order. Integers in the payload are
+ * LEB128 varints, strings are a varint length followed by the bytes, optional
+ * fields are a one byte presence flag followed by the value and doubles are
+ * their 8 byte big endian bit pattern. Event payloads start with the time since
+ * the previous event in microseconds, zigzag encoded. The length prefix lets a
+ * reader skip record types it does not know.
+ *
+ * Packet records are followed by the frames of the packet, each one a frame tag
+ * and the fields of that frame, up to the end of the payload.
+ */
+
+namespace quic {
+
+constexpr std::array<uint8_t, 8> kBinaryQLogMagic =
+    {'M', 'V', 'Q', 'L', 'O', 'G', 'B', 1};
+
+constexpr folly::StringPiece kBinaryQLogExtension = ".bqlog";
+
+constexpr size_t kBinaryQLogRecordHeaderSize = 5;
+
+enum class BinaryQLogRecordType : uint8_t {
+  // Vantage point and protocol type. Always the first record.
+  TraceInfo = 1,
+  Dcid = 2,
+  Scid = 3,
+  Packet = 4,
+  VersionNegotiation = 5,
+  Retry = 6,
+  ConnectionClose = 7,
+  TransportSummary = 8,
+  CongestionMetricUpdate = 9,
+  CongestionStateUpdate = 10,
+  BandwidthEstUpdate = 11,
+  AppLimitedUpdate = 12,
+  PacingMetricUpdate = 13,
+  PacingObservation = 14,
+  AppIdleUpdate = 15,
+  PacketDrop = 16,
+  DatagramReceived = 17,
+  LossAlarm = 18,
+  PacketsLost = 19,
+  TransportStateUpdate = 20,
+  PacketBuffered = 21,
+  MetricUpdate = 22,
+  StreamStateUpdate = 23,
+  ConnectionMigration = 24,
+  PathValidation = 25,
+  PriorityUpdate = 26,
+  L4sWeightUpdate = 27,
+  NetworkPathModelUpdate = 28,
+  PmtuUpdate = 29,
+};
+
+// Types from here on are events, so a reader can still apply the time delta
+// of an event type it does not know.
+constexpr BinaryQLogRecordType kFirstBinaryQLogEventRecordType =
+    BinaryQLogRecordType::Packet;
+
+enum class BinaryQLogFrameTag : uint8_t {
+  Padding = 1,
+  RstStream = 2,
+  ConnectionClose = 3,
+  MaxData = 4,
+  MaxStreamData = 5,
+  MaxStreams = 6,
+  StreamsBlocked = 7,
+  Ping = 8,
+  DataBlocked = 9,
+  NewToken = 10,
+  ReadNewToken = 11,
+  Knob = 12,
+  AckFrequency = 13,
+  ImmediateAck = 14,
+  Timestamp = 15,
+  StreamDataBlocked = 16,
+  Ack = 17,
+  Stream = 18,
+  Crypto = 19,
+  StopSending = 20,
+  PathChallenge = 21,
+  PathResponse = 22,
+  NewConnectionId = 23,
+  RetireConnectionId = 24,
+  HandshakeDone = 25,
+  Datagram = 26,
+};
+
+} // namespace quic
@@ -0,0 +1,721 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/common/ContiguousCursor.h>
+#include <quic/logging/BinaryQLogFormat.h>
+#include <quic/logging/BinaryQLogReader.h>
+
+#include <fmt/format.h>
+
+#include <cstring>
+#include <type_traits>
+
+namespace quic {
+
+namespace {
+
+/**
+ * Reads the fields of one record payload. A read past the end of the payload
+ * returns a zero value and marks the decoder failed, so callers decode a whole
+ * record and check failed() once.
+ */
+class RecordDecoder {
+ public:
+  explicit RecordDecoder(ByteRange payload)
+      : cursor_(payload.data(), payload.size()) {}
+
+  uint64_t varint() {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      uint8_t byte;
+      if (!cursor_.tryRead(byte)) {
+        failed_ = true;
+        return 0;
+      }
+      value |= uint64_t(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+    failed_ = true;
+    return 0;
+  }
+
+  bool boolean() {
+    uint8_t byte = 0;
+    if (!cursor_.tryRead(byte)) {
+      failed_ = true;
+    }
+    return byte != 0;
+  }
+
+  uint8_t tag() {
+    uint8_t value = 0;
+    if (!cursor_.tryRead(value)) {
+      failed_ = true;
+    }
+    return value;
+  }
+
+  std::string string() {
+    std::string value;
+    auto len = varint();
+    if (failed_ || !cursor_.tryReadFixedSizeString(value, len)) {
+      failed_ = true;
+    }
+    return value;
+  }
+
+  void bytes(uint8_t* out, size_t len) {
+    if (!cursor_.tryPull(out, len)) {
+      failed_ = true;
+    }
+  }
+
+  double fp() {
+    uint64_t bits = 0;
+    if (!cursor_.tryReadBE(bits)) {
+      failed_ = true;
+    }
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  Optional<uint64_t> optional() {
+    if (!boolean()) {
+      return std::nullopt;
+    }
+    return varint();
+  }
+
+  Optional<std::string> optionalString() {
+    if (!boolean()) {
+      return std::nullopt;
+    }
+    return string();
+  }
+
+  std::chrono::microseconds micros() {
+    return std::chrono::microseconds(varint());
+  }
+
+  [[nodiscard]] bool atEnd() const {
+    return cursor_.isAtEnd();
+  }
+
+  [[nodiscard]] bool failed() const {
+    return failed_;
+  }
+
+  void fail() {
+    failed_ = true;
+  }
+
+ private:
+  ContiguousReadCursor cursor_;
+  bool failed_{false};
+};
+
+QuicErrorCode decodeErrorCode(uint64_t type, uint64_t value) {
+  switch (static_cast<QuicErrorCode::Type>(type)) {
+    case QuicErrorCode::Type::LocalErrorCode:
+      return QuicErrorCode(static_cast<LocalErrorCode>(value));
+    case QuicErrorCode::Type::TransportErrorCode:
+      return QuicErrorCode(static_cast<TransportErrorCode>(value));
+    case QuicErrorCode::Type::ApplicationErrorCode:
+      break;
+  }
+  return QuicErrorCode(static_cast<ApplicationErrorCode>(value));
+}
+
+template <typename Range>
+Range decodeTimestampRange(RecordDecoder& decoder) {
+  Range range;
+  if constexpr (std::is_same_v<Range, RecvdPacketsTimestampsRange>) {
+    range.gap = decoder.varint();
+  } else {
+    range.deltaLargestAcknowledged = decoder.varint();
+  }
+  range.timestamp_delta_count = decoder.varint();
+  auto numDeltas = decoder.varint();
+  for (uint64_t i = 0; i < numDeltas && !decoder.failed(); ++i) {
+    range.deltas.push_back(decoder.varint());
+  }
+  return range;
+}
+
+// Received and sent acks serialize identically, so both come back as a
+// WriteAckFrameLog.
+std::unique_ptr<QLogFrame> decodeAckFrame(RecordDecoder& decoder) {
+  WriteAckFrame::AckBlockVec ackBlocks;
+  auto numBlocks = decoder.varint();
+  for (uint64_t i = 0; i < numBlocks && !decoder.failed(); ++i) {
+    auto start = decoder.varint();
+    auto end = decoder.varint();
+    ackBlocks.emplace_back(start, end);
+  }
+  auto ackDelay = decoder.micros();
+  auto frameType = static_cast<FrameType>(decoder.varint());
+  OptionalMicros latestRecvdPacketTime;
+  if (auto time = decoder.optional()) {
+    latestRecvdPacketTime = std::chrono::microseconds(*time);
+  }
+  OptionalIntegral<PacketNum> latestRecvdPacketNum;
+  if (auto packetNum = decoder.optional()) {
+    latestRecvdPacketNum = *packetNum;
+  }
+  RecvdPacketsTimestampsRangeVec timestampRanges;
+  auto numRanges = decoder.varint();
+  for (uint64_t i = 0; i < numRanges && !decoder.failed(); ++i) {
+    timestampRanges.push_back(
+        decodeTimestampRange<RecvdPacketsTimestampsRange>(decoder));
+  }
+  Draft02ReceiveTimestampsRangeVec draft02TimestampRanges;
+  numRanges = decoder.varint();
+  for (uint64_t i = 0; i < numRanges && !decoder.failed(); ++i) {
+    draft02TimestampRanges.push_back(
+        decodeTimestampRange<Draft02ReceiveTimestampsRange>(decoder));
+  }
+  auto ecnECT0Count = decoder.varint();
+  auto ecnECT1Count = decoder.varint();
+  auto ecnCECount = decoder.varint();
+  return std::make_unique<WriteAckFrameLog>(
+      std::move(ackBlocks),
+      ackDelay,
+      frameType,
+      latestRecvdPacketTime,
+      latestRecvdPacketNum,
+      std::move(timestampRanges),
+      std::move(draft02TimestampRanges),
+      ecnECT0Count,
+      ecnECT1Count,
+      ecnCECount);
+}
+
+std::unique_ptr<QLogFrame> decodeFrame(RecordDecoder& decoder) {
+  switch (static_cast<BinaryQLogFrameTag>(decoder.tag())) {
+    case BinaryQLogFrameTag::Padding:
+      return std::make_unique<PaddingFrameLog>(decoder.varint());
+    case BinaryQLogFrameTag::RstStream: {
+      auto streamId = decoder.varint();
+      auto errorCode = decoder.varint();
+      auto finalSize = decoder.varint();
+      return std::make_unique<RstStreamFrameLog>(
+          streamId, errorCode, finalSize);
+    }
+    case BinaryQLogFrameTag::ConnectionClose: {
+      auto errorType = decoder.varint();
+      auto errorValue = decoder.varint();
+      auto reason = decoder.string();
+      auto closingFrameType = static_cast<FrameType>(decoder.varint());
+      return std::make_unique<ConnectionCloseFrameLog>(
+          decodeErrorCode(errorType, errorValue),
+          std::move(reason),
+          closingFrameType);
+    }
+    case BinaryQLogFrameTag::MaxData:
+      return std::make_unique<MaxDataFrameLog>(decoder.varint());
+    case BinaryQLogFrameTag::MaxStreamData: {
+      auto streamId = decoder.varint();
+      auto maximumData = decoder.varint();
+      return std::make_unique<MaxStreamDataFrameLog>(streamId, maximumData);
+    }
+    case BinaryQLogFrameTag::MaxStreams: {
+      auto maxStreams = decoder.varint();
+      auto bidirectional = decoder.boolean();
+      return std::make_unique<MaxStreamsFrameLog>(maxStreams, bidirectional);
+    }
+    case BinaryQLogFrameTag::StreamsBlocked: {
+      auto streamLimit = decoder.varint();
+      auto bidirectional = decoder.boolean();
+      return std::make_unique<StreamsBlockedFrameLog>(
+          streamLimit, bidirectional);
+    }
+    case BinaryQLogFrameTag::Ping:
+      return std::make_unique<PingFrameLog>();
+    case BinaryQLogFrameTag::DataBlocked:
+      return std::make_unique<DataBlockedFrameLog>(decoder.varint());
+    case BinaryQLogFrameTag::NewToken:
+      return std::make_unique<NewTokenFrameLog>(decoder.string());
+    case BinaryQLogFrameTag::ReadNewToken:
+      return std::make_unique<ReadNewTokenFrameLog>();
+    case BinaryQLogFrameTag::Knob: {
+      auto knobSpace = decoder.varint();
+      auto knobId = decoder.varint();
+      auto blobLen = decoder.varint();
+      return std::make_unique<KnobFrameLog>(knobSpace, knobId, blobLen);
+    }
+    case BinaryQLogFrameTag::AckFrequency: {
+      auto sequenceNumber = decoder.varint();
+      auto packetTolerance = decoder.varint();
+      auto updateMaxAckDelay = decoder.varint();
+      auto reorderThreshold = decoder.varint();
+      return std::make_unique<AckFrequencyFrameLog>(
+          sequenceNumber, packetTolerance, updateMaxAckDelay, reorderThreshold);
+    }
+    case BinaryQLogFrameTag::ImmediateAck:
+      return std::make_unique<ImmediateAckFrameLog>();
+    case BinaryQLogFrameTag::Timestamp:
+      return std::make_unique<TimestampFrameLog>(decoder.varint());
+    case BinaryQLogFrameTag::StreamDataBlocked: {
+      auto streamId = decoder.varint();
+      auto dataLimit = decoder.varint();
+      return std::make_unique<StreamDataBlockedFrameLog>(streamId, dataLimit);
+    }
+    case BinaryQLogFrameTag::Ack:
+      return decodeAckFrame(decoder);
+    case BinaryQLogFrameTag::Stream: {
+      auto streamId = decoder.varint();
+      auto offset = decoder.varint();
+      auto len = decoder.varint();
+      auto fin = decoder.boolean();
+      return std::make_unique<StreamFrameLog>(streamId, offset, len, fin);
+    }
+    case BinaryQLogFrameTag::Crypto: {
+      auto offset = decoder.varint();
+      auto len = decoder.varint();
+      return std::make_unique<CryptoFrameLog>(offset, len);
+    }
+    case BinaryQLogFrameTag::StopSending: {
+      auto streamId = decoder.varint();
+      auto errorCode = decoder.varint();
+      return std::make_unique<StopSendingFrameLog>(streamId, errorCode);
+    }
+    case BinaryQLogFrameTag::PathChallenge:
+      return std::make_unique<PathChallengeFrameLog>(decoder.varint());
+    case BinaryQLogFrameTag::PathResponse:
+      return std::make_unique<PathResponseFrameLog>(decoder.varint());
+    case BinaryQLogFrameTag::NewConnectionId: {
+      auto sequence = decoder.varint();
+      StatelessResetToken token{};
+      decoder.bytes(token.data(), token.size());
+      return std::make_unique<NewConnectionIdFrameLog>(sequence, token);
+    }
+    case BinaryQLogFrameTag::RetireConnectionId:
+      return std::make_unique<RetireConnectionIdFrameLog>(decoder.varint());
+    case BinaryQLogFrameTag::HandshakeDone:
+      return std::make_unique<HandshakeDoneFrameLog>();
+    case BinaryQLogFrameTag::Datagram:
+      return std::make_unique<DatagramFrameLog>(decoder.varint());
+  }
+  // Frames carry no length, so an unknown one ends the whole record.
+  decoder.fail();
+  return nullptr;
+}
+
+std::unique_ptr<QLogEvent> decodePacket(
+    RecordDecoder& decoder,
+    std::chrono::microseconds refTime) {
+  auto event = std::make_unique<QLogPacketEvent>();
+  event->refTime = refTime;
+  event->eventType = decoder.boolean() ? QLogEventType::PacketReceived
+                                       : QLogEventType::PacketSent;
+  event->packetType = decoder.string();
+  event->packetNum = decoder.varint();
+  event->packetSize = decoder.varint();
+  while (!decoder.atEnd() && !decoder.failed()) {
+    auto frame = decodeFrame(decoder);
+    if (frame) {
+      event->frames.push_back(std::move(frame));
+    }
+  }
+  return event;
+}
+
+std::unique_ptr<QLogEvent> decodeEvent(
+    BinaryQLogRecordType type,
+    RecordDecoder& decoder,
+    std::chrono::microseconds refTime,
+    VantagePoint vantagePoint) {
+  switch (type) {
+    case BinaryQLogRecordType::Packet:
+      return decodePacket(decoder, refTime);
+    case BinaryQLogRecordType::VersionNegotiation: {
+      auto event = std::make_unique<QLogVersionNegotiationEvent>();
+      event->refTime = refTime;
+      event->eventType = decoder.boolean() ? QLogEventType::PacketReceived
+                                           : QLogEventType::PacketSent;
+      event->packetType = kVersionNegotiationPacketType;
+      event->packetSize = decoder.varint();
+      std::vector<QuicVersion> versions;
+      auto numVersions = decoder.varint();
+      for (uint64_t i = 0; i < numVersions && !decoder.failed(); ++i) {
+        versions.push_back(static_cast<QuicVersion>(decoder.varint()));
+      }
+      event->versionLog = std::make_unique<VersionNegotiationLog>(versions);
+      return event;
+    }
+    case BinaryQLogRecordType::Retry: {
+      auto event = std::make_unique<QLogRetryEvent>();
+      event->refTime = refTime;
+      event->eventType = decoder.boolean() ? QLogEventType::PacketReceived
+                                           : QLogEventType::PacketSent;
+      event->packetType = decoder.string();
+      event->packetSize = decoder.varint();
+      event->tokenSize = decoder.varint();
+      return event;
+    }
+    case BinaryQLogRecordType::ConnectionClose: {
+      auto error = decoder.string();
+      auto reason = decoder.string();
+      auto drainConnection = decoder.boolean();
+      auto sendCloseImmediately = decoder.boolean();
+      return std::make_unique<QLogConnectionCloseEvent>(
+          std::move(error),
+          std::move(reason),
+          drainConnection,
+          sendCloseImmediately,
+          refTime);
+    }
+    case BinaryQLogRecordType::TransportSummary: {
+      QLogger::TransportSummaryArgs args;
+      args.totalBytesSent = decoder.varint();
+      args.totalBytesRecvd = decoder.varint();
+      args.sumCurWriteOffset = decoder.varint();
+      args.sumMaxObservedOffset = decoder.varint();
+      args.sumCurStreamBufferLen = decoder.varint();
+      args.totalBytesRetransmitted = decoder.varint();
+      args.totalStreamBytesCloned = decoder.varint();
+      args.totalBytesCloned = decoder.varint();
+      args.totalCryptoDataWritten = decoder.varint();
+      args.totalCryptoDataRecvd = decoder.varint();
+      args.currentWritableBytes = decoder.varint();
+      args.currentConnFlowControl = decoder.varint();
+      args.totalPacketsSpuriouslyMarkedLost = decoder.varint();
+      args.finalPacketLossReorderingThreshold = decoder.varint();
+      args.finalPacketLossTimeReorderingThreshDividend = decoder.varint();
+      args.usedZeroRtt = decoder.boolean();
+      args.quicVersion = static_cast<QuicVersion>(decoder.varint());
+      args.initialPacketsReceived = decoder.varint();
+      args.uniqueInitialCryptoFramesReceived = decoder.varint();
+      args.timeUntilLastInitialCryptoFrameReceived =
+          std::chrono::milliseconds(decoder.varint());
+      args.alpn = decoder.string();
+      args.namedGroup = decoder.string();
+      args.pskType = decoder.string();
+      args.echStatus = decoder.string();
+      return std::make_unique<QLogTransportSummaryEvent>(
+          args.totalBytesSent,
+          args.totalBytesRecvd,
+          args.sumCurWriteOffset,
+          args.sumMaxObservedOffset,
+          args.sumCurStreamBufferLen,
+          args.totalBytesRetransmitted,
+          args.totalStreamBytesCloned,
+          args.totalBytesCloned,
+          args.totalCryptoDataWritten,
+          args.totalCryptoDataRecvd,
+          args.currentWritableBytes,
+          args.currentConnFlowControl,
+          args.totalPacketsSpuriouslyMarkedLost,
+          args.finalPacketLossReorderingThreshold,
+          args.finalPacketLossTimeReorderingThreshDividend,
+          args.usedZeroRtt,
+          args.quicVersion,
+          args.initialPacketsReceived,
+          args.uniqueInitialCryptoFramesReceived,
+          args.timeUntilLastInitialCryptoFrameReceived,
+          std::move(args.alpn),
+          std::move(args.namedGroup),
+          std::move(args.pskType),
+          std::move(args.echStatus),
+          refTime);
+    }
+    case BinaryQLogRecordType::CongestionMetricUpdate: {
+      auto bytesInFlight = decoder.varint();
+      auto currentCwnd = decoder.varint();
+      auto congestionEvent = decoder.string();
+      auto state = decoder.string();
+      auto recoveryState = decoder.string();
+      return std::make_unique<QLogCongestionMetricUpdateEvent>(
+          bytesInFlight,
+          currentCwnd,
+          std::move(congestionEvent),
+          std::move(state),
+          std::move(recoveryState),
+          refTime);
+    }
+    case BinaryQLogRecordType::CongestionStateUpdate: {
+      auto oldState = decoder.optionalString();
+      auto newState = decoder.string();
+      auto trigger = decoder.optionalString();
+      auto resumption = decoder.optional();
+      return std::make_unique<QLogCongestionStateUpdateEvent>(
+          std::move(oldState),
+          std::move(newState),
+          std::move(trigger),
+          resumption,
+          refTime);
+    }
+    case BinaryQLogRecordType::BandwidthEstUpdate: {
+      auto bytes = decoder.varint();
+      auto interval = decoder.micros();
+      return std::make_unique<QLogBandwidthEstUpdateEvent>(
+          bytes, interval, refTime);
+    }
+    case BinaryQLogRecordType::AppLimitedUpdate:
+      return std::make_unique<QLogAppLimitedUpdateEvent>(
+          decoder.boolean(), refTime);
+    case BinaryQLogRecordType::PacingMetricUpdate: {
+      auto burstSize = decoder.varint();
+      auto interval = decoder.micros();
+      return std::make_unique<QLogPacingMetricUpdateEvent>(
+          burstSize, interval, refTime);
+    }
+    case BinaryQLogRecordType::PacingObservation: {
+      auto actual = decoder.string();
+      auto expected = decoder.string();
+      auto conclusion = decoder.string();
+      return std::make_unique<QLogPacingObservationEvent>(
+          std::move(actual), std::move(expected), std::move(conclusion), refTime);
+    }
+    case BinaryQLogRecordType::AppIdleUpdate: {
+      auto idleEvent = decoder.string();
+      auto idle = decoder.boolean();
+      return std::make_unique<QLogAppIdleUpdateEvent>(
+          std::move(idleEvent), idle, refTime);
+    }
+    case BinaryQLogRecordType::PacketDrop: {
+      auto packetSize = decoder.varint();
+      auto dropReason = decoder.string();
+      return std::make_unique<QLogPacketDropEvent>(
+          packetSize, std::move(dropReason), refTime);
+    }
+    case BinaryQLogRecordType::DatagramReceived:
+      return std::make_unique<QLogDatagramReceivedEvent>(
+          decoder.varint(), refTime);
+    case BinaryQLogRecordType::LossAlarm: {
+      auto largestSent = decoder.varint();
+      auto alarmCount = decoder.varint();
+      auto outstandingPackets = decoder.varint();
+      auto alarmType = decoder.string();
+      return std::make_unique<QLogLossAlarmEvent>(
+          largestSent,
+          alarmCount,
+          outstandingPackets,
+          std::move(alarmType),
+          refTime);
+    }
+    case BinaryQLogRecordType::PacketsLost: {
+      auto largestLost = decoder.varint();
+      auto lostBytes = decoder.varint();
+      auto lostPackets = decoder.varint();
+      return std::make_unique<QLogPacketsLostEvent>(
+          largestLost, lostBytes, lostPackets, refTime);
+    }
+    case BinaryQLogRecordType::TransportStateUpdate:
+      return std::make_unique<QLogTransportStateUpdateEvent>(
+          decoder.string(), refTime);
+    case BinaryQLogRecordType::PacketBuffered: {
+      auto protectionType = static_cast<ProtectionType>(decoder.varint());
+      auto packetSize = decoder.varint();
+      return std::make_unique<QLogPacketBufferedEvent>(
+          protectionType, packetSize, refTime);
+    }
+    case BinaryQLogRecordType::MetricUpdate: {
+      auto latestRtt = decoder.micros();
+      auto mrtt = decoder.micros();
+      auto srtt = decoder.micros();
+      auto ackDelay = decoder.micros();
+      Optional<std::chrono::microseconds> rttVar;
+      if (auto value = decoder.optional()) {
+        rttVar = std::chrono::microseconds(*value);
+      }
+      auto congestionWindow = decoder.optional();
+      auto bytesInFlight = decoder.optional();
+      auto ssthresh = decoder.optional();
+      auto packetsInFlight = decoder.optional();
+      auto pacingRate = decoder.optional();
+      Optional<uint32_t> ptoCount;
+      if (auto value = decoder.optional()) {
+        ptoCount = static_cast<uint32_t>(*value);
+      }
+      return std::make_unique<QLogMetricUpdateEvent>(
+          latestRtt,
+          mrtt,
+          srtt,
+          ackDelay,
+          refTime,
+          rttVar,
+          congestionWindow,
+          bytesInFlight,
+          ssthresh,
+          packetsInFlight,
+          pacingRate,
+          ptoCount);
+    }
+    case BinaryQLogRecordType::StreamStateUpdate: {
+      auto id = decoder.varint();
+      auto update = decoder.string();
+      Optional<std::chrono::milliseconds> timeSinceStreamCreation;
+      if (auto value = decoder.optional()) {
+        timeSinceStreamCreation = std::chrono::milliseconds(*value);
+      }
+      return std::make_unique<QLogStreamStateUpdateEvent>(
+          id,
+          std::move(update),
+          timeSinceStreamCreation,
+          vantagePoint,
+          refTime);
+    }
+    case BinaryQLogRecordType::ConnectionMigration:
+      return std::make_unique<QLogConnectionMigrationEvent>(
+          decoder.boolean(), vantagePoint, refTime);
+    case BinaryQLogRecordType::PathValidation:
+      return std::make_unique<QLogPathValidationEvent>(
+          decoder.boolean(), vantagePoint, refTime);
+    case BinaryQLogRecordType::PriorityUpdate: {
+      auto streamId = decoder.varint();
+      PriorityQueue::PriorityLogFields fields;
+      auto numFields = decoder.varint();
+      for (uint64_t i = 0; i < numFields && !decoder.failed(); ++i) {
+        auto key = decoder.string();
+        auto value = decoder.string();
+        fields.emplace_back(std::move(key), std::move(value));
+      }
+      return std::make_unique<QLogPriorityUpdateEvent>(
+          streamId, std::move(fields), refTime);
+    }
+    case BinaryQLogRecordType::L4sWeightUpdate: {
+      auto l4sWeight = decoder.fp();
+      auto newEct1 = static_cast<uint32_t>(decoder.varint());
+      auto newCe = static_cast<uint32_t>(decoder.varint());
+      return std::make_unique<QLogL4sWeightUpdateEvent>(
+          l4sWeight, newEct1, newCe, refTime);
+    }
+    case BinaryQLogRecordType::NetworkPathModelUpdate: {
+      auto inflightHi = decoder.varint();
+      auto inflightLo = decoder.varint();
+      auto bandwidthHiBytes = decoder.varint();
+      auto bandwidthHiInterval = decoder.micros();
+      auto bandwidthLoBytes = decoder.varint();
+      auto bandwidthLoInterval = decoder.micros();
+      return std::make_unique<QLogNetworkPathModelUpdateEvent>(
+          inflightHi,
+          inflightLo,
+          bandwidthHiBytes,
+          bandwidthHiInterval,
+          bandwidthLoBytes,
+          bandwidthLoInterval,
+          refTime);
+    }
+    case BinaryQLogRecordType::PmtuUpdate: {
+      auto probeSize = decoder.varint();
+      auto packetSize = decoder.varint();
+      auto trigger = decoder.string();
+      return std::make_unique<QLogPmtuUpdateEvent>(
+          probeSize, packetSize, std::move(trigger), refTime);
+    }
+    case BinaryQLogRecordType::TraceInfo:
+    case BinaryQLogRecordType::Dcid:
+    case BinaryQLogRecordType::Scid:
+      break;
+  }
+  // A newer writer's event. Skipped, its time delta has been applied already.
+  return nullptr;
+}
+
+Optional<ConnectionId> decodeConnectionId(RecordDecoder& decoder) {
+  auto len = decoder.varint();
+  if (decoder.failed() || len > kMaxConnectionIdSize) {
+    decoder.fail();
+    return std::nullopt;
+  }
+  std::vector<uint8_t> bytes(len);
+  decoder.bytes(bytes.data(), bytes.size());
+  if (decoder.failed()) {
+    return std::nullopt;
+  }
+  auto connId = ConnectionId::create(bytes);
+  if (connId.hasError()) {
+    decoder.fail();
+    return std::nullopt;
+  }
+  return connId.value();
+}
+
+QuicError malformed(std::string message) {
+  return QuicError(LocalErrorCode::CODEC_ERROR, std::move(message));
+}
+
+} // namespace
+
+quic::Expected<std::unique_ptr<FileQLogger>, QuicError> readBinaryQLog(
+    ByteRange data) {
+  ContiguousReadCursor cursor(data.data(), data.size());
+  std::array<uint8_t, kBinaryQLogMagic.size()> magic{};
+  if (!cursor.tryPull(magic.data(), magic.size()) ||
+      magic != kBinaryQLogMagic) {
+    return quic::make_unexpected(malformed("Not a binary qlog file"));
+  }
+
+  std::unique_ptr<FileQLogger> logger;
+  std::chrono::microseconds refTime{0};
+  while (!cursor.isAtEnd()) {
+    uint8_t rawType = 0;
+    uint32_t length = 0;
+    if (!cursor.tryRead(rawType) || !cursor.tryReadBE(length) ||
+        !cursor.canAdvance(length)) {
+      // Truncated by a writer that did not get to finish.
+      break;
+    }
+    RecordDecoder decoder(ByteRange(cursor.data(), length));
+    cursor.skip(length);
+    auto type = static_cast<BinaryQLogRecordType>(rawType);
+
+    if (type == BinaryQLogRecordType::TraceInfo) {
+      auto vantagePoint = static_cast<VantagePoint>(decoder.varint());
+      auto protocolType = decoder.string();
+      if (decoder.failed()) {
+        return quic::make_unexpected(malformed("Malformed trace info record"));
+      }
+      logger =
+          std::make_unique<FileQLogger>(vantagePoint, std::move(protocolType));
+      continue;
+    }
+    if (!logger) {
+      return quic::make_unexpected(malformed("Missing trace info record"));
+    }
+
+    if (type == BinaryQLogRecordType::Dcid ||
+        type == BinaryQLogRecordType::Scid) {
+      auto connId = decodeConnectionId(decoder);
+      if (decoder.failed()) {
+        return quic::make_unexpected(malformed("Malformed connection id"));
+      }
+      if (type == BinaryQLogRecordType::Dcid) {
+        logger->dcid = connId;
+      } else {
+        logger->scid = connId;
+      }
+      continue;
+    }
+    if (rawType < static_cast<uint8_t>(kFirstBinaryQLogEventRecordType)) {
+      // Metadata of a newer writer.
+      continue;
+    }
+
+    auto zigzag = decoder.varint();
+    refTime += std::chrono::microseconds(
+        static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1));
+    auto event = decodeEvent(type, decoder, refTime, logger->vantagePoint);
+    if (decoder.failed()) {
+      return quic::make_unexpected(malformed(
+          fmt::format("Malformed record of type {}", unsigned(rawType))));
+    }
+    if (event) {
+      logger->logs.push_back(std::move(event));
+    }
+  }
+  if (!logger) {
+    return quic::make_unexpected(malformed("Missing trace info record"));
+  }
+  return logger;
+}
+
+} // namespace quic
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/QuicException.h>
+#include <quic/common/Expected.h>
+#include <quic/logging/FileQLogger.h>
+
+namespace quic {
+
+/**
+ * Decodes the contents of a file written by BinaryQLogger into a FileQLogger
+ * holding the same events, so that toDynamic() and outputLogsToFile() produce
+ * the usual qlog JSON. Records of unknown types are skipped. A truncated
+ * trailing record, as left behind by a process that died mid-write, ends the
+ * trace instead of failing the whole file.
+ */
+[[nodiscard]] quic::Expected<std::unique_ptr<FileQLogger>, QuicError>
+readBinaryQLog(ByteRange data);
+
+} // namespace quic
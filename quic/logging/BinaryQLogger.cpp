@@ -0,0 +1,1017 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/common/MvfstLogging.h>
+#include <quic/common/StringUtils.h>
+#include <quic/logging/BinaryQLogger.h>
+
+#include <folly/FileUtil.h>
+#include <folly/lang/Bits.h>
+
+#include <fcntl.h>
+#include <cstring>
+#include <future>
+#include <type_traits>
+#include <unordered_set>
+
+namespace {
+std::chrono::microseconds nowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+}
+} // namespace
+
+namespace quic {
+
+class BinaryQLogWriter::File {
+ public:
+  explicit File(std::string path) : path_(std::move(path)) {}
+
+  ~File() {
+    if (fd_ != -1) {
+      folly::closeNoInt(fd_);
+    }
+  }
+
+  File(const File&) = delete;
+  File& operator=(const File&) = delete;
+
+  // Only called on the writer thread.
+  void write(const std::string& data) {
+    if (failed_) {
+      return;
+    }
+    if (fd_ == -1) {
+      fd_ = folly::openNoInt(
+          path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+      if (fd_ == -1) {
+        MVLOG_ERROR << "Error creating binary qlog file " << path_ << ". "
+                    << quic::errnoStr(errno);
+        failed_ = true;
+        return;
+      }
+    }
+    if (folly::writeFull(fd_, data.data(), data.size()) !=
+        static_cast<ssize_t>(data.size())) {
+      MVLOG_ERROR << "Error writing binary qlog file " << path_ << ". "
+                  << quic::errnoStr(errno);
+      failed_ = true;
+    }
+  }
+
+ private:
+  friend class BinaryQLogWriter;
+
+  std::string path_;
+  int fd_{-1};
+  bool failed_{false};
+  // Set under the writer's mutex once a write to this file was dropped.
+  bool truncated_{false};
+};
+
+BinaryQLogWriter::BinaryQLogWriter(size_t maxQueuedBytes)
+    : maxQueuedBytes_(maxQueuedBytes), thread_([this] { loop(); }) {}
+
+BinaryQLogWriter::~BinaryQLogWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+std::shared_ptr<BinaryQLogWriter> BinaryQLogWriter::getDefault() {
+  static auto writer = std::make_shared<BinaryQLogWriter>();
+  return writer;
+}
+
+std::shared_ptr<BinaryQLogWriter::File> BinaryQLogWriter::makeFile(
+    std::string path) {
+  return std::make_shared<File>(std::move(path));
+}
+
+bool BinaryQLogWriter::write(std::shared_ptr<File> file, std::string data) {
+  auto bytes = data.size();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file->truncated_) {
+      numDropped_++;
+      numDroppedBytes_ += bytes;
+      return false;
+    }
+    if (!reserveLocked(bytes)) {
+      file->truncated_ = true;
+      MVLOG_WARNING << "Binary qlog writer queue is full, truncating "
+                    << file->path_;
+      return false;
+    }
+    tasks_.push_back(Task{
+        [file = std::move(file), data = std::move(data)] {
+          file->write(data);
+        },
+        bytes});
+  }
+  cv_.notify_one();
+  return true;
+}
+
+bool BinaryQLogWriter::run(std::function<void()> task, size_t bytes) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!reserveLocked(bytes)) {
+      return false;
+    }
+    tasks_.push_back(Task{std::move(task), bytes});
+  }
+  cv_.notify_one();
+  return true;
+}
+
+bool BinaryQLogWriter::reserveLocked(size_t bytes) {
+  if (bytes > 0 && queuedBytes_ + bytes > maxQueuedBytes_) {
+    numDropped_++;
+    numDroppedBytes_ += bytes;
+    return false;
+  }
+  queuedBytes_ += bytes;
+  return true;
+}
+
+uint64_t BinaryQLogWriter::numDropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return numDropped_;
+}
+
+uint64_t BinaryQLogWriter::numDroppedBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return numDroppedBytes_;
+}
+
+void BinaryQLogWriter::flush() {
+  MVCHECK(std::this_thread::get_id() != thread_.get_id());
+  std::promise<void> done;
+  auto future = done.get_future();
+  run([&done] { done.set_value(); });
+  future.wait();
+}
+
+void BinaryQLogWriter::loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+    if (tasks_.empty()) {
+      // Only reached when stopping, after everything queued is done.
+      return;
+    }
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    lock.unlock();
+    task.fn();
+    // Drop what the task holds, e.g. the last reference to a file, before
+    // waiting again.
+    task.fn = nullptr;
+    lock.lock();
+    queuedBytes_ -= task.bytes;
+  }
+}
+
+BinaryQLogger::BinaryQLogger(
+    VantagePoint vantagePointIn,
+    std::string protocolTypeIn,
+    std::string path,
+    size_t flushThreshold,
+    size_t maxBufferedBytes,
+    std::shared_ptr<BinaryQLogWriter> writer)
+    : QLogger(vantagePointIn, std::move(protocolTypeIn)),
+      path_(std::move(path)),
+      flushThreshold_(flushThreshold),
+      maxBufferedBytes_(maxBufferedBytes),
+      writer_(std::move(writer)) {
+  buffer_.reserve(flushThreshold_ + kBinaryQLogRecordHeaderSize);
+  buffer_.append(
+      reinterpret_cast<const char*>(kBinaryQLogMagic.data()),
+      kBinaryQLogMagic.size());
+  auto lengthOffset = beginRecord(BinaryQLogRecordType::TraceInfo);
+  writeVarint(static_cast<uint64_t>(vantagePoint));
+  writeString(protocolType);
+  endRecord(lengthOffset);
+}
+
+BinaryQLogger::~BinaryQLogger() {
+  flush();
+}
+
+void BinaryQLogger::setDcid(Optional<ConnectionId> connID) {
+  if (!connID.has_value()) {
+    return;
+  }
+  dcid = connID.value();
+  writeConnectionId(BinaryQLogRecordType::Dcid, *dcid);
+  if (file_ || path_.empty()) {
+    return;
+  }
+  openFile();
+}
+
+void BinaryQLogger::openFile() {
+  file_ = BinaryQLogWriter::makeFile(
+      fmt::format("{}/{}{}", path_, dcid->hex(), kBinaryQLogExtension));
+  flush();
+}
+
+BinaryQLogWriter& BinaryQLogger::writer() {
+  if (!writer_) {
+    writer_ = BinaryQLogWriter::getDefault();
+  }
+  return *writer_;
+}
+
+void BinaryQLogger::setScid(Optional<ConnectionId> connID) {
+  if (!connID.has_value()) {
+    return;
+  }
+  scid = connID.value();
+  writeConnectionId(BinaryQLogRecordType::Scid, *scid);
+}
+
+void BinaryQLogger::flush() {
+  if (!file_ || buffer_.empty()) {
+    return;
+  }
+  writer().write(file_, std::move(buffer_));
+  buffer_.clear();
+  buffer_.reserve(flushThreshold_ + kBinaryQLogRecordHeaderSize);
+}
+
+size_t BinaryQLogger::beginRecord(BinaryQLogRecordType type) {
+  buffer_.push_back(static_cast<char>(type));
+  auto lengthOffset = buffer_.size();
+  buffer_.append(sizeof(uint32_t), '\0');
+  return lengthOffset;
+}
+
+size_t BinaryQLogger::beginEvent(BinaryQLogRecordType type) {
+  auto lengthOffset = beginRecord(type);
+  auto now = nowMicros();
+  // Zigzag so that a clock going backwards still round trips.
+  auto delta = (now - lastEventTime_).count();
+  writeVarint((static_cast<uint64_t>(delta) << 1) ^ (delta >> 63));
+  previousEventTime_ = lastEventTime_;
+  lastEventTime_ = now;
+  return lengthOffset;
+}
+
+void BinaryQLogger::endRecord(size_t lengthOffset) {
+  auto length = folly::Endian::big(static_cast<uint32_t>(
+      buffer_.size() - lengthOffset - sizeof(uint32_t)));
+  std::memcpy(&buffer_[lengthOffset], &length, sizeof(length));
+  onRecordWritten(lengthOffset - 1);
+}
+
+void BinaryQLogger::onRecordWritten(size_t recordOffset) {
+  if (!file_ && buffer_.size() > maxBufferedBytes_ &&
+      static_cast<uint8_t>(buffer_[recordOffset]) >=
+          static_cast<uint8_t>(kFirstBinaryQLogEventRecordType)) {
+    // Nowhere to write it to yet. The trace header is always kept.
+    buffer_.resize(recordOffset);
+    lastEventTime_ = previousEventTime_;
+    numDroppedEvents_++;
+    return;
+  }
+  if (buffer_.size() >= flushThreshold_) {
+    flush();
+  }
+}
+
+void BinaryQLogger::writeVarint(uint64_t value) {
+  while (value >= 0x80) {
+    buffer_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer_.push_back(static_cast<char>(value));
+}
+
+void BinaryQLogger::writeBool(bool value) {
+  buffer_.push_back(value ? 1 : 0);
+}
+
+void BinaryQLogger::writeString(folly::StringPiece value) {
+  writeVarint(value.size());
+  buffer_.append(value.data(), value.size());
+}
+
+void BinaryQLogger::writeBytes(const uint8_t* data, size_t len) {
+  buffer_.append(reinterpret_cast<const char*>(data), len);
+}
+
+void BinaryQLogger::writeDouble(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  bits = folly::Endian::big(bits);
+  buffer_.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+}
+
+void BinaryQLogger::writeOptional(const Optional<uint64_t>& value) {
+  writeBool(value.has_value());
+  if (value.has_value()) {
+    writeVarint(*value);
+  }
+}
+
+void BinaryQLogger::writeFrameTag(BinaryQLogFrameTag tag) {
+  buffer_.push_back(static_cast<char>(tag));
+}
+
+void BinaryQLogger::writeConnectionId(
+    BinaryQLogRecordType type,
+    const ConnectionId& connId) {
+  auto lengthOffset = beginRecord(type);
+  writeVarint(connId.size());
+  writeBytes(connId.data(), connId.size());
+  endRecord(lengthOffset);
+}
+
+template <typename Frame>
+void BinaryQLogger::writeAckFrame(const Frame& frame) {
+  writeFrameTag(BinaryQLogFrameTag::Ack);
+  writeVarint(frame.ackBlocks.size());
+  for (const auto& block : frame.ackBlocks) {
+    if constexpr (std::is_same_v<Frame, ReadAckFrame>) {
+      writeVarint(block.startPacket);
+      writeVarint(block.endPacket);
+    } else {
+      writeVarint(block.start);
+      writeVarint(block.end);
+    }
+  }
+  writeVarint(frame.ackDelay.count());
+  writeVarint(static_cast<uint64_t>(frame.frameType));
+  writeOptional(
+      frame.maybeLatestRecvdPacketTime.has_value()
+          ? Optional<uint64_t>(frame.maybeLatestRecvdPacketTime->count())
+          : std::nullopt);
+  writeOptional(
+      frame.maybeLatestRecvdPacketNum.has_value()
+          ? Optional<uint64_t>(frame.maybeLatestRecvdPacketNum.value())
+          : std::nullopt);
+  writeVarint(frame.recvdPacketsTimestampRanges.size());
+  for (const auto& range : frame.recvdPacketsTimestampRanges) {
+    writeVarint(range.gap);
+    writeVarint(range.timestamp_delta_count);
+    writeVarint(range.deltas.size());
+    for (auto delta : range.deltas) {
+      writeVarint(delta);
+    }
+  }
+  writeVarint(frame.draft02RecvdPacketsTimestampRanges.size());
+  for (const auto& range : frame.draft02RecvdPacketsTimestampRanges) {
+    writeVarint(range.deltaLargestAcknowledged);
+    writeVarint(range.timestamp_delta_count);
+    writeVarint(range.deltas.size());
+    for (auto delta : range.deltas) {
+      writeVarint(delta);
+    }
+  }
+  writeVarint(frame.ecnECT0Count);
+  writeVarint(frame.ecnECT1Count);
+  writeVarint(frame.ecnCECount);
+}
+
+void BinaryQLogger::writeConnectionCloseFrame(
+    const ConnectionCloseFrame& frame) {
+  writeFrameTag(BinaryQLogFrameTag::ConnectionClose);
+  writeVarint(static_cast<uint64_t>(frame.errorCode.type()));
+  switch (frame.errorCode.type()) {
+    case QuicErrorCode::Type::ApplicationErrorCode:
+      writeVarint(*frame.errorCode.asApplicationErrorCode());
+      break;
+    case QuicErrorCode::Type::LocalErrorCode:
+      writeVarint(static_cast<uint64_t>(*frame.errorCode.asLocalErrorCode()));
+      break;
+    case QuicErrorCode::Type::TransportErrorCode:
+      writeVarint(
+          static_cast<uint64_t>(*frame.errorCode.asTransportErrorCode()));
+      break;
+  }
+  writeString(frame.reasonPhrase);
+  writeVarint(static_cast<uint64_t>(frame.closingFrameType));
+}
+
+void BinaryQLogger::writeSimpleFrame(const QuicSimpleFrame& simpleFrame) {
+  switch (simpleFrame.type()) {
+    case QuicSimpleFrame::Type::StopSendingFrame: {
+      const auto& frame = *simpleFrame.asStopSendingFrame();
+      writeFrameTag(BinaryQLogFrameTag::StopSending);
+      writeVarint(frame.streamId);
+      writeVarint(frame.errorCode);
+      break;
+    }
+    case QuicSimpleFrame::Type::PathChallengeFrame: {
+      writeFrameTag(BinaryQLogFrameTag::PathChallenge);
+      writeVarint(simpleFrame.asPathChallengeFrame()->pathData);
+      break;
+    }
+    case QuicSimpleFrame::Type::PathResponseFrame: {
+      writeFrameTag(BinaryQLogFrameTag::PathResponse);
+      writeVarint(simpleFrame.asPathResponseFrame()->pathData);
+      break;
+    }
+    case QuicSimpleFrame::Type::NewConnectionIdFrame: {
+      const auto& frame = *simpleFrame.asNewConnectionIdFrame();
+      writeFrameTag(BinaryQLogFrameTag::NewConnectionId);
+      writeVarint(frame.sequenceNumber);
+      writeBytes(frame.token.data(), frame.token.size());
+      break;
+    }
+    case QuicSimpleFrame::Type::MaxStreamsFrame: {
+      const auto& frame = *simpleFrame.asMaxStreamsFrame();
+      writeFrameTag(BinaryQLogFrameTag::MaxStreams);
+      writeVarint(frame.maxStreams);
+      writeBool(frame.isForBidirectional);
+      break;
+    }
+    case QuicSimpleFrame::Type::RetireConnectionIdFrame: {
+      writeFrameTag(BinaryQLogFrameTag::RetireConnectionId);
+      writeVarint(simpleFrame.asRetireConnectionIdFrame()->sequenceNumber);
+      break;
+    }
+    case QuicSimpleFrame::Type::HandshakeDoneFrame: {
+      writeFrameTag(BinaryQLogFrameTag::HandshakeDone);
+      break;
+    }
+    case QuicSimpleFrame::Type::KnobFrame: {
+      const auto& frame = *simpleFrame.asKnobFrame();
+      writeFrameTag(BinaryQLogFrameTag::Knob);
+      writeVarint(frame.knobSpace);
+      writeVarint(frame.id);
+      writeVarint(frame.blob->length());
+      break;
+    }
+    case QuicSimpleFrame::Type::AckFrequencyFrame: {
+      const auto& frame = *simpleFrame.asAckFrequencyFrame();
+      writeFrameTag(BinaryQLogFrameTag::AckFrequency);
+      writeVarint(frame.sequenceNumber);
+      writeVarint(frame.packetTolerance);
+      writeVarint(frame.updateMaxAckDelay);
+      writeVarint(frame.reorderThreshold);
+      break;
+    }
+    case QuicSimpleFrame::Type::NewTokenFrame: {
+      const auto& frame = *simpleFrame.asNewTokenFrame();
+      writeFrameTag(BinaryQLogFrameTag::NewToken);
+      writeString(hexlify(frame.token->coalesce()));
+      break;
+    }
+  }
+}
+
+void BinaryQLogger::addPacket(
+    const RegularQuicPacket& regularPacket,
+    uint64_t packetSize) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::Packet);
+  writeBool(true /* received */);
+  const ShortHeader* shortHeader = regularPacket.header.asShort();
+  folly::StringPiece packetType = shortHeader
+      ? kShortHeaderPacketType
+      : toQlogString(regularPacket.header.asLong()->getHeaderType());
+  writeString(packetType);
+  // A Retry packet does not include a packet number.
+  writeVarint(
+      packetType != toString(LongHeader::Types::Retry)
+          ? regularPacket.header.getPacketSequenceNum()
+          : 0);
+  writeVarint(packetSize);
+
+  uint64_t numPaddingFrames = 0;
+  for (const auto& quicFrame : regularPacket.frames) {
+    switch (quicFrame.type()) {
+      case QuicFrame::Type::PaddingFrame:
+        numPaddingFrames += quicFrame.asPaddingFrame()->numFrames;
+        break;
+      case QuicFrame::Type::RstStreamFrame: {
+        const auto& frame = *quicFrame.asRstStreamFrame();
+        writeFrameTag(BinaryQLogFrameTag::RstStream);
+        writeVarint(frame.streamId);
+        writeVarint(frame.errorCode);
+        writeVarint(frame.finalSize);
+        break;
+      }
+      case QuicFrame::Type::ConnectionCloseFrame:
+        writeConnectionCloseFrame(*quicFrame.asConnectionCloseFrame());
+        break;
+      case QuicFrame::Type::MaxDataFrame: {
+        writeFrameTag(BinaryQLogFrameTag::MaxData);
+        writeVarint(quicFrame.asMaxDataFrame()->maximumData);
+        break;
+      }
+      case QuicFrame::Type::MaxStreamDataFrame: {
+        const auto& frame = *quicFrame.asMaxStreamDataFrame();
+        writeFrameTag(BinaryQLogFrameTag::MaxStreamData);
+        writeVarint(frame.streamId);
+        writeVarint(frame.maximumData);
+        break;
+      }
+      case QuicFrame::Type::DataBlockedFrame: {
+        writeFrameTag(BinaryQLogFrameTag::DataBlocked);
+        writeVarint(quicFrame.asDataBlockedFrame()->dataLimit);
+        break;
+      }
+      case QuicFrame::Type::StreamDataBlockedFrame: {
+        const auto& frame = *quicFrame.asStreamDataBlockedFrame();
+        writeFrameTag(BinaryQLogFrameTag::StreamDataBlocked);
+        writeVarint(frame.streamId);
+        writeVarint(frame.dataLimit);
+        break;
+      }
+      case QuicFrame::Type::StreamsBlockedFrame: {
+        const auto& frame = *quicFrame.asStreamsBlockedFrame();
+        writeFrameTag(BinaryQLogFrameTag::StreamsBlocked);
+        writeVarint(frame.streamLimit);
+        writeBool(frame.isForBidirectional);
+        break;
+      }
+      case QuicFrame::Type::ReadAckFrame:
+        writeAckFrame(*quicFrame.asReadAckFrame());
+        break;
+      case QuicFrame::Type::ReadStreamFrame: {
+        const auto& frame = *quicFrame.asReadStreamFrame();
+        writeFrameTag(BinaryQLogFrameTag::Stream);
+        writeVarint(frame.streamId);
+        writeVarint(frame.offset);
+        writeVarint(frame.data->length());
+        writeBool(frame.fin);
+        break;
+      }
+      case QuicFrame::Type::ReadCryptoFrame: {
+        const auto& frame = *quicFrame.asReadCryptoFrame();
+        writeFrameTag(BinaryQLogFrameTag::Crypto);
+        writeVarint(frame.offset);
+        writeVarint(frame.data->length());
+        break;
+      }
+      case QuicFrame::Type::ReadNewTokenFrame:
+        writeFrameTag(BinaryQLogFrameTag::ReadNewToken);
+        break;
+      case QuicFrame::Type::PingFrame:
+        writeFrameTag(BinaryQLogFrameTag::Ping);
+        break;
+      case QuicFrame::Type::QuicSimpleFrame:
+        writeSimpleFrame(*quicFrame.asQuicSimpleFrame());
+        break;
+      case QuicFrame::Type::NoopFrame:
+        break;
+      case QuicFrame::Type::DatagramFrame:
+        writeFrameTag(BinaryQLogFrameTag::Datagram);
+        writeVarint(quicFrame.asDatagramFrame()->length);
+        break;
+      case QuicFrame::Type::TimestampFrame:
+        writeFrameTag(BinaryQLogFrameTag::Timestamp);
+        writeVarint(quicFrame.asTimestampFrame()->timestamp);
+        break;
+      case QuicFrame::Type::ImmediateAckFrame:
+        writeFrameTag(BinaryQLogFrameTag::ImmediateAck);
+        break;
+    }
+  }
+  if (numPaddingFrames > 0) {
+    writeFrameTag(BinaryQLogFrameTag::Padding);
+    writeVarint(numPaddingFrames);
+  }
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addPacket(
+    const RegularQuicWritePacket& writePacket,
+    uint64_t packetSize) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::Packet);
+  writeBool(false /* received */);
+  const ShortHeader* shortHeader = writePacket.header.asShort();
+  writeString(
+      shortHeader ? kShortHeaderPacketType
+                  : toQlogString(writePacket.header.asLong()->getHeaderType()));
+  writeVarint(writePacket.header.getPacketSequenceNum());
+  writeVarint(packetSize);
+
+  uint64_t numPaddingFrames = 0;
+  for (const auto& quicFrame : writePacket.frames) {
+    switch (quicFrame.type()) {
+      case QuicWriteFrame::Type::PaddingFrame:
+        numPaddingFrames += quicFrame.asPaddingFrame()->numFrames;
+        break;
+      case QuicWriteFrame::Type::RstStreamFrame: {
+        const auto& frame = *quicFrame.asRstStreamFrame();
+        writeFrameTag(BinaryQLogFrameTag::RstStream);
+        writeVarint(frame.streamId);
+        writeVarint(frame.errorCode);
+        writeVarint(frame.finalSize);
+        break;
+      }
+      case QuicWriteFrame::Type::ConnectionCloseFrame:
+        writeConnectionCloseFrame(*quicFrame.asConnectionCloseFrame());
+        break;
+      case QuicWriteFrame::Type::MaxDataFrame: {
+        writeFrameTag(BinaryQLogFrameTag::MaxData);
+        writeVarint(quicFrame.asMaxDataFrame()->maximumData);
+        break;
+      }
+      case QuicWriteFrame::Type::MaxStreamDataFrame: {
+        const auto& frame = *quicFrame.asMaxStreamDataFrame();
+        writeFrameTag(BinaryQLogFrameTag::MaxStreamData);
+        writeVarint(frame.streamId);
+        writeVarint(frame.maximumData);
+        break;
+      }
+      case QuicWriteFrame::Type::StreamsBlockedFrame: {
+        const auto& frame = *quicFrame.asStreamsBlockedFrame();
+        writeFrameTag(BinaryQLogFrameTag::StreamsBlocked);
+        writeVarint(frame.streamLimit);
+        writeBool(frame.isForBidirectional);
+        break;
+      }
+      case QuicWriteFrame::Type::DataBlockedFrame: {
+        writeFrameTag(BinaryQLogFrameTag::DataBlocked);
+        writeVarint(quicFrame.asDataBlockedFrame()->dataLimit);
+        break;
+      }
+      case QuicWriteFrame::Type::StreamDataBlockedFrame: {
+        const auto& frame = *quicFrame.asStreamDataBlockedFrame();
+        writeFrameTag(BinaryQLogFrameTag::StreamDataBlocked);
+        writeVarint(frame.streamId);
+        writeVarint(frame.dataLimit);
+        break;
+      }
+      case QuicWriteFrame::Type::WriteAckFrame:
+        writeAckFrame(*quicFrame.asWriteAckFrame());
+        break;
+      case QuicWriteFrame::Type::WriteStreamFrame: {
+        const auto& frame = *quicFrame.asWriteStreamFrame();
+        writeFrameTag(BinaryQLogFrameTag::Stream);
+        writeVarint(frame.streamId);
+        writeVarint(frame.offset);
+        writeVarint(frame.len);
+        writeBool(frame.fin);
+        break;
+      }
+      case QuicWriteFrame::Type::WriteCryptoFrame: {
+        const auto& frame = *quicFrame.asWriteCryptoFrame();
+        writeFrameTag(BinaryQLogFrameTag::Crypto);
+        writeVarint(frame.offset);
+        writeVarint(frame.len);
+        break;
+      }
+      case QuicWriteFrame::Type::QuicSimpleFrame:
+        writeSimpleFrame(*quicFrame.asQuicSimpleFrame());
+        break;
+      case QuicWriteFrame::Type::NoopFrame:
+        break;
+      case QuicWriteFrame::Type::DatagramFrame:
+        // Not logged by the JSON loggers either.
+        break;
+      case QuicWriteFrame::Type::TimestampFrame:
+        writeFrameTag(BinaryQLogFrameTag::Timestamp);
+        writeVarint(quicFrame.asTimestampFrame()->timestamp);
+        break;
+      case QuicWriteFrame::Type::ImmediateAckFrame:
+        writeFrameTag(BinaryQLogFrameTag::ImmediateAck);
+        break;
+      case QuicWriteFrame::Type::PingFrame:
+        writeFrameTag(BinaryQLogFrameTag::Ping);
+        break;
+    }
+  }
+  if (numPaddingFrames > 0) {
+    writeFrameTag(BinaryQLogFrameTag::Padding);
+    writeVarint(numPaddingFrames);
+  }
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addPacket(
+    const VersionNegotiationPacket& versionPacket,
+    uint64_t packetSize,
+    bool isPacketRecvd) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::VersionNegotiation);
+  writeBool(isPacketRecvd);
+  writeVarint(packetSize);
+  writeVarint(versionPacket.versions.size());
+  for (auto version : versionPacket.versions) {
+    writeVarint(static_cast<uint64_t>(version));
+  }
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addPacket(
+    const RetryPacket& retryPacket,
+    uint64_t packetSize,
+    bool isPacketRecvd) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::Retry);
+  writeBool(isPacketRecvd);
+  writeString(toQlogString(retryPacket.header.getHeaderType()));
+  writeVarint(packetSize);
+  writeVarint(retryPacket.header.getToken().size());
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addConnectionClose(
+    std::string error,
+    std::string reason,
+    bool drainConnection,
+    bool sendCloseImmediately) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::ConnectionClose);
+  writeString(error);
+  writeString(reason);
+  writeBool(drainConnection);
+  writeBool(sendCloseImmediately);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addTransportSummary(const TransportSummaryArgs& args) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::TransportSummary);
+  writeVarint(args.totalBytesSent);
+  writeVarint(args.totalBytesRecvd);
+  writeVarint(args.sumCurWriteOffset);
+  writeVarint(args.sumMaxObservedOffset);
+  writeVarint(args.sumCurStreamBufferLen);
+  writeVarint(args.totalBytesRetransmitted);
+  writeVarint(args.totalStreamBytesCloned);
+  writeVarint(args.totalBytesCloned);
+  writeVarint(args.totalCryptoDataWritten);
+  writeVarint(args.totalCryptoDataRecvd);
+  writeVarint(args.currentWritableBytes);
+  writeVarint(args.currentConnFlowControl);
+  writeVarint(args.totalPacketsSpuriouslyMarkedLost);
+  writeVarint(args.finalPacketLossReorderingThreshold);
+  writeVarint(args.finalPacketLossTimeReorderingThreshDividend);
+  writeBool(args.usedZeroRtt);
+  writeVarint(static_cast<uint64_t>(args.quicVersion));
+  writeVarint(args.initialPacketsReceived);
+  writeVarint(args.uniqueInitialCryptoFramesReceived);
+  writeVarint(args.timeUntilLastInitialCryptoFrameReceived.count());
+  writeString(args.alpn);
+  writeString(args.namedGroup);
+  writeString(args.pskType);
+  writeString(args.echStatus);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addCongestionMetricUpdate(
+    uint64_t bytesInFlight,
+    uint64_t currentCwnd,
+    std::string congestionEvent,
+    std::string state,
+    std::string recoveryState) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::CongestionMetricUpdate);
+  writeVarint(bytesInFlight);
+  writeVarint(currentCwnd);
+  writeString(congestionEvent);
+  writeString(state);
+  writeString(recoveryState);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addCongestionStateUpdate(
+    Optional<std::string> oldState,
+    std::string newState,
+    Optional<std::string> trigger,
+    Optional<uint64_t> resumption) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::CongestionStateUpdate);
+  writeBool(oldState.has_value());
+  if (oldState.has_value()) {
+    writeString(*oldState);
+  }
+  writeString(newState);
+  writeBool(trigger.has_value());
+  if (trigger.has_value()) {
+    writeString(*trigger);
+  }
+  writeOptional(resumption);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addBandwidthEstUpdate(
+    uint64_t bytes,
+    std::chrono::microseconds interval) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::BandwidthEstUpdate);
+  writeVarint(bytes);
+  writeVarint(interval.count());
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addAppLimitedUpdate() {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::AppLimitedUpdate);
+  writeBool(true);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addAppUnlimitedUpdate() {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::AppLimitedUpdate);
+  writeBool(false);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addPacingMetricUpdate(
+    uint64_t pacingBurstSizeIn,
+    std::chrono::microseconds pacingIntervalIn) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::PacingMetricUpdate);
+  writeVarint(pacingBurstSizeIn);
+  writeVarint(pacingIntervalIn.count());
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addPacingObservation(
+    std::string actual,
+    std::string expected,
+    std::string conclusion) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::PacingObservation);
+  writeString(actual);
+  writeString(expected);
+  writeString(conclusion);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addAppIdleUpdate(std::string idleEvent, bool idle) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::AppIdleUpdate);
+  writeString(idleEvent);
+  writeBool(idle);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addPacketDrop(size_t packetSize, std::string dropReason) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::PacketDrop);
+  writeVarint(packetSize);
+  writeString(dropReason);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addDatagramReceived(uint64_t dataLen) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::DatagramReceived);
+  writeVarint(dataLen);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addLossAlarm(
+    PacketNum largestSent,
+    uint64_t alarmCount,
+    uint64_t outstandingPackets,
+    std::string type) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::LossAlarm);
+  writeVarint(largestSent);
+  writeVarint(alarmCount);
+  writeVarint(outstandingPackets);
+  writeString(type);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addPacketsLost(
+    PacketNum largestLostPacketNum,
+    uint64_t lostBytes,
+    uint64_t lostPackets) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::PacketsLost);
+  writeVarint(largestLostPacketNum);
+  writeVarint(lostBytes);
+  writeVarint(lostPackets);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addTransportStateUpdate(std::string update) {
+  // Same filter as FileQLogger, so both produce the same trace.
+  static const std::unordered_set<std::string> validStates = {
+      "attempted",
+      "handshake_started",
+      "handshake_complete",
+      "closed",
+      "peer_validated",
+      "early_write",
+      "handshake_confirmed",
+      "closing",
+      "draining"};
+  if (validStates.find(update) == validStates.end()) {
+    return;
+  }
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::TransportStateUpdate);
+  writeString(update);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addPacketBuffered(
+    ProtectionType protectionType,
+    uint64_t packetSize) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::PacketBuffered);
+  writeVarint(static_cast<uint64_t>(protectionType));
+  writeVarint(packetSize);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addMetricUpdate(
+    std::chrono::microseconds latestRtt,
+    std::chrono::microseconds mrtt,
+    std::chrono::microseconds srtt,
+    std::chrono::microseconds ackDelay,
+    Optional<std::chrono::microseconds> rttVar,
+    Optional<uint64_t> congestionWindow,
+    Optional<uint64_t> bytesInFlight,
+    Optional<uint64_t> ssthresh,
+    Optional<uint64_t> packetsInFlight,
+    Optional<uint64_t> pacingRateBytesPerSec,
+    Optional<uint32_t> ptoCount) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::MetricUpdate);
+  writeVarint(latestRtt.count());
+  writeVarint(mrtt.count());
+  writeVarint(srtt.count());
+  writeVarint(ackDelay.count());
+  writeOptional(
+      rttVar.has_value() ? Optional<uint64_t>(rttVar->count()) : std::nullopt);
+  writeOptional(congestionWindow);
+  writeOptional(bytesInFlight);
+  writeOptional(ssthresh);
+  writeOptional(packetsInFlight);
+  writeOptional(pacingRateBytesPerSec);
+  writeOptional(
+      ptoCount.has_value() ? Optional<uint64_t>(*ptoCount) : std::nullopt);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addStreamStateUpdate(
+    StreamId id,
+    std::string update,
+    Optional<std::chrono::milliseconds> timeSinceStreamCreation) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::StreamStateUpdate);
+  writeVarint(id);
+  writeString(update);
+  writeOptional(
+      timeSinceStreamCreation.has_value()
+          ? Optional<uint64_t>(timeSinceStreamCreation->count())
+          : std::nullopt);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addConnectionMigrationUpdate(bool intentionalMigration) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::ConnectionMigration);
+  writeBool(intentionalMigration);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addPathValidationEvent(bool success) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::PathValidation);
+  writeBool(success);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addPriorityUpdate(
+    quic::StreamId streamId,
+    PriorityQueue::PriorityLogFields priority) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::PriorityUpdate);
+  writeVarint(streamId);
+  writeVarint(priority.size());
+  for (const auto& [key, value] : priority) {
+    writeString(key);
+    writeString(value);
+  }
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addL4sWeightUpdate(
+    double l4sWeight,
+    uint32_t newEct1,
+    uint32_t newCe) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::L4sWeightUpdate);
+  writeDouble(l4sWeight);
+  writeVarint(newEct1);
+  writeVarint(newCe);
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addNetworkPathModelUpdate(
+    uint64_t inflightHi,
+    uint64_t inflightLo,
+    uint64_t bandwidthHiBytes,
+    std::chrono::microseconds bandwidthHiInterval,
+    uint64_t bandwidthLoBytes,
+    std::chrono::microseconds bandwidthLoInterval) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::NetworkPathModelUpdate);
+  writeVarint(inflightHi);
+  writeVarint(inflightLo);
+  writeVarint(bandwidthHiBytes);
+  writeVarint(bandwidthHiInterval.count());
+  writeVarint(bandwidthLoBytes);
+  writeVarint(bandwidthLoInterval.count());
+  endRecord(lengthOffset);
+}
+
+void BinaryQLogger::addPmtuUpdate(
+    uint64_t probeSize,
+    uint64_t packetSize,
+    std::string trigger) {
+  auto lengthOffset = beginEvent(BinaryQLogRecordType::PmtuUpdate);
+  writeVarint(probeSize);
+  writeVarint(packetSize);
+  writeString(trigger);
+  endRecord(lengthOffset);
+}
+
+} // namespace quic
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/logging/BinaryQLogFormat.h>
+#include <quic/logging/QLogger.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace quic {
+
+/**
+ * Writes the binary qlogs of many connections to their files from a single
+ * background thread, so that a worker shares one writer, and one thread,
+ * between all of its connections. At most maxQueuedBytes of data wait for
+ * the disk. Past that, writes are dropped and counted rather than letting
+ * memory grow with the backlog.
+ */
+class BinaryQLogWriter {
+ public:
+  static constexpr size_t kDefaultMaxQueuedBytes = 64 * 1024 * 1024;
+
+  // A file opened on the writer thread by the first write to it, and closed
+  // once the last reference to it is gone.
+  class File;
+
+  explicit BinaryQLogWriter(size_t maxQueuedBytes = kDefaultMaxQueuedBytes);
+
+  // Writes everything queued before returning.
+  ~BinaryQLogWriter();
+
+  BinaryQLogWriter(const BinaryQLogWriter&) = delete;
+  BinaryQLogWriter& operator=(const BinaryQLogWriter&) = delete;
+
+  // Writer of the loggers that are not given one.
+  static std::shared_ptr<BinaryQLogWriter> getDefault();
+
+  static std::shared_ptr<File> makeFile(std::string path);
+
+  /**
+   * Queues data to be appended to file. Returns false if the queue is full,
+   * in which case this and every later write to file are dropped, so that the
+   * file stays a readable prefix of its trace.
+   */
+  bool write(std::shared_ptr<File> file, std::string data);
+
+  /**
+   * Runs task on the writer thread once everything queued before it is done.
+   * A task holding bytes of data counts against maxQueuedBytes and is dropped,
+   * returning false, if the queue is full. Tasks without data always run.
+   */
+  bool run(std::function<void()> task, size_t bytes = 0);
+
+  // Blocks until everything queued so far is done. Must not be called from
+  // the writer thread.
+  void flush();
+
+  // Writes and tasks dropped because the queue was full, and their bytes.
+  [[nodiscard]] uint64_t numDropped() const;
+  [[nodiscard]] uint64_t numDroppedBytes() const;
+
+ private:
+  struct Task {
+    std::function<void()> fn;
+    size_t bytes{0};
+  };
+
+  // Called with mutex_ held. Returns whether bytes more fit in the queue, and
+  // counts a drop if not.
+  bool reserveLocked(size_t bytes);
+
+  void loop();
+
+  const size_t maxQueuedBytes_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Task> tasks_;
+  size_t queuedBytes_{0};
+  uint64_t numDropped_{0};
+  uint64_t numDroppedBytes_{0};
+  bool stopping_{false};
+  std::thread thread_;
+};
+
+/**
+ * QLogger that appends every event as a compact binary record (see
+ * BinaryQLogFormat.h) to an append buffer, instead of allocating a QLogEvent
+ * for it. Once the dcid is known the buffer is handed to the writer for
+ * <path>/<dcid>.bqlog whenever it grows past flushThreshold, so memory use
+ * stays bounded for the lifetime of the connection. Until then events past
+ * maxBufferedBytes are dropped. Files are turned into the usual qlog JSON
+ * offline with readBinaryQLog().
+ */
+class BinaryQLogger : public QLogger {
+ public:
+  static constexpr size_t kDefaultFlushThreshold = 64 * 1024;
+  static constexpr size_t kDefaultMaxBufferedBytes = 1024 * 1024;
+
+  using QLogger::TransportSummaryArgs;
+
+  /**
+   * Without a writer, the one returned by BinaryQLogWriter::getDefault() is
+   * used.
+   */
+  explicit BinaryQLogger(
+      VantagePoint vantagePointIn,
+      std::string protocolTypeIn = kHTTP3ProtocolType,
+      std::string path = "",
+      size_t flushThreshold = kDefaultFlushThreshold,
+      size_t maxBufferedBytes = kDefaultMaxBufferedBytes,
+      std::shared_ptr<BinaryQLogWriter> writer = nullptr);
+
+  ~BinaryQLogger() override;
+
+  void addPacket(const RegularQuicPacket& regularPacket, uint64_t packetSize)
+      override;
+  void addPacket(
+      const VersionNegotiationPacket& versionPacket,
+      uint64_t packetSize,
+      bool isPacketRecvd) override;
+  void addPacket(const RegularQuicWritePacket& writePacket, uint64_t packetSize)
+      override;
+  void addPacket(
+      const RetryPacket& retryPacket,
+      uint64_t packetSize,
+      bool isPacketRecvd) override;
+  void addConnectionClose(
+      std::string error,
+      std::string reason,
+      bool drainConnection,
+      bool sendCloseImmediately) override;
+  void addTransportSummary(const TransportSummaryArgs& args) override;
+  void addCongestionMetricUpdate(
+      uint64_t bytesInFlight,
+      uint64_t currentCwnd,
+      std::string congestionEvent,
+      std::string state = "",
+      std::string recoveryState = "") override;
+  void addPacingMetricUpdate(
+      uint64_t pacingBurstSizeIn,
+      std::chrono::microseconds pacingIntervalIn) override;
+  void addPacingObservation(
+      std::string actual,
+      std::string expected,
+      std::string conclusion) override;
+  void addBandwidthEstUpdate(uint64_t bytes, std::chrono::microseconds interval)
+      override;
+  void addAppLimitedUpdate() override;
+  void addAppUnlimitedUpdate() override;
+  void addAppIdleUpdate(std::string idleEvent, bool idle) override;
+  void addPacketDrop(size_t packetSize, std::string dropReasonIn) override;
+  void addDatagramReceived(uint64_t dataLen) override;
+  void addLossAlarm(
+      PacketNum largestSent,
+      uint64_t alarmCount,
+      uint64_t outstandingPackets,
+      std::string type) override;
+  void addPacketsLost(
+      PacketNum largestLostPacketNum,
+      uint64_t lostBytes,
+      uint64_t lostPackets) override;
+  void addTransportStateUpdate(std::string update) override;
+  void addPacketBuffered(ProtectionType protectionType, uint64_t packetSize)
+      override;
+  void addMetricUpdate(
+      std::chrono::microseconds latestRtt,
+      std::chrono::microseconds mrtt,
+      std::chrono::microseconds srtt,
+      std::chrono::microseconds ackDelay,
+      Optional<std::chrono::microseconds> rttVar = std::nullopt,
+      Optional<uint64_t> congestionWindow = std::nullopt,
+      Optional<uint64_t> bytesInFlight = std::nullopt,
+      Optional<uint64_t> ssthresh = std::nullopt,
+      Optional<uint64_t> packetsInFlight = std::nullopt,
+      Optional<uint64_t> pacingRateBytesPerSec = std::nullopt,
+      Optional<uint32_t> ptoCount = std::nullopt) override;
+  void addCongestionStateUpdate(
+      Optional<std::string> oldState,
+      std::string newState,
+      Optional<std::string> trigger,
+      Optional<uint64_t> resumption = std::nullopt) override;
+  void addStreamStateUpdate(
+      StreamId id,
+      std::string update,
+      Optional<std::chrono::milliseconds> timeSinceStreamCreation) override;
+  void addConnectionMigrationUpdate(bool intentionalMigration) override;
+  void addPathValidationEvent(bool success) override;
+  void addPriorityUpdate(
+      quic::StreamId streamId,
+      PriorityQueue::PriorityLogFields priority) override;
+  void addL4sWeightUpdate(double l4sWeight, uint32_t newEct1, uint32_t newCe)
+      override;
+  void addNetworkPathModelUpdate(
+      uint64_t inflightHi,
+      uint64_t inflightLo,
+      uint64_t bandwidthHiBytes,
+      std::chrono::microseconds bandwidthHiInterval,
+      uint64_t bandwidthLoBytes,
+      std::chrono::microseconds bandwidthLoInterval) override;
+  void addPmtuUpdate(
+      uint64_t probeSize,
+      uint64_t packetSize,
+      std::string trigger) override;
+
+  void setDcid(Optional<ConnectionId> connID) override;
+  void setScid(Optional<ConnectionId> connID) override;
+
+  // Hands everything buffered so far to the file writer. A no-op until the
+  // dcid, and with it the file name, is known.
+  void flush();
+
+  // Bytes buffered and not yet handed to the file writer.
+  [[nodiscard]] size_t bufferedBytes() const {
+    return buffer_.size();
+  }
+
+  // Events dropped because no file was open yet to write them to.
+  [[nodiscard]] uint64_t numDroppedEvents() const {
+    return numDroppedEvents_;
+  }
+
+ protected:
+  // Called once a complete record has been appended to buffer_, with the
+  // offset of its type byte. Flushes past the threshold by default.
+  virtual void onRecordWritten(size_t recordOffset);
+
+  // Called once the dcid is known if there is a path. Opens
+  // <path>/<dcid>.bqlog and flushes what was buffered so far by default.
+  virtual void openFile();
+
+  [[nodiscard]] const std::string& path() const {
+    return path_;
+  }
+
+  // The writer given to the constructor, or the default one without it.
+  BinaryQLogWriter& writer();
+
+  std::string buffer_;
+
+ private:
+  // Starts a record and returns the offset of its length field.
+  size_t beginRecord(BinaryQLogRecordType type);
+  // Starts an event record, which carries a timestamp.
+  size_t beginEvent(BinaryQLogRecordType type);
+  void endRecord(size_t lengthOffset);
+
+  void writeVarint(uint64_t value);
+  void writeBool(bool value);
+  void writeString(folly::StringPiece value);
+  void writeBytes(const uint8_t* data, size_t len);
+  void writeDouble(double value);
+  void writeOptional(const Optional<uint64_t>& value);
+
+  template <typename Frame>
+  void writeAckFrame(const Frame& frame);
+  void writeConnectionCloseFrame(const ConnectionCloseFrame& frame);
+  void writeSimpleFrame(const QuicSimpleFrame& frame);
+  void writeFrameTag(BinaryQLogFrameTag tag);
+
+  void writeConnectionId(
+      BinaryQLogRecordType type,
+      const ConnectionId& connId);
+
+  std::string path_;
+  size_t flushThreshold_;
+  size_t maxBufferedBytes_;
+  std::shared_ptr<BinaryQLogWriter> writer_;
+  std::shared_ptr<BinaryQLogWriter::File> file_;
+  std::chrono::microseconds lastEventTime_{0};
+  // lastEventTime_ before the newest event, restored if it is dropped.
+  std::chrono::microseconds previousEventTime_{0};
+  uint64_t numDroppedEvents_{0};
+};
+
+} // namespace quic
@@ -621,6 +621,16 @@ void FileQLogger::addNetworkPathModelUpdate(
           refTime));
 }
 
+void FileQLogger::addPmtuUpdate(
+    uint64_t probeSize,
+    uint64_t packetSize,
+    std::string trigger) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+  handleEvent(std::make_unique<quic::QLogPmtuUpdateEvent>(
+      probeSize, packetSize, std::move(trigger), refTime));
+}
+
 void FileQLogger::outputLogsToFile(const std::string& path, bool prettyJson) {
   if (streaming_) {
     return;
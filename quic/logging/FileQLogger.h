@@ -134,6 +134,10 @@ class FileQLogger : public BaseQLogger {
       std::chrono::microseconds bandwidthHiInterval,
       uint64_t bandwidthLoBytes,
       std::chrono::microseconds bandwidthLoInterval) override;
+  void addPmtuUpdate(
+      uint64_t probeSize,
+      uint64_t packetSize,
+      std::string trigger) override;
   void outputLogsToFile(const std::string& path, bool prettyJson);
   folly::dynamic toDynamic() const;
   folly::dynamic toDynamicBase() const;
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/common/MvfstLogging.h>
+#include <quic/logging/BinaryQLogReader.h>
+#include <quic/logging/FlightRecorderQLogger.h>
+#include <quic/logging/QLoggerConstants.h>
+
+#include <folly/lang/Bits.h>
+
+#include <cstring>
+
+namespace {
+// Large enough for all but packets with many frames, which grow it once.
+constexpr size_t kScratchBufferSize = 4096;
+
+int64_t zigzagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void appendVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+size_t varintSize(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+} // namespace
+
+namespace quic {
+
+FlightRecorderQLogger::FlightRecorderQLogger(
+    VantagePoint vantagePointIn,
+    std::string protocolTypeIn,
+    std::string path,
+    size_t maxEvents,
+    size_t capacityBytes,
+    uint64_t ptoCountThreshold,
+    bool prettyJson,
+    std::shared_ptr<BinaryQLogWriter> writer)
+    // The base never opens a file, see openFile(), and everything but the
+    // trace header is moved into the ring.
+    : BinaryQLogger(
+          vantagePointIn,
+          std::move(protocolTypeIn),
+          std::move(path),
+          kScratchBufferSize,
+          kDefaultMaxBufferedBytes,
+          std::move(writer)),
+      maxEvents_(maxEvents),
+      ptoCountThreshold_(ptoCountThreshold),
+      prettyJson_(prettyJson),
+      ring_(capacityBytes) {
+  MVCHECK_GT(maxEvents_, 0);
+  MVCHECK_GT(ring_.size(), kBinaryQLogRecordHeaderSize);
+}
+
+void FlightRecorderQLogger::onRecordWritten(size_t recordOffset) {
+  auto type = static_cast<uint8_t>(buffer_[recordOffset]);
+  if (type < static_cast<uint8_t>(kFirstBinaryQLogEventRecordType)) {
+    // Trace info and connection ids stay in buffer_ as the trace header.
+    return;
+  }
+  auto record = reinterpret_cast<const uint8_t*>(buffer_.data()) + recordOffset;
+  size_t len = buffer_.size() - recordOffset;
+  if (len > ring_.size()) {
+    // Can never be retained, but later events are timed relative to it.
+    while (numEvents_ > 0) {
+      evictOldest();
+    }
+    uint64_t zigzag = 0;
+    for (size_t i = 0; i < 10; ++i) {
+      uint8_t byte = record[kBinaryQLogRecordHeaderSize + i];
+      zigzag |= uint64_t(byte & 0x7f) << (7 * i);
+      if (!(byte & 0x80)) {
+        break;
+      }
+    }
+    baseTime_ += std::chrono::microseconds(zigzagDecode(zigzag));
+    buffer_.resize(recordOffset);
+    return;
+  }
+  while (numEvents_ >= maxEvents_ || ring_.size() - size_ < len) {
+    evictOldest();
+  }
+  size_t tail = (head_ + size_) % ring_.size();
+  size_t firstPart = std::min(len, ring_.size() - tail);
+  std::memcpy(ring_.data() + tail, record, firstPart);
+  std::memcpy(ring_.data(), record + firstPart, len - firstPart);
+  size_ += len;
+  numEvents_++;
+  buffer_.resize(recordOffset);
+}
+
+uint8_t FlightRecorderQLogger::ringAt(size_t offset) const {
+  return ring_[(head_ + offset) % ring_.size()];
+}
+
+void FlightRecorderQLogger::appendFromRing(
+    std::string& out,
+    size_t offset,
+    size_t len) const {
+  size_t start = (head_ + offset) % ring_.size();
+  size_t firstPart = std::min(len, ring_.size() - start);
+  out.append(reinterpret_cast<const char*>(ring_.data() + start), firstPart);
+  out.append(reinterpret_cast<const char*>(ring_.data()), len - firstPart);
+}
+
+void FlightRecorderQLogger::readRingRecord(
+    size_t offset,
+    uint32_t& payloadLen,
+    int64_t& timeDelta,
+    size_t& timeDeltaLen) const {
+  payloadLen = 0;
+  for (size_t i = 1; i < kBinaryQLogRecordHeaderSize; ++i) {
+    payloadLen = (payloadLen << 8) | ringAt(offset + i);
+  }
+  uint64_t zigzag = 0;
+  timeDeltaLen = 0;
+  uint8_t byte;
+  do {
+    byte = ringAt(offset + kBinaryQLogRecordHeaderSize + timeDeltaLen);
+    zigzag |= uint64_t(byte & 0x7f) << (7 * timeDeltaLen);
+    ++timeDeltaLen;
+  } while ((byte & 0x80) && timeDeltaLen < 10);
+  timeDelta = zigzagDecode(zigzag);
+}
+
+void FlightRecorderQLogger::evictOldest() {
+  uint32_t payloadLen;
+  int64_t timeDelta;
+  size_t timeDeltaLen;
+  readRingRecord(0, payloadLen, timeDelta, timeDeltaLen);
+  baseTime_ += std::chrono::microseconds(timeDelta);
+  size_t len = kBinaryQLogRecordHeaderSize + payloadLen;
+  head_ = (head_ + len) % ring_.size();
+  size_ -= len;
+  numEvents_--;
+}
+
+std::string FlightRecorderQLogger::snapshot() const {
+  std::string out;
+  out.reserve(buffer_.size() + size_ + sizeof(uint64_t));
+  out.append(buffer_);
+  if (numEvents_ == 0) {
+    return out;
+  }
+  // The oldest event is timed relative to one that was evicted, so rewrite
+  // its delta as one from time zero, which is where a reader starts.
+  uint32_t payloadLen;
+  int64_t timeDelta;
+  size_t timeDeltaLen;
+  readRingRecord(0, payloadLen, timeDelta, timeDeltaLen);
+  auto time = baseTime_.count() + timeDelta;
+  auto zigzag = (static_cast<uint64_t>(time) << 1) ^ (time >> 63);
+  out.push_back(static_cast<char>(ringAt(0)));
+  auto newPayloadLen = folly::Endian::big(static_cast<uint32_t>(
+      payloadLen - timeDeltaLen + varintSize(zigzag)));
+  out.append(reinterpret_cast<const char*>(&newPayloadLen), sizeof(uint32_t));
+  appendVarint(out, zigzag);
+  size_t restOffset = kBinaryQLogRecordHeaderSize + timeDeltaLen;
+  appendFromRing(out, restOffset, size_ - restOffset);
+  return out;
+}
+
+void FlightRecorderQLogger::dump() {
+  if (path().empty() || !dcid.has_value()) {
+    return;
+  }
+  // Only the copy out of the ring happens here. Decoding and serializing to
+  // JSON are far more expensive, so they happen on the writer thread.
+  auto data = snapshot();
+  auto bytes = data.size();
+  auto queued = writer().run(
+      [data = std::move(data), path = path(), prettyJson = prettyJson_]() {
+        auto logger = readBinaryQLog(ByteRange(
+            reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+        if (logger.hasError()) {
+          MVLOG_ERROR << "Error decoding flight recorder qlog. "
+                      << logger.error().message;
+          return;
+        }
+        (*logger)->outputLogsToFile(path, prettyJson);
+      },
+      bytes);
+  if (!queued) {
+    MVLOG_WARNING << "Binary qlog writer queue is full, dropping flight "
+                  << "recorder dump for " << path();
+    return;
+  }
+  numDumps_++;
+}
+
+void FlightRecorderQLogger::setConnectionCloseError(const QuicErrorCode& code) {
+  closeError_ = code;
+}
+
+void FlightRecorderQLogger::addConnectionClose(
+    std::string error,
+    std::string reason,
+    bool drainConnection,
+    bool sendCloseImmediately) {
+  // The error string is only a description, so graceful closes such as an
+  // application NO_ERROR or an idle timeout are told apart by their code.
+  bool failed = closeError_.has_value() && !isNoError(*closeError_);
+  BinaryQLogger::addConnectionClose(
+      std::move(error),
+      std::move(reason),
+      drainConnection,
+      sendCloseImmediately);
+  if (failed) {
+    dump();
+  }
+}
+
+void FlightRecorderQLogger::addLossAlarm(
+    PacketNum largestSent,
+    uint64_t alarmCount,
+    uint64_t outstandingPackets,
+    std::string type) {
+  // Only the crossing, so a long run of PTOs dumps once.
+  bool thresholdReached = ptoCountThreshold_ > 0 && type == kPtoAlarm &&
+      alarmCount == ptoCountThreshold_;
+  BinaryQLogger::addLossAlarm(
+      largestSent, alarmCount, outstandingPackets, std::move(type));
+  if (thresholdReached) {
+    dump();
+  }
+}
+
+} // namespace quic
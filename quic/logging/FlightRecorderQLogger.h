@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/logging/BinaryQLogger.h>
+
+#include <vector>
+
+namespace quic {
+
+/**
+ * QLogger that keeps only the most recent events of a connection, cheap enough
+ * to leave on for every connection. Events are encoded as binary qlog records
+ * into a ring allocated up front, evicting the oldest ones once either
+ * maxEvents or capacityBytes is reached, so logging an event never allocates.
+ *
+ * The retained events are written out as qlog JSON to <path>/<dcid>.qlog when
+ * the connection closes with an error code that isNoError() does not accept,
+ * when the PTO count reaches ptoCountThreshold, or when dump() is called. The
+ * events are decoded and written on the writer thread, off the event base.
+ */
+class FlightRecorderQLogger : public BinaryQLogger {
+ public:
+  static constexpr size_t kDefaultMaxEvents = 1000;
+  static constexpr size_t kDefaultCapacityBytes = 64 * 1024;
+  static constexpr uint64_t kDefaultPtoCountThreshold = 3;
+
+  /**
+   * A ptoCountThreshold of 0 disables dumping on PTO. Without a writer, the
+   * one returned by BinaryQLogWriter::getDefault() is used.
+   */
+  explicit FlightRecorderQLogger(
+      VantagePoint vantagePointIn,
+      std::string protocolTypeIn = kHTTP3ProtocolType,
+      std::string path = "",
+      size_t maxEvents = kDefaultMaxEvents,
+      size_t capacityBytes = kDefaultCapacityBytes,
+      uint64_t ptoCountThreshold = kDefaultPtoCountThreshold,
+      bool prettyJson = true,
+      std::shared_ptr<BinaryQLogWriter> writer = nullptr);
+
+  void setConnectionCloseError(const QuicErrorCode& code) override;
+  void addConnectionClose(
+      std::string error,
+      std::string reason,
+      bool drainConnection,
+      bool sendCloseImmediately) override;
+  void addLossAlarm(
+      PacketNum largestSent,
+      uint64_t alarmCount,
+      uint64_t outstandingPackets,
+      std::string type) override;
+
+  // Queues the retained events to be written as qlog JSON on the writer
+  // thread. A no-op without a path or dcid.
+  void dump();
+
+  // The retained events as a binary qlog, readable with readBinaryQLog().
+  [[nodiscard]] std::string snapshot() const;
+
+  [[nodiscard]] size_t numEvents() const {
+    return numEvents_;
+  }
+
+  [[nodiscard]] size_t numDumps() const {
+    return numDumps_;
+  }
+
+ protected:
+  void onRecordWritten(size_t recordOffset) override;
+  // Dumps write their own files, so the binary qlog file is never opened.
+  void openFile() override {}
+
+ private:
+  void evictOldest();
+  [[nodiscard]] uint8_t ringAt(size_t offset) const;
+  void appendFromRing(std::string& out, size_t offset, size_t len) const;
+  // Reads the header and time delta of the record at offset from the head.
+  void readRingRecord(
+      size_t offset,
+      uint32_t& payloadLen,
+      int64_t& timeDelta,
+      size_t& timeDeltaLen) const;
+
+  size_t maxEvents_;
+  uint64_t ptoCountThreshold_;
+  bool prettyJson_;
+  Optional<QuicErrorCode> closeError_;
+
+  std::vector<uint8_t> ring_;
+  // Offset of the oldest record and number of bytes used.
+  size_t head_{0};
+  size_t size_{0};
+  size_t numEvents_{0};
+  // Time of the newest event that is no longer retained. The oldest retained
+  // event's time delta is relative to it.
+  std::chrono::microseconds baseTime_{0};
+  size_t numDumps_{0};
+};
+
+} // namespace quic
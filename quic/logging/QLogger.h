@@ -39,6 +39,9 @@ class QLogger {
       const RetryPacket& retryPacket,
       uint64_t packetSize,
       bool isPacketRecvd) = 0;
+  // Called with the code the connection is closing with, right before
+  // addConnectionClose.
+  virtual void setConnectionCloseError(const QuicErrorCode& /* code */) {}
   virtual void addConnectionClose(
       std::string error,
       std::string reason,
@@ -142,6 +145,10 @@ class QLogger {
       std::chrono::microseconds bandwidthHiInterval,
       uint64_t bandwidthLoBytes,
       std::chrono::microseconds bandwidthLoInterval) = 0;
+  virtual void addPmtuUpdate(
+      uint64_t probeSize,
+      uint64_t packetSize,
+      std::string trigger) = 0;
   virtual void setDcid(Optional<ConnectionId> connID) = 0;
   virtual void setScid(Optional<ConnectionId> connID) = 0;
 };
@@ -375,6 +375,16 @@ void QLoggerCommon::addNetworkPathModelUpdate(
           refTime));
 }
 
+void QLoggerCommon::addPmtuUpdate(
+    uint64_t probeSize,
+    uint64_t packetSize,
+    std::string trigger) {
+  auto refTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+  logTrace(std::make_unique<quic::QLogPmtuUpdateEvent>(
+      probeSize, packetSize, std::move(trigger), refTime));
+}
+
 void QLoggerCommon::setDcid(Optional<quic::ConnectionId> connID) {
   if (connID.has_value()) {
     dcid = connID;
@@ -106,6 +106,10 @@ class QLoggerCommon : public quic::BaseQLogger {
       std::chrono::microseconds bandwidthHiInterval,
       uint64_t bandwidthLoBytes,
       std::chrono::microseconds bandwidthLoInterval) override;
+  void addPmtuUpdate(
+      uint64_t probeSize,
+      uint64_t packetSize,
+      std::string trigger) override;
   void setDcid(Optional<quic::ConnectionId> connID) override;
   void setScid(Optional<quic::ConnectionId> connID) override;
 
@@ -55,6 +55,11 @@ constexpr auto kPtoAlarm = "pto alarm";
 constexpr auto kHandshakeAlarm = "handshake alarm";
 constexpr auto kLossTimeoutExpired = "loss timeout expired";
 constexpr auto kSconeSignal = "scone signal";
+constexpr auto kPmtuSearchStart = "pmtu search start";
+constexpr auto kPmtuProbeAcked = "pmtu probe acked";
+constexpr auto kPmtuProbeLost = "pmtu probe lost";
+constexpr auto kPmtuSearchComplete = "pmtu search complete";
+constexpr auto kPmtuBlackHole = "pmtu black hole";
 constexpr auto kStart = "start";
 constexpr auto kWriteNst = "write nst";
 constexpr auto kTransportReady = "transport ready";
@@ -1246,6 +1246,33 @@ folly::dynamic QLogNetworkPathModelUpdateEvent::toDynamic() const {
   return event;
 }
 
+QLogPmtuUpdateEvent::QLogPmtuUpdateEvent(
+    uint64_t probeSize,
+    uint64_t packetSize,
+    std::string trigger,
+    std::chrono::microseconds refTimeIn)
+    : probeSize_(probeSize),
+      packetSize_(packetSize),
+      trigger_(std::move(trigger)) {
+  eventType = QLogEventType::PmtuUpdate;
+  refTime = refTimeIn;
+}
+
+folly::dynamic QLogPmtuUpdateEvent::toDynamic() const {
+  folly::dynamic event = folly::dynamic::object();
+
+  event["time"] = refTime.count() / 1000.0;
+  event["name"] = toQlogEventName(eventType);
+
+  folly::dynamic data = folly::dynamic::object();
+  data["probe_size"] = probeSize_;
+  data["packet_size"] = packetSize_;
+  data["trigger"] = trigger_;
+
+  event["data"] = std::move(data);
+  return event;
+}
+
 folly::StringPiece toString(QLogEventType type) {
   switch (type) {
     case QLogEventType::PacketSent:
@@ -1296,6 +1323,8 @@ folly::StringPiece toString(QLogEventType type) {
       return "l4s_weight_update";
     case QLogEventType::NetworkPathModelUpdate:
       return "network_path_model_update";
+    case QLogEventType::PmtuUpdate:
+      return "pmtu_update";
   }
   folly::assume_unreachable();
 }
@@ -1353,6 +1382,8 @@ std::string toQlogEventName(QLogEventType type) {
       return "mvfst:l4s_weight_update";
     case QLogEventType::NetworkPathModelUpdate:
       return "mvfst:network_path_model_update";
+    case QLogEventType::PmtuUpdate:
+      return "mvfst:pmtu_update";
   }
   folly::assume_unreachable();
 }
@@ -445,7 +445,8 @@ enum class QLogEventType : uint32_t {
   PathValidation,
   PriorityUpdate,
   L4sWeightUpdate,
-  NetworkPathModelUpdate
+  NetworkPathModelUpdate,
+  PmtuUpdate
 };
 
 folly::StringPiece toString(QLogEventType type);
@@ -898,4 +899,20 @@ class QLogNetworkPathModelUpdateEvent : public QLogEvent {
   std::chrono::microseconds bandwidthLoInterval_;
 };
 
+class QLogPmtuUpdateEvent : public QLogEvent {
+ public:
+  explicit QLogPmtuUpdateEvent(
+      uint64_t probeSize,
+      uint64_t packetSize,
+      std::string trigger,
+      std::chrono::microseconds refTimeIn);
+  ~QLogPmtuUpdateEvent() override = default;
+
+  [[nodiscard]] folly::dynamic toDynamic() const override;
+
+  uint64_t probeSize_;
+  uint64_t packetSize_;
+  std::string trigger_;
+};
+
 } // namespace quic
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/logging/BinaryQLogReader.h>
+#include <quic/logging/BinaryQLogger.h>
+
+#include <folly/FileUtil.h>
+#include <folly/portability/Filesystem.h>
+#include <gtest/gtest.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/logging/FileQLogger.h>
+
+#include <future>
+
+using namespace testing;
+
+namespace quic::test {
+
+class BinaryQLoggerTest : public Test {
+ public:
+  void SetUp() override {
+    dir_ = folly::fs::temp_directory_path().string();
+    dcid_ =
+        ConnectionId::createRandom(8).value_or(ConnectionId::createZeroLength());
+  }
+
+  // Logs the same mix of events to any logger.
+  void logEvents(QLogger& q) {
+    RegularQuicWritePacket writePacket =
+        createNewPacket(100, PacketNumberSpace::Initial);
+    WriteAckFrame writeAck;
+    writeAck.ackDelay = 111us;
+    writeAck.ackBlocks.emplace_back(300, 400);
+    writeAck.ackBlocks.emplace_back(100, 200);
+    writePacket.frames.emplace_back(std::move(writeAck));
+    writePacket.frames.emplace_back(WriteStreamFrame(4, 10, 20, true));
+    writePacket.frames.emplace_back(PaddingFrame());
+    writePacket.frames.emplace_back(PaddingFrame());
+    q.addPacket(writePacket, 1200);
+
+    RegularQuicPacket readPacket(
+        ShortHeader(ProtectionType::KeyPhaseZero, getTestConnectionId(1), 7));
+    ReadAckFrame readAck;
+    readAck.frameType = FrameType::ACK_RECEIVE_TIMESTAMPS_DRAFT_02;
+    readAck.ackDelay = 222us;
+    readAck.ackBlocks.emplace_back(300, 400);
+    readAck.timestampsVersion = AckReceiveTimestampsVersion::DraftIetf02;
+    readAck.draft02RecvdPacketsTimestampRanges = {
+        Draft02ReceiveTimestampsRange{
+            .deltaLargestAcknowledged = 0,
+            .timestamp_delta_count = 3,
+            .deltas = {500, 10, 5}}};
+    readPacket.frames.emplace_back(std::move(readAck));
+    readPacket.frames.emplace_back(ConnectionCloseFrame(
+        QuicErrorCode(TransportErrorCode::PROTOCOL_VIOLATION),
+        "bye",
+        FrameType::STREAM));
+    readPacket.frames.emplace_back(
+        QuicSimpleFrame(MaxStreamsFrame(10, true /* isBidirectional */)));
+    q.addPacket(readPacket, 50);
+
+    q.addPacket(createVersionNegotiationPacket(), 30, true /* isRecvd */);
+    q.addMetricUpdate(10us, 20us, 30us, 5us, 7us, 1000, std::nullopt, 500);
+    q.addCongestionStateUpdate(
+        std::nullopt, "Startup", std::string("loss"), 1234);
+    q.addStreamStateUpdate(4, "on headers", 3ms);
+    q.addPriorityUpdate(4, {{"urgency", "3"}, {"incremental", "true"}});
+    q.addL4sWeightUpdate(0.25, 10, 2);
+    q.addPmtuUpdate(1400, 1300, "probe_acked");
+    q.addAppLimitedUpdate();
+    q.addTransportStateUpdate("not a qlog state");
+    q.addTransportStateUpdate("handshake_confirmed");
+    q.addConnectionClose("error", "reason", true, false);
+  }
+
+  std::string binaryPath() const {
+    return fmt::format("{}/{}{}", dir_, dcid_.hex(), kBinaryQLogExtension);
+  }
+
+  std::string readBinaryFile() const {
+    std::string data;
+    EXPECT_TRUE(folly::readFile(binaryPath().c_str(), data));
+    return data;
+  }
+
+  static ByteRange toRange(const std::string& data) {
+    return ByteRange(
+        reinterpret_cast<const uint8_t*>(data.data()), data.size());
+  }
+
+  // Event JSON without the timestamp, which differs between two loggers.
+  static folly::dynamic eventsWithoutTime(const FileQLogger& q) {
+    folly::dynamic events = folly::dynamic::array();
+    for (const auto& event : q.logs) {
+      auto dyn = event->toDynamic();
+      dyn.erase("time");
+      events.push_back(std::move(dyn));
+    }
+    return events;
+  }
+
+  std::unique_ptr<BinaryQLogger> makeLogger(
+      VantagePoint vantagePoint,
+      std::string protocolType = kHTTP3ProtocolType,
+      size_t flushThreshold = BinaryQLogger::kDefaultFlushThreshold,
+      size_t maxBufferedBytes = BinaryQLogger::kDefaultMaxBufferedBytes) {
+    return std::make_unique<BinaryQLogger>(
+        vantagePoint,
+        std::move(protocolType),
+        dir_,
+        flushThreshold,
+        maxBufferedBytes,
+        writer_);
+  }
+
+  std::string dir_;
+  ConnectionId dcid_{ConnectionId::createZeroLength()};
+  std::shared_ptr<BinaryQLogWriter> writer_{
+      std::make_shared<BinaryQLogWriter>()};
+};
+
+TEST_F(BinaryQLoggerTest, RoundTripMatchesFileQLogger) {
+  FileQLogger expected(VantagePoint::Server, "some-protocol");
+  logEvents(expected);
+
+  {
+    auto q = makeLogger(VantagePoint::Server, "some-protocol");
+    q->setDcid(dcid_);
+    q->setScid(getTestConnectionId(2));
+    logEvents(*q);
+  }
+  writer_->flush();
+
+  auto data = readBinaryFile();
+  auto got = readBinaryQLog(toRange(data));
+  ASSERT_FALSE(got.hasError()) << got.error().message;
+  auto& logger = *got.value();
+  EXPECT_EQ(logger.vantagePoint, VantagePoint::Server);
+  EXPECT_EQ(logger.protocolType, "some-protocol");
+  EXPECT_EQ(logger.dcid, dcid_);
+  EXPECT_EQ(logger.scid, getTestConnectionId(2));
+  ASSERT_EQ(logger.logs.size(), expected.logs.size());
+  EXPECT_EQ(eventsWithoutTime(expected), eventsWithoutTime(logger));
+  for (size_t i = 1; i < logger.logs.size(); ++i) {
+    EXPECT_GE(logger.logs[i]->refTime, logger.logs[i - 1]->refTime);
+  }
+  EXPECT_GE(logger.logs.front()->refTime, expected.logs.front()->refTime);
+}
+
+TEST_F(BinaryQLoggerTest, FlushesPastThreshold) {
+  auto q = makeLogger(VantagePoint::Client, kHTTP3ProtocolType, 64);
+  // Buffered until the file name is known.
+  logEvents(*q);
+  EXPECT_GT(q->bufferedBytes(), 64);
+  q->setDcid(dcid_);
+  EXPECT_EQ(q->bufferedBytes(), 0);
+  for (int i = 0; i < 100; ++i) {
+    q->addPacketsLost(i, 1200, 1);
+    EXPECT_LT(q->bufferedBytes(), 64);
+  }
+}
+
+TEST_F(BinaryQLoggerTest, DropsEventsPastCapWithoutFile) {
+  auto q = makeLogger(
+      VantagePoint::Client,
+      kHTTP3ProtocolType,
+      BinaryQLogger::kDefaultFlushThreshold,
+      256 /* maxBufferedBytes */);
+  for (int i = 0; i < 1000; ++i) {
+    q->addPacketsLost(i, 1200, 1);
+  }
+  EXPECT_LE(q->bufferedBytes(), 256);
+  EXPECT_GT(q->numDroppedEvents(), 0);
+
+  // What was kept is still a valid trace, ending with the last event that
+  // fit, and events after the file is known are no longer dropped.
+  auto dropped = q->numDroppedEvents();
+  q->setDcid(dcid_);
+  q->addPacketsLost(5000, 1200, 1);
+  EXPECT_EQ(q->numDroppedEvents(), dropped);
+  q.reset();
+  writer_->flush();
+
+  auto data = readBinaryFile();
+  auto got = readBinaryQLog(toRange(data));
+  ASSERT_FALSE(got.hasError()) << got.error().message;
+  ASSERT_EQ(got.value()->logs.size(), 1000 - dropped + 1);
+  auto last =
+      dynamic_cast<QLogPacketsLostEvent*>(got.value()->logs.back().get());
+  ASSERT_NE(last, nullptr);
+  EXPECT_EQ(last->largestLostPacketNum, 5000);
+}
+
+TEST_F(BinaryQLoggerTest, SharesWriterBetweenConnections) {
+  auto otherDcid = getTestConnectionId(3);
+  {
+    auto first = makeLogger(VantagePoint::Server);
+    auto second = makeLogger(VantagePoint::Server);
+    first->setDcid(dcid_);
+    second->setDcid(otherDcid);
+    first->addPacketsLost(1, 1200, 1);
+    second->addPacketsLost(2, 1200, 1);
+    second->addPacketsLost(3, 1200, 1);
+  }
+  writer_->flush();
+
+  auto firstData = readBinaryFile();
+  auto firstLog = readBinaryQLog(toRange(firstData));
+  ASSERT_FALSE(firstLog.hasError());
+  EXPECT_EQ(firstLog.value()->logs.size(), 1);
+
+  std::string secondData;
+  ASSERT_TRUE(folly::readFile(
+      fmt::format("{}/{}{}", dir_, otherDcid.hex(), kBinaryQLogExtension)
+          .c_str(),
+      secondData));
+  auto secondLog = readBinaryQLog(toRange(secondData));
+  ASSERT_FALSE(secondLog.hasError());
+  EXPECT_EQ(secondLog.value()->logs.size(), 2);
+}
+
+TEST_F(BinaryQLoggerTest, FullQueueTruncatesFile) {
+  writer_ = std::make_shared<BinaryQLogWriter>(256 /* maxQueuedBytes */);
+  // Keep the writer thread busy, as a slow disk would, so writes pile up.
+  std::promise<void> unblock;
+  auto blocked = unblock.get_future().share();
+  EXPECT_TRUE(writer_->run([blocked] { blocked.wait(); }));
+
+  auto q = makeLogger(VantagePoint::Client, kHTTP3ProtocolType, 0);
+  q->setDcid(dcid_);
+  for (int i = 1; i <= 100; ++i) {
+    q->addPacketsLost(i, 1200, 1);
+  }
+  EXPECT_GT(writer_->numDropped(), 0);
+  EXPECT_GT(writer_->numDroppedBytes(), 0);
+  // Tasks without data are never dropped.
+  std::promise<void> ran;
+  EXPECT_TRUE(writer_->run([&ran] { ran.set_value(); }));
+
+  unblock.set_value();
+  writer_->flush();
+  ran.get_future().wait();
+  // Once a write was dropped, later ones to the same file are too, even with
+  // room in the queue again.
+  auto dropped = writer_->numDropped();
+  q->addPacketsLost(1000, 1200, 1);
+  EXPECT_EQ(writer_->numDropped(), dropped + 1);
+  q.reset();
+  writer_->flush();
+
+  // What made it to the file is a readable prefix of the trace.
+  auto data = readBinaryFile();
+  auto got = readBinaryQLog(toRange(data));
+  ASSERT_FALSE(got.hasError());
+  const auto& logs = got.value()->logs;
+  ASSERT_FALSE(logs.empty());
+  ASSERT_LT(logs.size(), 100);
+  for (size_t i = 0; i < logs.size(); ++i) {
+    auto event = dynamic_cast<QLogPacketsLostEvent*>(logs[i].get());
+    ASSERT_NE(event, nullptr);
+    EXPECT_EQ(event->largestLostPacketNum, i + 1);
+  }
+}
+
+TEST_F(BinaryQLoggerTest, TruncatedTailEndsTrace) {
+  {
+    auto q = makeLogger(VantagePoint::Client);
+    q->setDcid(dcid_);
+    q->addPacketsLost(1, 1200, 1);
+    q->addPacketsLost(2, 1200, 1);
+  }
+  writer_->flush();
+  auto data = readBinaryFile();
+  data.resize(data.size() - 2);
+  auto got = readBinaryQLog(toRange(data));
+  ASSERT_FALSE(got.hasError());
+  ASSERT_EQ(got.value()->logs.size(), 1);
+  auto event = dynamic_cast<QLogPacketsLostEvent*>(got.value()->logs[0].get());
+  ASSERT_NE(event, nullptr);
+  EXPECT_EQ(event->largestLostPacketNum, 1);
+}
+
+TEST_F(BinaryQLoggerTest, RejectsForeignFile) {
+  std::string data = R"({"qlog_version": "0.3"})";
+  EXPECT_TRUE(readBinaryQLog(toRange(data)).hasError());
+}
+
+} // namespace quic::test
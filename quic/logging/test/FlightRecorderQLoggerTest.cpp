@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/logging/BinaryQLogReader.h>
+#include <quic/logging/FlightRecorderQLogger.h>
+
+#include <folly/FileUtil.h>
+#include <folly/json/json.h> // @manual=//folly:dynamic
+#include <folly/portability/Filesystem.h>
+#include <gtest/gtest.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/logging/QLoggerConstants.h>
+
+using namespace testing;
+
+namespace quic::test {
+
+class FlightRecorderQLoggerTest : public Test {
+ public:
+  void SetUp() override {
+    dir_ = folly::fs::temp_directory_path().string();
+    dcid_ =
+        ConnectionId::createRandom(8).value_or(ConnectionId::createZeroLength());
+  }
+
+  static std::unique_ptr<FileQLogger> decode(const FlightRecorderQLogger& q) {
+    auto data = q.snapshot();
+    auto logger = readBinaryQLog(ByteRange(
+        reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+    EXPECT_FALSE(logger.hasError());
+    return std::move(logger.value());
+  }
+
+  static std::vector<PacketNum> lostPacketNums(const FileQLogger& q) {
+    std::vector<PacketNum> packetNums;
+    for (const auto& event : q.logs) {
+      if (auto lost = dynamic_cast<QLogPacketsLostEvent*>(event.get())) {
+        packetNums.push_back(lost->largestLostPacketNum);
+      }
+    }
+    return packetNums;
+  }
+
+  std::string jsonPath() const {
+    return fmt::format(
+        "{}/{}{}", dir_, dcid_.hex(), FileQLogger::kQlogExtension);
+  }
+
+  std::string dir_;
+  ConnectionId dcid_{ConnectionId::createZeroLength()};
+  std::shared_ptr<BinaryQLogWriter> writer_{
+      std::make_shared<BinaryQLogWriter>()};
+};
+
+TEST_F(FlightRecorderQLoggerTest, KeepsLastEvents) {
+  auto start = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+  FlightRecorderQLogger q(VantagePoint::Server, kHTTP3ProtocolType, "", 5);
+  q.setDcid(dcid_);
+  for (PacketNum i = 0; i < 10; ++i) {
+    q.addPacketsLost(i, 1200, 1);
+  }
+  EXPECT_EQ(q.numEvents(), 5);
+
+  auto logger = decode(q);
+  EXPECT_EQ(logger->dcid, dcid_);
+  EXPECT_EQ(lostPacketNums(*logger), std::vector<PacketNum>({5, 6, 7, 8, 9}));
+  // Evicted events still count towards the time of the retained ones.
+  EXPECT_GE(logger->logs.front()->refTime, start);
+  for (size_t i = 1; i < logger->logs.size(); ++i) {
+    EXPECT_GE(logger->logs[i]->refTime, logger->logs[i - 1]->refTime);
+  }
+}
+
+TEST_F(FlightRecorderQLoggerTest, EvictsToFitCapacity) {
+  FlightRecorderQLogger q(
+      VantagePoint::Client, kHTTP3ProtocolType, "", 1000, 100);
+  for (PacketNum i = 0; i < 100; ++i) {
+    q.addPacketsLost(i, 1200, 1);
+  }
+  EXPECT_LT(q.numEvents(), 100);
+  EXPECT_GT(q.numEvents(), 0);
+
+  // The ring has wrapped several times by now.
+  auto packetNums = lostPacketNums(*decode(q));
+  ASSERT_EQ(packetNums.size(), q.numEvents());
+  EXPECT_EQ(packetNums.back(), 99);
+  for (size_t i = 1; i < packetNums.size(); ++i) {
+    EXPECT_EQ(packetNums[i], packetNums[i - 1] + 1);
+  }
+}
+
+TEST_F(FlightRecorderQLoggerTest, DropsEventLargerThanRing) {
+  FlightRecorderQLogger q(
+      VantagePoint::Client, kHTTP3ProtocolType, "", 1000, 32);
+  q.addPacketsLost(1, 1200, 1);
+  q.addConnectionClose(
+      kNoError, std::string(100, 'x'), true /* drainConnection */, false);
+  EXPECT_EQ(q.numEvents(), 0);
+  q.addPacketsLost(2, 1200, 1);
+  EXPECT_EQ(lostPacketNums(*decode(q)), std::vector<PacketNum>({2}));
+}
+
+TEST_F(FlightRecorderQLoggerTest, DumpsOnConnectionError) {
+  folly::fs::remove(jsonPath());
+  FlightRecorderQLogger q(
+      VantagePoint::Server,
+      kHTTP3ProtocolType,
+      dir_,
+      FlightRecorderQLogger::kDefaultMaxEvents,
+      FlightRecorderQLogger::kDefaultCapacityBytes,
+      FlightRecorderQLogger::kDefaultPtoCountThreshold,
+      true /* prettyJson */,
+      writer_);
+  q.setDcid(dcid_);
+  q.addPacketsLost(1, 1200, 1);
+  // Graceful closes whose error strings are not kNoError.
+  q.setConnectionCloseError(GenericApplicationErrorCode::NO_ERROR);
+  q.addConnectionClose("No Error", "", false, false);
+  q.setConnectionCloseError(LocalErrorCode::IDLE_TIMEOUT);
+  q.addConnectionClose("Idle timeout", "", true, false);
+  EXPECT_EQ(q.numDumps(), 0);
+  writer_->flush();
+  EXPECT_FALSE(folly::fs::exists(jsonPath()));
+
+  q.setConnectionCloseError(TransportErrorCode::PROTOCOL_VIOLATION);
+  q.addConnectionClose("Protocol violation", "", false, true);
+  EXPECT_EQ(q.numDumps(), 1);
+  writer_->flush();
+  std::string json;
+  ASSERT_TRUE(folly::readFile(jsonPath().c_str(), json));
+  auto events = folly::parseJson(json)["traces"][0]["events"];
+  ASSERT_EQ(events.size(), 4);
+  EXPECT_EQ(events[0]["name"], "quic:packet_lost");
+  EXPECT_EQ(events[3]["data"]["error"], "Protocol violation");
+}
+
+TEST_F(FlightRecorderQLoggerTest, DumpsOnPtoThreshold) {
+  FlightRecorderQLogger q(
+      VantagePoint::Server,
+      kHTTP3ProtocolType,
+      dir_,
+      FlightRecorderQLogger::kDefaultMaxEvents,
+      FlightRecorderQLogger::kDefaultCapacityBytes,
+      2,
+      true /* prettyJson */,
+      writer_);
+  q.setDcid(dcid_);
+  q.addLossAlarm(10, 1, 5, kPtoAlarm);
+  EXPECT_EQ(q.numDumps(), 0);
+  q.addLossAlarm(10, 2, 5, kPtoAlarm);
+  EXPECT_EQ(q.numDumps(), 1);
+  q.addLossAlarm(10, 3, 5, kPtoAlarm);
+  EXPECT_EQ(q.numDumps(), 1);
+  q.dump();
+  EXPECT_EQ(q.numDumps(), 2);
+  writer_->flush();
+  EXPECT_TRUE(folly::fs::exists(jsonPath()));
+  // Only dumps are written, never a binary qlog of every event.
+  EXPECT_FALSE(folly::fs::exists(
+      fmt::format("{}/{}{}", dir_, dcid_.hex(), kBinaryQLogExtension)));
+}
+
+} // namespace quic::test
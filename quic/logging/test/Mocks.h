@@ -98,5 +98,9 @@ class MockQLogger : public QLogger {
        std::chrono::microseconds bandwidthHiInterval,
        uint64_t bandwidthLoBytes,
        std::chrono::microseconds bandwidthLoInterval));
+  MOCK_METHOD(
+      void,
+      addPmtuUpdate,
+      (uint64_t probeSize, uint64_t packetSize, std::string trigger));
 };
 } // namespace quic::test
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/logging/FileQLogger.h>
+#include <quic/logging/FlightRecorderQLogger.h>
+
+#include <optional>
+
+using namespace quic;
+using namespace quic::test;
+
+namespace {
+// Bounds the memory FileQLogger holds on to over a long run.
+constexpr size_t kMaxRetainedLogs = 4096;
+
+RegularQuicWritePacket makePacket() {
+  RegularQuicWritePacket packet =
+      createNewPacket(100, PacketNumberSpace::AppData);
+  WriteAckFrame ackFrame;
+  ackFrame.ackDelay = 111us;
+  ackFrame.ackBlocks.emplace_back(300, 400);
+  ackFrame.ackBlocks.emplace_back(100, 200);
+  packet.frames.emplace_back(std::move(ackFrame));
+  packet.frames.emplace_back(WriteStreamFrame(4, 0, 1200, false));
+  return packet;
+}
+} // namespace
+
+BENCHMARK(file_qlogger_add_packet, iters) {
+  std::optional<FileQLogger> q;
+  std::optional<RegularQuicWritePacket> packet;
+  BENCHMARK_SUSPEND {
+    q.emplace(VantagePoint::Server);
+    q->logs.reserve(kMaxRetainedLogs);
+    packet.emplace(makePacket());
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    q->addPacket(*packet, 1252);
+    if (q->logs.size() == kMaxRetainedLogs) {
+      BENCHMARK_SUSPEND {
+        q->logs.clear();
+      }
+    }
+  }
+}
+
+BENCHMARK_RELATIVE(flight_recorder_add_packet, iters) {
+  std::optional<FlightRecorderQLogger> q;
+  std::optional<RegularQuicWritePacket> packet;
+  BENCHMARK_SUSPEND {
+    q.emplace(VantagePoint::Server);
+    packet.emplace(makePacket());
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    q->addPacket(*packet, 1252);
+  }
+  folly::doNotOptimizeAway(q->numEvents());
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -11,6 +11,7 @@
 #include <quic/loss/QuicLossFunctions.h>
 #include <quic/observer/SocketObserverMacros.h>
 #include <quic/state/ConnectionOopsFields.h>
+#include <quic/state/PmtuDiscoveryFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
 
 namespace quic {
@@ -64,6 +65,11 @@ quic::Expected<void, QuicError> onPTOAlarm(QuicConnectionStateBase& conn) {
       conn.lossState.ptoCount,
       conn.outstandings.numOutstanding(),
       kPtoAlarm);
+  // Repeated PTOs after path MTU discovery raised the packet size suggest the
+  // path stopped carrying the larger packets.
+  if (conn.lossState.ptoCount >= kPmtuBlackHolePtoThreshold) {
+    onPmtuBlackHoleSuspected(conn, Clock::now());
+  }
   // Path degradation / blackhole detection via ptoCount thresholds.
   // Uses pending event flags so the transport can invoke connCallback_
   // (onPTOAlarm only has access to QuicConnectionStateBase, not callbacks).
@@ -428,12 +434,25 @@ quic::Expected<bool, QuicError> processOutstandingsForLoss(
       QUIC_STATS(conn.statsCallback, onPacketLossByReorderingThreshold);
       iter->metadata.lossReorderDistance = reorderDistance;
     }
-    lossEvent.addLostPacket(pkt);
-    if (observerLossEvent) {
-      observerLossEvent->addLostPacket(
-          pkt.metadata,
-          pkt.packet.header.getPacketSequenceNum(),
-          pkt.packet.header.getPacketNumberSpace());
+    if (pkt.isPmtuProbe) {
+      // A lost probe most likely did not fit the path, which says nothing
+      // about congestion. Take it out of flight without reporting a loss to
+      // the congestion controller.
+      subtractAndCheckUnderflow(
+          conn.lossState.inflightBytes, pkt.metadata.encodedSize);
+      if (conn.congestionController) {
+        conn.congestionController->onRemoveBytesFromInflight(
+            pkt.metadata.encodedSize);
+      }
+      onPmtuProbeLost(conn, currentPacketNum, lossTime);
+    } else {
+      lossEvent.addLostPacket(pkt);
+      if (observerLossEvent) {
+        observerLossEvent->addLostPacket(
+            pkt.metadata,
+            pkt.packet.header.getPacketSequenceNum(),
+            pkt.packet.header.getPacketNumberSpace());
+      }
     }
     conn.outstandings.declaredLostCount++;
     iter->declaredLost = true;
@@ -24,6 +24,7 @@
 #include <quic/logging/test/Mocks.h>
 #include <quic/loss/QuicLossFunctions.h>
 #include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/PmtuDiscoveryFunctions.h>
 #include <quic/state/stream/StreamSendHandlers.h>
 #include <quic/state/test/MockQuicStats.h>
 #include <quic/state/test/Mocks.h>
@@ -916,6 +917,61 @@ TEST_F(QuicLossFunctionsTest, TestReorderingThresholdWithSkippedPacket) {
   // reorder threshold anymore
 }
 
+TEST_F(QuicLossFunctionsTest, LostPmtuProbeIsNotCongestion) {
+  std::vector<PacketNum> lostPacket;
+  auto conn = createConn();
+  conn->transportSettings.pmtuDiscoveryConfig.enabled = true;
+  conn->transportSettings.pmtuDiscoveryConfig.maxPacketSize = 1500;
+  maybeInitPmtuDiscovery(*conn, kMaxUDPPayload);
+  ASSERT_TRUE(conn->pmtuDiscovery.has_value());
+  startPmtuDiscovery(*conn, Clock::now());
+  auto probeSize = nextPmtuProbeSize(*conn, Clock::now());
+
+  auto mockCongestionController = std::make_unique<MockCongestionController>();
+  auto rawCongestionController = mockCongestionController.get();
+  conn->congestionController = std::move(mockCongestionController);
+  EXPECT_CALL(*rawCongestionController, onPacketSent(_))
+      .WillRepeatedly(Return());
+
+  auto probeNum = sendPacket(
+      *conn,
+      Clock::now(),
+      std::nullopt,
+      PacketType::OneRtt,
+      static_cast<uint16_t>(probeSize));
+  auto& probe = conn->outstandings.packets.back();
+  probe.isPmtuProbe = true;
+  auto probeBytes = probe.metadata.encodedSize;
+  onPmtuProbeSent(*conn, probeNum);
+  auto packetNum =
+      sendPacket(*conn, Clock::now(), std::nullopt, PacketType::OneRtt);
+  auto packetBytes = conn->outstandings.packets.back().metadata.encodedSize;
+  conn->lossState.inflightBytes = probeBytes + packetBytes;
+
+  // Only the probe is taken out of flight directly, the regular packet is
+  // left to the loss event.
+  EXPECT_CALL(*rawCongestionController, onRemoveBytesFromInflight(probeBytes))
+      .Times(1);
+  auto& ackState = getAckState(*conn, PacketNumberSpace::AppData);
+  ackState.largestAckedByPeer = packetNum + kReorderingThreshold;
+  auto lossResult = detectLossPackets(
+      *conn,
+      ackState,
+      TESTING_LOSS_MARK_FUNC(lostPacket),
+      TimePoint(90ms),
+      PacketNumberSpace::AppData);
+  ASSERT_FALSE(lossResult.hasError());
+  auto& lossEvent = lossResult.value();
+  ASSERT_TRUE(lossEvent.has_value());
+  EXPECT_EQ(lossEvent->lostPackets, 1);
+  EXPECT_EQ(lossEvent->lostBytes, packetBytes);
+  EXPECT_EQ(lossEvent->largestLostPacketNum, packetNum);
+  EXPECT_EQ(conn->lossState.inflightBytes, packetBytes);
+  EXPECT_EQ(lostPacket, std::vector<PacketNum>({probeNum, packetNum}));
+  EXPECT_EQ(conn->pmtuDiscovery->probesLost, 1);
+  EXPECT_TRUE(conn->outstandings.packets.front().declaredLost);
+}
+
 TEST_F(QuicLossFunctionsTest, TestHandleAckForLoss) {
   auto conn = createConn();
   auto mockQLogger = std::make_shared<MockQLogger>(VantagePoint::Server);
@@ -14,7 +14,7 @@ namespace quic {
 
 SocketObserverInterface::WriteEvent::Builder&&
 SocketObserverInterface::WriteEvent::Builder::setOutstandingPackets(
-    const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn) {
+    const OutstandingPacketContainer& outstandingPacketsIn) {
   maybeOutstandingPacketsRef = outstandingPacketsIn;
   return std::move(*this);
 }
@@ -75,7 +75,7 @@ SocketObserverInterface::WriteEvent::WriteEvent(
 
 SocketObserverInterface::AppLimitedEvent::Builder&&
 SocketObserverInterface::AppLimitedEvent::Builder::setOutstandingPackets(
-    const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn) {
+    const OutstandingPacketContainer& outstandingPacketsIn) {
   maybeOutstandingPacketsRef = outstandingPacketsIn;
   return std::move(*this);
 }
@@ -230,7 +230,7 @@ void SocketObserverInterface::PacketsWrittenEvent::
 
 SocketObserverInterface::PacketsWrittenEvent::Builder&&
 SocketObserverInterface::PacketsWrittenEvent::Builder::setOutstandingPackets(
-    const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn) {
+    const OutstandingPacketContainer& outstandingPacketsIn) {
   maybeOutstandingPacketsRef = outstandingPacketsIn;
   return std::move(*this);
 }
@@ -13,7 +13,6 @@
 #include <quic/state/OutstandingPacket.h>
 #include <quic/state/QuicStreamUtilities.h>
 
-#include <deque>
 #include <utility>
 
 namespace quic {
@@ -89,13 +88,13 @@ class SocketObserverInterface {
   };
 
   struct WriteEvent {
-    [[nodiscard]] const std::deque<OutstandingPacketWrapper>&
-    getOutstandingPackets() const {
+    [[nodiscard]] const OutstandingPacketContainer& getOutstandingPackets()
+        const {
       return outstandingPackets;
     }
 
     // Reference to the current list of outstanding packets.
-    const std::deque<OutstandingPacketWrapper>& outstandingPackets;
+    const OutstandingPacketContainer& outstandingPackets;
 
     // Monotonically increasing number assigned to each write operation.
     const uint64_t writeCount;
@@ -114,8 +113,7 @@ class SocketObserverInterface {
     const Optional<uint64_t> maybeWritableBytes;
 
     struct BuilderFields {
-      Optional<
-          std::reference_wrapper<const std::deque<OutstandingPacketWrapper>>>
+      Optional<std::reference_wrapper<const OutstandingPacketContainer>>
           maybeOutstandingPacketsRef;
       Optional<uint64_t> maybeWriteCount;
       Optional<TimePoint> maybeLastPacketSentTime;
@@ -126,7 +124,7 @@ class SocketObserverInterface {
 
     struct Builder : public BuilderFields {
       Builder&& setOutstandingPackets(
-          const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn);
+          const OutstandingPacketContainer& outstandingPacketsIn);
       Builder&& setWriteCount(const uint64_t writeCountIn);
       Builder&& setLastPacketSentTime(const TimePoint& lastPacketSentTimeIn);
       Builder&& setLastPacketSentTime(
@@ -155,7 +153,7 @@ class SocketObserverInterface {
   struct AppLimitedEvent : public WriteEvent {
     struct Builder : public WriteEvent::BuilderFields {
       Builder&& setOutstandingPackets(
-          const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn);
+          const OutstandingPacketContainer& outstandingPacketsIn);
       Builder&& setWriteCount(const uint64_t writeCountIn);
       Builder&& setLastPacketSentTime(const TimePoint& lastPacketSentTimeIn);
       Builder&& setLastPacketSentTime(
@@ -198,7 +196,7 @@ class SocketObserverInterface {
 
     struct Builder : public BuilderFields {
       Builder&& setOutstandingPackets(
-          const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn);
+          const OutstandingPacketContainer& outstandingPacketsIn);
       Builder&& setWriteCount(const uint64_t writeCountIn);
       Builder&& setLastPacketSentTime(const TimePoint& lastPacketSentTimeIn);
       Builder&& setLastPacketSentTime(
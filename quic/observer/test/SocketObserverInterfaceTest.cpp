@@ -76,7 +76,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // no new packets, no old packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
 
     // build event with writeCount = 10
     const auto event = SocketObserverInterface::PacketsWrittenEvent::Builder()
@@ -108,7 +108,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // no new packets, has old packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -149,7 +149,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // no new ack eliciting packets, no old packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
 
     // build event with writeCount = 10
     const auto event = SocketObserverInterface::PacketsWrittenEvent::Builder()
@@ -181,7 +181,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // no new ack eliciting packets, has old packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -222,7 +222,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // first packet sent for initial, handshake, app data, single write, ordered
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::Initial;
@@ -303,7 +303,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // first packet sent for initial, handshake, app data, single write, reversed
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -385,7 +385,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // specifically, ordered by packet number, but random on pnspace
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::Handshake;
@@ -466,7 +466,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // first packet for initial, handshake, app data, separate writes, ordered
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::Initial;
@@ -535,7 +535,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // first packet for initial, handshake, app data, separate writes, reversed
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -604,7 +604,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // retransmit initial
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::Initial;
@@ -683,7 +683,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // retransmit all three
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::Initial;
@@ -794,7 +794,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, single new packet
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -843,7 +843,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, single new packet, non-ack eliciting written
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -892,7 +892,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, multiple new packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -957,7 +957,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, multiple new packets, non-ack eliciting written
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -1022,7 +1022,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, multiple old packets, multiple new packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -1107,7 +1107,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, multiple old packets, single new packet
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketContainer outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -0,0 +1,511 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Random.h>
+#include <quic/codec/QuicConnectionId.h>
+#include <quic/common/MvfstCheck.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace quic {
+
+/**
+ * Open addressing map from connection id to Value, for the lookup every
+ * received datagram does in QuicServerWorker.
+ *
+ * Every slot has a control byte holding either 7 bits of its key's hash or an
+ * empty / deleted marker. Lookups compare a group of 16 control bytes at once
+ * (with SSE2 where available) and only touch the slots whose bits match. The
+ * full hash is kept next to each key, so mismatching keys are rejected without
+ * comparing connection ids and growing never rehashes them.
+ *
+ * The hash reads a word at a time, unlike ConnectionIdHash which has to stay
+ * compatible with its historical values. It is seeded once per process, so a
+ * hash computed with one map can be handed to find() on another. prefetch()
+ * starts loading the control bytes and first slot for a connection id given
+ * as raw bytes, so that a reader can overlap the cache misses of a whole
+ * batch of packets before looking any of them up.
+ *
+ * Inserting invalidates iterators; erasing only invalidates the erased one.
+ * Iteration order is unspecified.
+ */
+template <typename Value>
+class ConnectionIdMap {
+  static constexpr size_t kGroupWidth = 16;
+
+ public:
+  using key_type = ConnectionId;
+  using mapped_type = Value;
+  using value_type = std::pair<const ConnectionId, Value>;
+
+  template <bool IsConst>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = ConnectionIdMap::value_type;
+    using reference =
+        std::conditional_t<IsConst, const value_type&, value_type&>;
+    using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+    using MapPtr =
+        std::conditional_t<IsConst, const ConnectionIdMap*, ConnectionIdMap*>;
+
+    Iterator() = default;
+
+    // An iterator converts to a const_iterator.
+    template <bool WasConst, typename = std::enable_if_t<IsConst && !WasConst>>
+    /* implicit */ Iterator(const Iterator<WasConst>& other)
+        : map_(other.map_), index_(other.index_) {}
+
+    reference operator*() const {
+      return map_->slots_[index_].entry();
+    }
+
+    pointer operator->() const {
+      return &map_->slots_[index_].entry();
+    }
+
+    Iterator& operator++() {
+      index_ = map_->nextFull(index_ + 1);
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      auto prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    friend class ConnectionIdMap;
+    template <bool>
+    friend class Iterator;
+
+    Iterator(MapPtr map, size_t index) : map_(map), index_(index) {}
+
+    MapPtr map_{nullptr};
+    size_t index_{0};
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  ConnectionIdMap() : seed_(processSeed()) {}
+
+  ConnectionIdMap(const ConnectionIdMap&) = delete;
+  ConnectionIdMap& operator=(const ConnectionIdMap&) = delete;
+
+  ~ConnectionIdMap() {
+    destroyAll();
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return size_;
+  }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  iterator begin() {
+    return iterator(this, nextFull(0));
+  }
+
+  iterator end() {
+    return iterator(this, capacity_);
+  }
+
+  const_iterator begin() const {
+    return const_iterator(this, nextFull(0));
+  }
+
+  const_iterator end() const {
+    return const_iterator(this, capacity_);
+  }
+
+  /**
+   * Hashes the connection id in data and prefetches where its lookup will
+   * start. Returns the hash, which find() accepts to skip hashing again.
+   */
+  uint64_t prefetch(const uint8_t* data, size_t len) const {
+    auto hash = hashBytes(data, len);
+    if (capacity_ != 0) {
+      auto index = probeStart(hash);
+      prefetchAddress(ctrl_.get() + index);
+      prefetchAddress(&slots_[index]);
+    }
+    return hash;
+  }
+
+  [[nodiscard]] uint64_t hash(const ConnectionId& connId) const {
+    return hashBytes(connId.data(), connId.size());
+  }
+
+  iterator find(const ConnectionId& connId) {
+    return find(connId, hash(connId));
+  }
+
+  const_iterator find(const ConnectionId& connId) const {
+    return find(connId, hash(connId));
+  }
+
+  // hash must be what hash() or prefetch() of any map returned for connId.
+  iterator find(const ConnectionId& connId, uint64_t hash) {
+    return iterator(this, findIndex(connId, hash));
+  }
+
+  const_iterator find(const ConnectionId& connId, uint64_t hash) const {
+    return const_iterator(this, findIndex(connId, hash));
+  }
+
+  [[nodiscard]] bool contains(const ConnectionId& connId) const {
+    return findIndex(connId, hash(connId)) != capacity_;
+  }
+
+  [[nodiscard]] size_t count(const ConnectionId& connId) const {
+    return contains(connId) ? 1 : 0;
+  }
+
+  /**
+   * Constructs Value(args...) for connId if it is not in the map yet, with
+   * the same semantics as std::unordered_map::try_emplace().
+   */
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(
+      const ConnectionId& connId,
+      Args&&... args) {
+    auto hash = this->hash(connId);
+    auto index = findIndex(connId, hash);
+    if (index != capacity_) {
+      return {iterator(this, index), false};
+    }
+    if (growthLeft_ == 0) {
+      growForInsert();
+    }
+    index = findFreeIndex(hash);
+    auto& slot = slots_[index];
+    new (&slot.storage) value_type(
+        std::piecewise_construct,
+        std::forward_as_tuple(connId),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+    slot.hash = hash;
+    // A reused tombstone was already counted against growth.
+    if (ctrl_[index] == kEmpty) {
+      --growthLeft_;
+    }
+    setCtrl(index, hashBits(hash));
+    ++size_;
+    return {iterator(this, index), true};
+  }
+
+  std::pair<iterator, bool> emplace(const ConnectionId& connId, Value value) {
+    return try_emplace(connId, std::move(value));
+  }
+
+  // Returns the iterator following pos.
+  iterator erase(iterator pos) {
+    MVDCHECK(pos.map_ == this && pos.index_ < capacity_);
+    eraseIndex(pos.index_);
+    return iterator(this, nextFull(pos.index_ + 1));
+  }
+
+  size_t erase(const ConnectionId& connId) {
+    auto index = findIndex(connId, hash(connId));
+    if (index == capacity_) {
+      return 0;
+    }
+    eraseIndex(index);
+    return 1;
+  }
+
+  // Keeps the allocated capacity.
+  void clear() noexcept {
+    if (capacity_ == 0) {
+      return;
+    }
+    destroyAll();
+    std::memset(ctrl_.get(), kEmpty, capacity_ + kGroupWidth);
+    size_ = 0;
+    growthLeft_ = maxLoad(capacity_);
+  }
+
+  void reserve(size_t count) {
+    if (count > maxLoad(capacity_)) {
+      resize(capacityFor(count));
+    }
+  }
+
+ private:
+  // Control byte values. Full slots hold the low 7 bits of their hash.
+  static constexpr uint8_t kEmpty = 0x80;
+  static constexpr uint8_t kDeleted = 0xfe;
+
+  struct Slot {
+    value_type& entry() {
+      return *std::launder(reinterpret_cast<value_type*>(&storage));
+    }
+
+    const value_type& entry() const {
+      return *std::launder(reinterpret_cast<const value_type*>(&storage));
+    }
+
+    uint64_t hash;
+    alignas(value_type) unsigned char storage[sizeof(value_type)];
+  };
+
+  /**
+   * The control bytes of kGroupWidth consecutive slots, as bitmasks with bit
+   * i standing for the i-th slot.
+   */
+  class Group {
+   public:
+    explicit Group(const uint8_t* ctrl) {
+#if defined(__SSE2__)
+      ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+      std::memcpy(ctrl_, ctrl, kGroupWidth);
+#endif
+    }
+
+    [[nodiscard]] uint32_t match(uint8_t value) const {
+#if defined(__SSE2__)
+      return static_cast<uint32_t>(_mm_movemask_epi8(
+          _mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(static_cast<char>(value)))));
+#else
+      uint32_t mask = 0;
+      for (size_t i = 0; i < kGroupWidth; ++i) {
+        mask |= uint32_t(ctrl_[i] == value) << i;
+      }
+      return mask;
+#endif
+    }
+
+    [[nodiscard]] uint32_t matchEmpty() const {
+      return match(kEmpty);
+    }
+
+    // Both markers have the top bit set, full slots do not.
+    [[nodiscard]] uint32_t matchFree() const {
+#if defined(__SSE2__)
+      return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+#else
+      uint32_t mask = 0;
+      for (size_t i = 0; i < kGroupWidth; ++i) {
+        mask |= uint32_t(ctrl_[i] >> 7) << i;
+      }
+      return mask;
+#endif
+    }
+
+   private:
+#if defined(__SSE2__)
+    __m128i ctrl_;
+#else
+    uint8_t ctrl_[kGroupWidth];
+#endif
+  };
+
+  static uint64_t processSeed() {
+    static const uint64_t seed = folly::Random::rand64();
+    return seed;
+  }
+
+  uint64_t hashBytes(const uint8_t* data, size_t len) const {
+    uint64_t hash = seed_ ^ len;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, data + i, sizeof(word));
+      hash = std::rotl((hash ^ word) * 0x9e3779b97f4a7c15ULL, 31);
+    }
+    if (i < len) {
+      uint64_t word = 0;
+      std::memcpy(&word, data + i, len - i);
+      hash = std::rotl((hash ^ word) * 0x9e3779b97f4a7c15ULL, 31);
+    }
+    // Murmur3's finalizer, so that both the control bits and the position
+    // depend on every input bit.
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  static void prefetchAddress(const void* address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+  }
+
+  static uint8_t hashBits(uint64_t hash) {
+    return static_cast<uint8_t>(hash & 0x7f);
+  }
+
+  [[nodiscard]] size_t probeStart(uint64_t hash) const {
+    return (hash >> 7) & (capacity_ - 1);
+  }
+
+  // At most 7/8 of the slots are full or deleted, so probing always ends at
+  // an empty slot.
+  static size_t maxLoad(size_t capacity) {
+    return capacity - capacity / 8;
+  }
+
+  static size_t capacityFor(size_t count) {
+    return std::bit_ceil(std::max(kGroupWidth, count + count / 7 + 1));
+  }
+
+  // Returns capacity_ when connId is not in the map.
+  [[nodiscard]] size_t findIndex(const ConnectionId& connId, uint64_t hash)
+      const {
+    if (size_ == 0) {
+      return capacity_;
+    }
+    auto mask = capacity_ - 1;
+    auto bits = hashBits(hash);
+    auto pos = probeStart(hash);
+    for (size_t step = kGroupWidth;; step += kGroupWidth) {
+      Group group(ctrl_.get() + pos);
+      for (auto match = group.match(bits); match; match &= match - 1) {
+        auto index = (pos + std::countr_zero(match)) & mask;
+        const auto& slot = slots_[index];
+        if (slot.hash == hash && slot.entry().first == connId) {
+          return index;
+        }
+      }
+      if (group.matchEmpty()) {
+        return capacity_;
+      }
+      pos = (pos + step) & mask;
+    }
+  }
+
+  [[nodiscard]] size_t findFreeIndex(uint64_t hash) const {
+    auto mask = capacity_ - 1;
+    auto pos = probeStart(hash);
+    for (size_t step = kGroupWidth;; step += kGroupWidth) {
+      if (auto free = Group(ctrl_.get() + pos).matchFree()) {
+        return (pos + std::countr_zero(free)) & mask;
+      }
+      pos = (pos + step) & mask;
+    }
+  }
+
+  [[nodiscard]] size_t nextFull(size_t index) const {
+    while (index < capacity_ && (ctrl_[index] & kEmpty)) {
+      ++index;
+    }
+    return index;
+  }
+
+  void setCtrl(size_t index, uint8_t value) {
+    ctrl_[index] = value;
+    // The bytes past the end mirror the first group, so that a group can be
+    // loaded from any slot without wrapping.
+    if (index < kGroupWidth) {
+      ctrl_[capacity_ + index] = value;
+    }
+  }
+
+  void eraseIndex(size_t index) {
+    slots_[index].entry().~value_type();
+    --size_;
+    // The slot can become empty again only if no probe ever went past it,
+    // i.e. if no group containing it was ever entirely full.
+    auto mask = capacity_ - 1;
+    auto emptyAfter = Group(ctrl_.get() + index).matchEmpty();
+    auto emptyBefore =
+        Group(ctrl_.get() + ((index - kGroupWidth) & mask)).matchEmpty();
+    if (emptyAfter && emptyBefore &&
+        std::countr_zero(emptyAfter) +
+                std::countl_zero(static_cast<uint16_t>(emptyBefore)) <
+            static_cast<int>(kGroupWidth)) {
+      setCtrl(index, kEmpty);
+      ++growthLeft_;
+    } else {
+      setCtrl(index, kDeleted);
+    }
+  }
+
+  void growForInsert() {
+    if (capacity_ == 0) {
+      resize(kGroupWidth);
+    } else if (size_ <= maxLoad(capacity_) / 2) {
+      // Mostly tombstones, drop them instead of growing.
+      resize(capacity_);
+    } else {
+      resize(capacity_ * 2);
+    }
+  }
+
+  void resize(size_t capacity) {
+    auto oldCtrl = std::move(ctrl_);
+    auto oldSlots = std::move(slots_);
+    auto oldCapacity = capacity_;
+    ctrl_ = std::make_unique<uint8_t[]>(capacity + kGroupWidth);
+    std::memset(ctrl_.get(), kEmpty, capacity + kGroupWidth);
+    slots_ = std::unique_ptr<Slot[]>(new Slot[capacity]);
+    capacity_ = capacity;
+    growthLeft_ = maxLoad(capacity) - size_;
+    for (size_t i = 0; i < oldCapacity; ++i) {
+      if (oldCtrl[i] & kEmpty) {
+        continue;
+      }
+      auto& oldSlot = oldSlots[i];
+      auto index = findFreeIndex(oldSlot.hash);
+      auto& slot = slots_[index];
+      new (&slot.storage) value_type(std::move(oldSlot.entry()));
+      oldSlot.entry().~value_type();
+      slot.hash = oldSlot.hash;
+      setCtrl(index, hashBits(slot.hash));
+    }
+  }
+
+  void destroyAll() noexcept {
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (!(ctrl_[i] & kEmpty)) {
+        slots_[i].entry().~value_type();
+      }
+    }
+  }
+
+  std::unique_ptr<uint8_t[]> ctrl_;
+  std::unique_ptr<Slot[]> slots_;
+  // A power of two of at least kGroupWidth, or 0 before the first insert.
+  size_t capacity_{0};
+  size_t size_{0};
+  // How many more empty slots may be filled before resizing.
+  size_t growthLeft_{0};
+  const uint64_t seed_;
+};
+
+} // namespace quic
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/server/QuicReusePortSteering.h>
+
+#include <quic/QuicConstants.h>
+#include <quic/common/StringUtils.h>
+
+#if defined(__linux__)
+#include <linux/filter.h>
+#include <sys/socket.h>
+#endif
+
+#include <vector>
+
+namespace quic {
+
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+
+namespace {
+
+// Any socket index past the end of the group makes the kernel fall back to
+// hashing.
+constexpr uint32_t kFallbackToHash = 0xffffffff;
+// The first byte of the destination connection id in a short header packet.
+// The program runs on the UDP payload.
+constexpr uint32_t kShortHeaderDcidOffset = 1;
+constexpr uint8_t kLongHeaderBit = 0x80;
+constexpr uint8_t kCidVersionBitsMask = 0xc0;
+
+class ProgramBuilder {
+ public:
+  void stmt(uint16_t code, uint32_t k) {
+    program_.push_back(BPF_STMT(code, k));
+  }
+
+  // Jumps to the fallback when the condition is false.
+  void jumpToFallbackUnless(uint16_t code, uint32_t k) {
+    fallbackJumps_.push_back(program_.size());
+    program_.push_back(BPF_JUMP(BPF_JMP | code | BPF_K, k, 0, 0));
+  }
+
+  // Loads the byte at offset of the destination connection id into A.
+  void loadDcidByte(uint32_t offset) {
+    stmt(BPF_LD | BPF_B | BPF_ABS, kShortHeaderDcidOffset + offset);
+  }
+
+  std::vector<sock_filter> finish() && {
+    stmt(BPF_RET | BPF_A, 0);
+    auto fallback = program_.size();
+    stmt(BPF_RET | BPF_K, kFallbackToHash);
+    for (auto jump : fallbackJumps_) {
+      program_[jump].jf = static_cast<uint8_t>(fallback - jump - 1);
+    }
+    return std::move(program_);
+  }
+
+ private:
+  std::vector<sock_filter> program_;
+  std::vector<size_t> fallbackJumps_;
+};
+
+} // namespace
+
+quic::Expected<void, QuicError> attachReusePortSteeringProgram(
+    int fd,
+    ConnectionIdVersion version,
+    size_t numWorkers) {
+  if (numWorkers == 0) {
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        "No workers to steer to"));
+  }
+  // Bytes of the connection id up to and including the worker id.
+  uint32_t minCidSize;
+  switch (version) {
+    case ConnectionIdVersion::V1:
+      minCidSize = kMinSelfConnectionIdV1Size;
+      break;
+    case ConnectionIdVersion::V2:
+      minCidSize = kMinSelfConnectionIdV2Size;
+      break;
+    case ConnectionIdVersion::V3:
+      minCidSize = kMinSelfConnectionIdV3Size;
+      break;
+    default:
+      return quic::make_unexpected(QuicError(
+          QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+          "No worker id in connection id version"));
+  }
+
+  ProgramBuilder builder;
+  builder.stmt(BPF_LD | BPF_W | BPF_LEN, 0);
+  builder.jumpToFallbackUnless(BPF_JGE, kShortHeaderDcidOffset + minCidSize);
+  // Only short header packets carry a connection id we chose.
+  builder.stmt(BPF_LD | BPF_B | BPF_ABS, 0);
+  builder.stmt(BPF_ALU | BPF_AND | BPF_K, kLongHeaderBit);
+  builder.jumpToFallbackUnless(BPF_JEQ, 0);
+  builder.loadDcidByte(0);
+  builder.stmt(BPF_ALU | BPF_AND | BPF_K, kCidVersionBitsMask);
+  builder.jumpToFallbackUnless(BPF_JEQ, static_cast<uint32_t>(version) << 6);
+  // Mirrors getWorkerIdFromConnId() in DefaultConnectionIdAlgo.
+  switch (version) {
+    case ConnectionIdVersion::V1:
+      builder.loadDcidByte(2);
+      builder.stmt(BPF_ALU | BPF_AND | BPF_K, 0x3f);
+      builder.stmt(BPF_ALU | BPF_LSH | BPF_K, 2);
+      builder.stmt(BPF_MISC | BPF_TAX, 0);
+      builder.loadDcidByte(3);
+      builder.stmt(BPF_ALU | BPF_RSH | BPF_K, 6);
+      builder.stmt(BPF_ALU | BPF_OR | BPF_X, 0);
+      break;
+    case ConnectionIdVersion::V2:
+      builder.loadDcidByte(4);
+      break;
+    default:
+      builder.loadDcidByte(5);
+      break;
+  }
+  builder.stmt(BPF_ALU | BPF_MOD | BPF_K, static_cast<uint32_t>(numWorkers));
+  auto program = std::move(builder).finish();
+
+  sock_fprog prog{};
+  prog.len = static_cast<unsigned short>(program.size());
+  prog.filter = program.data();
+  if (::setsockopt(
+          fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) != 0) {
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        "Failed to attach reuseport steering program: " +
+            quic::errnoStr(errno)));
+  }
+  return {};
+}
+
+#else
+
+quic::Expected<void, QuicError> attachReusePortSteeringProgram(
+    int /* fd */,
+    ConnectionIdVersion /* version */,
+    size_t /* numWorkers */) {
+  return quic::make_unexpected(QuicError(
+      QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+      "Reuseport steering is not supported on this platform"));
+}
+
+#endif
+
+} // namespace quic
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/QuicException.h>
+#include <quic/codec/QuicConnectionId.h>
+#include <quic/common/Expected.h>
+
+namespace quic {
+
+/**
+ * Attaches a classic BPF program to the SO_REUSEPORT group of fd that picks
+ * the socket for a short header packet from the worker id that
+ * DefaultConnectionIdAlgo encoded into its destination connection id, modulo
+ * numWorkers, the same way QuicServer routes packets between workers. It
+ * relies on the i-th socket that joined the group belonging to worker i.
+ *
+ * Long header packets, packets too short to carry the worker id and
+ * connection ids of another version fall back to the kernel's 4-tuple hash,
+ * so Initial packets are spread as before.
+ *
+ * Linux only; returns an error elsewhere or when the kernel refuses it.
+ */
+[[nodiscard]] quic::Expected<void, QuicError> attachReusePortSteeringProgram(
+    int fd,
+    ConnectionIdVersion version,
+    size_t numWorkers);
+
+} // namespace quic
@@ -14,6 +14,7 @@
 #include <folly/system/HardwareConcurrency.h>
 #include <quic/codec/DefaultConnectionIdAlgo.h>
 #include <quic/codec/QuicHeaderCodec.h>
+#include <quic/server/QuicReusePortSteering.h>
 #include <quic/server/QuicReusePortUDPSocketFactory.h>
 #include <quic/server/QuicServerTransport.h>
 #include <quic/server/QuicSharedUDPSocketFactory.h>
@@ -116,6 +117,25 @@ QuicServer::getBatchWriterFactoryOverride() const noexcept {
   return batchWriterFactoryOverride_;
 }
 
+void QuicServer::setEgressBatchFlushObserver(
+    QuicServerEgressBatcher::FlushObserver observer) {
+  checkRunningInThread(mainThreadId_);
+  MVCHECK(!initialized_, kQuicServerNotInitialized << __func__);
+  egressBatchFlushObserver_ = std::move(observer);
+}
+
+void QuicServer::setForwardingRingCapacity(size_t ringCapacity) {
+  checkRunningInThread(mainThreadId_);
+  MVCHECK(!initialized_, kQuicServerNotInitialized << __func__);
+  forwardingRingCapacity_ = ringCapacity;
+}
+
+void QuicServer::setReusePortSteering(bool enabled) {
+  checkRunningInThread(mainThreadId_);
+  MVCHECK(!initialized_, kQuicServerNotInitialized << __func__);
+  reusePortSteering_ = enabled;
+}
+
 void QuicServer::forEachListenerSocket(
     folly::FunctionRef<void(const folly::AsyncUDPSocket*)> fn) const {
   for (const auto& worker : workers_) {
@@ -138,6 +158,16 @@ void QuicServer::setUnfinishedHandshakeLimit(std::function<int()> limitFn) {
   unfinishedHandshakeLimitFn_ = std::move(limitFn);
 }
 
+void QuicServer::setRetryUnderLoad(
+    uint32_t maxUnfinishedHandshakes,
+    uint32_t maxInitialsPerSecond) {
+  checkRunningInThread(mainThreadId_);
+  MVCHECK(!initialized_, kQuicServerNotInitialized << __func__);
+  retryUnderLoad_ = RetryUnderLoad{
+      .maxUnfinishedHandshakes = maxUnfinishedHandshakes,
+      .maxInitialsPerSecond = maxInitialsPerSecond};
+}
+
 void QuicServer::setSupportedVersion(const std::vector<QuicVersion>& versions) {
   checkRunningInThread(mainThreadId_);
   supportedVersions_ = versions;
@@ -253,6 +283,10 @@ void QuicServer::initializeWorkers(bool useDefaultTransport) {
     evbToWorkers_.emplace(
         (*workerEvbs)[i]->getEventBase(), workers_.back().get());
   }
+  if (forwardingRingCapacity_ > 0) {
+    forwarder_ = std::make_unique<QuicServerForwarder>(
+        workers_.size(), forwardingRingCapacity_);
+  }
 }
 
 std::unique_ptr<QuicServerWorker> QuicServer::newWorkerWithoutSocket() {
@@ -276,12 +310,18 @@ std::unique_ptr<QuicServerWorker> QuicServer::newWorkerWithoutSocket() {
   worker->setConnectionIdAlgo(connIdAlgoFactory_->make());
   worker->setCongestionControllerFactory(ccFactory_);
   worker->setBatchWriterFactoryOverride(batchWriterFactoryOverride_);
+  worker->setEgressBatchFlushObserver(egressBatchFlushObserver_);
   if (rateLimit_) {
     worker->setRateLimiter(
         std::make_unique<SlidingWindowRateLimiter>(
             rateLimit_->count, rateLimit_->window));
   }
   worker->setUnfinishedHandshakeLimit(unfinishedHandshakeLimitFn_);
+  if (retryUnderLoad_) {
+    worker->setRetryUnderLoad(
+        retryUnderLoad_->maxUnfinishedHandshakes,
+        retryUnderLoad_->maxInitialsPerSecond);
+  }
   worker->setTransportSettingsOverrideFn(transportSettingsOverrideFn_);
   worker->setShouldRegisterKnobParamHandlerFn(
       shouldRegisterKnobParamHandlerFn_);
@@ -342,6 +382,11 @@ void QuicServer::bindWorkersToSocket(const quic::SocketAddress& address) {
             }
           }
           if (idx == (numWorkers - 1)) {
+            if (self->reusePortSteering_) {
+              // Sockets joined the reuseport group in worker order, which is
+              // what the program relies on.
+              self->attachReusePortSteering();
+            }
             MVVLOG(4) << "Initialized all workers in the eventbase";
             self->initialized_ = true;
             folly::call_once(
@@ -351,6 +396,18 @@ void QuicServer::bindWorkersToSocket(const quic::SocketAddress& address) {
   }
 }
 
+void QuicServer::attachReusePortSteering() {
+  const auto* sock = workers_.front()->getListenerSocket();
+  if (!sock) {
+    return;
+  }
+  auto result = attachReusePortSteeringProgram(
+      sock->getNetworkSocket().toFd(), cidVersion_, workers_.size());
+  if (result.hasError()) {
+    MVLOG_ERROR << "Reuseport steering disabled. " << result.error().message;
+  }
+}
+
 void QuicServer::start() {
   checkRunningInThread(mainThreadId_);
   MVCHECK(initialized_, kQuicServerNotInitialized << __func__);
@@ -532,6 +589,17 @@ void QuicServer::routeDataToWorker(
         isForwardedData);
     return;
   }
+  if (forwarder_) {
+    forwardToWorker(
+        workerToRunOn,
+        ForwardedPacket{
+            client,
+            std::move(routingData),
+            std::move(networkData),
+            quicVersion,
+            isForwardedData});
+    return;
+  }
   worker->getEventBase()->runInEventBaseThread([server =
                                                     this->shared_from_this(),
                                                 cl = client,
@@ -549,6 +617,55 @@ void QuicServer::routeDataToWorker(
   });
 }
 
+void QuicServer::forwardToWorker(size_t dst, ForwardedPacket&& packet) {
+  // Worker ids wrap past 255 workers, which only makes workers share a ring.
+  size_t src =
+      workerPtr_ ? workerPtr_->getWorkerId() : forwarder_->numWorkers();
+  switch (forwarder_->enqueue(src, dst, std::move(packet))) {
+    case QuicServerForwarder::EnqueueResult::Queued:
+      break;
+    case QuicServerForwarder::EnqueueResult::QueuedScheduleDrain:
+      scheduleForwardedPacketsDrain(dst);
+      break;
+    case QuicServerForwarder::EnqueueResult::Full:
+      MVVLOG(4) << "Dropping data since the ring to workerId=" << dst
+                << " is full";
+      if (workerPtr_) {
+        QUIC_STATS(
+            workerPtr_->getTransportStatsCallback(),
+            onPacketDropped,
+            PacketDropReason::FORWARDING_RING_FULL);
+      }
+      break;
+  }
+}
+
+void QuicServer::scheduleForwardedPacketsDrain(size_t dst) {
+  workers_[dst]->getEventBase()->runInEventBaseThread(
+      [server = this->shared_from_this(), dst]() {
+        server->drainForwardedPackets(dst);
+      });
+}
+
+void QuicServer::drainForwardedPackets(size_t dst) {
+  auto* worker = workers_[dst].get();
+  bool leftBehind = forwarder_->drain(dst, [&](ForwardedPacket&& packet) {
+    if (shutdown_) {
+      return;
+    }
+    worker->dispatchPacketData(
+        packet.client,
+        std::move(packet.routingData),
+        std::move(packet.networkData),
+        packet.quicVersion,
+        packet.isForwardedData);
+  });
+  if (leftBehind) {
+    // Let the rest of the loop run before the next batch.
+    scheduleForwardedPacketsDrain(dst);
+  }
+}
+
 void QuicServer::handleWorkerError(LocalErrorCode error) {
   shutdown(error);
 }
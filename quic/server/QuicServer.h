@@ -21,6 +21,7 @@
 #include <quic/api/QuicBatchWriterFactory.h>
 #include <quic/codec/ConnectionIdAlgo.h>
 #include <quic/congestion_control/ServerCongestionControllerFactory.h>
+#include <quic/server/QuicServerForwardingRing.h>
 #include <quic/server/QuicServerTransportFactory.h>
 #include <quic/server/QuicServerWorker.h>
 #include <quic/server/QuicUDPSocketFactory.h>
@@ -134,6 +135,34 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
   const quic::BatchWriterFactoryOverride& getBatchWriterFactoryOverride()
       const noexcept;
 
+  /**
+   * Install an observer called on the worker thread after every flush of a
+   * worker's egress batcher (BATCHING_MODE_WORKER_SENDMMSG_GSO). Must be set
+   * before `start()`.
+   */
+  void setEgressBatchFlushObserver(
+      QuicServerEgressBatcher::FlushObserver observer);
+
+  /**
+   * Forward packets that arrive on the wrong worker through lock-free rings of
+   * ringCapacity packets per pair of workers, drained in batches by the
+   * owning worker, instead of one runInEventBaseThread() per packet. Packets
+   * are dropped when a ring is full. 0 (the default) disables. Must be set
+   * before `start()`.
+   */
+  void setForwardingRingCapacity(size_t ringCapacity);
+
+  /**
+   * Attach a BPF program to the listeners' SO_REUSEPORT group that delivers
+   * short header packets to the socket of the worker encoded in their
+   * destination connection id, so packets of a client whose address changed
+   * do not need forwarding between workers. Long header packets are still
+   * spread by 4-tuple hash. Assumes the DefaultConnectionIdAlgo layout. Linux
+   * only; logs an error and keeps hashing when it cannot be attached. Must be
+   * set before `start()`.
+   */
+  void setReusePortSteering(bool enabled);
+
   /**
    * Invoke `fn` once per worker with that worker's listener
    * `const folly::AsyncUDPSocket*`. Unbound workers are skipped — `fn` is
@@ -153,6 +182,17 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
 
   void setUnfinishedHandshakeLimit(std::function<int()> limitFn);
 
+  /**
+   * Have each worker answer new connections with a stateless Retry, without
+   * creating a transport, while it has maxUnfinishedHandshakes unfinished
+   * handshakes or receives more than maxInitialsPerSecond Initials a second.
+   * The limits apply per worker. See QuicServerWorker::setRetryUnderLoad().
+   * Must be set before `start()`.
+   */
+  void setRetryUnderLoad(
+      uint32_t maxUnfinishedHandshakes,
+      uint32_t maxInitialsPerSecond);
+
   /**
    * Set list of supported QUICVersion for this server. These versions will be
    * used during the 'Version-Negotiation' phase with the client.
@@ -380,6 +420,14 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
    */
   std::vector<folly::EventBase*> getWorkerEvbs() const noexcept;
 
+  /**
+   * Runs func for every worker on the worker's event base thread and returns
+   * once all of them ran. Does nothing after shutdown. Used to attach
+   * per-worker ingress such as an AF_XDP receiver, which has to be detached
+   * the same way before the server shuts down.
+   */
+  void runOnAllWorkersSync(const std::function<void(QuicServerWorker*)>& func);
+
   /**
    * Adds observer for accept events.
    *
@@ -433,6 +481,14 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
 
   void handleWorkerError(LocalErrorCode error) override;
 
+  // Hands packet to worker dst through forwarder_.
+  void forwardToWorker(size_t dst, ForwardedPacket&& packet);
+
+  void scheduleForwardedPacketsDrain(size_t dst);
+
+  // Runs on the thread of worker dst.
+  void drainForwardedPackets(size_t dst);
+
   using MaybeOwnedEvbPtr =
       std::unique_ptr<folly::IOExecutor, void (*)(folly::IOExecutor*)>;
 
@@ -457,11 +513,11 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
   // helper method to run the given function in all worker asynchronously
   void runOnAllWorkers(const std::function<void(QuicServerWorker*)>& func);
 
-  // helper method to run the given function in all worker synchronously
-  void runOnAllWorkersSync(const std::function<void(QuicServerWorker*)>& func);
-
   void bindWorkersToSocket(const quic::SocketAddress& address);
 
+  // Called once the last worker bound its listener.
+  void attachReusePortSteering();
+
   std::vector<QuicVersion> supportedVersions_{{
       QuicVersion::MVFST,
       QuicVersion::MVFST_EXPERIMENTAL,
@@ -502,6 +558,11 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
   // factory used to create specific instance of Congestion control algorithm
   std::shared_ptr<CongestionControllerFactory> ccFactory_;
   quic::BatchWriterFactoryOverride batchWriterFactoryOverride_;
+  QuicServerEgressBatcher::FlushObserver egressBatchFlushObserver_;
+  size_t forwardingRingCapacity_{0};
+  bool reusePortSteering_{false};
+  // Only set with a non-zero forwardingRingCapacity_.
+  std::unique_ptr<QuicServerForwarder> forwarder_;
 
   Optional<std::string> healthCheckToken_;
   // vector of all the listening fds on each quic server worker
@@ -543,6 +604,12 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
 
   std::function<int()> unfinishedHandshakeLimitFn_{[]() { return 1048576; }};
 
+  struct RetryUnderLoad {
+    uint32_t maxUnfinishedHandshakes;
+    uint32_t maxInitialsPerSecond;
+  };
+  Optional<RetryUnderLoad> retryUnderLoad_;
+
   // Options to AsyncUDPSocket::bind, only controls IPV6_ONLY currently.
   FollyAsyncUDPSocketAlias::BindOptions bindOptions_;
 
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/server/QuicServerEgressBatcher.h>
+
+#include <quic/QuicConstants.h>
+#include <quic/common/MvfstLogging.h>
+
+#include <algorithm>
+
+namespace quic {
+
+namespace {
+// Messages per sendmmsg call. Bounds the latency a single flush adds to the
+// event loop and the per-call scratch space in the socket implementation.
+constexpr size_t kMaxMessagesPerFlush = 256;
+} // namespace
+
+QuicServerEgressBatcher::QuicServerEgressBatcher(
+    folly::EventBase* evb,
+    std::unique_ptr<QuicAsyncUDPSocket> sock,
+    uint32_t maxSegmentsPerMessage)
+    : evb_(evb),
+      sock_(std::move(sock)),
+      maxSegmentsPerMessage_(std::max<uint32_t>(1, maxSegmentsPerMessage)) {
+  addrs_.reserve(kMaxMessagesPerFlush);
+  bufs_.reserve(kMaxMessagesPerFlush);
+  options_.reserve(kMaxMessagesPerFlush);
+  departureTimes_.reserve(kMaxMessagesPerFlush);
+}
+
+void QuicServerEgressBatcher::enqueue(
+    const quic::SocketAddress& peer,
+    BufPtr&& buf,
+    size_t size,
+    bool allowGso,
+    std::chrono::microseconds txTime) {
+  if (!isLoopCallbackScheduled()) {
+    // Run at the end of this loop iteration, after every connection that is
+    // going to write in it had its turn.
+    evb_->runInLoop(this, /*thisIteration=*/true);
+  }
+  numPackets_++;
+  numBytes_ += size;
+
+  if (allowGso && !lastMessageClosed_ && addrs_.back() == peer &&
+      lastMessageTxTime_ == txTime &&
+      size <= lastSegmentSize_ &&
+      lastMessageSegments_ < maxSegmentsPerMessage_ &&
+      lastMessageBytes_ + size <= kMaxGsoBatchBytes) {
+    bufs_.back()->appendToChain(std::move(buf));
+    options_.back().gso = static_cast<int>(lastSegmentSize_);
+    lastMessageSegments_++;
+    lastMessageBytes_ += size;
+    lastMessageClosed_ = size < lastSegmentSize_;
+    return;
+  }
+
+  addrs_.push_back(peer);
+  bufs_.push_back(std::move(buf));
+  options_.emplace_back(0, false);
+  // The offset is relative to now, the flush converts it back.
+  departureTimes_.push_back(
+      txTime.count() > 0 ? Clock::now() + txTime : TimePoint());
+  lastMessageTxTime_ = txTime;
+  lastSegmentSize_ = size;
+  lastMessageBytes_ = size;
+  lastMessageSegments_ = 1;
+  lastMessageClosed_ = !allowGso;
+  if (bufs_.size() >= kMaxMessagesPerFlush) {
+    flush();
+  }
+}
+
+void QuicServerEgressBatcher::flush() {
+  if (bufs_.empty()) {
+    return;
+  }
+  auto start = Clock::now();
+  FlushStats stats;
+  stats.messages = bufs_.size();
+  stats.packets = numPackets_;
+  stats.bytes = numBytes_;
+
+  for (size_t i = 0; i < departureTimes_.size(); ++i) {
+    if (departureTimes_[i] > start) {
+      options_[i].txTime =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              departureTimes_[i] - start);
+    }
+  }
+
+  size_t sent = 0;
+  while (sent < bufs_.size()) {
+    auto count = bufs_.size() - sent;
+    int ret = sock_->writemGSO(
+        AddressRange(addrs_.data() + sent, count),
+        bufs_.data() + sent,
+        count,
+        options_.data() + sent);
+    stats.syscalls++;
+    if (ret <= 0) {
+      stats.lastErrno = ret < 0 ? errno : 0;
+      break;
+    }
+    // A partial write leaves the remaining messages for another call.
+    sent += ret;
+  }
+
+  if (sent < bufs_.size()) {
+    // The packets are already tracked as outstanding by their connections,
+    // so treat the unsent ones as lost like the per-connection writers do.
+    for (size_t i = sent; i < bufs_.size(); ++i) {
+      auto len = bufs_[i]->computeChainDataLength();
+      auto gso = static_cast<size_t>(options_[i].gso);
+      stats.droppedPackets += gso ? (len + gso - 1) / gso : 1;
+    }
+    MVVLOG(4) << "Worker egress batch dropped " << stats.droppedPackets
+              << " packets, errno=" << stats.lastErrno;
+    if (stats.lastErrno) {
+      QUIC_STATS(
+          statsCallback_,
+          onUDPSocketWriteError,
+          QuicTransportStatsCallback::errnoToSocketErrorType(stats.lastErrno));
+    }
+  }
+
+  reset();
+  stats.duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+  if (flushObserver_) {
+    flushObserver_(stats);
+  }
+}
+
+void QuicServerEgressBatcher::runLoopCallback() noexcept {
+  flush();
+}
+
+void QuicServerEgressBatcher::reset() {
+  addrs_.clear();
+  bufs_.clear();
+  options_.clear();
+  departureTimes_.clear();
+  lastMessageTxTime_ = std::chrono::microseconds::zero();
+  lastSegmentSize_ = 0;
+  lastMessageBytes_ = 0;
+  lastMessageSegments_ = 0;
+  lastMessageClosed_ = true;
+  numPackets_ = 0;
+  numBytes_ = 0;
+}
+
+BatchWriterFactoryOverride makeEgressBatchWriterFactory(
+    std::weak_ptr<QuicServerEgressBatcher> batcher,
+    BatchWriterFactoryOverride next) {
+  return [batcher = std::move(batcher), next = std::move(next)](
+             const quic::QuicBatchingMode& batchingMode,
+             uint32_t batchSize,
+             DataPathType dataPathType,
+             QuicConnectionStateBase& conn,
+             bool gsoSupported) -> BatchWriterPtr {
+    if (next) {
+      auto batchWriter =
+          next(batchingMode, batchSize, dataPathType, conn, gsoSupported);
+      if (batchWriter) {
+        return batchWriter;
+      }
+    }
+    if (batchingMode !=
+            quic::QuicBatchingMode::BATCHING_MODE_WORKER_SENDMMSG_GSO ||
+        dataPathType != DataPathType::ChainedMemory) {
+      return nullptr;
+    }
+    auto egressBatcher = batcher.lock();
+    if (!egressBatcher) {
+      return nullptr;
+    }
+    return BatchWriterPtr(
+        new QuicServerEgressBatchWriter(std::move(egressBatcher), gsoSupported));
+  };
+}
+
+} // namespace quic
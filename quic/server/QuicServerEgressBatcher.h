@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/io/async/EventBase.h>
+#include <quic/api/QuicBatchWriterFactory.h>
+#include <quic/common/udpsocket/QuicAsyncUDPSocket.h>
+#include <quic/state/QuicTransportStatsCallback.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace quic {
+
+/**
+ * Worker level egress batching for BATCHING_MODE_WORKER_SENDMMSG_GSO.
+ *
+ * Every connection of a QuicServerWorker hands its packets to the worker's
+ * batcher instead of writing them itself. The batcher holds them until the
+ * end of the current event loop iteration and then sends everything with a
+ * single sendmmsg. Consecutive equally sized packets to the same peer are
+ * coalesced into one GSO message, so a connection writing a burst costs one
+ * message and an idle connection sending a lone ACK costs no syscall of its
+ * own.
+ *
+ * All connections must write through sockets sharing the fd of the socket
+ * the batcher sends on, which is the worker's listening socket. The batcher
+ * owns that socket: connection writers keep the batcher alive, so the socket
+ * must live at least as long as the last of them.
+ */
+class QuicServerEgressBatcher : private folly::EventBase::LoopCallback {
+ public:
+  struct FlushStats {
+    // sendmmsg calls made for this flush.
+    uint64_t syscalls{0};
+    uint64_t messages{0};
+    uint64_t packets{0};
+    uint64_t bytes{0};
+    // Packets dropped because the socket write failed.
+    uint64_t droppedPackets{0};
+    // errno of the last failed write, or 0.
+    int lastErrno{0};
+    std::chrono::microseconds duration{0};
+  };
+
+  // Called on the worker thread after every flush.
+  using FlushObserver = std::function<void(const FlushStats&)>;
+
+  QuicServerEgressBatcher(
+      folly::EventBase* evb,
+      std::unique_ptr<QuicAsyncUDPSocket> sock,
+      uint32_t maxSegmentsPerMessage);
+
+  ~QuicServerEgressBatcher() override = default;
+
+  QuicServerEgressBatcher(const QuicServerEgressBatcher&) = delete;
+  QuicServerEgressBatcher& operator=(const QuicServerEgressBatcher&) = delete;
+
+  void setStatsCallback(QuicTransportStatsCallback* statsCallback) noexcept {
+    statsCallback_ = statsCallback;
+  }
+
+  void setFlushObserver(FlushObserver observer) {
+    flushObserver_ = std::move(observer);
+  }
+
+  /**
+   * Queues one packet for peer. With allowGso the packet may be coalesced
+   * with the previous packet when that one went to the same peer with the
+   * same txTime. A non-zero txTime is the departure time relative to now.
+   */
+  void enqueue(
+      const quic::SocketAddress& peer,
+      BufPtr&& buf,
+      size_t size,
+      bool allowGso,
+      std::chrono::microseconds txTime = std::chrono::microseconds::zero());
+
+  /**
+   * Sends everything queued so far. Runs automatically at the end of every
+   * event loop iteration that queued packets.
+   */
+  void flush();
+
+  [[nodiscard]] bool empty() const noexcept {
+    return bufs_.empty();
+  }
+
+  [[nodiscard]] size_t numQueuedPackets() const noexcept {
+    return numPackets_;
+  }
+
+  [[nodiscard]] size_t numQueuedMessages() const noexcept {
+    return bufs_.size();
+  }
+
+ private:
+  void runLoopCallback() noexcept override;
+
+  void reset();
+
+  folly::EventBase* evb_;
+  std::unique_ptr<QuicAsyncUDPSocket> sock_;
+  uint32_t maxSegmentsPerMessage_;
+  QuicTransportStatsCallback* statsCallback_{nullptr};
+  FlushObserver flushObserver_;
+
+  // One entry per sendmmsg message.
+  std::vector<quic::SocketAddress> addrs_;
+  std::vector<BufPtr> bufs_;
+  std::vector<QuicAsyncUDPSocket::WriteOptions> options_;
+  // Absolute departure time of each message, or a default TimePoint.
+  std::vector<TimePoint> departureTimes_;
+  std::chrono::microseconds lastMessageTxTime_{0};
+  // Segment size of the last message. Only the final segment of a GSO
+  // message may be shorter, after which the message is closed.
+  size_t lastSegmentSize_{0};
+  size_t lastMessageBytes_{0};
+  uint32_t lastMessageSegments_{0};
+  bool lastMessageClosed_{true};
+
+  size_t numPackets_{0};
+  size_t numBytes_{0};
+};
+
+/**
+ * Per-connection BatchWriter that forwards every packet to the worker's
+ * QuicServerEgressBatcher. It never has anything buffered itself, so the
+ * transport's own flushes are no-ops.
+ */
+class QuicServerEgressBatchWriter : public BatchWriter {
+ public:
+  QuicServerEgressBatchWriter(
+      std::shared_ptr<QuicServerEgressBatcher> batcher,
+      bool gsoSupported)
+      : batcher_(std::move(batcher)), gsoSupported_(gsoSupported) {}
+
+  ~QuicServerEgressBatchWriter() override = default;
+
+  [[nodiscard]] bool empty() const override {
+    return true;
+  }
+
+  [[nodiscard]] size_t size() const override {
+    return 0;
+  }
+
+  void reset() override {}
+
+  [[nodiscard]] bool handsOffOnAppend() const override {
+    return true;
+  }
+
+  bool append(
+      BufPtr&& buf,
+      size_t size,
+      const quic::SocketAddress& addr,
+      QuicAsyncUDPSocket* /*sock*/) override {
+    batcher_->enqueue(addr, std::move(buf), size, gsoSupported_, txTime_);
+    return false;
+  }
+
+  ssize_t write(
+      QuicAsyncUDPSocket& /*sock*/,
+      const quic::SocketAddress& /*address*/) override {
+    return 0;
+  }
+
+  void setTxTime(std::chrono::microseconds txTime) override {
+    txTime_ = txTime;
+  }
+
+ private:
+  std::shared_ptr<QuicServerEgressBatcher> batcher_;
+  bool gsoSupported_;
+  std::chrono::microseconds txTime_{0};
+};
+
+/**
+ * Wraps next so that connections in BATCHING_MODE_WORKER_SENDMMSG_GSO write
+ * through batcher. next, when set, is consulted first. Only the chained
+ * memory data path is batched across connections: the continuous memory path
+ * reuses one write buffer per worker, so its packets cannot outlive the write
+ * call and fall back to per-connection batching.
+ */
+BatchWriterFactoryOverride makeEgressBatchWriterFactory(
+    std::weak_ptr<QuicServerEgressBatcher> batcher,
+    BatchWriterFactoryOverride next);
+
+} // namespace quic
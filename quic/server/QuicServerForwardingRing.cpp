@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/server/QuicServerForwardingRing.h>
+
+#include <folly/lang/Bits.h>
+#include <quic/common/MvfstLogging.h>
+
+#include <algorithm>
+
+namespace quic {
+
+ForwardedPacketRing::ForwardedPacketRing(size_t capacity)
+    : mask_(folly::nextPowTwo(std::max<size_t>(capacity, 2)) - 1),
+      slots_(std::make_unique<Slot[]>(mask_ + 1)) {
+  for (size_t i = 0; i <= mask_; ++i) {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool ForwardedPacketRing::tryPush(ForwardedPacket&& packet) {
+  // A slot is free for the producer at position pos once its sequence is pos,
+  // and holds a packet for the consumer once it is pos + 1.
+  auto pos = tail_.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true) {
+    slot = &slots_[pos & mask_];
+    auto sequence = slot->sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<std::ptrdiff_t>(sequence) -
+        static_cast<std::ptrdiff_t>(pos);
+    if (diff == 0) {
+      if (tail_.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // The consumer has not freed this slot from the previous lap yet.
+      return false;
+    } else {
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+  slot->packet.emplace(std::move(packet));
+  slot->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+Optional<ForwardedPacket> ForwardedPacketRing::tryPop() {
+  auto& slot = slots_[head_ & mask_];
+  if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+    return std::nullopt;
+  }
+  Optional<ForwardedPacket> packet(std::move(slot.packet));
+  slot.packet.reset();
+  slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+  ++head_;
+  return packet;
+}
+
+QuicServerForwarder::QuicServerForwarder(
+    size_t numWorkers,
+    size_t ringCapacity) {
+  MVCHECK_GT(numWorkers, 0);
+  inboxes_.reserve(numWorkers);
+  for (size_t dst = 0; dst < numWorkers; ++dst) {
+    auto inbox = std::make_unique<Inbox>();
+    inbox->rings.reserve(numWorkers + 1);
+    for (size_t src = 0; src <= numWorkers; ++src) {
+      inbox->rings.push_back(
+          std::make_unique<ForwardedPacketRing>(ringCapacity));
+    }
+    inboxes_.push_back(std::move(inbox));
+  }
+}
+
+QuicServerForwarder::EnqueueResult QuicServerForwarder::enqueue(
+    size_t src,
+    size_t dst,
+    ForwardedPacket&& packet) {
+  MVDCHECK_LT(dst, inboxes_.size());
+  auto& inbox = *inboxes_[dst];
+  MVDCHECK_LT(src, inbox.rings.size());
+  if (!inbox.rings[src]->tryPush(std::move(packet))) {
+    return EnqueueResult::Full;
+  }
+  // Pairs with the exchange in drain(): either the drain that clears the
+  // flag sees this packet, or this sees the flag cleared and schedules
+  // another drain.
+  if (!inbox.drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+    return EnqueueResult::QueuedScheduleDrain;
+  }
+  return EnqueueResult::Queued;
+}
+
+} // namespace quic
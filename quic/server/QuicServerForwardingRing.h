@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/lang/Align.h>
+#include <quic/common/NetworkData.h>
+#include <quic/common/Optional.h>
+#include <quic/server/QuicServerPacketRouter.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace quic {
+
+/**
+ * A packet handed from the worker that read it to the worker that owns its
+ * connection.
+ */
+struct ForwardedPacket {
+  quic::SocketAddress client;
+  RoutingData routingData;
+  NetworkData networkData;
+  Optional<QuicVersion> quicVersion;
+  bool isForwardedData;
+};
+
+/**
+ * Bounded lock-free multi-producer single-consumer ring of ForwardedPackets.
+ * Packets are moved in and out of preallocated slots, so neither side
+ * allocates or takes a lock. Every slot carries a sequence number that tells
+ * producers whether it is free and the consumer whether it is published.
+ */
+class ForwardedPacketRing {
+ public:
+  // capacity is rounded up to a power of two.
+  explicit ForwardedPacketRing(size_t capacity);
+
+  ForwardedPacketRing(const ForwardedPacketRing&) = delete;
+  ForwardedPacketRing& operator=(const ForwardedPacketRing&) = delete;
+
+  /**
+   * Any thread. Returns false, leaving packet untouched, when the ring is
+   * full.
+   */
+  [[nodiscard]] bool tryPush(ForwardedPacket&& packet);
+
+  // Consumer thread only. Returns std::nullopt when the ring is empty.
+  [[nodiscard]] Optional<ForwardedPacket> tryPop();
+
+  [[nodiscard]] size_t capacity() const noexcept {
+    return mask_ + 1;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    Optional<ForwardedPacket> packet;
+  };
+
+  size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(folly::hardware_destructive_interference_size)
+      std::atomic<size_t> tail_{0};
+  alignas(folly::hardware_destructive_interference_size) size_t head_{0};
+};
+
+/**
+ * Forwarding between the workers of a QuicServer. Every destination worker
+ * has one ring per source worker, plus one shared by threads that are not
+ * workers, so producers on different workers never contend with each other.
+ *
+ * The first packet queued for a worker since its last drain asks the caller
+ * to schedule a drain on that worker, which then handles everything queued by
+ * then in one go. A burst of forwarded packets therefore costs one event base
+ * notification instead of one per packet. When a ring is full the packet is
+ * dropped, so a slow worker cannot make the others queue without bound.
+ */
+class QuicServerForwarder {
+ public:
+  QuicServerForwarder(size_t numWorkers, size_t ringCapacity);
+
+  enum class EnqueueResult : uint8_t {
+    Queued,
+    // Queued, and the caller must schedule drain(dst) on the worker's thread.
+    QueuedScheduleDrain,
+    Full,
+  };
+
+  /**
+   * Any thread. src is the index of the calling worker, or numWorkers() for
+   * threads that are not workers. It only picks the ring: every ring takes
+   * any number of producers, distinct sources just do not contend.
+   */
+  EnqueueResult enqueue(size_t src, size_t dst, ForwardedPacket&& packet);
+
+  /**
+   * Thread of worker dst only. Hands at most one ring's worth of packets per
+   * ring to fn and returns true if packets were left behind, in which case
+   * the caller must schedule another drain.
+   */
+  template <typename Fn>
+  bool drain(size_t dst, Fn&& fn) {
+    auto& inbox = *inboxes_[dst];
+    // Cleared before looking at the rings, so a packet queued from here on
+    // schedules another drain.
+    inbox.drainScheduled.exchange(false, std::memory_order_acq_rel);
+    bool leftBehind = false;
+    for (auto& ring : inbox.rings) {
+      size_t n = 0;
+      for (; n < ring->capacity(); ++n) {
+        auto packet = ring->tryPop();
+        if (!packet) {
+          break;
+        }
+        fn(std::move(*packet));
+      }
+      leftBehind |= n == ring->capacity();
+    }
+    if (leftBehind) {
+      inbox.drainScheduled.store(true, std::memory_order_relaxed);
+    }
+    return leftBehind;
+  }
+
+  [[nodiscard]] size_t numWorkers() const noexcept {
+    return inboxes_.size();
+  }
+
+ private:
+  struct Inbox {
+    // Indexed by source, the last one is for threads that are not workers.
+    std::vector<std::unique_ptr<ForwardedPacketRing>> rings;
+    alignas(folly::hardware_destructive_interference_size)
+        std::atomic<bool> drainScheduled{false};
+  };
+
+  std::vector<std::unique_ptr<Inbox>> inboxes_;
+};
+
+} // namespace quic
@@ -48,6 +48,10 @@ struct RoutingData {
   // Source connection may not be present for short header packets.
   Optional<ConnectionId> sourceConnId;
 
+  // The ConnectionIdMap hash of destinationConnId, when the receiving worker
+  // computed it ahead of the lookup.
+  Optional<uint64_t> destinationConnIdHash;
+
   RoutingData(
       HeaderForm headerFormIn,
       bool isInitialIn,
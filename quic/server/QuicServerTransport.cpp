@@ -160,6 +160,14 @@ void QuicServerTransport::setServerConnectionIdRejector(
   }
 }
 
+void QuicServerTransport::setInitialCipherCache(
+    InitialCipherCache* initialCipherCache) noexcept {
+  MVCHECK(initialCipherCache);
+  if (serverConn_) {
+    serverConn_->initialCipherCache = initialCipherCache;
+  }
+}
+
 quic::Expected<void, QuicError> QuicServerTransport::onReadData(
     const quic::SocketAddress& localAddress,
     ReceivedUdpPacket&& udpPacket) {
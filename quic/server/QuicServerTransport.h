@@ -132,6 +132,12 @@ class QuicServerTransport
   void setServerConnectionIdRejector(
       ServerConnectionIdRejector* connIdRejector) noexcept;
 
+  /**
+   * Set the cache the connection takes its Initial ciphers from. It must
+   * outlive the connection's handshake.
+   */
+  void setInitialCipherCache(InitialCipherCache* initialCipherCache) noexcept;
+
   virtual void setClientConnectionId(const ConnectionId& clientConnectionId);
 
   void setClientChosenDestConnectionId(const ConnectionId& serverCid);
@@ -14,6 +14,7 @@
 #include <quic/common/MvfstLogging.h>
 #include <atomic>
 #include <chrono>
+#include <limits>
 #include <memory>
 
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
@@ -23,6 +24,7 @@
 #endif
 
 #include <quic/common/SocketUtil.h>
+#include <quic/common/udpsocket/IoUringQuicAsyncUDPSocket.h>
 #include <quic/congestion_control/Bbr.h>
 #include <quic/congestion_control/Copa.h>
 #include <quic/fizz/handshake/FizzRetryIntegrityTagGenerator.h>
@@ -30,6 +32,7 @@
 #include <quic/server/AcceptObserver.h>
 #include <quic/server/QuicServerWorker.h>
 #include <quic/server/handshake/StatelessResetGenerator.h>
+#include <quic/server/handshake/InitialCipherCache.h>
 #include <quic/server/handshake/TokenGenerator.h>
 #include <quic/server/third-party/siphash.h>
 #include <quic/state/ConnectionOopsFields.h>
@@ -76,6 +79,14 @@ QuicServerWorker::QuicServerWorker(
     MVVLOG(10)
         << "GSO write buf accessor created for ContinuousMemory data path";
   }
+  if (transportSettings_.initialCipherCacheSize > 0) {
+    initialCipherCache_ = std::make_unique<InitialCipherCache>(
+        transportSettings_.initialCipherCacheSize);
+  }
+  if (transportSettings_.retryTokenSecret.has_value()) {
+    tokenGenerator_ =
+        std::make_unique<TokenGenerator>(*transportSettings_.retryTokenSecret);
+  }
 }
 
 folly::EventBase* QuicServerWorker::getEventBase() const {
@@ -215,6 +226,11 @@ void QuicServerWorker::setBatchWriterFactoryOverride(
   batchWriterFactoryOverride_ = std::move(override);
 }
 
+void QuicServerWorker::setEgressBatchFlushObserver(
+    QuicServerEgressBatcher::FlushObserver observer) {
+  egressBatchFlushObserver_ = std::move(observer);
+}
+
 void QuicServerWorker::setRateLimiter(
     std::unique_ptr<RateLimiter> rateLimiter) {
   newConnRateLimiter_ = std::move(rateLimiter);
@@ -225,20 +241,39 @@ void QuicServerWorker::setUnfinishedHandshakeLimit(
   unfinishedHandshakeLimitFn_ = std::move(limitFn);
 }
 
+void QuicServerWorker::setRetryUnderLoad(
+    uint32_t maxUnfinishedHandshakes,
+    uint32_t maxInitialsPerSecond) {
+  retryUnderLoad_ = RetryUnderLoad{
+      .maxUnfinishedHandshakes = maxUnfinishedHandshakes,
+      .maxInitialsPerSecond = maxInitialsPerSecond};
+}
+
 void QuicServerWorker::start() {
   MVCHECK(socket_);
   if (!pacingTimer_) {
     pacingTimer_ = std::make_unique<HighResQuicTimer>(
         evb_.get(), transportSettings_.pacingTimerResolution);
   }
+  auto qEvb = std::make_shared<FollyQuicEventBase>(evb_.get());
   if (transportSettings_.shouldUseWrapperRecvmmsgForBatchRecv) {
-    auto qEvb = std::make_shared<FollyQuicEventBase>(evb_.get());
-    quicSocket_ = std::make_shared<FollyQuicAsyncUDPSocket>(qEvb, *socket_);
+    quicSocket_ = makeListenerQuicSocket(qEvb);
     quicReadCallbackAdapter_ = std::make_unique<QuicReadCallbackAdapter>(this);
     quicSocket_->resumeRead(quicReadCallbackAdapter_.get());
   } else {
     socket_->resumeRead(this);
   }
+  if (transportSettings_.batchingMode ==
+      QuicBatchingMode::BATCHING_MODE_WORKER_SENDMMSG_GSO) {
+    if (auto egressSocket = makeEgressQuicSocket(qEvb)) {
+      egressBatcher_ = std::make_shared<QuicServerEgressBatcher>(
+          evb_.get(), std::move(egressSocket), transportSettings_.maxBatchSize);
+      egressBatcher_->setStatsCallback(statsCallback_.get());
+      egressBatcher_->setFlushObserver(egressBatchFlushObserver_);
+    } else {
+      MVLOG_ERROR << "Failed to create the egress batching socket";
+    }
+  }
   MVVLOG(10) << fmt::format(
       "Registered read on worker={}, thread={}, processId={}",
       fmt::ptr(this),
@@ -246,6 +281,62 @@ void QuicServerWorker::start() {
       (int)processId_);
 }
 
+std::unique_ptr<QuicAsyncUDPSocket> QuicServerWorker::makeListenerQuicSocket(
+    const std::shared_ptr<FollyQuicEventBase>& qEvb) {
+  if (auto sock = makeIoUringListenerQuicSocket(qEvb)) {
+    return sock;
+  }
+  return std::make_unique<FollyQuicAsyncUDPSocket>(qEvb, *socket_);
+}
+
+std::unique_ptr<QuicAsyncUDPSocket> QuicServerWorker::makeEgressQuicSocket(
+    const std::shared_ptr<FollyQuicEventBase>& qEvb) {
+  if (auto sock = makeIoUringListenerQuicSocket(qEvb)) {
+    return sock;
+  }
+  // Connections can keep the egress batcher alive past shutdown, which
+  // resets socket_, so wrap a socket of our own on the listening fd.
+  auto sock = makeSocket(evb_.get());
+  if (!sock) {
+    return nullptr;
+  }
+  sock->setTXTime({.clockid = CLOCK_MONOTONIC, .deadline = false});
+  return std::make_unique<FollyQuicAsyncUDPSocket>(qEvb, std::move(sock));
+}
+
+std::unique_ptr<QuicAsyncUDPSocket>
+QuicServerWorker::makeIoUringListenerQuicSocket(
+    const std::shared_ptr<FollyQuicEventBase>& qEvb) {
+  if (transportSettings_.useIoUringSocket) {
+    IoUringQuicSocketOptions options;
+    // A provided receive buffer holds what one recvmmsg entry would, which
+    // with GRO is a whole batch. Keep the total buffer memory about the same.
+    options.maxRecvPayloadSize = static_cast<uint32_t>(std::min<uint64_t>(
+        std::max(
+            transportSettings_.maxRecvPacketSize,
+            uint64_t(kDefaultUDPReadBufferSize)) *
+            numGROBuffers_,
+        std::numeric_limits<uint16_t>::max()));
+    options.numRecvBuffers = std::max<uint32_t>(
+        options.numRecvBuffers / numGROBuffers_,
+        transportSettings_.maxRecvBatchSize);
+    auto sock = makeIoUringQuicAsyncUDPSocket(qEvb, options);
+    if (!sock) {
+      MVLOG_WARNING << "io_uring sockets are not supported on this host";
+    } else {
+      auto fdResult = sock->setFD(
+          socket_->getNetworkSocket().toFd(),
+          QuicAsyncUDPSocket::FDOwnership::SHARED);
+      if (!fdResult.hasError()) {
+        return sock;
+      }
+      MVLOG_ERROR << "Failed to use the listening fd with io_uring: "
+                  << fdResult.error().message;
+    }
+  }
+  return nullptr;
+}
+
 void QuicServerWorker::timeoutExpired() noexcept {
   logTimeBasedStats();
 }
@@ -447,6 +538,7 @@ void QuicServerWorker::onDataAvailable(
 
     size_t remaining = len;
     size_t offset = 0;
+    batchingReads_ = true;
     while (remaining) {
       if (static_cast<int>(remaining) <= params.gro) {
         // do not clone the last packet
@@ -477,6 +569,7 @@ void QuicServerWorker::onDataAvailable(
       udpPacket.peerAddress = client;
       handleNetworkData(udpPacket);
     }
+    flushReadBatch();
   }
 }
 
@@ -517,8 +610,22 @@ void QuicServerWorker::onSocketReadable(QuicAsyncUDPSocket& sock) noexcept {
     }
   }
 
+  auto packets = std::move(networkData).movePackets();
+  handleReceivedPackets(packets);
+}
+
+void QuicServerWorker::handleReceivedPackets(
+    std::vector<ReceivedUdpPacket>& packets) noexcept {
   const auto batchReceiveTime = Clock::now();
-  for (auto& udpPacket : std::move(networkData).movePackets()) {
+  // Start the connection id lookups of the whole batch before handling any
+  // of it, so that their cache misses overlap.
+  batchConnIdHashes_.clear();
+  for (const auto& udpPacket : packets) {
+    batchConnIdHashes_.push_back(prefetchConnectionId(udpPacket));
+  }
+  batchingReads_ = true;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    auto& udpPacket = packets[i];
     if (udpPacket.buf.empty()) {
       continue;
     }
@@ -550,13 +657,66 @@ void QuicServerWorker::onSocketReadable(QuicAsyncUDPSocket& sock) noexcept {
     QUIC_STATS(statsCallback_, onPacketReceived);
     QUIC_STATS(statsCallback_, onRead, udpPacket.buf.chainLength());
 
-    handleNetworkData(udpPacket);
+    handleNetworkData(udpPacket, false, batchConnIdHashes_[i]);
+  }
+  flushReadBatch();
+}
+
+Optional<uint64_t> QuicServerWorker::prefetchConnectionId(
+    const ReceivedUdpPacket& packet) const {
+  if (packet.buf.empty()) {
+    return std::nullopt;
+  }
+  // Where parseShortHeaderInvariants() will read the connection id from.
+  const auto* head = packet.buf.front();
+  if (head->length() < sizeof(uint8_t) + kDefaultConnectionIdSize ||
+      getHeaderForm(head->data()[0]) != HeaderForm::Short) {
+    return std::nullopt;
+  }
+  return connectionIdMap_.prefetch(
+      head->data() + sizeof(uint8_t), kDefaultConnectionIdSize);
+}
+
+bool QuicServerWorker::batchShortHeaderPacket(
+    const quic::SocketAddress& client,
+    const ConnectionId& dstConnId,
+    Optional<uint64_t> dstConnIdHash,
+    ReceivedUdpPacket& udpPacket) {
+  auto it = dstConnIdHash ? connectionIdMap_.find(dstConnId, *dstConnIdHash)
+                          : connectionIdMap_.find(dstConnId);
+  if (it == connectionIdMap_.end()) {
+    return false;
   }
+  for (auto& entry : readBatch_) {
+    if (entry.transport == it->second && entry.peerAddress == client) {
+      // Adding stamps the packet with the first packet's time, keep its own.
+      auto receiveTimePoint = udpPacket.timings.receiveTimePoint;
+      entry.networkData.emplacePacket(std::move(udpPacket))
+          .timings.receiveTimePoint = receiveTimePoint;
+      return true;
+    }
+  }
+  readBatch_.push_back(
+      ReadBatchEntry{it->second, client, NetworkData(std::move(udpPacket))});
+  return true;
+}
+
+void QuicServerWorker::flushReadBatch() noexcept {
+  batchingReads_ = false;
+  // The entries keep their transports alive while earlier ones run, even if
+  // handling the data closes and unbinds them.
+  for (auto& entry : readBatch_) {
+    MVDCHECK(entry.transport->getEventBase()->isInEventBaseThread());
+    entry.transport->onNetworkData(
+        socket_->address(), std::move(entry.networkData));
+  }
+  readBatch_.clear();
 }
 
 void QuicServerWorker::handleNetworkData(
     ReceivedUdpPacket& udpPacket,
-    bool isForwardedData) noexcept {
+    bool isForwardedData,
+    Optional<uint64_t> dstConnIdHash) noexcept {
   MVCHECK(udpPacket.peerAddress.has_value());
   const auto& client = *udpPacket.peerAddress;
   // if packet drop reason is set, invoke stats cb accordingly
@@ -604,12 +764,21 @@ void QuicServerWorker::handleNetworkData(
     if (headerForm == HeaderForm::Short) {
       if (auto maybeParsedShortHeader =
               parseShortHeaderInvariants(initialByte, cursor)) {
+        if (batchingReads_ &&
+            batchShortHeaderPacket(
+                client,
+                maybeParsedShortHeader->destinationConnId,
+                dstConnIdHash,
+                udpPacket)) {
+          return;
+        }
         RoutingData routingData(
             headerForm,
             false, /* isInitial */
             false, /* is0Rtt */
             std::move(maybeParsedShortHeader->destinationConnId),
             std::nullopt);
+        routingData.destinationConnIdHash = dstConnIdHash;
         return forwardNetworkData(
             client,
             std::move(routingData),
@@ -753,10 +922,21 @@ QuicServerTransport::Ptr QuicServerWorker::makeTransport(
   // create 'accepting' transport
   auto* evb = getEventBase();
   auto sock = zeroCopyEnabled_ ? makeAlias() : makeSocket(evb);
+  if (sock &&
+      transportSettings_.pacingMode == PacingMode::EarliestDepartureTime) {
+    // Departure times are only attached to writes of sockets that enabled
+    // SO_TXTIME themselves, even if they share the listener's fd.
+    sock->setTXTime({.clockid = CLOCK_MONOTONIC, .deadline = false});
+  }
+  // The worker batcher sends on the listening socket, so it can only carry
+  // packets of connections whose socket shares that fd.
+  bool useEgressBatcher = egressBatcher_ && sock &&
+      sock->getNetworkSocket() == socket_->getNetworkSocket();
   auto trans =
       transportFactory_->make(evb, std::move(sock), client, quicVersion, ctx_);
   if (trans) {
     globalUnfinishedHandshakes++;
+    unfinishedHandshakes_++;
     if (transportSettings_.dataPathType == DataPathType::ContinuousMemory &&
         bufAccessor_) {
       trans->setBufAccessor(bufAccessor_.get());
@@ -770,7 +950,10 @@ QuicServerTransport::Ptr QuicServerWorker::makeTransport(
       trans->verifiedClientAddress();
     }
     trans->setCongestionControllerFactory(ccFactory_);
-    if (batchWriterFactoryOverride_) {
+    if (useEgressBatcher) {
+      trans->setBatchWriterFactoryOverride(makeEgressBatchWriterFactory(
+          egressBatcher_, batchWriterFactoryOverride_));
+    } else if (batchWriterFactoryOverride_) {
       trans->setBatchWriterFactoryOverride(batchWriterFactoryOverride_);
     }
     trans->setTransportStatsCallback(statsCallback_.get()); // ok if nullptr
@@ -804,6 +987,9 @@ QuicServerTransport::Ptr QuicServerWorker::makeTransport(
     trans->setTransportSettings(transportSettingsCopy);
     trans->setConnectionIdAlgo(connIdAlgo_.get());
     trans->setServerConnectionIdRejector(this);
+    if (initialCipherCache_) {
+      trans->setInitialCipherCache(initialCipherCache_.get());
+    }
     trans->setShouldRegisterKnobParamHandlerFn(
         shouldRegisterKnobParamHandlerFn_);
     trans->setQuicExperimentHandlerFn(quicExperimentHandlerFn_);
@@ -894,7 +1080,9 @@ void QuicServerWorker::dispatchPacketData(
   bool shouldFwdPacket = false;
   const auto& maybeSrcConnId = routingData.sourceConnId;
   const auto& dstConnId = routingData.destinationConnId;
-  auto cit = connectionIdMap_.find(dstConnId);
+  auto cit = routingData.destinationConnIdHash
+      ? connectionIdMap_.find(dstConnId, *routingData.destinationConnIdHash)
+      : connectionIdMap_.find(dstConnId);
 
   // if conditions satisfy, drop packet or fwd to another server
   auto handlePacketFwdOrDrop = folly::makeGuard([&]() {
@@ -1073,19 +1261,34 @@ void QuicServerWorker::dispatchPacketData(
   auto maybeEncryptedToken = maybeGetEncryptedToken(cursor);
   bool hasTokenSecret = transportSettings_.retryTokenSecret.has_value();
 
+  bool retryUnderLoad =
+      hasTokenSecret && shouldRetryUnderLoad(networkData.getReceiveTimePoint());
+  if (retryUnderLoad && !maybeEncryptedToken) {
+    // Nothing to validate, so answer before doing any token decryption.
+    QUIC_STATS(statsCallback_, onConnectionRateLimited);
+    sendRetryPacket(
+        client,
+        dstConnId,
+        maybeSrcConnId.value_or(ConnectionId::createZeroLength()));
+    return;
+  }
+
   // If the retryTokenSecret is not set, just skip evaluating validity of
   // token and assume true
   bool isValidRetryToken = !hasTokenSecret ||
       (maybeEncryptedToken &&
        validRetryToken(*maybeEncryptedToken, dstConnId, client.getIPAddress()));
 
+  // A token that decrypted as a retry token can't also be a new token. Under
+  // load only a retry token lets the connection through, so a new token isn't
+  // worth decrypting either.
   bool isValidNewToken = !hasTokenSecret ||
-      (maybeEncryptedToken &&
+      (maybeEncryptedToken && !isValidRetryToken && !retryUnderLoad &&
        validNewToken(*maybeEncryptedToken, client.getIPAddress()));
 
   if (isValidNewToken) {
     QUIC_STATS(statsCallback_, onNewTokenReceived);
-  } else if (maybeEncryptedToken && !isValidRetryToken) {
+  } else if (maybeEncryptedToken && !isValidRetryToken && !retryUnderLoad) {
     // Failed to decrypt the token as either a new or retry token
     QUIC_STATS(statsCallback_, onTokenDecryptFailure);
   }
@@ -1093,7 +1296,8 @@ void QuicServerWorker::dispatchPacketData(
   // If rate-limiting is configured and there is no retry token,
   // send a retry packet back to the client
   if (!isValidRetryToken &&
-      ((newConnRateLimiter_ &&
+      (retryUnderLoad ||
+       (newConnRateLimiter_ &&
         newConnRateLimiter_->check(networkData.getReceiveTimePoint())) ||
        (unfinishedHandshakeLimitFn_.has_value() &&
         globalUnfinishedHandshakes >= (*unfinishedHandshakeLimitFn_)()))) {
@@ -1200,14 +1404,12 @@ bool QuicServerWorker::validRetryToken(
     std::string& encryptedToken,
     const ConnectionId& dstConnId,
     const folly::IPAddress& clientIp) {
-  MVCHECK(transportSettings_.retryTokenSecret.has_value());
-
-  TokenGenerator tokenGenerator(transportSettings_.retryTokenSecret.value());
+  MVCHECK(tokenGenerator_);
 
   // Create a pseudo token to generate the assoc data.
   RetryToken token(dstConnId, clientIp, 0);
 
-  auto maybeDecryptedRetryTokenMs = tokenGenerator.decryptToken(
+  auto maybeDecryptedRetryTokenMs = tokenGenerator_->decryptToken(
       BufHelpers::copyBuffer(encryptedToken), token.genAeadAssocData());
 
   return maybeDecryptedRetryTokenMs &&
@@ -1217,20 +1419,59 @@ bool QuicServerWorker::validRetryToken(
 bool QuicServerWorker::validNewToken(
     std::string& encryptedToken,
     const folly::IPAddress& clientIp) {
-  MVCHECK(transportSettings_.retryTokenSecret.has_value());
-
-  TokenGenerator tokenGenerator(transportSettings_.retryTokenSecret.value());
+  MVCHECK(tokenGenerator_);
 
   // Create a pseudo token to generate the assoc data.
   NewToken token(clientIp);
 
-  auto maybeDecryptedNewTokenMs = tokenGenerator.decryptToken(
+  auto maybeDecryptedNewTokenMs = tokenGenerator_->decryptToken(
       BufHelpers::copyBuffer(encryptedToken), token.genAeadAssocData());
 
   return maybeDecryptedNewTokenMs &&
       checkTokenAge(maybeDecryptedNewTokenMs, kMaxNewTokenValidMs);
 }
 
+bool QuicServerWorker::shouldRetryUnderLoad(TimePoint receiveTime) {
+  if (!retryUnderLoad_) {
+    return false;
+  }
+  auto& load = *retryUnderLoad_;
+  if (receiveTime - load.windowStart >= std::chrono::seconds(1)) {
+    if (load.retrying) {
+      // Only the window that just ended counts, so a gap of more than a
+      // second means no Initials arrived in the last one.
+      uint32_t lastSecondInitials =
+          receiveTime - load.windowStart < std::chrono::seconds(2)
+          ? load.initialsInWindow
+          : 0;
+      bool initialsBelow = load.maxInitialsPerSecond == 0 ||
+          lastSecondInitials <= load.maxInitialsPerSecond / 2;
+      bool handshakesBelow = load.maxUnfinishedHandshakes == 0 ||
+          unfinishedHandshakes_ <= load.maxUnfinishedHandshakes / 2;
+      if (initialsBelow && handshakesBelow) {
+        MVVLOG(2) << "Worker no longer under load, unfinishedHandshakes="
+                  << unfinishedHandshakes_
+                  << " initialsPerSecond=" << lastSecondInitials;
+        load.retrying = false;
+      }
+    }
+    load.windowStart = receiveTime;
+    load.initialsInWindow = 0;
+  }
+  load.initialsInWindow++;
+  if (!load.retrying &&
+      ((load.maxInitialsPerSecond != 0 &&
+        load.initialsInWindow > load.maxInitialsPerSecond) ||
+       (load.maxUnfinishedHandshakes != 0 &&
+        unfinishedHandshakes_ >= load.maxUnfinishedHandshakes))) {
+    MVVLOG(2) << "Worker under load, answering Initials with Retry,"
+              << " unfinishedHandshakes=" << unfinishedHandshakes_
+              << " initialsInWindow=" << load.initialsInWindow;
+    load.retrying = true;
+  }
+  return load.retrying;
+}
+
 void QuicServerWorker::sendRetryPacket(
     const quic::SocketAddress& client,
     const ConnectionId& dstConnId,
@@ -1241,11 +1482,9 @@ void QuicServerWorker::sendRetryPacket(
   }
 
   // Create the encrypted retry token
-  TokenGenerator generator(transportSettings_.retryTokenSecret.value());
-
   // RetryToken defaults to currentTimeInMs
   RetryToken retryToken(dstConnId, client.getIPAddress(), client.getPort());
-  auto encryptedToken = generator.encryptToken(retryToken);
+  auto encryptedToken = tokenGenerator_->encryptToken(retryToken);
 
   MVCHECK(encryptedToken.has_value());
   std::string encryptedTokenStr = encryptedToken.value()->toString();
@@ -1468,8 +1707,7 @@ void QuicServerWorker::onConnectionIdAvailable(
             << *transport;
   QuicServerTransport* transportPtr = transport.get();
   std::weak_ptr<QuicServerTransport> weakTransport = transport;
-  auto result =
-      connectionIdMap_.emplace(std::make_pair(id, std::move(transport)));
+  auto result = connectionIdMap_.emplace(id, std::move(transport));
   if (!result.second) {
     // In the case of duplicates, log if they represent the same transport,
     // or different ones.
@@ -1583,10 +1821,14 @@ void QuicServerWorker::onConnectionUnbound(
 
 void QuicServerWorker::onHandshakeFinished() noexcept {
   MVCHECK_GE(--globalUnfinishedHandshakes, 0);
+  MVCHECK_GT(unfinishedHandshakes_, 0);
+  unfinishedHandshakes_--;
 }
 
 void QuicServerWorker::onHandshakeUnfinished() noexcept {
   MVCHECK_GE(--globalUnfinishedHandshakes, 0);
+  MVCHECK_GT(unfinishedHandshakes_, 0);
+  unfinishedHandshakes_--;
 }
 
 void QuicServerWorker::shutdownAllConnections(LocalErrorCode error) {
@@ -1627,6 +1869,12 @@ void QuicServerWorker::shutdownAllConnections(LocalErrorCode error) {
           QuicError(QuicErrorCode(error), std::string("shutting down")));
     }
   }
+  if (egressBatcher_) {
+    // Get the close frames written above out now. Transports still holding a
+    // writer keep the batcher, and with it the socket, alive.
+    egressBatcher_->flush();
+    egressBatcher_.reset();
+  }
   cancelTimeout();
   boundServerTransports_.clear();
   sourceAddressMap_.clear();
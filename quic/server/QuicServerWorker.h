@@ -24,6 +24,8 @@
 #include <quic/common/udpsocket/FollyQuicAsyncUDPSocket.h>
 #include <quic/common/udpsocket/QuicAsyncUDPSocket.h>
 #include <quic/congestion_control/CongestionControllerFactory.h>
+#include <quic/server/ConnectionIdMap.h>
+#include <quic/server/QuicServerEgressBatcher.h>
 #include <quic/server/QuicServerPacketRouter.h>
 #include <quic/server/QuicServerTransportFactory.h>
 #include <quic/server/QuicUDPSocketFactory.h>
@@ -35,6 +37,7 @@
 namespace quic {
 
 class AcceptObserver;
+class TokenGenerator;
 
 class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
                          public QuicServerTransport::RoutingCallback,
@@ -313,6 +316,13 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
    */
   void setBatchWriterFactoryOverride(quic::BatchWriterFactoryOverride override);
 
+  /**
+   * Set an observer called after every flush of the worker egress batcher
+   * used with BATCHING_MODE_WORKER_SENDMMSG_GSO. Must be set before start().
+   */
+  void setEgressBatchFlushObserver(
+      QuicServerEgressBatcher::FlushObserver observer);
+
   /**
    * Set the rate limiter which will be used to rate limit new connections.
    */
@@ -320,6 +330,19 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
 
   void setUnfinishedHandshakeLimit(std::function<int()> limitFn);
 
+  /**
+   * Answer Initials that don't carry a valid retry token with a stateless
+   * Retry, without creating a transport, while this worker is loaded. The
+   * worker starts doing so once its unfinished handshakes reach
+   * maxUnfinishedHandshakes or it receives more than maxInitialsPerSecond
+   * Initials within a second, and stops after a second in which both stayed
+   * at or below half their limit. A limit of 0 is not checked. Has no effect
+   * unless TransportSettings::retryTokenSecret is set.
+   */
+  void setRetryUnderLoad(
+      uint32_t maxUnfinishedHandshakes,
+      uint32_t maxInitialsPerSecond);
+
   // Read callback
   void getReadBuffer(void** buf, size_t* len) noexcept override;
 
@@ -425,8 +448,7 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
       Optional<QuicVersion> quicVersion,
       bool isForwardedData = false) noexcept;
 
-  using ConnIdToTransportMap = folly::
-      F14FastMap<ConnectionId, QuicServerTransport::Ptr, ConnectionIdHash>;
+  using ConnIdToTransportMap = ConnectionIdMap<QuicServerTransport::Ptr>;
 
   struct SourceIdentityHash {
     size_t operator()(const QuicServerTransport::SourceIdentity& sid) const;
@@ -449,10 +471,18 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
   }
 
   // Handle the network data for a udp packet. Caller must populate
-  // packet.peerAddress with the datagram source. Public so tests can call it.
+  // packet.peerAddress with the datagram source. dstConnIdHash is what
+  // prefetchConnectionId() returned for the packet, if it was called. Public
+  // so tests can call it.
   void handleNetworkData(
       ReceivedUdpPacket& packet,
-      bool isForwardedData = false) noexcept;
+      bool isForwardedData = false,
+      Optional<uint64_t> dstConnIdHash = std::nullopt) noexcept;
+
+  // Handles a batch of datagrams read outside of the listening socket, e.g.
+  // from an AF_XDP socket, the way onSocketReadable() handles what it reads.
+  // Every packet must have its peerAddress set.
+  void handleReceivedPackets(std::vector<ReceivedUdpPacket>& packets) noexcept;
 
   /**
    * Try handling the data as a health check.
@@ -541,6 +571,10 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
       std::string& encryptedToken,
       const folly::IPAddress& clientIp);
 
+  // Counts an Initial for a new connection towards the retry under load
+  // limits and returns whether it should be answered with a Retry.
+  bool shouldRetryUnderLoad(TimePoint receiveTime);
+
   void sendRetryPacket(
       const quic::SocketAddress& client,
       const ConnectionId& dstConnId,
@@ -603,8 +637,40 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
   // then dispatches each packet to handleNetworkData using its peerAddress.
   void onSocketReadable(QuicAsyncUDPSocket& sock) noexcept;
 
+  // Starts the connectionIdMap_ lookup of a short header packet ahead of
+  // handling it. Returns the hash of its destination connection id.
+  Optional<uint64_t> prefetchConnectionId(
+      const ReceivedUdpPacket& packet) const;
+
+  // While reading a batch, adds a short header packet of a connection of
+  // this worker to readBatch_ instead of dispatching it. Returns false,
+  // leaving the packet as it was, if it has to be routed.
+  bool batchShortHeaderPacket(
+      const quic::SocketAddress& client,
+      const ConnectionId& dstConnId,
+      Optional<uint64_t> dstConnIdHash,
+      ReceivedUdpPacket& udpPacket);
+
+  // Hands every transport in readBatch_ its packets in one onNetworkData().
+  void flushReadBatch() noexcept;
+
+  // A QuicAsyncUDPSocket on the listening fd, io_uring based if
+  // TransportSettings::useIoUringSocket is set and io_uring is usable.
+  std::unique_ptr<QuicAsyncUDPSocket> makeListenerQuicSocket(
+      const std::shared_ptr<FollyQuicEventBase>& qEvb);
+
+  // Like makeListenerQuicSocket, but never refers to socket_, so it can
+  // outlive the worker's shutdown.
+  std::unique_ptr<QuicAsyncUDPSocket> makeEgressQuicSocket(
+      const std::shared_ptr<FollyQuicEventBase>& qEvb);
+
+  // An io_uring socket sharing the listening fd, or nullptr when
+  // TransportSettings::useIoUringSocket is unset or io_uring is unusable.
+  std::unique_ptr<QuicAsyncUDPSocket> makeIoUringListenerQuicSocket(
+      const std::shared_ptr<FollyQuicEventBase>& qEvb);
+
   std::unique_ptr<FollyAsyncUDPSocketAlias> socket_;
-  std::shared_ptr<FollyQuicAsyncUDPSocket> quicSocket_;
+  std::shared_ptr<QuicAsyncUDPSocket> quicSocket_;
   std::unique_ptr<QuicReadCallbackAdapter> quicReadCallbackAdapter_;
   folly::SocketOptionMap* socketOptions_{nullptr};
   std::shared_ptr<WorkerCallback> callback_;
@@ -623,9 +689,29 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
   // connection's `QuicConnectionStateBase::batchWriterFactoryOverride`.
   quic::BatchWriterFactoryOverride batchWriterFactoryOverride_;
 
+  // Egress batching across this worker's connections, only set up in
+  // BATCHING_MODE_WORKER_SENDMMSG_GSO. Sends on a socket sharing the
+  // listening socket's fd, which the batcher owns.
+  std::shared_ptr<QuicServerEgressBatcher> egressBatcher_;
+  QuicServerEgressBatcher::FlushObserver egressBatchFlushObserver_;
+
   // A server transport's membership is exclusive to only one of these maps.
   ConnIdToTransportMap connectionIdMap_;
   SrcToTransportMap sourceAddressMap_;
+  // Scratch space of handleReceivedPackets(), one entry per packet of the
+  // batch.
+  std::vector<Optional<uint64_t>> batchConnIdHashes_;
+
+  // Short header packets of the current read batch grouped per transport and
+  // peer address, so that each transport runs its per-read work (ACK and
+  // loss timers, write looper) once per batch rather than once per packet.
+  struct ReadBatchEntry {
+    QuicServerTransport::Ptr transport;
+    quic::SocketAddress peerAddress;
+    NetworkData networkData;
+  };
+  std::vector<ReadBatchEntry> readBatch_;
+  bool batchingReads_{false};
 
   folly::EvictingCacheMap<
       ConnectionId,
@@ -689,6 +775,27 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
 
   Optional<std::function<int()>> unfinishedHandshakeLimitFn_;
 
+  // Handshakes of transports created by this worker that have neither
+  // finished nor failed yet.
+  uint32_t unfinishedHandshakes_{0};
+
+  struct RetryUnderLoad {
+    uint32_t maxUnfinishedHandshakes{0};
+    uint32_t maxInitialsPerSecond{0};
+    TimePoint windowStart;
+    uint32_t initialsInWindow{0};
+    bool retrying{false};
+  };
+  Optional<RetryUnderLoad> retryUnderLoad_;
+
+  // Built once from TransportSettings::retryTokenSecret, rather than for
+  // every token that is generated or validated.
+  std::unique_ptr<TokenGenerator> tokenGenerator_;
+
+  // Shared by the transports of this worker when
+  // TransportSettings::initialCipherCacheSize is set.
+  std::unique_ptr<InitialCipherCache> initialCipherCache_;
+
   // Wrapper around list of AcceptObservers to handle cleanup on destruction
   class AcceptObserverList {
    public:
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/server/handshake/InitialCipherCache.h>
+
+namespace quic {
+
+quic::Expected<InitialCiphers, QuicError> makeInitialCiphers(
+    const CryptoFactory& cryptoFactory,
+    const ConnectionId& clientDestinationConnId,
+    QuicVersion version) {
+  InitialCiphers ciphers;
+  auto clientCipherResult =
+      cryptoFactory.getClientInitialCipher(clientDestinationConnId, version);
+  if (clientCipherResult.hasError()) {
+    return quic::make_unexpected(clientCipherResult.error());
+  }
+  ciphers.clientCipher = std::move(clientCipherResult.value());
+  auto serverCipherResult =
+      cryptoFactory.getServerInitialCipher(clientDestinationConnId, version);
+  if (serverCipherResult.hasError()) {
+    return quic::make_unexpected(serverCipherResult.error());
+  }
+  ciphers.serverCipher = std::move(serverCipherResult.value());
+  auto clientHeaderCipherResult = cryptoFactory.makeClientInitialHeaderCipher(
+      clientDestinationConnId, version);
+  if (clientHeaderCipherResult.hasError()) {
+    return quic::make_unexpected(clientHeaderCipherResult.error());
+  }
+  ciphers.clientHeaderCipher = std::move(clientHeaderCipherResult.value());
+  auto serverHeaderCipherResult = cryptoFactory.makeServerInitialHeaderCipher(
+      clientDestinationConnId, version);
+  if (serverHeaderCipherResult.hasError()) {
+    return quic::make_unexpected(serverHeaderCipherResult.error());
+  }
+  ciphers.serverHeaderCipher = std::move(serverHeaderCipherResult.value());
+  return ciphers;
+}
+
+InitialCipherCache::InitialCipherCache(size_t capacity) : keys_(capacity) {}
+
+quic::Expected<InitialCiphers, QuicError> InitialCipherCache::getCiphers(
+    const CryptoFactory& cryptoFactory,
+    const ConnectionId& clientDestinationConnId,
+    QuicVersion version) {
+  auto it = keys_.find(clientDestinationConnId);
+  if (it != keys_.end() && it->second.version == version) {
+    hits_++;
+    const auto& keys = it->second;
+    InitialCiphers ciphers;
+    auto clientCipherResult =
+        cryptoFactory.makeInitialAeadFromKey(keys.clientKey);
+    if (clientCipherResult.hasError()) {
+      return quic::make_unexpected(clientCipherResult.error());
+    }
+    ciphers.clientCipher = std::move(clientCipherResult.value());
+    auto serverCipherResult =
+        cryptoFactory.makeInitialAeadFromKey(keys.serverKey);
+    if (serverCipherResult.hasError()) {
+      return quic::make_unexpected(serverCipherResult.error());
+    }
+    ciphers.serverCipher = std::move(serverCipherResult.value());
+    auto clientHeaderCipherResult =
+        cryptoFactory.makeInitialHeaderCipherFromKey(
+            keys.clientHeaderKey->coalesce());
+    if (clientHeaderCipherResult.hasError()) {
+      return quic::make_unexpected(clientHeaderCipherResult.error());
+    }
+    ciphers.clientHeaderCipher = std::move(clientHeaderCipherResult.value());
+    auto serverHeaderCipherResult =
+        cryptoFactory.makeInitialHeaderCipherFromKey(
+            keys.serverHeaderKey->coalesce());
+    if (serverHeaderCipherResult.hasError()) {
+      return quic::make_unexpected(serverHeaderCipherResult.error());
+    }
+    ciphers.serverHeaderCipher = std::move(serverHeaderCipherResult.value());
+    return ciphers;
+  }
+
+  misses_++;
+  auto ciphersResult =
+      makeInitialCiphers(cryptoFactory, clientDestinationConnId, version);
+  if (ciphersResult.hasError()) {
+    return ciphersResult;
+  }
+  auto& ciphers = ciphersResult.value();
+  auto clientKey = ciphers.clientCipher->getKey();
+  auto serverKey = ciphers.serverCipher->getKey();
+  const auto& clientHeaderKey = ciphers.clientHeaderCipher->getKey();
+  const auto& serverHeaderKey = ciphers.serverHeaderCipher->getKey();
+  // Ciphers that don't expose their keys are made again every time.
+  if (clientKey && serverKey && clientHeaderKey && serverHeaderKey) {
+    keys_.set(
+        clientDestinationConnId,
+        Keys{
+            .version = version,
+            .clientKey = std::move(*clientKey),
+            .serverKey = std::move(*serverKey),
+            .clientHeaderKey = clientHeaderKey->clone(),
+            .serverHeaderKey = serverHeaderKey->clone()});
+  }
+  return ciphersResult;
+}
+
+} // namespace quic
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/container/EvictingCacheMap.h>
+#include <quic/codec/QuicConnectionId.h>
+#include <quic/handshake/CryptoFactory.h>
+
+namespace quic {
+
+/**
+ * The ciphers a server connection protects its Initial packets with.
+ */
+struct InitialCiphers {
+  std::unique_ptr<Aead> clientCipher;
+  std::unique_ptr<Aead> serverCipher;
+  std::unique_ptr<PacketNumberCipher> clientHeaderCipher;
+  std::unique_ptr<PacketNumberCipher> serverHeaderCipher;
+};
+
+/**
+ * Derives the Initial ciphers for the destination connection id the client
+ * chose.
+ */
+[[nodiscard]] quic::Expected<InitialCiphers, QuicError> makeInitialCiphers(
+    const CryptoFactory& cryptoFactory,
+    const ConnectionId& clientDestinationConnId,
+    QuicVersion version);
+
+/**
+ * Keeps the Initial keys derived for the most recently seen client chosen
+ * destination connection ids, so that a connection starting with one of them
+ * builds its ciphers from the keys instead of running the HKDF derivation
+ * again. That happens when the same Initial arrives from several addresses,
+ * e.g. because of a NAT rebinding or a replay flood.
+ *
+ * Each worker owns one and only uses it on its thread.
+ */
+class InitialCipherCache {
+ public:
+  explicit InitialCipherCache(size_t capacity);
+
+  [[nodiscard]] quic::Expected<InitialCiphers, QuicError> getCiphers(
+      const CryptoFactory& cryptoFactory,
+      const ConnectionId& clientDestinationConnId,
+      QuicVersion version);
+
+  [[nodiscard]] uint64_t getHits() const {
+    return hits_;
+  }
+
+  [[nodiscard]] uint64_t getMisses() const {
+    return misses_;
+  }
+
+ private:
+  struct Keys {
+    QuicVersion version;
+    TrafficKey clientKey;
+    TrafficKey serverKey;
+    BufPtr clientHeaderKey;
+    BufPtr serverHeaderKey;
+  };
+
+  folly::EvictingCacheMap<ConnectionId, Keys, ConnectionIdHash> keys_;
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+};
+
+} // namespace quic
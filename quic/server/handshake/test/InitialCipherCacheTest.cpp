@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/server/handshake/InitialCipherCache.h>
+
+#include <folly/io/IOBuf.h>
+#include <folly/portability/GTest.h>
+#include <quic/fizz/handshake/FizzCryptoFactory.h>
+
+using namespace testing;
+
+namespace quic::test {
+
+class InitialCipherCacheTest : public Test {
+ public:
+  static void expectSameCiphers(
+      const InitialCiphers& expected,
+      const InitialCiphers& actual) {
+    folly::IOBufEqualTo eq;
+    auto expectSameKey = [&](const Aead& expectedAead, const Aead& aead) {
+      auto expectedKey = expectedAead.getKey();
+      auto key = aead.getKey();
+      ASSERT_TRUE(expectedKey.has_value());
+      ASSERT_TRUE(key.has_value());
+      EXPECT_TRUE(eq(expectedKey->key, key->key));
+      EXPECT_TRUE(eq(expectedKey->iv, key->iv));
+    };
+    expectSameKey(*expected.clientCipher, *actual.clientCipher);
+    expectSameKey(*expected.serverCipher, *actual.serverCipher);
+    EXPECT_TRUE(eq(
+        expected.clientHeaderCipher->getKey(),
+        actual.clientHeaderCipher->getKey()));
+    EXPECT_TRUE(eq(
+        expected.serverHeaderCipher->getKey(),
+        actual.serverHeaderCipher->getKey()));
+  }
+
+ protected:
+  FizzCryptoFactory cryptoFactory_;
+  ConnectionId connId_{
+      ConnectionId::createAndMaybeCrash({1, 2, 3, 4, 5, 6, 7, 8})};
+  ConnectionId otherConnId_{
+      ConnectionId::createAndMaybeCrash({8, 7, 6, 5, 4, 3, 2, 1})};
+};
+
+TEST_F(InitialCipherCacheTest, HitMatchesDerivation) {
+  InitialCipherCache cache(4);
+  auto derived =
+      makeInitialCiphers(cryptoFactory_, connId_, QuicVersion::QUIC_V1);
+  ASSERT_FALSE(derived.hasError());
+
+  auto first = cache.getCiphers(cryptoFactory_, connId_, QuicVersion::QUIC_V1);
+  ASSERT_FALSE(first.hasError());
+  EXPECT_EQ(cache.getMisses(), 1);
+  EXPECT_EQ(cache.getHits(), 0);
+  expectSameCiphers(derived.value(), first.value());
+
+  auto second =
+      cache.getCiphers(cryptoFactory_, connId_, QuicVersion::QUIC_V1);
+  ASSERT_FALSE(second.hasError());
+  EXPECT_EQ(cache.getMisses(), 1);
+  EXPECT_EQ(cache.getHits(), 1);
+  expectSameCiphers(derived.value(), second.value());
+
+  // Each connection gets ciphers of its own.
+  EXPECT_NE(first->clientCipher.get(), second->clientCipher.get());
+}
+
+TEST_F(InitialCipherCacheTest, CachedCipherDecryptsDerivedCipherOutput) {
+  InitialCipherCache cache(4);
+  ASSERT_FALSE(cache.getCiphers(cryptoFactory_, connId_, QuicVersion::QUIC_V1)
+                   .hasError());
+  auto cached = cache.getCiphers(cryptoFactory_, connId_, QuicVersion::QUIC_V1);
+  ASSERT_FALSE(cached.hasError());
+  ASSERT_EQ(cache.getHits(), 1);
+
+  auto clientCipher =
+      cryptoFactory_.getClientInitialCipher(connId_, QuicVersion::QUIC_V1);
+  ASSERT_FALSE(clientCipher.hasError());
+  auto header = folly::IOBuf::copyBuffer("header");
+  auto encrypted = clientCipher.value()->inplaceEncrypt(
+      folly::IOBuf::copyBuffer("initial"), header.get(), 0);
+  ASSERT_FALSE(encrypted.hasError());
+  auto decrypted = cached->clientCipher->tryDecrypt(
+      std::move(encrypted.value()), header.get(), 0);
+  ASSERT_TRUE(decrypted.has_value());
+  EXPECT_EQ((*decrypted)->to<std::string>(), "initial");
+}
+
+TEST_F(InitialCipherCacheTest, DifferentVersionIsMiss) {
+  InitialCipherCache cache(4);
+  ASSERT_FALSE(cache.getCiphers(cryptoFactory_, connId_, QuicVersion::QUIC_V1)
+                   .hasError());
+  auto ciphers =
+      cache.getCiphers(cryptoFactory_, connId_, QuicVersion::QUIC_V1_ALIAS);
+  ASSERT_FALSE(ciphers.hasError());
+  EXPECT_EQ(cache.getMisses(), 2);
+  EXPECT_EQ(cache.getHits(), 0);
+
+  auto derived =
+      makeInitialCiphers(cryptoFactory_, connId_, QuicVersion::QUIC_V1_ALIAS);
+  ASSERT_FALSE(derived.hasError());
+  expectSameCiphers(derived.value(), ciphers.value());
+}
+
+TEST_F(InitialCipherCacheTest, EvictsLeastRecentlyUsed) {
+  InitialCipherCache cache(1);
+  ASSERT_FALSE(cache.getCiphers(cryptoFactory_, connId_, QuicVersion::QUIC_V1)
+                   .hasError());
+  ASSERT_FALSE(
+      cache.getCiphers(cryptoFactory_, otherConnId_, QuicVersion::QUIC_V1)
+          .hasError());
+  ASSERT_FALSE(cache.getCiphers(cryptoFactory_, connId_, QuicVersion::QUIC_V1)
+                   .hasError());
+  EXPECT_EQ(cache.getMisses(), 3);
+  EXPECT_EQ(cache.getHits(), 0);
+}
+
+} // namespace quic::test
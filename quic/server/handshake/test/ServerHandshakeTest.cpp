@@ -11,8 +11,10 @@
 #include <fizz/client/test/Mocks.h>
 #include <fizz/crypto/test/TestUtil.h>
 #include <fizz/protocol/test/Mocks.h>
+#include <fizz/server/DefaultCertManager.h>
 #include <fizz/server/test/Mocks.h>
 
+#include <folly/executors/ManualExecutor.h>
 #include <folly/io/async/SSLContext.h>
 #include <folly/io/async/ScopedEventBaseThread.h>
 
@@ -26,6 +28,7 @@
 #include <quic/fizz/server/handshake/AppToken.h>
 #include <quic/fizz/server/handshake/FizzServerHandshake.h>
 #include <quic/fizz/server/handshake/FizzServerQuicHandshakeContext.h>
+#include <quic/fizz/server/handshake/OffloadedSelfCert.h>
 #include <quic/server/handshake/AppToken.h>
 #include <quic/server/handshake/ServerHandshake.h>
 #include <quic/state/StateData.h>
@@ -466,6 +469,64 @@ TEST_F(ServerHandshakeTest, TestMalformedHandshakeMessage) {
   EXPECT_TRUE(ex.hasError());
 }
 
+class ServerHandshakeOffloadedSignTest : public ServerHandshakeTest {
+ public:
+  void setupClientAndServerContext() override {
+    auto certManager = std::make_unique<fizz::server::DefaultCertManager>();
+    certManager->addCertAndSetDefault(
+        std::make_shared<OffloadedSelfCert>(
+            readCert(), folly::getKeepAliveToken(signExecutor)));
+    serverCtx->setCertManager(std::move(certManager));
+  }
+
+  void TearDown() override {
+    // The cert holds a keep-alive on signExecutor, whose destructor waits for
+    // it to be released, and signExecutor is destroyed before the base
+    // members that keep the cert alive.
+    conn.reset();
+    handshake = nullptr;
+    cryptoState = nullptr;
+    serverCtx.reset();
+    signExecutor.drain();
+    evb.loop();
+  }
+
+  folly::ManualExecutor signExecutor;
+};
+
+TEST_F(ServerHandshakeOffloadedSignTest, TestSignOnExecutor) {
+  clientServerRound();
+  // The server flight waits for the CertificateVerify signature.
+  expectOneRttWriteCipher(false);
+
+  EXPECT_GT(signExecutor.drain(), 0);
+  // The handshake resumes on the connection's EventBase.
+  evb.loop();
+  handshakeCv.wait();
+  handshakeCv.reset();
+  expectOneRttWriteCipher(true);
+
+  serverClientRound();
+  clientServerRound();
+  EXPECT_EQ(handshake->getPhase(), ServerHandshake::Phase::Established);
+  ASSERT_FALSE(ex.hasError());
+  expectOneRttCipher(true);
+  EXPECT_TRUE(handshakeSuccess);
+}
+
+TEST_F(ServerHandshakeOffloadedSignTest, TestCancelWhileSigning) {
+  clientServerRound();
+  handshake->cancel();
+  // Let's destroy the crypto state to make sure it is not referenced.
+  conn->cryptoState.reset();
+
+  signExecutor.drain();
+  evb.loop();
+
+  EXPECT_EQ(conn->getDestructorGuardCount(), 0);
+  expectOneRttCipher(false);
+}
+
 class AsyncRejectingTicketCipher : public fizz::server::TicketCipher {
  public:
   ~AsyncRejectingTicketCipher() override = default;
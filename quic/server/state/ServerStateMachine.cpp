@@ -21,6 +21,7 @@
 #include <quic/logging/QLoggerConstants.h>
 #include <quic/state/ConnectionOopsFields.h>
 #include <quic/state/DatagramHandlers.h>
+#include <quic/state/PmtuDiscoveryFunctions.h>
 #include <quic/state/QuicPacingFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
 #include <quic/state/QuicTransportStatsCallback.h>
@@ -499,6 +500,8 @@ quic::Expected<void, QuicError> processClientInitialParams(
   // Default to max because we can probe PMTU now, and this will be the upper
   // limit
   uint64_t maxUdpPayloadSize = kDefaultMaxUDPPayload;
+  // An absent max_udp_payload_size means the RFC default of 65527.
+  auto pmtuCeiling = packetSize.value_or(kMaxUDPPayload);
   if (packetSize) {
     maxUdpPayloadSize = std::min(*packetSize, maxUdpPayloadSize);
     conn.peerMaxUdpPayloadSize = maxUdpPayloadSize;
@@ -513,6 +516,7 @@ quic::Expected<void, QuicError> processClientInitialParams(
       conn.udpSendPacketLen = *packetSize;
     }
   }
+  maybeInitPmtuDiscovery(conn, pmtuCeiling);
 
   conn.peerActiveConnectionIdLimit =
       activeConnectionIdLimit.value_or(kDefaultActiveConnectionIdLimit);
@@ -1161,15 +1165,19 @@ quic::Expected<void, QuicError> onServerReadDataFromOpen(
     conn.transportParametersEncoded = true;
     const CryptoFactory& cryptoFactory =
         conn.serverHandshakeLayer->getCryptoFactory();
+    auto initialCiphersResult = conn.initialCipherCache
+        ? conn.initialCipherCache->getCiphers(
+              cryptoFactory, initialDestinationConnectionId, version)
+        : makeInitialCiphers(
+              cryptoFactory, initialDestinationConnectionId, version);
+    if (initialCiphersResult.hasError()) {
+      return quic::make_unexpected(initialCiphersResult.error());
+    }
+    auto& initialCiphers = initialCiphersResult.value();
     conn.readCodec = std::make_unique<QuicReadCodec>(QuicNodeType::Server);
     conn.readCodec->setConnectionStatsCallback(conn.statsCallback);
-    auto clientInitialCipherResult = cryptoFactory.getClientInitialCipher(
-        initialDestinationConnectionId, version);
-    if (clientInitialCipherResult.hasError()) {
-      return quic::make_unexpected(clientInitialCipherResult.error());
-    }
     conn.readCodec->setInitialReadCipher(
-        std::move(clientInitialCipherResult.value()));
+        std::move(initialCiphers.clientCipher));
     conn.readCodec->setClientConnectionId(clientConnectionId);
     conn.readCodec->setServerConnectionId(*conn.serverConnectionId);
     QLOG(conn, setScid, conn.serverConnectionId);
@@ -1182,30 +1190,10 @@ quic::Expected<void, QuicError> onServerReadDataFromOpen(
     codecParams.peerTimestampFrameTimestampExponent =
         conn.peerTimestampFrameState.sendExponent;
     conn.readCodec->setCodecParameters(std::move(codecParams));
-    auto serverInitialCipherResult = cryptoFactory.getServerInitialCipher(
-        initialDestinationConnectionId, version);
-    if (serverInitialCipherResult.hasError()) {
-      return quic::make_unexpected(serverInitialCipherResult.error());
-    }
-    conn.initialWriteCipher = std::move(serverInitialCipherResult.value());
-
-    auto clientInitialHeaderCipherResult =
-        cryptoFactory.makeClientInitialHeaderCipher(
-            initialDestinationConnectionId, version);
-    if (clientInitialHeaderCipherResult.hasError()) {
-      return quic::make_unexpected(clientInitialHeaderCipherResult.error());
-    }
+    conn.initialWriteCipher = std::move(initialCiphers.serverCipher);
     conn.readCodec->setInitialHeaderCipher(
-        std::move(clientInitialHeaderCipherResult.value()));
-
-    auto serverInitialHeaderCipherResult =
-        cryptoFactory.makeServerInitialHeaderCipher(
-            initialDestinationConnectionId, version);
-    if (serverInitialHeaderCipherResult.hasError()) {
-      return quic::make_unexpected(serverInitialHeaderCipherResult.error());
-    }
-    conn.initialHeaderCipher =
-        std::move(serverInitialHeaderCipherResult.value());
+        std::move(initialCiphers.clientHeaderCipher));
+    conn.initialHeaderCipher = std::move(initialCiphers.serverHeaderCipher);
     conn.peerAddress = conn.originalPeerAddress;
     auto pathIdResult = conn.pathManager->addValidatedPath(
         readData.localAddress, conn.peerAddress);
@@ -18,6 +18,7 @@
 #include <quic/flowcontrol/QuicFlowController.h>
 
 #include <quic/loss/QuicLossFunctions.h>
+#include <quic/server/handshake/InitialCipherCache.h>
 #include <quic/server/handshake/ServerHandshake.h>
 #include <quic/server/handshake/ServerHandshakeFactory.h>
 #include <quic/server/state/ServerConnectionIdRejector.h>
@@ -101,6 +102,10 @@ struct QuicServerConnectionState : public QuicConnectionStateBase {
   // ServerConnectionIdRejector can reject a ConnectionId from ConnectionIdAlgo
   ServerConnectionIdRejector* connIdRejector{nullptr};
 
+  // Initial keys shared by the connections of a worker. The Initial ciphers
+  // are derived from scratch when it isn't set.
+  InitialCipherCache* initialCipherCache{nullptr};
+
   // Source address token that can be saved to client via PSK.
   // Address with higher index is more recently used.
   std::vector<folly::IPAddress> tokenSourceAddresses;
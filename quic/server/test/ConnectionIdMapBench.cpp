@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/container/F14Map.h>
+#include <quic/QuicConstants.h>
+#include <quic/server/ConnectionIdMap.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+using namespace quic;
+
+namespace {
+// Connections owned by one worker.
+constexpr size_t kNumConnections = 1000000;
+// Packets per read of a worker with a raised maxRecvBatchSize.
+constexpr size_t kBatchSize = 32;
+
+struct Transport {};
+
+struct Fixture {
+  Fixture() {
+    folly::BenchmarkSuspender suspender;
+    auto transport = std::make_shared<Transport>();
+    connIds.reserve(kNumConnections);
+    for (size_t i = 0; i < kNumConnections; ++i) {
+      auto connId = ConnectionId::createRandom(kDefaultConnectionIdSize);
+      MVCHECK(connId.has_value());
+      connIds.push_back(*connId);
+      f14.emplace(*connId, transport);
+      map.emplace(*connId, transport);
+    }
+    // Packets arrive for connections in no particular order.
+    lookups.reserve(kNumConnections);
+    for (size_t i = 0; i < kNumConnections; ++i) {
+      lookups.push_back(&connIds[folly::Random::rand32(kNumConnections)]);
+    }
+  }
+
+  const ConnectionId& lookup(size_t n) const {
+    return *lookups[n % lookups.size()];
+  }
+
+  std::vector<ConnectionId> connIds;
+  std::vector<const ConnectionId*> lookups;
+  folly::F14FastMap<ConnectionId, std::shared_ptr<Transport>, ConnectionIdHash>
+      f14;
+  ConnectionIdMap<std::shared_ptr<Transport>> map;
+};
+
+Fixture& fixture() {
+  static Fixture fixture;
+  return fixture;
+}
+} // namespace
+
+// What QuicServerWorker used before ConnectionIdMap.
+BENCHMARK(lookup_f14_fnv, iters) {
+  auto& f = fixture();
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(f.f14.find(f.lookup(i)));
+  }
+}
+
+BENCHMARK_RELATIVE(lookup_connection_id_map, iters) {
+  auto& f = fixture();
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(f.map.find(f.lookup(i)));
+  }
+}
+
+// Prefetches a batch of lookups and then does them with the hashes from the
+// prefetch, as QuicServerWorker::onSocketReadable() does.
+BENCHMARK_RELATIVE(lookup_connection_id_map_batch_prefetch, iters) {
+  auto& f = fixture();
+  std::array<uint64_t, kBatchSize> hashes{};
+  for (size_t i = 0; i < iters; i += kBatchSize) {
+    auto batch = std::min(kBatchSize, iters - i);
+    for (size_t j = 0; j < batch; ++j) {
+      const auto& connId = f.lookup(i + j);
+      hashes[j] = f.map.prefetch(connId.data(), connId.size());
+    }
+    for (size_t j = 0; j < batch; ++j) {
+      folly::doNotOptimizeAway(f.map.find(f.lookup(i + j), hashes[j]));
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
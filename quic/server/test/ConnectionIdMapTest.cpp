@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+#include <quic/server/ConnectionIdMap.h>
+
+#include <memory>
+#include <random>
+#include <unordered_map>
+
+using namespace testing;
+
+namespace quic::test {
+
+namespace {
+
+ConnectionId makeConnId(uint64_t n, size_t len = 8) {
+  std::vector<uint8_t> bytes(len);
+  for (size_t i = 0; i < len; ++i) {
+    bytes[i] = static_cast<uint8_t>(n >> (8 * (i % 8)));
+  }
+  return ConnectionId::createAndMaybeCrash(bytes);
+}
+
+struct Counted {
+  explicit Counted(int& liveIn, uint64_t valueIn)
+      : live(&liveIn), value(valueIn) {
+    ++*live;
+  }
+
+  Counted(Counted&& other) noexcept : live(other.live), value(other.value) {
+    ++*live;
+  }
+
+  Counted(const Counted&) = delete;
+  Counted& operator=(const Counted&) = delete;
+
+  ~Counted() {
+    --*live;
+  }
+
+  int* live;
+  uint64_t value;
+};
+
+} // namespace
+
+TEST(ConnectionIdMapTest, InsertFindErase) {
+  ConnectionIdMap<int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.find(makeConnId(1)), map.end());
+  EXPECT_EQ(map.erase(makeConnId(1)), 0);
+
+  auto [it, inserted] = map.emplace(makeConnId(1), 10);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(it->first, makeConnId(1));
+  EXPECT_EQ(it->second, 10);
+  // An existing entry is left as it was.
+  std::tie(it, inserted) = map.emplace(makeConnId(1), 11);
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(it->second, 10);
+
+  // Same leading bytes, different length.
+  map.emplace(makeConnId(1, 4), 4);
+  map.emplace(ConnectionId::createZeroLength(), 0);
+  EXPECT_EQ(map.size(), 3);
+  EXPECT_EQ(map.find(makeConnId(1, 4))->second, 4);
+  EXPECT_TRUE(map.contains(ConnectionId::createZeroLength()));
+
+  EXPECT_EQ(map.erase(makeConnId(1)), 1);
+  EXPECT_FALSE(map.contains(makeConnId(1)));
+  EXPECT_TRUE(map.contains(makeConnId(1, 4)));
+  map.erase(map.find(makeConnId(1, 4)));
+  EXPECT_EQ(map.size(), 1);
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST(ConnectionIdMapTest, PrefetchReturnsHash) {
+  ConnectionIdMap<int> map;
+  auto connId = makeConnId(42, kMaxConnectionIdSize);
+  EXPECT_EQ(map.prefetch(connId.data(), connId.size()), map.hash(connId));
+  map.emplace(connId, 1);
+  auto hash = map.prefetch(connId.data(), connId.size());
+  EXPECT_EQ(map.find(connId, hash)->second, 1);
+}
+
+// Checks the map against std::unordered_map through growth and churn, which
+// leaves tombstones behind.
+TEST(ConnectionIdMapTest, MatchesUnorderedMap) {
+  // Values are n << 32 | i for the i-th operation on connection id n.
+  ConnectionIdMap<uint64_t> map;
+  std::unordered_map<uint64_t, uint64_t> expected;
+  auto connIdFor = [](uint64_t n) { return makeConnId(n, 4 + n % 17); };
+  std::mt19937_64 rng(1);
+  for (uint64_t i = 0; i < 50000; ++i) {
+    auto n = rng() % 2000;
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(map.erase(connIdFor(n)), expected.erase(n));
+    } else {
+      auto inserted = map.emplace(connIdFor(n), n << 32 | i).second;
+      EXPECT_EQ(inserted, expected.emplace(n, n << 32 | i).second);
+    }
+  }
+  EXPECT_EQ(map.size(), expected.size());
+  for (const auto& [n, value] : expected) {
+    auto it = map.find(connIdFor(n));
+    ASSERT_NE(it, map.end());
+    EXPECT_EQ(it->second, value);
+  }
+  size_t iterated = 0;
+  for (const auto& [connId, value] : map) {
+    EXPECT_EQ(connId, connIdFor(value >> 32));
+    EXPECT_EQ(expected[value >> 32], value);
+    iterated++;
+  }
+  EXPECT_EQ(iterated, expected.size());
+}
+
+TEST(ConnectionIdMapTest, EraseWhileIterating) {
+  ConnectionIdMap<uint64_t> map;
+  for (uint64_t n = 0; n < 1000; ++n) {
+    map.emplace(makeConnId(n), n);
+  }
+  for (auto it = map.begin(); it != map.end();) {
+    it = it->second % 2 ? map.erase(it) : std::next(it);
+  }
+  EXPECT_EQ(map.size(), 500);
+  for (uint64_t n = 0; n < 1000; ++n) {
+    EXPECT_EQ(map.contains(makeConnId(n)), n % 2 == 0);
+  }
+}
+
+TEST(ConnectionIdMapTest, ReserveAvoidsResize) {
+  ConnectionIdMap<uint64_t> map;
+  map.reserve(1000);
+  map.emplace(makeConnId(0), 0);
+  const auto* first = &map.find(makeConnId(0))->second;
+  for (uint64_t n = 1; n < 1000; ++n) {
+    map.emplace(makeConnId(n), n);
+  }
+  // Elements only move when the map resizes.
+  EXPECT_EQ(&map.find(makeConnId(0))->second, first);
+}
+
+TEST(ConnectionIdMapTest, DestroysValues) {
+  int live = 0;
+  {
+    ConnectionIdMap<Counted> map;
+    for (uint64_t n = 0; n < 100; ++n) {
+      map.try_emplace(makeConnId(n), live, n);
+    }
+    EXPECT_EQ(live, 100);
+    map.erase(makeConnId(0));
+    EXPECT_EQ(live, 99);
+    EXPECT_EQ(map.find(makeConnId(1))->second.value, 1);
+    map.clear();
+    EXPECT_EQ(live, 0);
+    map.try_emplace(makeConnId(1), live, 1);
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST(ConnectionIdMapTest, SharedPtrValues) {
+  ConnectionIdMap<std::shared_ptr<int>> map;
+  auto value = std::make_shared<int>(1);
+  map.emplace(makeConnId(1), value);
+  map.emplace(makeConnId(2), value);
+  EXPECT_EQ(value.use_count(), 3);
+  map.erase(makeConnId(1));
+  EXPECT_EQ(value.use_count(), 2);
+  map.clear();
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+} // namespace quic::test
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <quic/QuicConstants.h>
+#include <quic/fizz/handshake/FizzCryptoFactory.h>
+#include <quic/server/handshake/InitialCipherCache.h>
+
+#include <vector>
+
+using namespace quic;
+
+namespace {
+// Distinct destination connection ids in the replayed Initials.
+constexpr size_t kNumConnIds = 64;
+// Connection ids a worker's cache holds in the benchmark.
+constexpr size_t kCacheSize = 1024;
+
+std::vector<ConnectionId> makeConnIds(size_t count) {
+  std::vector<ConnectionId> connIds;
+  connIds.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    connIds.push_back(
+        ConnectionId::createRandom(kDefaultConnectionIdSize).value());
+  }
+  return connIds;
+}
+} // namespace
+
+// What a new server connection does for its first Initial without a cache.
+BENCHMARK(initial_ciphers_derive, iters) {
+  folly::BenchmarkSuspender suspender;
+  FizzCryptoFactory cryptoFactory;
+  auto connIds = makeConnIds(kNumConnIds);
+  suspender.dismiss();
+  for (size_t i = 0; i < iters; ++i) {
+    auto ciphers = makeInitialCiphers(
+        cryptoFactory, connIds[i % connIds.size()], QuicVersion::QUIC_V1);
+    MVCHECK(!ciphers.hasError());
+    folly::doNotOptimizeAway(ciphers);
+  }
+}
+
+// Initials replayed with a small set of connection ids, all cache hits after
+// the first round.
+BENCHMARK_RELATIVE(initial_ciphers_cache_replayed, iters) {
+  folly::BenchmarkSuspender suspender;
+  FizzCryptoFactory cryptoFactory;
+  InitialCipherCache cache(kCacheSize);
+  auto connIds = makeConnIds(kNumConnIds);
+  suspender.dismiss();
+  for (size_t i = 0; i < iters; ++i) {
+    auto ciphers = cache.getCiphers(
+        cryptoFactory, connIds[i % connIds.size()], QuicVersion::QUIC_V1);
+    MVCHECK(!ciphers.hasError());
+    folly::doNotOptimizeAway(ciphers);
+  }
+}
+
+// Every Initial with a new connection id, the cost of the cache when it never
+// hits.
+BENCHMARK_RELATIVE(initial_ciphers_cache_unique, iters) {
+  folly::BenchmarkSuspender suspender;
+  FizzCryptoFactory cryptoFactory;
+  InitialCipherCache cache(kCacheSize);
+  auto connIds = makeConnIds(iters);
+  suspender.dismiss();
+  for (size_t i = 0; i < iters; ++i) {
+    auto ciphers =
+        cache.getCiphers(cryptoFactory, connIds[i], QuicVersion::QUIC_V1);
+    MVCHECK(!ciphers.hasError());
+    folly::doNotOptimizeAway(ciphers);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+#include <quic/codec/DefaultConnectionIdAlgo.h>
+#include <quic/server/QuicReusePortSteering.h>
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <vector>
+
+using namespace testing;
+
+namespace quic::test {
+
+namespace {
+
+constexpr size_t kNumSockets = 4;
+
+/**
+ * A reuseport group of loopback UDP sockets standing in for the listeners of
+ * kNumSockets workers, plus a client socket sending to them.
+ */
+class ReusePortGroup {
+ public:
+  ReusePortGroup() {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (auto& fd : fds_) {
+      fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+      int one = 1;
+      ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+      EXPECT_EQ(
+          ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+      socklen_t len = sizeof(addr);
+      ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    }
+    addr_ = addr;
+    client_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+  }
+
+  ~ReusePortGroup() {
+    for (auto fd : fds_) {
+      ::close(fd);
+    }
+    ::close(client_);
+  }
+
+  int listener() const {
+    return fds_[0];
+  }
+
+  // Sends the packet and returns the index of the socket it arrived on.
+  Optional<size_t> receivingSocket(const std::vector<uint8_t>& packet) {
+    ::sendto(
+        client_,
+        packet.data(),
+        packet.size(),
+        0,
+        reinterpret_cast<const sockaddr*>(&addr_),
+        sizeof(addr_));
+    std::array<pollfd, kNumSockets> pfds{};
+    for (size_t i = 0; i < kNumSockets; ++i) {
+      pfds[i].fd = fds_[i];
+      pfds[i].events = POLLIN;
+    }
+    if (::poll(pfds.data(), pfds.size(), 1000) <= 0) {
+      return std::nullopt;
+    }
+    for (size_t i = 0; i < kNumSockets; ++i) {
+      if (pfds[i].revents & POLLIN) {
+        std::array<uint8_t, 64> buf{};
+        ::recv(fds_[i], buf.data(), buf.size(), 0);
+        return i;
+      }
+    }
+    return std::nullopt;
+  }
+
+ private:
+  std::array<int, kNumSockets> fds_{};
+  int client_{-1};
+  sockaddr_in addr_{};
+};
+
+std::vector<uint8_t> shortHeaderPacket(const ConnectionId& dcid) {
+  std::vector<uint8_t> packet{0x40};
+  packet.insert(packet.end(), dcid.data(), dcid.data() + dcid.size());
+  packet.resize(packet.size() + 20);
+  return packet;
+}
+
+} // namespace
+
+class QuicReusePortSteeringTest
+    : public TestWithParam<ConnectionIdVersion> {};
+
+TEST_P(QuicReusePortSteeringTest, ShortHeaderToEncodedWorker) {
+  ReusePortGroup group;
+  ASSERT_TRUE(attachReusePortSteeringProgram(
+                  group.listener(), GetParam(), kNumSockets)
+                  .has_value());
+  DefaultConnectionIdAlgo algo;
+  for (uint8_t workerId = 0; workerId < 2 * kNumSockets; ++workerId) {
+    auto dcid = algo.encodeConnectionId(
+        ServerConnectionIdParams(GetParam(), 0x1234, 0, workerId));
+    ASSERT_TRUE(dcid.has_value());
+    EXPECT_EQ(
+        group.receivingSocket(shortHeaderPacket(*dcid)),
+        workerId % kNumSockets);
+  }
+}
+
+TEST_P(QuicReusePortSteeringTest, LongHeaderFallsBackToHash) {
+  ReusePortGroup group;
+  ASSERT_TRUE(attachReusePortSteeringProgram(
+                  group.listener(), GetParam(), kNumSockets)
+                  .has_value());
+  DefaultConnectionIdAlgo algo;
+  auto dcid = algo.encodeConnectionId(
+      ServerConnectionIdParams(GetParam(), 0x1234, 0, 1));
+  ASSERT_TRUE(dcid.has_value());
+  auto packet = shortHeaderPacket(*dcid);
+  packet[0] = 0xc0;
+  // Whichever socket the 4-tuple hashes to, but it is delivered.
+  auto first = group.receivingSocket(packet);
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(group.receivingSocket(packet), first);
+  // As are packets too short to carry a worker id.
+  EXPECT_EQ(group.receivingSocket({0x40, 0x40}), first);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    QuicReusePortSteeringTests,
+    QuicReusePortSteeringTest,
+    Values(
+        ConnectionIdVersion::V1,
+        ConnectionIdVersion::V2,
+        ConnectionIdVersion::V3));
+
+TEST(QuicReusePortSteeringErrorTest, RejectsVersionWithoutWorkerId) {
+  ReusePortGroup group;
+  EXPECT_TRUE(attachReusePortSteeringProgram(
+                  group.listener(), ConnectionIdVersion::V0, kNumSockets)
+                  .hasError());
+  EXPECT_TRUE(attachReusePortSteeringProgram(
+                  group.listener(), ConnectionIdVersion::V1, 0)
+                  .hasError());
+}
+
+} // namespace quic::test
+
+#endif
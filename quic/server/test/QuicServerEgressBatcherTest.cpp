@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+#include <quic/common/udpsocket/test/QuicAsyncUDPSocketMock.h>
+#include <quic/server/QuicServerEgressBatcher.h>
+#include <quic/state/StateData.h>
+
+using namespace testing;
+
+namespace quic::test {
+
+namespace {
+
+struct SentMessage {
+  quic::SocketAddress peer;
+  size_t bytes;
+  int gso;
+  std::chrono::microseconds txTime;
+};
+
+BufPtr makePacket(size_t size) {
+  auto buf = folly::IOBuf::create(size);
+  buf->append(size);
+  return buf;
+}
+
+} // namespace
+
+class QuicServerEgressBatcherTest : public Test {
+ public:
+  void SetUp() override {
+    auto sock = std::make_unique<NiceMock<QuicAsyncUDPSocketMock>>();
+    sock_ = sock.get();
+    batcher_ =
+        std::make_shared<QuicServerEgressBatcher>(&evb_, std::move(sock), 16);
+    batcher_->setFlushObserver(
+        [this](const QuicServerEgressBatcher::FlushStats& stats) {
+          flushes_.push_back(stats);
+        });
+    ON_CALL(
+        *sock_,
+        writemGSO(
+            A<AddressRange>(),
+            A<const BufPtr*>(),
+            A<size_t>(),
+            A<const QuicAsyncUDPSocket::WriteOptions*>()))
+        .WillByDefault(
+            [this](
+                AddressRange addrs,
+                const BufPtr* bufs,
+                size_t count,
+                const QuicAsyncUDPSocket::WriteOptions* options) {
+              for (size_t i = 0; i < count; ++i) {
+                sent_.push_back(
+                    {addrs[i],
+                     bufs[i]->computeChainDataLength(),
+                     options[i].gso,
+                     options[i].txTime});
+              }
+              return static_cast<int>(count);
+            });
+  }
+
+ protected:
+  folly::EventBase evb_;
+  // Owned by batcher_.
+  NiceMock<QuicAsyncUDPSocketMock>* sock_{nullptr};
+  std::shared_ptr<QuicServerEgressBatcher> batcher_;
+  std::vector<SentMessage> sent_;
+  std::vector<QuicServerEgressBatcher::FlushStats> flushes_;
+  quic::SocketAddress peer1_{"1.2.3.4", 1234};
+  quic::SocketAddress peer2_{"5.6.7.8", 5678};
+};
+
+TEST_F(QuicServerEgressBatcherTest, FlushesAtEndOfLoop) {
+  evb_.runInEventBaseThread([&] {
+    batcher_->enqueue(peer1_, makePacket(1000), 1000, true);
+    batcher_->enqueue(peer2_, makePacket(1000), 1000, true);
+    EXPECT_EQ(batcher_->numQueuedPackets(), 2);
+    EXPECT_TRUE(sent_.empty());
+  });
+  evb_.loopOnce();
+  EXPECT_TRUE(batcher_->empty());
+  ASSERT_EQ(sent_.size(), 2);
+  EXPECT_EQ(sent_[0].peer, peer1_);
+  EXPECT_EQ(sent_[1].peer, peer2_);
+  ASSERT_EQ(flushes_.size(), 1);
+  EXPECT_EQ(flushes_[0].syscalls, 1);
+  EXPECT_EQ(flushes_[0].messages, 2);
+  EXPECT_EQ(flushes_[0].packets, 2);
+  EXPECT_EQ(flushes_[0].bytes, 2000);
+}
+
+TEST_F(QuicServerEgressBatcherTest, CoalescesSamePeer) {
+  batcher_->enqueue(peer1_, makePacket(1000), 1000, true);
+  batcher_->enqueue(peer1_, makePacket(1000), 1000, true);
+  // A shorter packet ends the GSO message.
+  batcher_->enqueue(peer1_, makePacket(500), 500, true);
+  batcher_->enqueue(peer1_, makePacket(500), 500, true);
+  // Packets to another peer or without GSO start new messages.
+  batcher_->enqueue(peer2_, makePacket(1000), 1000, true);
+  batcher_->enqueue(peer2_, makePacket(1000), 1000, false);
+  EXPECT_EQ(batcher_->numQueuedMessages(), 4);
+  batcher_->flush();
+
+  ASSERT_EQ(sent_.size(), 4);
+  EXPECT_EQ(sent_[0].bytes, 2500);
+  EXPECT_EQ(sent_[0].gso, 1000);
+  EXPECT_EQ(sent_[1].bytes, 500);
+  EXPECT_EQ(sent_[1].gso, 0);
+  EXPECT_EQ(sent_[2].peer, peer2_);
+  EXPECT_EQ(sent_[3].gso, 0);
+  ASSERT_EQ(flushes_.size(), 1);
+  EXPECT_EQ(flushes_[0].packets, 6);
+}
+
+TEST_F(QuicServerEgressBatcherTest, TxTimeSplitsMessages) {
+  batcher_->enqueue(peer1_, makePacket(1000), 1000, true, 0us);
+  batcher_->enqueue(peer1_, makePacket(1000), 1000, true, 0us);
+  // A burst departing later goes into its own message.
+  batcher_->enqueue(peer1_, makePacket(1000), 1000, true, 1000us);
+  batcher_->enqueue(peer1_, makePacket(1000), 1000, true, 1000us);
+  EXPECT_EQ(batcher_->numQueuedMessages(), 2);
+  batcher_->flush();
+
+  ASSERT_EQ(sent_.size(), 2);
+  EXPECT_EQ(sent_[0].bytes, 2000);
+  EXPECT_EQ(sent_[0].txTime, 0us);
+  EXPECT_EQ(sent_[1].bytes, 2000);
+  EXPECT_EQ(sent_[1].gso, 1000);
+  // The departure time is relative to the flush rather than the enqueue.
+  EXPECT_GT(sent_[1].txTime, 0us);
+  EXPECT_LE(sent_[1].txTime, 1000us);
+}
+
+TEST_F(QuicServerEgressBatcherTest, PartialWriteRetries) {
+  EXPECT_CALL(
+      *sock_,
+      writemGSO(
+          A<AddressRange>(),
+          A<const BufPtr*>(),
+          A<size_t>(),
+          A<const QuicAsyncUDPSocket::WriteOptions*>()))
+      .WillOnce(Return(1))
+      .WillOnce(Return(2));
+  batcher_->enqueue(peer1_, makePacket(100), 100, false);
+  batcher_->enqueue(peer1_, makePacket(100), 100, false);
+  batcher_->enqueue(peer1_, makePacket(100), 100, false);
+  batcher_->flush();
+  ASSERT_EQ(flushes_.size(), 1);
+  EXPECT_EQ(flushes_[0].syscalls, 2);
+  EXPECT_EQ(flushes_[0].droppedPackets, 0);
+}
+
+TEST_F(QuicServerEgressBatcherTest, WriteErrorDropsRemaining) {
+  EXPECT_CALL(
+      *sock_,
+      writemGSO(
+          A<AddressRange>(),
+          A<const BufPtr*>(),
+          A<size_t>(),
+          A<const QuicAsyncUDPSocket::WriteOptions*>()))
+      .WillOnce(Return(1))
+      .WillOnce([](auto&&...) {
+        errno = ENOBUFS;
+        return -1;
+      });
+  batcher_->enqueue(peer1_, makePacket(100), 100, false);
+  batcher_->enqueue(peer2_, makePacket(100), 100, true);
+  batcher_->enqueue(peer2_, makePacket(100), 100, true);
+  batcher_->flush();
+  ASSERT_EQ(flushes_.size(), 1);
+  EXPECT_EQ(flushes_[0].droppedPackets, 2);
+  EXPECT_EQ(flushes_[0].lastErrno, ENOBUFS);
+  EXPECT_TRUE(batcher_->empty());
+}
+
+TEST_F(QuicServerEgressBatcherTest, FactoryOnlyForWorkerMode) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  auto factory = makeEgressBatchWriterFactory(batcher_, nullptr);
+  EXPECT_EQ(
+      factory(
+          QuicBatchingMode::BATCHING_MODE_GSO,
+          16,
+          DataPathType::ChainedMemory,
+          conn,
+          true),
+      nullptr);
+  EXPECT_EQ(
+      factory(
+          QuicBatchingMode::BATCHING_MODE_WORKER_SENDMMSG_GSO,
+          16,
+          DataPathType::ContinuousMemory,
+          conn,
+          true),
+      nullptr);
+  auto writer = factory(
+      QuicBatchingMode::BATCHING_MODE_WORKER_SENDMMSG_GSO,
+      16,
+      DataPathType::ChainedMemory,
+      conn,
+      true);
+  ASSERT_NE(writer, nullptr);
+  EXPECT_FALSE(writer->append(makePacket(100), 100, peer1_, sock_));
+  EXPECT_TRUE(writer->empty());
+  EXPECT_EQ(batcher_->numQueuedPackets(), 1);
+}
+
+TEST_F(QuicServerEgressBatcherTest, WriterKeepsSocketAlive) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  auto writer = makeEgressBatchWriterFactory(batcher_, nullptr)(
+      QuicBatchingMode::BATCHING_MODE_WORKER_SENDMMSG_GSO,
+      16,
+      DataPathType::ChainedMemory,
+      conn,
+      true);
+  ASSERT_NE(writer, nullptr);
+  // The worker drops its batcher on shutdown while transports may still
+  // write through theirs.
+  std::weak_ptr<QuicServerEgressBatcher> weakBatcher = batcher_;
+  batcher_.reset();
+  ASSERT_FALSE(weakBatcher.expired());
+  evb_.runInEventBaseThread([&] {
+    EXPECT_FALSE(writer->append(makePacket(100), 100, peer1_, nullptr));
+  });
+  evb_.loopOnce();
+  ASSERT_EQ(sent_.size(), 1);
+  EXPECT_EQ(sent_[0].peer, peer1_);
+  writer.reset();
+  EXPECT_TRUE(weakBatcher.expired());
+}
+
+} // namespace quic::test
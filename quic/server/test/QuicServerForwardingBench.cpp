@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+#include <folly/synchronization/Baton.h>
+#include <quic/server/QuicServerForwardingRing.h>
+
+#include <functional>
+#include <thread>
+
+using namespace quic;
+
+namespace {
+constexpr size_t kPacketSize = 1200;
+constexpr size_t kRingCapacity = 1024;
+
+ForwardedPacket makePacket() {
+  auto buf = folly::IOBuf::create(kPacketSize);
+  buf->append(kPacketSize);
+  return ForwardedPacket{
+      quic::SocketAddress("127.0.0.1", 1234),
+      RoutingData(
+          HeaderForm::Short,
+          false /* isInitial */,
+          false /* is0Rtt */,
+          ConnectionId::createZeroLength(),
+          std::nullopt),
+      // Stamped with the time it was forwarded, for the latency.
+      NetworkData(std::move(buf), Clock::now(), 0),
+      std::nullopt,
+      false};
+}
+
+/**
+ * Stands in for the worker that owns the connections. It records how long
+ * every packet took from being forwarded to being handled.
+ */
+struct Consumer {
+  explicit Consumer(size_t expectedIn) : expected(expectedIn) {}
+
+  void handle(ForwardedPacket&& packet) {
+    auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - packet.networkData.getReceiveTimePoint());
+    totalLatency += latency;
+    maxLatency = std::max(maxLatency, latency);
+    if (++handled == expected) {
+      done.post();
+    }
+  }
+
+  void report(folly::UserCounters& counters) const {
+    counters["avg_latency_ns"] = expected
+        ? static_cast<int64_t>(totalLatency.count() / expected)
+        : 0;
+    counters["max_latency_ns"] = static_cast<int64_t>(maxLatency.count());
+  }
+
+  size_t expected;
+  size_t handled{0};
+  std::chrono::nanoseconds totalLatency{0};
+  std::chrono::nanoseconds maxLatency{0};
+  folly::Baton<> done;
+};
+
+// What QuicServer did before the rings: one closure per packet.
+void runPerPacketClosures(folly::UserCounters& counters, size_t iters) {
+  folly::ScopedEventBaseThread worker;
+  Consumer consumer(iters);
+  for (size_t i = 0; i < iters; ++i) {
+    worker.getEventBase()->runInEventBaseThread(
+        [&consumer, packet = makePacket()]() mutable {
+          consumer.handle(std::move(packet));
+        });
+  }
+  if (iters > 0) {
+    consumer.done.wait();
+  }
+  consumer.report(counters);
+}
+
+void runForwardingRing(folly::UserCounters& counters, size_t iters) {
+  folly::ScopedEventBaseThread worker;
+  QuicServerForwarder forwarder(1, kRingCapacity);
+  Consumer consumer(iters);
+  uint64_t ringFull = 0;
+  std::function<void()> drain = [&]() {
+    if (forwarder.drain(0, [&](ForwardedPacket&& packet) {
+          consumer.handle(std::move(packet));
+        })) {
+      worker.getEventBase()->runInEventBaseThread(drain);
+    }
+  };
+  for (size_t i = 0; i < iters; ++i) {
+    // Queued from a thread that is not a worker. The server drops packets
+    // when the ring is full, the benchmark waits for room instead so that
+    // every packet is handled.
+    auto packet = makePacket();
+    auto result = forwarder.enqueue(1, 0, std::move(packet));
+    while (result == QuicServerForwarder::EnqueueResult::Full) {
+      ringFull++;
+      std::this_thread::yield();
+      result = forwarder.enqueue(1, 0, std::move(packet));
+    }
+    if (result == QuicServerForwarder::EnqueueResult::QueuedScheduleDrain) {
+      worker.getEventBase()->runInEventBaseThread(drain);
+    }
+  }
+  if (iters > 0) {
+    consumer.done.wait();
+  }
+  consumer.report(counters);
+  counters["ring_full"] = static_cast<int64_t>(ringFull);
+}
+} // namespace
+
+BENCHMARK_COUNTERS(forward_per_packet_closure, counters, iters) {
+  runPerPacketClosures(counters, iters);
+}
+
+BENCHMARK_COUNTERS(forward_mpsc_ring, counters, iters) {
+  runForwardingRing(counters, iters);
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/io/IOBuf.h>
+#include <folly/portability/GTest.h>
+#include <quic/server/QuicServerForwardingRing.h>
+
+#include <thread>
+
+using namespace testing;
+
+namespace quic::test {
+
+namespace {
+
+// The size of the packet identifies it.
+ForwardedPacket makePacket(size_t id) {
+  auto buf = folly::IOBuf::create(id + 1);
+  buf->append(id + 1);
+  return ForwardedPacket{
+      quic::SocketAddress("127.0.0.1", 1234),
+      RoutingData(
+          HeaderForm::Short,
+          false /* isInitial */,
+          false /* is0Rtt */,
+          ConnectionId::createZeroLength(),
+          std::nullopt),
+      NetworkData(std::move(buf), Clock::now(), 0),
+      std::nullopt,
+      false};
+}
+
+size_t packetId(const ForwardedPacket& packet) {
+  return packet.networkData.getTotalData() - 1;
+}
+
+} // namespace
+
+TEST(ForwardedPacketRingTest, FifoAndFull) {
+  ForwardedPacketRing ring(3);
+  EXPECT_EQ(ring.capacity(), 4);
+  EXPECT_FALSE(ring.tryPop().has_value());
+  for (size_t lap = 0; lap < 3; ++lap) {
+    for (size_t i = 0; i < 4; ++i) {
+      EXPECT_TRUE(ring.tryPush(makePacket(i)));
+    }
+    auto packet = makePacket(100);
+    EXPECT_FALSE(ring.tryPush(std::move(packet)));
+    // A rejected packet is left as it was.
+    EXPECT_EQ(packetId(packet), 100);
+    for (size_t i = 0; i < 4; ++i) {
+      auto popped = ring.tryPop();
+      ASSERT_TRUE(popped.has_value());
+      EXPECT_EQ(packetId(*popped), i);
+    }
+    EXPECT_FALSE(ring.tryPop().has_value());
+  }
+}
+
+TEST(ForwardedPacketRingTest, ConcurrentProducers) {
+  constexpr size_t kNumProducers = 4;
+  constexpr size_t kPacketsPerProducer = 2000;
+  ForwardedPacketRing ring(64);
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < kNumProducers; ++p) {
+    producers.emplace_back([&ring, p]() {
+      for (size_t i = 0; i < kPacketsPerProducer; ++i) {
+        auto packet = makePacket(p * kPacketsPerProducer + i);
+        while (!ring.tryPush(std::move(packet))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  // Every producer's packets come out in the order it queued them.
+  std::vector<size_t> next(kNumProducers, 0);
+  size_t received = 0;
+  while (received < kNumProducers * kPacketsPerProducer) {
+    auto packet = ring.tryPop();
+    if (!packet) {
+      std::this_thread::yield();
+      continue;
+    }
+    auto id = packetId(*packet);
+    auto producer = id / kPacketsPerProducer;
+    EXPECT_EQ(id % kPacketsPerProducer, next[producer]);
+    next[producer] = id % kPacketsPerProducer + 1;
+    received++;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_FALSE(ring.tryPop().has_value());
+}
+
+TEST(QuicServerForwarderTest, SchedulesOneDrainPerBatch) {
+  QuicServerForwarder forwarder(2, 8);
+  EXPECT_EQ(
+      forwarder.enqueue(0, 1, makePacket(1)),
+      QuicServerForwarder::EnqueueResult::QueuedScheduleDrain);
+  EXPECT_EQ(
+      forwarder.enqueue(2, 1, makePacket(2)),
+      QuicServerForwarder::EnqueueResult::Queued);
+  // Another destination has its own schedule.
+  EXPECT_EQ(
+      forwarder.enqueue(1, 0, makePacket(3)),
+      QuicServerForwarder::EnqueueResult::QueuedScheduleDrain);
+
+  std::vector<size_t> drained;
+  EXPECT_FALSE(forwarder.drain(1, [&](ForwardedPacket&& packet) {
+    drained.push_back(packetId(packet));
+  }));
+  EXPECT_EQ(drained, std::vector<size_t>({1, 2}));
+  EXPECT_EQ(
+      forwarder.enqueue(0, 1, makePacket(4)),
+      QuicServerForwarder::EnqueueResult::QueuedScheduleDrain);
+}
+
+TEST(QuicServerForwarderTest, DropsWhenFull) {
+  QuicServerForwarder forwarder(2, 2);
+  EXPECT_NE(
+      forwarder.enqueue(0, 1, makePacket(1)),
+      QuicServerForwarder::EnqueueResult::Full);
+  EXPECT_NE(
+      forwarder.enqueue(0, 1, makePacket(2)),
+      QuicServerForwarder::EnqueueResult::Full);
+  EXPECT_EQ(
+      forwarder.enqueue(0, 1, makePacket(3)),
+      QuicServerForwarder::EnqueueResult::Full);
+  // Other sources have rings of their own.
+  EXPECT_NE(
+      forwarder.enqueue(2, 1, makePacket(4)),
+      QuicServerForwarder::EnqueueResult::Full);
+
+  std::vector<size_t> drained;
+  // A full ring may have more behind it, so another drain is asked for.
+  EXPECT_TRUE(forwarder.drain(1, [&](ForwardedPacket&& packet) {
+    drained.push_back(packetId(packet));
+  }));
+  EXPECT_EQ(drained, std::vector<size_t>({1, 2, 4}));
+  EXPECT_FALSE(forwarder.drain(1, [&](ForwardedPacket&&) { FAIL(); }));
+}
+
+} // namespace quic::test
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/io/async/EventBase.h>
+#include <quic/codec/DefaultConnectionIdAlgo.h>
+#include <quic/codec/QuicPacketBuilder.h>
+#include <quic/codec/QuicWriteCodec.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/server/QuicServerWorker.h>
+#include <quic/server/handshake/TokenGenerator.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace quic;
+using namespace quic::test;
+
+namespace {
+// Distinct clients sending an Initial each, cycled through by the load.
+constexpr size_t kNumClients = 4096;
+
+/**
+ * Counts the transports the worker asks for. It doesn't create them, so the
+ * worker answers those Initials as if it failed to, with a version
+ * negotiation packet. A real transport also runs a handshake, which makes
+ * every avoided transport worth far more than the difference measured here.
+ */
+class CountingTransportFactory : public QuicServerTransportFactory {
+ public:
+  QuicServerTransport::Ptr make(
+      folly::EventBase*,
+      std::unique_ptr<FollyAsyncUDPSocketAlias>,
+      const quic::SocketAddress&,
+      QuicVersion,
+      std::shared_ptr<const fizz::server::FizzServerContext>) noexcept
+      override {
+    transportsRequested++;
+    return nullptr;
+  }
+
+  uint64_t transportsRequested{0};
+};
+
+class NullWorkerCallback : public QuicServerWorker::WorkerCallback {
+ public:
+  void handleWorkerError(LocalErrorCode) override {}
+
+  void routeDataToWorker(
+      const quic::SocketAddress&,
+      RoutingData&&,
+      NetworkData&&,
+      Optional<QuicVersion>,
+      folly::EventBase*,
+      bool) override {}
+};
+
+class NullSocketFactory : public QuicUDPSocketFactory {
+ public:
+  std::unique_ptr<FollyAsyncUDPSocketAlias> make(folly::EventBase*, int)
+      override {
+    return nullptr;
+  }
+};
+
+struct Initial {
+  quic::SocketAddress client;
+  ConnectionId srcConnId;
+  ConnectionId dstConnId;
+  BufPtr packet;
+};
+
+Initial makeInitial(size_t n) {
+  Initial initial{
+      quic::SocketAddress("127.0.0.1", 10000 + n),
+      getTestConnectionId(0),
+      ConnectionId::createRandom(kDefaultConnectionIdSize).value(),
+      nullptr};
+  LongHeader header(
+      LongHeader::Types::Initial,
+      initial.srcConnId,
+      initial.dstConnId,
+      1,
+      QuicVersion::MVFST);
+  RegularQuicPacketBuilder builder(
+      kDefaultUDPSendPacketLen, std::move(header), 0);
+  MVCHECK(!builder.encodePacketHeader().hasError());
+  while (builder.remainingSpaceInPkt() > 0) {
+    MVCHECK(!writeFrame(PaddingFrame(), builder).hasError());
+  }
+  initial.packet = packetToBuf(std::move(builder).buildPacket());
+  return initial;
+}
+
+struct Fixture {
+  Fixture() {
+    TransportSettings settings;
+    settings.statelessResetTokenSecret = getRandSecret();
+    settings.retryTokenSecret = secret;
+    worker = std::make_unique<QuicServerWorker>(
+        std::make_shared<NullWorkerCallback>(), settings);
+    auto sock = std::make_unique<FollyAsyncUDPSocketAlias>(&evb);
+    // Responses go to ports nobody listens on, and are dropped.
+    sock->bind(quic::SocketAddress("127.0.0.1", 0));
+    worker->setSocket(std::move(sock));
+    worker->setSupportedVersions({QuicVersion::MVFST});
+    worker->setConnectionIdAlgo(std::make_unique<DefaultConnectionIdAlgo>());
+    worker->setTransportFactory(&transportFactory);
+    worker->setNewConnectionSocketFactory(&socketFactory);
+  }
+
+  ~Fixture() {
+    worker->shutdownAllConnections(LocalErrorCode::SHUTTING_DOWN);
+  }
+
+  void dispatch(const Initial& initial) {
+    worker->dispatchPacketData(
+        initial.client,
+        RoutingData(
+            HeaderForm::Long,
+            true /* isInitial */,
+            false /* is0Rtt */,
+            initial.dstConnId,
+            initial.srcConnId),
+        NetworkData(initial.packet->clone(), Clock::now(), 0),
+        QuicVersion::MVFST);
+  }
+
+  TokenSecret secret{getRandSecret()};
+  folly::EventBase evb;
+  CountingTransportFactory transportFactory;
+  NullSocketFactory socketFactory;
+  std::unique_ptr<QuicServerWorker> worker;
+};
+
+void runInitialFlood(
+    folly::UserCounters& counters,
+    size_t iters,
+    bool retryUnderLoad) {
+  folly::BenchmarkSuspender suspender;
+  Fixture f;
+  if (retryUnderLoad) {
+    // Loaded after the first Initial of the flood.
+    f.worker->setRetryUnderLoad(0, 1);
+  }
+  std::vector<Initial> initials;
+  initials.reserve(kNumClients);
+  for (size_t i = 0; i < kNumClients; ++i) {
+    initials.push_back(makeInitial(i));
+  }
+  suspender.dismiss();
+  for (size_t i = 0; i < iters; ++i) {
+    f.dispatch(initials[i % initials.size()]);
+  }
+  suspender.rehire();
+  counters["transports_requested"] =
+      static_cast<int64_t>(f.transportFactory.transportsRequested);
+}
+
+// Validates an Initial's retry token the way the worker used to: with a
+// TokenGenerator built for the check, and a second decryption as a new token
+// even when it was a valid retry token.
+bool validatePerCallGenerator(
+    const TokenSecret& secret,
+    const std::string& encryptedToken,
+    const Initial& initial) {
+  TokenGenerator retryGenerator(secret);
+  RetryToken retryToken(initial.dstConnId, initial.client.getIPAddress(), 0);
+  bool validRetry =
+      retryGenerator.decryptToken(
+          BufHelpers::copyBuffer(encryptedToken),
+          retryToken.genAeadAssocData()) != 0;
+  TokenGenerator newGenerator(secret);
+  NewToken newToken(initial.client.getIPAddress());
+  bool validNew = newGenerator.decryptToken(
+                      BufHelpers::copyBuffer(encryptedToken),
+                      newToken.genAeadAssocData()) != 0;
+  return validRetry || validNew;
+}
+
+bool validateCachedGenerator(
+    TokenGenerator& generator,
+    const std::string& encryptedToken,
+    const Initial& initial) {
+  RetryToken retryToken(initial.dstConnId, initial.client.getIPAddress(), 0);
+  return generator.decryptToken(
+             BufHelpers::copyBuffer(encryptedToken),
+             retryToken.genAeadAssocData()) != 0;
+}
+
+struct TokenFixture {
+  TokenFixture() : generator(secret) {
+    for (size_t i = 0; i < kNumClients; ++i) {
+      initials.push_back(makeInitial(i));
+      RetryToken token(
+          initials.back().dstConnId,
+          initials.back().client.getIPAddress(),
+          initials.back().client.getPort());
+      tokens.push_back(generator.encryptToken(token).value()->toString());
+    }
+  }
+
+  TokenSecret secret{getRandSecret()};
+  TokenGenerator generator;
+  std::vector<Initial> initials;
+  std::vector<std::string> tokens;
+};
+
+TokenFixture& tokenFixture() {
+  static TokenFixture fixture;
+  return fixture;
+}
+} // namespace
+
+BENCHMARK_COUNTERS(initial_flood_create_transports, counters, iters) {
+  runInitialFlood(counters, iters, false /* retryUnderLoad */);
+}
+
+BENCHMARK_COUNTERS(initial_flood_retry_under_load, counters, iters) {
+  runInitialFlood(counters, iters, true /* retryUnderLoad */);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(retry_token_generator_per_call, iters) {
+  auto& f = tokenFixture();
+  for (size_t i = 0; i < iters; ++i) {
+    auto n = i % kNumClients;
+    folly::doNotOptimizeAway(
+        validatePerCallGenerator(f.secret, f.tokens[n], f.initials[n]));
+  }
+}
+
+BENCHMARK_RELATIVE(retry_token_cached_generator, iters) {
+  auto& f = tokenFixture();
+  for (size_t i = 0; i < iters; ++i) {
+    auto n = i % kNumClients;
+    folly::doNotOptimizeAway(
+        validateCachedGenerator(f.generator, f.tokens[n], f.initials[n]));
+  }
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
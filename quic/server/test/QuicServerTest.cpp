@@ -896,6 +896,52 @@ TEST_F(QuicServerWorkerTest, QuicServerMultipleConnIdsRouting) {
   transport_->QuicServerTransport::setRoutingCallback(nullptr);
 }
 
+TEST_F(QuicServerWorkerTest, GroBatchDeliveredOncePerTransport) {
+  EXPECT_CALL(*socketPtr_, address()).WillRepeatedly(ReturnRef(fakeAddress_));
+  auto connId = getTestConnectionId(hostId_);
+  createQuicConnection(kClientAddr, connId);
+  transport_->QuicServerTransport::setRoutingCallback(worker_.get());
+  worker_->onConnectionIdAvailable(transport_, connId);
+  auto connId2 = connId;
+  connId2.data()[7] ^= 0x1;
+  worker_->onConnectionIdAvailable(transport_, connId2);
+
+  // Three equally sized short header packets, one of them for the second
+  // connection id of the same transport, coalesced into one GRO read.
+  constexpr size_t kPacketSize = 40;
+  std::vector<ConnectionId> dstConnIds{connId, connId2, connId};
+  uint8_t* workerBuf = nullptr;
+  size_t workerBufLen = 0;
+  worker_->getReadBuffer((void**)&workerBuf, &workerBufLen);
+  ASSERT_GE(workerBufLen, kPacketSize * dstConnIds.size());
+  for (size_t i = 0; i < dstConnIds.size(); ++i) {
+    auto* packet = workerBuf + i * kPacketSize;
+    memset(packet, static_cast<int>(i), kPacketSize);
+    packet[0] = 0x40;
+    memcpy(packet + 1, dstConnIds[i].data(), dstConnIds[i].size());
+  }
+
+  EXPECT_CALL(*quicStats_, onPacketReceived());
+  EXPECT_CALL(*quicStats_, onRead(kPacketSize * dstConnIds.size()));
+  EXPECT_CALL(*transport_, onNetworkData(_, _))
+      .WillOnce(Invoke([&](auto&, const NetworkData& networkData) {
+        const auto& packets = networkData.getPackets();
+        ASSERT_EQ(packets.size(), dstConnIds.size());
+        for (size_t i = 0; i < packets.size(); ++i) {
+          EXPECT_EQ(packets[i].peerAddress, kClientAddr);
+          ASSERT_EQ(packets[i].buf.chainLength(), kPacketSize);
+          EXPECT_EQ(packets[i].buf.front()->data()[kPacketSize - 1], i);
+        }
+      }));
+  OnDataAvailableParams params;
+  params.gro = kPacketSize;
+  worker_->onDataAvailable(
+      kClientAddr, kPacketSize * dstConnIds.size(), false, params);
+  eventbase_.loopIgnoreKeepAlive();
+
+  transport_->QuicServerTransport::setRoutingCallback(nullptr);
+}
+
 TEST_F(QuicServerWorkerTest, RetireConnIds) {
   EXPECT_CALL(*socketPtr_, address()).WillRepeatedly(ReturnRef(fakeAddress_));
   auto connId = getTestConnectionId(hostId_);
@@ -1767,7 +1813,8 @@ class QuicServerWorkerRetryTest : public QuicServerWorkerTest {
       ConnectionId& clientSrcConnId,
       ConnectionId& dstConnId,
       const quic::SocketAddress& clientAddr,
-      const std::string& retryToken = "") {
+      const std::string& retryToken = "",
+      TimePoint receiveTime = Clock::now()) {
     QuicVersion version = QuicVersion::MVFST;
     PacketNum num = 1;
     LongHeader initialHeader(
@@ -1790,7 +1837,7 @@ class QuicServerWorkerRetryTest : public QuicServerWorkerTest {
     worker_->dispatchPacketData(
         clientAddr,
         std::move(routingData),
-        NetworkData(initialPacket->clone(), Clock::now(), 0),
+        NetworkData(initialPacket->clone(), receiveTime, 0),
         version);
     eventbase_.loopIgnoreKeepAlive();
   }
@@ -1847,6 +1894,28 @@ class QuicServerWorkerRetryTest : public QuicServerWorkerTest {
   void enableUnfinishedHandshakeLimitForRetry() {
     worker_->setUnfinishedHandshakeLimit([]() { return 0; });
   }
+
+  // A transport for a second connection, for tests in which transport_ is
+  // already taken.
+  MockQuicTransport::Ptr makeSecondTransport(
+      const quic::SocketAddress& peerAddr) {
+    auto mockSock =
+        std::make_unique<folly::test::MockAsyncUDPSocketT<>>(&eventbase_);
+    EXPECT_CALL(*mockSock, address()).WillRepeatedly(ReturnRef(fakeAddress_));
+    auto qSock =
+        std::make_unique<FollyQuicAsyncUDPSocket>(qEvb_, std::move(mockSock));
+    auto transport = std::make_shared<MockQuicTransport>(
+        qEvb_, std::move(qSock), &connSetupCb_, &connCb_, nullptr);
+    EXPECT_CALL(*transport, getEventBase()).WillRepeatedly(Return(qEvb_));
+    EXPECT_CALL(*transport, getOriginalPeerAddress())
+        .WillRepeatedly(ReturnRefOfCopy(peerAddr));
+    EXPECT_CALL(*transport, setRoutingCallback(nullptr));
+    EXPECT_CALL(*transport, setTransportStatsCallback(nullptr));
+    return transport;
+  }
+
+  NiceMock<MockConnectionSetupCallback> connSetupCb_;
+  NiceMock<MockConnectionCallback> connCb_;
 };
 
 // Validate that when the worker receives a valid NewToken, it invokes
@@ -1965,6 +2034,60 @@ TEST_F(QuicServerWorkerRetryTest, TestRetryInvalidInitialDstConnId) {
   testSendInitial(srcConnId, invalidDstConnId, kClientAddr, retryToken);
 }
 
+TEST_F(QuicServerWorkerRetryTest, TestRetryUnderLoadUnfinishedHandshakes) {
+  worker_->setRetryUnderLoad(1, 0);
+  EXPECT_CALL(*transport_, setRoutingCallback(nullptr));
+  EXPECT_CALL(*transport_, setTransportStatsCallback(nullptr));
+  createQuicConnection(kClientAddr, getTestConnectionId(hostId_));
+
+  // The worker now has as many unfinished handshakes as it allows.
+  auto srcConnId = getTestConnectionId(0);
+  auto dstConnId = getTestConnectionId(1);
+  std::string retryToken;
+  expectServerRetryPacketWrite(retryToken);
+  auto now = Clock::now();
+  testSendInitial(srcConnId, dstConnId, kClientAddr2, "", now);
+
+  // A new token is not enough while the worker is loaded, and isn't decrypted.
+  NewToken newToken(kClientAddr2.getIPAddress());
+  TokenGenerator generator(tokenSecret_);
+  auto encryptedNewToken = generator.encryptToken(newToken);
+  CHECK(encryptedNewToken.has_value());
+  EXPECT_CALL(*quicStats_, onNewTokenReceived()).Times(0);
+  std::string secondRetryToken;
+  expectServerRetryPacketWrite(secondRetryToken);
+  testSendInitial(
+      srcConnId,
+      dstConnId,
+      kClientAddr2,
+      encryptedNewToken.value()->toString(),
+      now);
+
+  // Once the handshake finishes the worker stops sending Retry at the start
+  // of the next second, and creates the connection.
+  worker_->onHandshakeFinished();
+  expectConnectionCreation(kClientAddr2, makeSecondTransport(kClientAddr2));
+  testSendInitial(srcConnId, dstConnId, kClientAddr2, "", now + 1s);
+}
+
+TEST_F(QuicServerWorkerRetryTest, TestRetryUnderLoadInitialRate) {
+  worker_->setRetryUnderLoad(0, 1);
+  EXPECT_CALL(*transport_, setRoutingCallback(nullptr));
+  EXPECT_CALL(*transport_, setTransportStatsCallback(nullptr));
+  createQuicConnection(kClientAddr, getTestConnectionId(hostId_));
+
+  // The second Initial within a second is over the limit.
+  auto srcConnId = getTestConnectionId(0);
+  auto dstConnId = getTestConnectionId(1);
+  std::string retryToken;
+  expectServerRetryPacketWrite(retryToken);
+  testSendInitial(srcConnId, dstConnId, kClientAddr2);
+
+  // The Retry's token lets the client through.
+  expectConnectionCreation(kClientAddr2, makeSecondTransport(kClientAddr2));
+  testSendInitial(srcConnId, dstConnId, kClientAddr2, retryToken);
+}
+
 class QuicServerWorkerTakeoverTest : public Test {
  public:
   void SetUp() override {
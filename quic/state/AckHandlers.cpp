@@ -15,6 +15,7 @@
 #include <quic/state/AckHandlers.h>
 #include <quic/state/AckedPacketIterator.h>
 #include <quic/state/ConnectionOopsFields.h>
+#include <quic/state/PmtuDiscoveryFunctions.h>
 #include <quic/state/QuicStateFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
 #include <iterator>
@@ -275,7 +276,9 @@ quic::Expected<AckEvent, QuicError> processAckFrame(
             TransportErrorCode::INTERNAL_ERROR,
             "Failed to modify state for spurious loss"));
       }
-      if (!ack.implicit) {
+      // A probe's loss was never reported as congestion, so there is
+      // nothing for the congestion controller to undo.
+      if (!ack.implicit && !ackedPacketIterator->isPmtuProbe) {
         ++ack.numPacketsSpuriouslyAcked;
       }
       QUIC_STATS(conn.statsCallback, onPacketSpuriousLoss);
@@ -311,6 +314,9 @@ quic::Expected<AckEvent, QuicError> processAckFrame(
       --conn.outstandings.packetCount[currentPacketNumberSpace];
     }
     ack.ackedBytes += ackedPacketIterator->metadata.encodedSize;
+    if (ackedPacketIterator->isPmtuProbe) {
+      onPmtuProbeAcked(conn, currentPacketNum, ackReceiveTime);
+    }
     if (ackedPacketIterator->maybeClonedPacketIdentifier) {
       PROTO_OOPS_LOG_BUILDER_IF(
           conn.nodeType == QuicNodeType::Server &&
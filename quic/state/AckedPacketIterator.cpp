@@ -97,13 +97,8 @@ AckedPacketIterator::MoveResult AckedPacketIterator::moveToNextValid() {
 
 AckedPacketIterator::MoveResult AckedPacketIterator::moveToNextValidInAckBlock(
     const AckBlock& ackBlock) {
-  outstandingsIter_ = std::lower_bound(
-      outstandingsIter_,
-      conn_.outstandings.packets.rend(),
-      ackBlock.endPacket,
-      [&](const auto& packetWithTime, const auto& val) {
-        return packetWithTime.packet.header.getPacketSequenceNum() > val;
-      });
+  outstandingsIter_ = findOutstandingPacketAtOrBelow(
+      conn_, outstandingsIter_, ackBlock.endPacket);
 
   while (
       (outstandingsIter_ != conn_.outstandings.packets.rend()) &&
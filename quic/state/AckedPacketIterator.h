@@ -46,7 +46,7 @@ class AckedPacketIterator {
   const quic::ReadAckFrame::Vec& ackBlocks_;
   QuicConnectionStateBase& conn_;
   PacketNumberSpace pnSpace_;
-  std::deque<OutstandingPacketWrapper>::reverse_iterator outstandingsIter_;
+  OutstandingPacketContainer::reverse_iterator outstandingsIter_;
   quic::ReadAckFrame::Vec::const_iterator ackBlockIter_;
   bool valid_{true};
 };
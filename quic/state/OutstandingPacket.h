@@ -9,6 +9,7 @@
 
 #include <folly/io/SocketOptionMap.h>
 #include <quic/codec/Types.h>
+#include <quic/common/CircularDeque.h>
 #include <quic/state/ClonedPacketIdentifier.h>
 #include <quic/state/LossState.h>
 #include <chrono>
@@ -196,6 +197,10 @@ struct OutstandingPacket {
   // lost.
   bool declaredLost : 1;
 
+  // True if this is a path MTU discovery probe. Probes are padded past
+  // udpSendPacketLen, and their loss says nothing about congestion.
+  bool isPmtuProbe : 1;
+
   [[nodiscard]] quic::PacketNum getPacketSequenceNum() const {
     return packet.header.getPacketSequenceNum();
   }
@@ -228,6 +233,7 @@ struct OutstandingPacket {
     // TODO remove when C++20 everywhere.
     isAppLimited = false;
     declaredLost = false;
+    isPmtuProbe = false;
   }
 
   OutstandingPacket(OutstandingPacket&&) noexcept = default;
@@ -278,8 +284,7 @@ struct OutstandingPacketWrapper : OutstandingPacket {
   OutstandingPacketWrapper(const OutstandingPacketWrapper& source) = delete;
   OutstandingPacketWrapper& operator=(const OutstandingPacketWrapper&) = delete;
 
-  // TODO: bring noexcept back after retiring gcc 9: T202935929
-  OutstandingPacketWrapper(OutstandingPacketWrapper&& rhs)
+  OutstandingPacketWrapper(OutstandingPacketWrapper&& rhs) noexcept
       : OutstandingPacket(std::move(rhs)),
         destroyContext_(std::exchange(rhs.destroyContext_, nullptr)), // NOLINT
         destroyFn_(std::exchange(rhs.destroyFn_, nullptr)) {} // NOLINT
@@ -305,4 +310,9 @@ struct OutstandingPacketWrapper : OutstandingPacket {
     }
   }
 };
+
+// Outstanding packets of a connection, sorted by packet number. Backed by a
+// contiguous ring so that walking and erasing acked ranges stays cache
+// friendly even with tens of thousands of packets in flight.
+using OutstandingPacketContainer = CircularDeque<OutstandingPacketWrapper>;
 } // namespace quic
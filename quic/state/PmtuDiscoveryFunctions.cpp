@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/common/MvfstLogging.h>
+#include <quic/logging/QLoggerConstants.h>
+#include <quic/logging/QLoggerMacros.h>
+#include <quic/state/PmtuDiscoveryFunctions.h>
+
+#include <algorithm>
+
+namespace quic {
+
+namespace {
+
+using Phase = QuicConnectionStateBase::PmtuDiscoveryState::Phase;
+
+uint64_t searchGranularity(const QuicConnectionStateBase& conn) {
+  return std::max<uint64_t>(
+      conn.transportSettings.pmtuDiscoveryConfig.searchGranularity, 1);
+}
+
+void completeSearch(QuicConnectionStateBase& conn, TimePoint now) {
+  auto& pmtu = *conn.pmtuDiscovery;
+  pmtu.phase = Phase::SearchComplete;
+  pmtu.searchCompleteTime = now;
+  pmtu.outstandingProbe.reset();
+  // The next search, if any, starts at the ceiling again.
+  pmtu.probeSize = pmtu.maxPacketSize;
+  QLOG(
+      conn,
+      addPmtuUpdate,
+      pmtu.searchLow,
+      conn.udpSendPacketLen,
+      kPmtuSearchComplete);
+}
+
+// Picks the next probe size from the remaining interval, or completes the
+// search once the interval is narrower than the granularity.
+void advanceSearch(QuicConnectionStateBase& conn, TimePoint now) {
+  auto& pmtu = *conn.pmtuDiscovery;
+  pmtu.probesLost = 0;
+  pmtu.outstandingProbe.reset();
+  if (pmtu.searchHigh < pmtu.searchLow + searchGranularity(conn)) {
+    completeSearch(conn, now);
+    return;
+  }
+  pmtu.phase = Phase::Searching;
+  pmtu.probeSize = pmtu.searchLow + (pmtu.searchHigh - pmtu.searchLow + 1) / 2;
+}
+
+void beginSearch(QuicConnectionStateBase& conn, TimePoint now) {
+  auto& pmtu = *conn.pmtuDiscovery;
+  pmtu.searchLow = conn.udpSendPacketLen;
+  pmtu.searchHigh = pmtu.maxPacketSize;
+  pmtu.searchCompleteTime.reset();
+  advanceSearch(conn, now);
+  if (pmtu.phase != Phase::Searching) {
+    return;
+  }
+  // Probe the ceiling first. Paths that carry it, which is the common case
+  // for jumbo frame capable networks, are raised in a single round trip.
+  pmtu.probeSize = pmtu.searchHigh;
+  QLOG(
+      conn,
+      addPmtuUpdate,
+      pmtu.probeSize,
+      conn.udpSendPacketLen,
+      kPmtuSearchStart);
+}
+
+} // namespace
+
+void maybeInitPmtuDiscovery(
+    QuicConnectionStateBase& conn,
+    uint64_t peerMaxUdpPayloadSize) {
+  const auto& config = conn.transportSettings.pmtuDiscoveryConfig;
+  if (!config.enabled || conn.pmtuDiscovery) {
+    return;
+  }
+  // Continuous memory write buffers are sized for udpSendPacketLen packets and
+  // cannot take a larger probe.
+  if (conn.transportSettings.dataPathType != DataPathType::ChainedMemory) {
+    MVVLOG(4) << "Path MTU discovery needs the chained memory data path "
+              << conn;
+    return;
+  }
+  uint64_t maxPacketSize = std::min<uint64_t>(
+      {config.maxPacketSize, peerMaxUdpPayloadSize, kMaxUDPPayload});
+  if (maxPacketSize <= conn.udpSendPacketLen) {
+    return;
+  }
+  conn.pmtuDiscovery.emplace();
+  conn.pmtuDiscovery->maxPacketSize = maxPacketSize;
+}
+
+void startPmtuDiscovery(QuicConnectionStateBase& conn, TimePoint now) {
+  if (!conn.pmtuDiscovery || conn.pmtuDiscovery->phase != Phase::NotStarted) {
+    return;
+  }
+  conn.pmtuDiscovery->basePacketLen = conn.udpSendPacketLen;
+  beginSearch(conn, now);
+}
+
+bool shouldSendPmtuProbe(const QuicConnectionStateBase& conn, TimePoint now) {
+  if (!conn.pmtuDiscovery) {
+    return false;
+  }
+  const auto& pmtu = *conn.pmtuDiscovery;
+  switch (pmtu.phase) {
+    case Phase::NotStarted:
+      return false;
+    case Phase::Searching:
+      return !pmtu.outstandingProbe.has_value();
+    case Phase::SearchComplete:
+      return conn.udpSendPacketLen + searchGranularity(conn) <=
+          pmtu.maxPacketSize &&
+          pmtu.searchCompleteTime &&
+          now - *pmtu.searchCompleteTime >=
+          conn.transportSettings.pmtuDiscoveryConfig.raiseTimer;
+  }
+  folly::assume_unreachable();
+}
+
+uint64_t nextPmtuProbeSize(QuicConnectionStateBase& conn, TimePoint now) {
+  MVCHECK(conn.pmtuDiscovery);
+  if (conn.pmtuDiscovery->phase == Phase::SearchComplete) {
+    beginSearch(conn, now);
+  }
+  return conn.pmtuDiscovery->probeSize;
+}
+
+void onPmtuProbeSent(QuicConnectionStateBase& conn, PacketNum packetNum) {
+  MVCHECK(conn.pmtuDiscovery);
+  conn.pmtuDiscovery->outstandingProbe = packetNum;
+}
+
+void onPmtuProbeAcked(
+    QuicConnectionStateBase& conn,
+    PacketNum packetNum,
+    TimePoint now) {
+  if (!conn.pmtuDiscovery) {
+    return;
+  }
+  auto& pmtu = *conn.pmtuDiscovery;
+  // Probes of an abandoned search are ignored.
+  if (pmtu.outstandingProbe != packetNum) {
+    return;
+  }
+  auto probeSize = pmtu.probeSize;
+  pmtu.searchLow = probeSize;
+  conn.udpSendPacketLen = std::max(conn.udpSendPacketLen, probeSize);
+  QLOG(conn, addPmtuUpdate, probeSize, conn.udpSendPacketLen, kPmtuProbeAcked);
+  advanceSearch(conn, now);
+}
+
+void onPmtuProbeLost(
+    QuicConnectionStateBase& conn,
+    PacketNum packetNum,
+    TimePoint now) {
+  if (!conn.pmtuDiscovery) {
+    return;
+  }
+  auto& pmtu = *conn.pmtuDiscovery;
+  if (pmtu.outstandingProbe != packetNum) {
+    return;
+  }
+  pmtu.outstandingProbe.reset();
+  auto probeSize = pmtu.probeSize;
+  QLOG(conn, addPmtuUpdate, probeSize, conn.udpSendPacketLen, kPmtuProbeLost);
+  auto maxProbes = std::max<uint8_t>(
+      conn.transportSettings.pmtuDiscoveryConfig.maxProbes, 1);
+  if (++pmtu.probesLost < maxProbes) {
+    // Retry the same size, a single loss may have nothing to do with its size.
+    return;
+  }
+  pmtu.searchHigh = probeSize - 1;
+  advanceSearch(conn, now);
+}
+
+void onPmtuBlackHoleSuspected(QuicConnectionStateBase& conn, TimePoint now) {
+  if (!conn.pmtuDiscovery || conn.pmtuDiscovery->phase == Phase::NotStarted ||
+      conn.udpSendPacketLen <= conn.pmtuDiscovery->basePacketLen) {
+    return;
+  }
+  auto& pmtu = *conn.pmtuDiscovery;
+  auto failedSize = conn.udpSendPacketLen;
+  conn.udpSendPacketLen = pmtu.basePacketLen;
+  QLOG(conn, addPmtuUpdate, failedSize, conn.udpSendPacketLen, kPmtuBlackHole);
+  pmtu.searchLow = pmtu.basePacketLen;
+  pmtu.searchHigh = failedSize - 1;
+  pmtu.searchCompleteTime.reset();
+  advanceSearch(conn, now);
+}
+
+} // namespace quic
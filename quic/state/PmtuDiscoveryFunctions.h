@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/state/StateData.h>
+
+namespace quic {
+
+/**
+ * Datagram packetization layer path MTU discovery (RFC 8899).
+ *
+ * Once the handshake is confirmed the connection sends PING+PADDING probes
+ * larger than udpSendPacketLen. The first probe goes straight to the search
+ * ceiling, so a path that carries it is raised in one round trip. After
+ * maxProbes losses of one size the search bisects the remaining interval.
+ * Each acknowledged probe raises udpSendPacketLen to its size. Probe loss is
+ * not treated as congestion.
+ */
+
+// Sets up path MTU discovery if it is enabled and the peer's
+// max_udp_payload_size leaves room above udpSendPacketLen.
+void maybeInitPmtuDiscovery(
+    QuicConnectionStateBase& conn,
+    uint64_t peerMaxUdpPayloadSize);
+
+// Starts searching. Called when the handshake is confirmed.
+void startPmtuDiscovery(QuicConnectionStateBase& conn, TimePoint now);
+
+[[nodiscard]] bool shouldSendPmtuProbe(
+    const QuicConnectionStateBase& conn,
+    TimePoint now);
+
+// Returns the size of the next probe. A completed search whose raise timer has
+// expired starts over.
+uint64_t nextPmtuProbeSize(QuicConnectionStateBase& conn, TimePoint now);
+
+void onPmtuProbeSent(QuicConnectionStateBase& conn, PacketNum packetNum);
+
+// Acks and losses of probes other than the outstanding one are ignored.
+void onPmtuProbeAcked(
+    QuicConnectionStateBase& conn,
+    PacketNum packetNum,
+    TimePoint now);
+
+void onPmtuProbeLost(
+    QuicConnectionStateBase& conn,
+    PacketNum packetNum,
+    TimePoint now);
+
+// Falls back to the base packet size and searches below the size that stopped
+// getting through.
+void onPmtuBlackHoleSuspected(QuicConnectionStateBase& conn, TimePoint now);
+
+} // namespace quic
@@ -14,11 +14,11 @@
 #include <quic/common/TimeUtil.h>
 
 namespace {
-std::deque<quic::OutstandingPacketWrapper>::reverse_iterator
+quic::OutstandingPacketContainer::reverse_iterator
 getPreviousOutstandingPacket(
     quic::QuicConnectionStateBase& conn,
     quic::PacketNumberSpace packetNumberSpace,
-    const std::deque<quic::OutstandingPacketWrapper>::reverse_iterator& from,
+    const quic::OutstandingPacketContainer::reverse_iterator& from,
     bool includeLost = false,
     bool includeScheduledForDestruction = false) {
   return std::find_if(
@@ -284,14 +284,14 @@ void increaseNextPacketNum(
   }
 }
 
-std::deque<OutstandingPacketWrapper>::iterator getFirstOutstandingPacket(
+OutstandingPacketContainer::iterator getFirstOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace) {
   return getNextOutstandingPacket(
       conn, packetNumberSpace, conn.outstandings.packets.begin());
 }
 
-std::deque<OutstandingPacketWrapper>::reverse_iterator getLastOutstandingPacket(
+OutstandingPacketContainer::reverse_iterator getLastOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace,
     bool includeLost,
@@ -304,10 +304,37 @@ std::deque<OutstandingPacketWrapper>::reverse_iterator getLastOutstandingPacket(
       includeScheduledForDestruction);
 }
 
-std::deque<OutstandingPacketWrapper>::iterator getNextOutstandingPacket(
+OutstandingPacketContainer::reverse_iterator findOutstandingPacketAtOrBelow(
+    QuicConnectionStateBase& conn,
+    OutstandingPacketContainer::reverse_iterator from,
+    PacketNum packetNum) {
+  auto rend = conn.outstandings.packets.rend();
+  if (from == rend || from->getPacketSequenceNum() <= packetNum) {
+    return from;
+  }
+  auto compare = [](const auto& op, PacketNum val) {
+    return op.getPacketSequenceNum() > val;
+  };
+  auto remaining = static_cast<uint64_t>(std::distance(from, rend));
+  auto offset = from->getPacketSequenceNum() - packetNum;
+  if (offset >= remaining) {
+    return std::lower_bound(from, rend, packetNum, compare);
+  }
+  auto candidate = from + offset;
+  if (candidate->getPacketSequenceNum() > packetNum) {
+    return std::lower_bound(candidate + 1, rend, packetNum, compare);
+  }
+  if ((candidate - 1)->getPacketSequenceNum() > packetNum) {
+    // Exact hit, which is the common case with no reordering or gaps.
+    return candidate;
+  }
+  return std::lower_bound(from + 1, candidate, packetNum, compare);
+}
+
+OutstandingPacketContainer::iterator getNextOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace,
-    std::deque<OutstandingPacketWrapper>::iterator from) {
+    OutstandingPacketContainer::iterator from) {
   return std::find_if(
       from, conn.outstandings.packets.end(), [=](const auto& op) {
         return !op.declaredLost &&
@@ -457,9 +484,10 @@ Expected<AddPacketToAckStateResult, IntervalSetError> addPacketToAckState(
   ackState.lastRecvdPacketInfo = {packetNum, udpPacket.timings};
 
   // Store every non-duplicate packet in arrival order. Packet numbers and
-  // receive times may both be non-monotonic; encoders own the wire-format
-  // constraints (legacy filters to a monotonic suffix at write time;
-  // draft-02 sorts the storage view by receive-time desc before grouping).
+  // receive times may both be non-monotonic; the storage keeps a receive-time
+  // index up to date and encoders own the wire-format constraints (legacy
+  // filters to a monotonic suffix at write time; draft-02 walks the index by
+  // receive-time desc while grouping).
   if (ackState.recvdPacketInfos.size() ==
       conn.transportSettings.maxReceiveTimestampsPerAckStored) {
     ackState.recvdPacketInfos.pop_front();
@@ -83,20 +83,32 @@ addPacketToAckState(
     PacketNum packetNum,
     const ReceivedUdpPacket& udpPacket);
 
-std::deque<OutstandingPacketWrapper>::iterator getNextOutstandingPacket(
+OutstandingPacketContainer::iterator getNextOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace,
-    std::deque<OutstandingPacketWrapper>::iterator from);
-std::deque<OutstandingPacketWrapper>::iterator getFirstOutstandingPacket(
+    OutstandingPacketContainer::iterator from);
+OutstandingPacketContainer::iterator getFirstOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace);
 
-std::deque<OutstandingPacketWrapper>::reverse_iterator getLastOutstandingPacket(
+OutstandingPacketContainer::reverse_iterator getLastOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace,
     bool includeDeclaredLost = false,
     bool includeScheduledForDestruction = false);
 
+/**
+ * Starting at from and walking towards older packets, returns the first
+ * outstanding packet whose packet number is at most packetNum, regardless of
+ * its packet number space. Packet numbers are nearly dense in the outstanding
+ * list, so the packet number delta is tried as a direct index before falling
+ * back to a binary search.
+ */
+OutstandingPacketContainer::reverse_iterator findOutstandingPacketAtOrBelow(
+    QuicConnectionStateBase& conn,
+    OutstandingPacketContainer::reverse_iterator from,
+    PacketNum packetNum);
+
 bool hasReceivedUdpPackets(const QuicConnectionStateBase& conn) noexcept;
 
 bool hasReceivedUdpPacketsAtLastCloseSent(
@@ -200,33 +200,34 @@ QuicStreamManager::QuicStreamManager(
   openUnidirectionalLocalStreams_ =
       std::move(other.openUnidirectionalLocalStreams_);
   newPeerStreams_ = std::move(other.newPeerStreams_);
-  blockedStreams_ = std::move(other.blockedStreams_);
-  stopSendingStreams_ = std::move(other.stopSendingStreams_);
-  windowUpdates_ = std::move(other.windowUpdates_);
-  flowControlUpdated_ = std::move(other.flowControlUpdated_);
   numStreamsWithLoss_ = other.numStreamsWithLoss_;
   other.numStreamsWithLoss_ = 0;
-  readableStreams_ = std::move(other.readableStreams_);
-  peekableStreams_ = std::move(other.peekableStreams_);
   writeQueue_ = std::move(other.writeQueue_);
   controlWriteQueue_ = std::move(other.controlWriteQueue_);
-  txStreams_ = std::move(other.txStreams_);
-  deliverableStreams_ = std::move(other.deliverableStreams_);
-  closedStreams_ = std::move(other.closedStreams_);
   isAppIdle_ = other.isAppIdle_;
   maxLocalBidirectionalStreamIdIncreased_ =
       other.maxLocalBidirectionalStreamIdIncreased_;
   maxLocalUnidirectionalStreamIdIncreased_ =
       other.maxLocalUnidirectionalStreamIdIncreased_;
 
-  for (auto& pair : other.streams_) {
-    streams_.emplace(
-        std::piecewise_construct,
-        std::forward_as_tuple(pair.first),
-        std::forward_as_tuple(
-            conn_, // Use the new conn ref
-            std::move(pair.second)));
-  }
+  other.streams_.forEach([&](QuicStreamState& stream) {
+    streams_.tryEmplace(
+        stream.id,
+        conn_, // Use the new conn ref
+        std::move(stream));
+  });
+  // The moved states keep their membership links, which are keyed by stream
+  // ID, so the sets can be taken over as they are.
+  blockedStreams_.adopt(other.blockedStreams_);
+  stopSendingStreams_.adopt(other.stopSendingStreams_);
+  windowUpdates_.adopt(other.windowUpdates_);
+  flowControlUpdated_.adopt(other.flowControlUpdated_);
+  connFlowControlBlocked_.adopt(other.connFlowControlBlocked_);
+  readableStreams_.adopt(other.readableStreams_);
+  peekableStreams_.adopt(other.peekableStreams_);
+  txStreams_.adopt(other.txStreams_);
+  deliverableStreams_.adopt(other.deliverableStreams_);
+  closedStreams_.adopt(other.closedStreams_);
   // Call refreshTransportSettings which now returns Expected
   auto refreshResult = refreshTransportSettings(transportSettings);
   if (refreshResult.hasError()) {
@@ -320,9 +321,7 @@ QuicStreamManager::nextAcceptableLocalUnidirectionalStreamId() {
 
 void QuicStreamManager::streamStateForEach(
     FunctionRef<void(QuicStreamState&)> f) {
-  for (auto& s : streams_) {
-    f(s.second);
-  }
+  streams_.forEach(f);
 }
 
 void QuicStreamManager::removeLoss(StreamId id) {
@@ -479,12 +478,7 @@ bool QuicStreamManager::streamExists(StreamId streamId) {
 }
 
 QuicStreamState* QuicStreamManager::findStream(StreamId streamId) {
-  auto lookup = streams_.find(streamId);
-  if (lookup == streams_.end()) {
-    return nullptr;
-  } else {
-    return &lookup->second;
-  }
+  return streams_.find(streamId);
 }
 
 QuicStreamState* QuicStreamManager::getStreamIfExists(StreamId streamId) {
@@ -682,16 +676,13 @@ QuicStreamManager::getOrCreateOpenedLocalStream(StreamId streamId) {
       ? openUnidirectionalLocalStreams_
       : openBidirectionalLocalStreams_;
   if (openLocalStreams.contains(streamId)) {
-    auto it = streams_.emplace(
-        std::piecewise_construct,
-        std::forward_as_tuple(streamId),
-        std::forward_as_tuple(streamId, conn_));
-    if (!it.second) {
+    auto [stream, inserted] = streams_.tryEmplace(streamId, streamId, conn_);
+    if (!inserted) {
       return quic::make_unexpected(QuicError(
           TransportErrorCode::STREAM_STATE_ERROR, "Creating an active stream"));
     }
     QUIC_STATS(conn_.statsCallback, onNewQuicStream);
-    return &it.first->second;
+    return stream;
   }
   return nullptr;
 }
@@ -710,11 +701,10 @@ quic::Expected<QuicStreamState*, QuicError> QuicStreamManager::getStream(
   }
 
   // Handle local streams
-  auto it = streams_.find(streamId);
-  if (it != streams_.end()) {
+  if (auto* existing = streams_.find(streamId)) {
     // Stream state already exists
     updateAppIdleState();
-    return &it->second;
+    return existing;
   }
 
   // Try to get/create state for an already opened (but not instantiated) local
@@ -804,12 +794,12 @@ QuicStreamManager::createNextUnidirectionalStream() {
 QuicStreamState* FOLLY_NULLABLE
 QuicStreamManager::instantiatePeerStream(StreamId streamId) {
   // Use try_emplace to avoid potential double-check issues if called directly
-  auto [it, inserted] = streams_.try_emplace(streamId, streamId, conn_);
+  auto [stream, inserted] = streams_.tryEmplace(streamId, streamId, conn_);
 
   if (inserted) {
     QUIC_STATS(conn_.statsCallback, onNewQuicStream);
   }
-  return &it->second;
+  return stream;
 }
 
 // Returns QuicError for transport-level issues (limits, state), nullptr if
@@ -832,9 +822,8 @@ QuicStreamManager::getOrCreatePeerStream(StreamId streamId) {
   }
 
   // Check if stream state already exists in the map
-  auto peerStreamIt = streams_.find(streamId);
-  if (peerStreamIt != streams_.end()) {
-    return &peerStreamIt->second;
+  if (auto* peerStream = streams_.find(streamId)) {
+    return peerStream;
   }
 
   // Check if stream was previously opened (in the StreamIdSet)
@@ -975,7 +964,7 @@ quic::Expected<QuicStreamState*, QuicError> QuicStreamManager::createStream(
   MVDCHECK(openedResultCode == LocalErrorCode::NO_ERROR);
 
   // Stream is now officially open, instantiate its state in the map.
-  auto [it, inserted] = streams_.try_emplace(streamId, streamId, conn_);
+  auto [stream, inserted] = streams_.tryEmplace(streamId, streamId, conn_);
 
   if (!inserted) {
     // Propagate internal error as QuicError
@@ -988,24 +977,24 @@ quic::Expected<QuicStreamState*, QuicError> QuicStreamManager::createStream(
 
   QUIC_STATS(conn_.statsCallback, onNewQuicStream);
   updateAppIdleState();
-  return &it->second;
+  return stream;
 }
 
 quic::Expected<void, QuicError> QuicStreamManager::removeClosedStream(
     StreamId streamId) {
-  auto it = streams_.find(streamId);
-  if (it == streams_.end()) {
+  auto* stream = streams_.find(streamId);
+  if (!stream) {
     MVVLOG(10) << "Trying to remove already closed stream=" << streamId;
     return {};
   }
   MVVLOG(10) << "Removing closed stream=" << streamId;
   PROTO_OOPS_LOG_BUILDER_IF(
-      conn_.nodeType == QuicNodeType::Server && !it->second.inTerminalStates(),
+      conn_.nodeType == QuicNodeType::Server && !stream->inTerminalStates(),
       conn_.oopsLogger,
       proto_oops::OopsFieldsBuilder().setStreamId(streamId),
       "quic_stream_manager",
       "removing non-terminal stream");
-  MVDCHECK(it->second.inTerminalStates());
+  MVDCHECK(stream->inTerminalStates());
 
   // Clear from various tracking sets
   if (conn_.pendingEvents.resets.contains(streamId)) {
@@ -1013,10 +1002,10 @@ quic::Expected<void, QuicError> QuicStreamManager::removeClosedStream(
   }
   readableStreams_.erase(streamId);
   peekableStreams_.erase(streamId);
-  removeWritable(it->second);
+  removeWritable(*stream);
   // Handle loss counter - we have mutable access to the stream here
-  if (it->second.inLossSet_) {
-    it->second.inLossSet_ = false;
+  if (stream->inLossSet_) {
+    stream->inLossSet_ = false;
     PROTO_OOPS_LOG_BUILDER_IF(
         conn_.nodeType == QuicNodeType::Server && numStreamsWithLoss_ == 0,
         conn_.oopsLogger,
@@ -1033,8 +1022,9 @@ quic::Expected<void, QuicError> QuicStreamManager::removeClosedStream(
   stopSendingStreams_.erase(streamId);
   flowControlUpdated_.erase(streamId);
   connFlowControlBlocked_.erase(streamId);
+  closedStreams_.erase(streamId);
   // Adjust control stream count if needed
-  if (it->second.isControl) {
+  if (stream->isControl) {
     PROTO_OOPS_LOG_BUILDER_IF(
         conn_.nodeType == QuicNodeType::Server && numControlStreams_ == 0,
         conn_.oopsLogger,
@@ -1046,7 +1036,7 @@ quic::Expected<void, QuicError> QuicStreamManager::removeClosedStream(
   }
 
   // Erase the main stream state
-  streams_.erase(it);
+  streams_.erase(streamId);
   QUIC_STATS(conn_.statsCallback, onQuicStreamClosed);
 
   // Handle stream limit updates for remote streams
@@ -1207,13 +1197,18 @@ bool QuicStreamManager::isAppIdle() const {
 
 void QuicStreamManager::clearOpenStreams() {
   // Call stats callback before clearing
-  QUIC_STATS_FOR_EACH(
-      streams().cbegin(),
-      streams().cend(),
-      conn_.statsCallback,
-      onQuicStreamClosed);
-
-  // Clear all stream sets and maps
+  streams_.forEach([&](const QuicStreamState&) {
+    QUIC_STATS(conn_.statsCallback, onQuicStreamClosed);
+  });
+
+  // Clear all stream sets and maps. The membership sets have to be cleared
+  // while the stream states they are linked through are still alive.
+  clearActionable();
+  blockedStreams_.clear();
+  stopSendingStreams_.clear();
+  windowUpdates_.clear();
+  connFlowControlBlocked_.clear();
+  closedStreams_.clear();
   openBidirectionalLocalStreams_.clear();
   openUnidirectionalLocalStreams_.clear();
   openBidirectionalPeerStreams_.clear();
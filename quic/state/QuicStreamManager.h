@@ -16,6 +16,8 @@
 #include <quic/common/FunctionRef.h>
 #include <quic/priority/PriorityQueue.h>
 #include <quic/state/StreamData.h>
+#include <quic/state/StreamMembership.h>
+#include <quic/state/StreamStateTable.h>
 #include <quic/state/TransportSettings.h>
 #include <numeric>
 #include <set>
@@ -506,29 +508,40 @@ class QuicStreamManager {
   StreamIdSet openBidirectionalLocalStreams_;
   StreamIdSet openUnidirectionalLocalStreams_;
 
-  UnorderedMap<StreamId, QuicStreamState> streams_;
+  StreamStateTable<QuicStreamState> streams_;
 
   std::vector<StreamId> newPeerStreams_;
 
-  UnorderedMap<StreamId, uint64_t> blockedStreams_; // StreamId -> offset
-  UnorderedMap<StreamId, ApplicationErrorCode> stopSendingStreams_;
-  UnorderedSet<StreamId> windowUpdates_;
-  UnorderedSet<StreamId> flowControlUpdated_;
+  // Per-category stream sets. Membership is stored intrusively in the stream
+  // states of streams_, see StreamMembership.
+  StreamMembershipSet<QuicStreamState, StreamSetKind::Blocked> blockedStreams_{
+      streams_};
+  StreamMembershipSet<QuicStreamState, StreamSetKind::StopSending>
+      stopSendingStreams_{streams_};
+  StreamMembershipSet<QuicStreamState, StreamSetKind::WindowUpdate>
+      windowUpdates_{streams_};
+  StreamMembershipSet<QuicStreamState, StreamSetKind::FlowControlUpdated>
+      flowControlUpdated_{streams_};
 
   // Streams that were removed from the write queue because they are blocked
   // on connection flow control.
-  UnorderedSet<StreamId> connFlowControlBlocked_;
+  StreamMembershipSet<QuicStreamState, StreamSetKind::ConnFlowControlBlocked>
+      connFlowControlBlocked_{streams_};
 
   // Counter of streams that have bytes in loss buffer
   size_t numStreamsWithLoss_{0};
-  UnorderedSet<StreamId> readableStreams_;
-  UnorderedSet<StreamId> peekableStreams_;
+  StreamMembershipSet<QuicStreamState, StreamSetKind::Readable>
+      readableStreams_{streams_};
+  StreamMembershipSet<QuicStreamState, StreamSetKind::Peekable>
+      peekableStreams_{streams_};
 
   std::unique_ptr<PriorityQueue> writeQueue_;
   std::set<StreamId> controlWriteQueue_;
-  UnorderedSet<StreamId> txStreams_;
-  UnorderedSet<StreamId> deliverableStreams_;
-  UnorderedSet<StreamId> closedStreams_;
+  StreamMembershipSet<QuicStreamState, StreamSetKind::Tx> txStreams_{streams_};
+  StreamMembershipSet<QuicStreamState, StreamSetKind::Deliverable>
+      deliverableStreams_{streams_};
+  StreamMembershipSet<QuicStreamState, StreamSetKind::Closed> closedStreams_{
+      streams_};
 
   bool isAppIdle_{false};
   const TransportSettings* FOLLY_NONNULL transportSettings_;
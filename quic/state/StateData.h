@@ -51,8 +51,9 @@
 namespace quic {
 
 struct OutstandingsInfo {
-  // Sent packets which have not been acked. These are sorted by PacketNum.
-  std::deque<OutstandingPacketWrapper> packets;
+  // Sent packets which have not been acked. These are sorted by PacketNum and
+  // stored contiguously, see findOutstandingPacketAtOrBelow() for lookups.
+  OutstandingPacketContainer packets;
 
   // All PacketEvents of this connection. If a OutstandingPacketWrapper doesn't
   // have an maybeClonedPacketIdentifier or if it's not in this set, there is no
@@ -216,6 +217,16 @@ struct Pacer {
    */
   [[nodiscard]] virtual uint64_t getCachedWriteBatchSize() const = 0;
 
+  /**
+   * Departure time of the next packet as an offset from writeTime, for
+   * pacers that leave holding packets back to the kernel. Zero means send
+   * immediately.
+   */
+  [[nodiscard]] virtual std::chrono::microseconds getTxTimeOffset(
+      TimePoint /* writeTime */) const {
+    return std::chrono::microseconds::zero();
+  }
+
   virtual void onPacketSent() = 0;
   virtual void onPacketsLoss() = 0;
 };
@@ -832,6 +843,39 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
 
   // Peer advertised scone_supported. Gates SCONE send.
   bool peerAdvertisedSconeSupport{false};
+
+  struct PmtuDiscoveryState {
+    enum class Phase : uint8_t {
+      // Waiting for the handshake to be confirmed.
+      NotStarted,
+      // Probing for a larger packet size.
+      Searching,
+      // Waiting for the raise timer before searching again.
+      SearchComplete,
+    };
+
+    Phase phase{Phase::NotStarted};
+    // Upper bound of the search, the smaller of the configured maximum and the
+    // peer's max_udp_payload_size.
+    uint64_t maxPacketSize{0};
+    // Packet size when the search started, fallen back to on a black hole.
+    uint64_t basePacketLen{0};
+    // Largest packet size the path is known to carry.
+    uint64_t searchLow{0};
+    // Largest packet size not yet known to be too large for the path.
+    uint64_t searchHigh{0};
+    // Size of the outstanding probe, or of the next one to send.
+    uint64_t probeSize{0};
+    // Number of probes of probeSize declared lost.
+    uint8_t probesLost{0};
+    // Packet number of the probe of probeSize in flight, if any.
+    Optional<PacketNum> outstandingProbe;
+    Optional<TimePoint> searchCompleteTime;
+  };
+
+  // Set when transportSettings.pmtuDiscoveryConfig is enabled and the peer's
+  // transport parameters leave room to grow udpSendPacketLen.
+  Optional<PmtuDiscoveryState> pmtuDiscovery;
 };
 
 std::ostream& operator<<(std::ostream& os, const QuicConnectionStateBase& st);
@@ -15,6 +15,7 @@
 #include <quic/common/Expected.h>
 #include <quic/common/IntervalSet.h>
 #include <quic/priority/PriorityQueue.h>
+#include <quic/state/StreamMembership.h>
 
 namespace quic {
 
@@ -365,6 +366,7 @@ struct QuicStreamState : public QuicStreamLike {
     streamLossCount = other.streamLossCount;
     inLossSet_ = other.inLossSet_;
     retransmissionDisabled_ = other.retransmissionDisabled_;
+    membership = other.membership;
   }
 
   // Connection that this stream is associated with.
@@ -431,6 +433,10 @@ struct QuicStreamState : public QuicStreamLike {
   // be retransmitted).
   bool retransmissionDisabled_{false};
 
+  // Which of the QuicStreamManager stream sets this stream is in, and its
+  // links within them. Only touched through StreamMembershipSet.
+  StreamMembership membership;
+
   // Returns true if both send and receive state machines are in a terminal
   // state
   [[nodiscard]] bool inTerminalStates() const noexcept {
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/QuicConstants.h>
+#include <quic/codec/Types.h>
+#include <quic/common/MvfstCheck.h>
+#include <quic/state/StreamStateTable.h>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace quic {
+
+/**
+ * The per-connection stream sets QuicStreamManager keeps. Membership in each
+ * of them is recorded inside the stream state, see StreamMembership.
+ */
+enum class StreamSetKind : uint8_t {
+  Readable,
+  Peekable,
+  WindowUpdate,
+  FlowControlUpdated,
+  ConnFlowControlBlocked,
+  Tx,
+  Deliverable,
+  Closed,
+  // StreamId -> offset
+  Blocked,
+  // StreamId -> error code
+  StopSending,
+  // Must be last.
+  NumKinds,
+};
+
+/**
+ * Intrusive hooks linking a stream state into the StreamMembershipSets of its
+ * connection. The links are stream IDs rather than pointers so that they stay
+ * valid when the state is moved, e.g. when streams are migrated to a new
+ * connection state.
+ */
+struct StreamMembership {
+  static constexpr StreamId kNone = std::numeric_limits<StreamId>::max();
+  static constexpr size_t kNumKinds =
+      static_cast<size_t>(StreamSetKind::NumKinds);
+
+  struct Link {
+    StreamId prev{kNone};
+    StreamId next{kNone};
+  };
+
+  static constexpr uint16_t bitOf(StreamSetKind kind) noexcept {
+    return uint16_t(1) << static_cast<uint8_t>(kind);
+  }
+
+  [[nodiscard]] bool in(StreamSetKind kind) const noexcept {
+    return bits & bitOf(kind);
+  }
+
+  std::array<Link, kNumKinds> links;
+  uint16_t bits{0};
+  // Values of the map-like sets.
+  uint64_t blockedOffset{0};
+  ApplicationErrorCode stopSendingError{0};
+};
+
+static_assert(
+    StreamMembership::kNumKinds <= 16,
+    "StreamMembership::bits is 16 bits");
+
+namespace detail {
+
+struct NoStreamSetValue {};
+
+template <StreamSetKind Kind>
+struct StreamSetValue {
+  using type = NoStreamSetValue;
+};
+
+template <>
+struct StreamSetValue<StreamSetKind::Blocked> {
+  using type = uint64_t;
+  static uint64_t& get(StreamMembership& membership) noexcept {
+    return membership.blockedOffset;
+  }
+};
+
+template <>
+struct StreamSetValue<StreamSetKind::StopSending> {
+  using type = ApplicationErrorCode;
+  static ApplicationErrorCode& get(StreamMembership& membership) noexcept {
+    return membership.stopSendingError;
+  }
+};
+
+} // namespace detail
+
+/**
+ * A set of stream IDs (or a map from stream ID to a value for the Blocked and
+ * StopSending kinds) threaded through StreamMembership::links of the states in
+ * a StreamStateTable. Adding, removing and membership tests are O(1) and never
+ * hash or allocate, and iteration walks the list in insertion order.
+ *
+ * State is expected to have a `StreamMembership membership` member. Every
+ * state must be removed from all sets before it is destroyed.
+ *
+ * IDs which have no stream state, which happens only when something is queued
+ * for a stream that is already gone, are kept in a small side vector so the
+ * container keeps set semantics for any ID.
+ */
+template <typename State, StreamSetKind Kind>
+class StreamMembershipSet {
+  using ValueTraits = detail::StreamSetValue<Kind>;
+  using Mapped = typename ValueTraits::type;
+  static constexpr bool kIsMap =
+      !std::is_same_v<Mapped, detail::NoStreamSetValue>;
+  static constexpr StreamId kNone = StreamMembership::kNone;
+  static constexpr size_t kIndex = static_cast<size_t>(Kind);
+  static constexpr uint16_t kBit = StreamMembership::bitOf(Kind);
+
+ public:
+  using Table = StreamStateTable<State>;
+  using key_type = StreamId;
+  using value_type =
+      std::conditional_t<kIsMap, std::pair<StreamId, Mapped>, StreamId>;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = StreamMembershipSet::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+
+    const_iterator() = default;
+
+    value_type operator*() const {
+      if (cur_ != kNone) {
+        if constexpr (kIsMap) {
+          return {cur_, ValueTraits::get(set_->membershipOf(cur_))};
+        } else {
+          return cur_;
+        }
+      }
+      if constexpr (kIsMap) {
+        return set_->detached_[detached_];
+      } else {
+        return set_->detached_[detached_].first;
+      }
+    }
+
+    const_iterator& operator++() {
+      if (cur_ != kNone) {
+        cur_ = set_->membershipOf(cur_).links[kIndex].next;
+      } else {
+        ++detached_;
+      }
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      auto ret = *this;
+      ++(*this);
+      return ret;
+    }
+
+    bool operator==(const const_iterator& other) const noexcept {
+      return cur_ == other.cur_ && detached_ == other.detached_;
+    }
+
+    bool operator!=(const const_iterator& other) const noexcept {
+      return !(*this == other);
+    }
+
+   private:
+    friend class StreamMembershipSet;
+
+    const_iterator(const StreamMembershipSet* set, StreamId cur, size_t idx)
+        : set_(set), cur_(cur), detached_(idx) {}
+
+    const StreamMembershipSet* set_{nullptr};
+    // Current linked stream, or kNone once past the linked ones.
+    StreamId cur_{kNone};
+    size_t detached_{0};
+  };
+
+  using iterator = const_iterator;
+
+  explicit StreamMembershipSet(Table& table) : table_(&table) {}
+
+  // Membership lives in the states of table_, so sets are bound to it.
+  StreamMembershipSet(const StreamMembershipSet&) = delete;
+  StreamMembershipSet& operator=(const StreamMembershipSet&) = delete;
+  StreamMembershipSet(StreamMembershipSet&&) = delete;
+  StreamMembershipSet& operator=(StreamMembershipSet&&) = delete;
+
+  [[nodiscard]] const_iterator begin() const noexcept {
+    return const_iterator(this, head_, 0);
+  }
+
+  [[nodiscard]] const_iterator end() const noexcept {
+    return const_iterator(this, kNone, detached_.size());
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return numLinked_ + detached_.size();
+  }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  [[nodiscard]] bool contains(StreamId id) const noexcept {
+    auto* state = table_->find(id);
+    if (state && (state->membership.bits & kBit)) {
+      return true;
+    }
+    return findDetached(id) != detached_.end();
+  }
+
+  [[nodiscard]] size_t count(StreamId id) const noexcept {
+    return contains(id) ? 1 : 0;
+  }
+
+  /**
+   * Adds id if it is not in the set yet. Returns whether it was added.
+   */
+  template <bool IsMap = kIsMap, std::enable_if_t<!IsMap, int> = 0>
+  bool insert(StreamId id) {
+    return add(id, Mapped{});
+  }
+
+  template <bool IsMap = kIsMap, std::enable_if_t<!IsMap, int> = 0>
+  bool emplace(StreamId id) {
+    return add(id, Mapped{});
+  }
+
+  /**
+   * Maps id to value if id is not in the map yet, without overwriting an
+   * existing value. Returns whether it was added.
+   */
+  template <bool IsMap = kIsMap, std::enable_if_t<IsMap, int> = 0>
+  bool emplace(StreamId id, Mapped value) {
+    return add(id, value);
+  }
+
+  size_t erase(StreamId id) noexcept {
+    auto* state = table_->find(id);
+    if (state && (state->membership.bits & kBit)) {
+      unlink(state->membership, id);
+      return 1;
+    }
+    auto it = findDetached(id);
+    if (it == detached_.end()) {
+      return 0;
+    }
+    detached_.erase(it);
+    return 1;
+  }
+
+  /**
+   * Removes the element at pos and returns the iterator following it.
+   */
+  const_iterator erase(const_iterator pos) noexcept {
+    MVDCHECK(pos.set_ == this);
+    if (pos.cur_ != kNone) {
+      auto& membership = membershipOf(pos.cur_);
+      auto next = membership.links[kIndex].next;
+      unlink(membership, pos.cur_);
+      return const_iterator(this, next, 0);
+    }
+    detached_.erase(detached_.begin() + pos.detached_);
+    return pos;
+  }
+
+  void clear() noexcept {
+    auto id = head_;
+    while (id != kNone) {
+      auto& membership = membershipOf(id);
+      id = membership.links[kIndex].next;
+      membership.links[kIndex] = StreamMembership::Link();
+      membership.bits &= ~kBit;
+    }
+    head_ = tail_ = kNone;
+    numLinked_ = 0;
+    detached_.clear();
+  }
+
+  /**
+   * Takes over the contents of other, which is bound to a table whose states
+   * have been moved into this set's table under the same stream IDs.
+   */
+  void adopt(StreamMembershipSet& other) noexcept {
+    head_ = std::exchange(other.head_, kNone);
+    tail_ = std::exchange(other.tail_, kNone);
+    numLinked_ = std::exchange(other.numLinked_, 0);
+    detached_ = std::move(other.detached_);
+    other.detached_.clear();
+  }
+
+ private:
+  using DetachedEntry = std::pair<StreamId, Mapped>;
+
+  StreamMembership& membershipOf(StreamId id) const noexcept {
+    auto* state = table_->find(id);
+    MVDCHECK(state);
+    return state->membership;
+  }
+
+  typename std::vector<DetachedEntry>::const_iterator findDetached(
+      StreamId id) const noexcept {
+    return std::find_if(
+        detached_.begin(), detached_.end(), [id](const DetachedEntry& entry) {
+          return entry.first == id;
+        });
+  }
+
+  bool add(StreamId id, Mapped value) {
+    auto* state = table_->find(id);
+    if (state && (state->membership.bits & kBit)) {
+      return false;
+    }
+    if (findDetached(id) != detached_.end()) {
+      return false;
+    }
+    if (!state) {
+      detached_.emplace_back(id, value);
+      return true;
+    }
+    auto& membership = state->membership;
+    auto& link = membership.links[kIndex];
+    link.prev = tail_;
+    link.next = kNone;
+    if (tail_ != kNone) {
+      membershipOf(tail_).links[kIndex].next = id;
+    } else {
+      head_ = id;
+    }
+    tail_ = id;
+    membership.bits |= kBit;
+    if constexpr (kIsMap) {
+      ValueTraits::get(membership) = value;
+    }
+    ++numLinked_;
+    return true;
+  }
+
+  void unlink(StreamMembership& membership, StreamId id) noexcept {
+    auto& link = membership.links[kIndex];
+    if (link.prev != kNone) {
+      membershipOf(link.prev).links[kIndex].next = link.next;
+    } else {
+      MVDCHECK_EQ(head_, id);
+      head_ = link.next;
+    }
+    if (link.next != kNone) {
+      membershipOf(link.next).links[kIndex].prev = link.prev;
+    } else {
+      MVDCHECK_EQ(tail_, id);
+      tail_ = link.prev;
+    }
+    link = StreamMembership::Link();
+    membership.bits &= ~kBit;
+    MVDCHECK_GT(numLinked_, 0);
+    --numLinked_;
+  }
+
+  Table* table_;
+  StreamId head_{kNone};
+  StreamId tail_{kNone};
+  size_t numLinked_{0};
+  std::vector<DetachedEntry> detached_;
+};
+
+} // namespace quic
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/codec/Types.h>
+#include <quic/common/CircularDeque.h>
+#include <quic/common/MvfstCheck.h>
+
+#include <array>
+#include <bit>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace quic {
+
+/**
+ * Stream state storage keyed by (stream type, stream index) instead of a hash
+ * of the stream ID.
+ *
+ * Stream IDs are allocated sequentially in four interleaved spaces, so the two
+ * low bits of an ID select the space and the remaining bits are a dense index
+ * within it. Each space keeps a window of fixed-size chunks covering the range
+ * of live indices. Lookups are two array accesses, and opening or closing a
+ * stream never rehashes.
+ *
+ * Elements live inside heap-allocated chunks which never move, so pointers and
+ * references to stored states stay valid until that state is erased. Chunks
+ * are released as soon as they become empty, so long-lived connections that
+ * open many short-lived streams only hold memory for the live window.
+ */
+template <typename T, size_t ChunkSize = 16>
+class StreamStateTable {
+  static_assert(ChunkSize > 0 && ChunkSize <= 64, "Chunk bitmap is 64 bits");
+
+ public:
+  StreamStateTable() = default;
+
+  StreamStateTable(const StreamStateTable&) = delete;
+  StreamStateTable& operator=(const StreamStateTable&) = delete;
+
+  StreamStateTable(StreamStateTable&& other) noexcept {
+    swap(other);
+  }
+
+  StreamStateTable& operator=(StreamStateTable&& other) noexcept {
+    clear();
+    swap(other);
+    return *this;
+  }
+
+  ~StreamStateTable() = default;
+
+  [[nodiscard]] size_t size() const noexcept {
+    return size_;
+  }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  /**
+   * Returns the state stored for id, or nullptr if there is none.
+   */
+  [[nodiscard]] T* find(StreamId id) noexcept {
+    auto& space = spaces_[spaceOf(id)];
+    auto chunkNum = chunkOf(id);
+    if (chunkNum < space.baseChunk ||
+        chunkNum - space.baseChunk >= space.chunks.size()) {
+      return nullptr;
+    }
+    auto& chunk = space.chunks[chunkNum - space.baseChunk];
+    if (!chunk) {
+      return nullptr;
+    }
+    auto slot = slotOf(id);
+    return chunk->occupied(slot) ? chunk->at(slot) : nullptr;
+  }
+
+  [[nodiscard]] const T* find(StreamId id) const noexcept {
+    return const_cast<StreamStateTable*>(this)->find(id);
+  }
+
+  [[nodiscard]] bool contains(StreamId id) const noexcept {
+    return find(id) != nullptr;
+  }
+
+  /**
+   * Constructs T(args...) for id if there is no state stored for it yet.
+   * Returns the stored state and whether it was inserted by this call, with
+   * the same semantics as std::unordered_map::try_emplace().
+   */
+  template <typename... Args>
+  std::pair<T*, bool> tryEmplace(StreamId id, Args&&... args) {
+    auto& chunk = getOrAllocateChunk(id);
+    auto slot = slotOf(id);
+    if (chunk.occupied(slot)) {
+      return {chunk.at(slot), false};
+    }
+    auto* state = new (&chunk.slots[slot]) T(std::forward<Args>(args)...);
+    chunk.bitmap |= (uint64_t(1) << slot);
+    ++size_;
+    return {state, true};
+  }
+
+  /**
+   * Destroys the state stored for id. Returns false if there was none.
+   */
+  bool erase(StreamId id) noexcept {
+    auto& space = spaces_[spaceOf(id)];
+    auto chunkNum = chunkOf(id);
+    if (chunkNum < space.baseChunk ||
+        chunkNum - space.baseChunk >= space.chunks.size()) {
+      return false;
+    }
+    auto& chunk = space.chunks[chunkNum - space.baseChunk];
+    auto slot = slotOf(id);
+    if (!chunk || !chunk->occupied(slot)) {
+      return false;
+    }
+    chunk->destroy(slot);
+    MVDCHECK_GT(size_, 0);
+    --size_;
+    if (chunk->bitmap == 0) {
+      releaseChunk(std::move(chunk));
+      trim(space);
+    }
+    return true;
+  }
+
+  void clear() noexcept {
+    for (auto& space : spaces_) {
+      space.chunks.clear();
+      space.baseChunk = 0;
+    }
+    size_ = 0;
+  }
+
+  /**
+   * Calls fn on every stored state. Stream spaces are visited in type order
+   * and each space in ascending stream ID order. fn must not insert into or
+   * erase from the table.
+   */
+  template <typename Fn>
+  void forEach(Fn&& fn) {
+    for (auto& space : spaces_) {
+      for (auto& chunk : space.chunks) {
+        if (!chunk) {
+          continue;
+        }
+        auto bitmap = chunk->bitmap;
+        while (bitmap) {
+          auto slot = static_cast<size_t>(std::countr_zero(bitmap));
+          bitmap &= bitmap - 1;
+          fn(*chunk->at(slot));
+        }
+      }
+    }
+  }
+
+  void swap(StreamStateTable& other) noexcept {
+    using std::swap;
+    for (size_t i = 0; i < spaces_.size(); ++i) {
+      swap(spaces_[i].baseChunk, other.spaces_[i].baseChunk);
+      spaces_[i].chunks.swap(other.spaces_[i].chunks);
+    }
+    swap(freeChunk_, other.freeChunk_);
+    swap(size_, other.size_);
+  }
+
+ private:
+  struct Chunk {
+    Chunk() = default;
+    Chunk(const Chunk&) = delete;
+    Chunk& operator=(const Chunk&) = delete;
+
+    ~Chunk() {
+      while (bitmap) {
+        destroy(static_cast<size_t>(std::countr_zero(bitmap)));
+      }
+    }
+
+    [[nodiscard]] bool occupied(size_t slot) const noexcept {
+      return bitmap & (uint64_t(1) << slot);
+    }
+
+    T* at(size_t slot) noexcept {
+      return std::launder(reinterpret_cast<T*>(&slots[slot]));
+    }
+
+    void destroy(size_t slot) noexcept {
+      at(slot)->~T();
+      bitmap &= ~(uint64_t(1) << slot);
+    }
+
+    struct alignas(T) Slot {
+      unsigned char bytes[sizeof(T)];
+    };
+    std::array<Slot, ChunkSize> slots;
+    uint64_t bitmap{0};
+  };
+
+  struct Space {
+    // Chunk number of chunks.front().
+    uint64_t baseChunk{0};
+    // Null entries are holes in the window with no live state.
+    CircularDeque<std::unique_ptr<Chunk>> chunks;
+  };
+
+  static size_t spaceOf(StreamId id) noexcept {
+    return id & 0x3;
+  }
+
+  static uint64_t indexOf(StreamId id) noexcept {
+    return id >> 2;
+  }
+
+  static uint64_t chunkOf(StreamId id) noexcept {
+    return indexOf(id) / ChunkSize;
+  }
+
+  static size_t slotOf(StreamId id) noexcept {
+    return indexOf(id) % ChunkSize;
+  }
+
+  Chunk& getOrAllocateChunk(StreamId id) {
+    auto& space = spaces_[spaceOf(id)];
+    auto chunkNum = chunkOf(id);
+    if (space.chunks.empty()) {
+      space.baseChunk = chunkNum;
+      space.chunks.emplace_back();
+    } else if (chunkNum < space.baseChunk) {
+      // A stream below the window, e.g. one that was opened implicitly and
+      // is only now getting state. Grow the window downwards.
+      while (space.baseChunk > chunkNum) {
+        space.chunks.emplace_front();
+        --space.baseChunk;
+      }
+    } else {
+      while (chunkNum - space.baseChunk >= space.chunks.size()) {
+        space.chunks.emplace_back();
+      }
+    }
+    auto& chunk = space.chunks[chunkNum - space.baseChunk];
+    if (!chunk) {
+      chunk = freeChunk_ ? std::move(freeChunk_) : std::make_unique<Chunk>();
+    }
+    return *chunk;
+  }
+
+  void releaseChunk(std::unique_ptr<Chunk> chunk) noexcept {
+    // Keep one empty chunk around so that a connection which keeps opening
+    // and closing a single stream does not allocate every time.
+    if (!freeChunk_) {
+      freeChunk_ = std::move(chunk);
+    }
+  }
+
+  static void trim(Space& space) noexcept {
+    while (!space.chunks.empty() && !space.chunks.front()) {
+      space.chunks.pop_front();
+      ++space.baseChunk;
+    }
+    while (!space.chunks.empty() && !space.chunks.back()) {
+      space.chunks.pop_back();
+    }
+  }
+
+  std::array<Space, 4> spaces_;
+  std::unique_ptr<Chunk> freeChunk_;
+  size_t size_{0};
+};
+
+} // namespace quic
@@ -152,6 +152,21 @@ struct DatagramConfig {
   uint8_t defaultDatagramPriority{0};
 };
 
+// Datagram packetization layer path MTU discovery (RFC 8899). Once the
+// handshake is confirmed, PING+PADDING probes search for the largest packet
+// size the path carries and udpSendPacketLen is raised to it.
+struct PmtuDiscoveryConfig {
+  bool enabled{false};
+  // Upper bound of the search. The peer's max_udp_payload_size caps it further.
+  uint64_t maxPacketSize{kDefaultMaxUDPPayload};
+  // Lost probes of one size before the search gives up on that size.
+  uint8_t maxProbes{kDefaultPmtuMaxProbes};
+  // The search completes once the remaining interval is smaller than this.
+  uint64_t searchGranularity{kDefaultPmtuSearchGranularity};
+  // How long after a completed search to probe for a larger size again.
+  std::chrono::seconds raiseTimer{kDefaultPmtuRaiseTimer};
+};
+
 struct AckReceiveTimestampsConfig {
   uint64_t maxReceiveTimestampsPerAck{kMaxReceivedPktsTimestampsStored};
   uint64_t receiveTimestampsExponent{kDefaultReceiveTimestampsExponent};
@@ -273,6 +288,13 @@ struct TransportSettings {
   // than kDefaultPacingTickInterval.
   std::chrono::microseconds pacingTimerResolution{
       kDefaultPacingTimerResolution};
+  // How paced packets are held back. EarliestDepartureTime needs a GSO
+  // batching mode and sockets with SO_TXTIME enabled, which only the server
+  // worker sets up; otherwise the timer is used.
+  PacingMode pacingMode{PacingMode::Timer};
+  // With EarliestDepartureTime, how far ahead of now departures may be
+  // scheduled. The transport writes again once half of it has drained.
+  std::chrono::microseconds edtPacingHorizon{kDefaultEdtPacingHorizon};
   ZeroRttSourceTokenMatchingPolicy zeroRttSourceTokenMatchingPolicy{
       ZeroRttSourceTokenMatchingPolicy::REJECT_IF_NO_EXACT_MATCH};
   // Scale pacing rate for CC, non-empty indicates override via transport knobs
@@ -340,6 +362,14 @@ struct TransportSettings {
   uint16_t maxRecvBatchSize{5};
   // Whether to use new receive path for recvmmsg.
   bool shouldUseWrapperRecvmmsgForBatchRecv{false};
+  // Whether server workers do the I/O of the wrapper receive path and of
+  // worker level egress batching through io_uring instead of recvmmsg and
+  // sendmmsg. Falls back to the regular sockets where io_uring is missing.
+  bool useIoUringSocket{false};
+  // Number of client chosen destination connection ids whose Initial keys a
+  // server worker keeps, so that connections starting with the same one
+  // don't derive them again. 0 disables the cache.
+  uint32_t initialCipherCacheSize{0};
   // Whether or not use recvmmsg.
   bool shouldUseRecvmmsgForBatchRecv{false};
   // Config struct for congestion controllers
@@ -361,6 +391,9 @@ struct TransportSettings {
   std::vector<SerializedKnob> knobs;
   // Datagram config
   DatagramConfig datagramConfig;
+  // Path MTU discovery config. Only supported with
+  // DataPathType::ChainedMemory.
+  PmtuDiscoveryConfig pmtuDiscoveryConfig;
   // Whether or not to opportunistically retransmit 0RTT when the handshake
   // completes.
   bool earlyRetransmit0Rtt{false};
@@ -19,6 +19,7 @@
 #include <quic/server/state/ServerStateMachine.h>
 #include <quic/state/AckHandlers.h>
 #include <quic/state/OutstandingPacket.h>
+#include <quic/state/PmtuDiscoveryFunctions.h>
 #include <quic/state/StateData.h>
 #include <quic/state/stream/StreamSendHandlers.h>
 #include <quic/state/test/AckEventTestUtil.h>
@@ -718,8 +719,8 @@ TEST_P(AckHandlersTest, TestPacketDestructionBigDeque) {
           Clock::now())
           .hasError());
 
-  // Shrink the deque to the remaining packets.
-  conn.outstandings.packets.shrink_to_fit();
+  // Shrink the container to the remaining packets.
+  conn.outstandings.packets.resize(conn.outstandings.packets.size());
 
   ReadAckFrame ackFrame1;
   ackFrame1.largestAcked = 1;
@@ -7932,4 +7933,103 @@ TEST(Draft02AckProcessing, RejectsTimestampUnderflow) {
   EXPECT_EQ(res.error().code, TransportErrorCode::FRAME_ENCODING_ERROR);
 }
 
+namespace {
+// Sends a path MTU probe with the given packet number and returns its size.
+uint64_t sendPmtuProbe(QuicServerConnectionState& conn, PacketNum packetNum) {
+  conn.udpSendPacketLen = 1200;
+  conn.transportSettings.pmtuDiscoveryConfig.enabled = true;
+  conn.transportSettings.pmtuDiscoveryConfig.maxPacketSize = 1500;
+  maybeInitPmtuDiscovery(conn, kMaxUDPPayload);
+  startPmtuDiscovery(conn, Clock::now());
+  auto probeSize = nextPmtuProbeSize(conn, Clock::now());
+  conn.outstandings.packets.emplace_back(
+      createNewPacket(packetNum, PacketNumberSpace::AppData),
+      Clock::now() - 1ms,
+      0,
+      static_cast<uint16_t>(probeSize),
+      0,
+      probeSize,
+      0,
+      LossState(),
+      0,
+      OutstandingPacketMetadata::DetailsPerStream());
+  conn.outstandings.packets.back().isPmtuProbe = true;
+  conn.outstandings.packetCount[PacketNumberSpace::AppData]++;
+  conn.lossState.inflightBytes += probeSize;
+  getAckState(conn, PacketNumberSpace::AppData).nextPacketNum = packetNum + 1;
+  onPmtuProbeSent(conn, packetNum);
+  return probeSize;
+}
+
+quic::Expected<AckEvent, QuicError> ackPacket(
+    QuicServerConnectionState& conn,
+    PacketNum packetNum) {
+  ReadAckFrame ackFrame;
+  ackFrame.largestAcked = packetNum;
+  ackFrame.ackBlocks.emplace_back(packetNum, packetNum);
+  return processAckFrame(
+      conn,
+      PacketNumberSpace::AppData,
+      ackFrame,
+      [](auto&) -> quic::Expected<void, quic::QuicError> { return {}; },
+      [](const auto&, const auto&) -> quic::Expected<void, quic::QuicError> {
+        return {};
+      },
+      [](auto&, auto, auto&, bool) -> quic::Expected<void, quic::QuicError> {
+        return {};
+      },
+      Clock::now());
+}
+} // namespace
+
+TEST(AckHandlersPmtuProbeTest, AckedProbeRaisesPacketSize) {
+  QuicServerConnectionState conn(
+      FizzServerQuicHandshakeContext::Builder().build());
+  auto mockCongestionController = std::make_unique<MockCongestionController>();
+  auto* rawCongestionController = mockCongestionController.get();
+  conn.congestionController = std::move(mockCongestionController);
+
+  constexpr PacketNum kPacketNum = 7;
+  auto probeSize = sendPmtuProbe(conn, kPacketNum);
+  EXPECT_CALL(*rawCongestionController, onPacketAckOrLoss(_, IsNull()))
+      .WillOnce([&](const AckEvent* ack, const LossEvent*) {
+        ASSERT_NE(nullptr, ack);
+        EXPECT_EQ(probeSize, ack->ackedBytes);
+      });
+  auto result = ackPacket(conn, kPacketNum);
+
+  ASSERT_FALSE(result.hasError());
+  EXPECT_EQ(probeSize, conn.udpSendPacketLen);
+  EXPECT_FALSE(conn.pmtuDiscovery->outstandingProbe.has_value());
+  EXPECT_EQ(0, conn.lossState.inflightBytes);
+}
+
+TEST(AckHandlersPmtuProbeTest, LateAckedProbeIsNotSpuriousLoss) {
+  QuicServerConnectionState conn(
+      FizzServerQuicHandshakeContext::Builder().build());
+  auto mockCongestionController = std::make_unique<MockCongestionController>();
+  auto* rawCongestionController = mockCongestionController.get();
+  conn.congestionController = std::move(mockCongestionController);
+
+  constexpr PacketNum kPacketNum = 7;
+  sendPmtuProbe(conn, kPacketNum);
+  // What loss detection does to a lost probe.
+  conn.outstandings.packets.back().declaredLost = true;
+  conn.outstandings.declaredLostCount = 1;
+  conn.outstandings.packetCount[PacketNumberSpace::AppData]--;
+  conn.lossState.inflightBytes = 0;
+  onPmtuProbeLost(conn, kPacketNum, Clock::now());
+
+  // The probe's loss never reached the congestion controller, so neither
+  // does its late ack.
+  EXPECT_CALL(*rawCongestionController, onPacketAckOrLoss(_, _)).Times(0);
+  auto result = ackPacket(conn, kPacketNum);
+
+  ASSERT_FALSE(result.hasError());
+  EXPECT_EQ(0, result.value().numPacketsSpuriouslyAcked);
+  EXPECT_EQ(0, conn.outstandings.declaredLostCount);
+  // Only the ack of the outstanding probe raises the packet size.
+  EXPECT_EQ(1200, conn.udpSendPacketLen);
+}
+
 } // namespace quic::test
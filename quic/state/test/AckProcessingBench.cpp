@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/state/QuicStateFunctions.h>
+#include <quic/state/StateData.h>
+#include <algorithm>
+#include <deque>
+
+using namespace quic;
+using namespace quic::test;
+
+namespace {
+constexpr size_t kNumOutstanding = 20000;
+constexpr uint16_t kPacketSize = 1200;
+
+/**
+ * Builds an ACK frame for [1, largestAcked]. With gapEvery set, every
+ * gapEvery-th packet is left unacked to emulate heavy reordering.
+ */
+ReadAckFrame makeAckFrame(PacketNum largestAcked, PacketNum gapEvery) {
+  ReadAckFrame frame;
+  frame.largestAcked = largestAcked;
+  if (!gapEvery) {
+    frame.ackBlocks.emplace_back(1, largestAcked);
+    return frame;
+  }
+  PacketNum end = largestAcked;
+  while (end > gapEvery) {
+    frame.ackBlocks.emplace_back(end - gapEvery + 2, end);
+    end -= gapEvery;
+  }
+  return frame;
+}
+
+template <typename Container>
+void fillOutstandings(Container& packets) {
+  for (PacketNum packetNum = 1; packetNum <= kNumOutstanding; packetNum++) {
+    packets.push_back(makeTestingWritePacket(
+        packetNum, kPacketSize, packetNum * kPacketSize));
+  }
+}
+
+template <typename ReverseIterator>
+ReverseIterator lowerBoundAtOrBelow(
+    ReverseIterator from,
+    ReverseIterator rend,
+    PacketNum packetNum) {
+  return std::lower_bound(
+      from, rend, packetNum, [](const auto& op, PacketNum val) {
+        return op.getPacketSequenceNum() > val;
+      });
+}
+
+/**
+ * The erase loop AckedPacketIterator runs: find each ACK block from the back,
+ * then erase the acked range. Every variant runs this same loop and only the
+ * container and the block lookup differ.
+ */
+template <typename Container, typename Lookup>
+void eraseAcked(
+    Container& packets,
+    const ReadAckFrame& frame,
+    const Lookup& lookup) {
+  auto iter = packets.rbegin();
+  for (const auto& block : frame.ackBlocks) {
+    iter = lookup(iter, block.endPacket);
+    auto eraseEnd = iter;
+    while (iter != packets.rend() &&
+           iter->getPacketSequenceNum() >= block.startPacket) {
+      iter++;
+    }
+    auto next = packets.erase(iter.base(), eraseEnd.base());
+    iter = std::reverse_iterator<decltype(next)>(next);
+  }
+}
+
+// The layout before: std::deque with a binary search per ACK block.
+void runDequeAck(size_t iters, PacketNum gapEvery) {
+  folly::BenchmarkSuspender suspender;
+  auto frame = makeAckFrame(kNumOutstanding - 1, gapEvery);
+  while (iters--) {
+    std::deque<OutstandingPacketWrapper> packets;
+    fillOutstandings(packets);
+    suspender.dismiss();
+    eraseAcked(packets, frame, [&](auto from, PacketNum packetNum) {
+      return lowerBoundAtOrBelow(from, packets.rend(), packetNum);
+    });
+    folly::doNotOptimizeAway(packets.size());
+    suspender.rehire();
+  }
+}
+
+// The ring, with either the same binary search or the packet number indexed
+// lookup, so the container and the lookup can be told apart.
+void runRingAck(size_t iters, PacketNum gapEvery, bool indexedLookup) {
+  folly::BenchmarkSuspender suspender;
+  auto frame = makeAckFrame(kNumOutstanding - 1, gapEvery);
+  while (iters--) {
+    QuicConnectionStateBase conn(QuicNodeType::Client);
+    auto& packets = conn.outstandings.packets;
+    fillOutstandings(packets);
+    suspender.dismiss();
+    if (indexedLookup) {
+      eraseAcked(packets, frame, [&](auto from, PacketNum packetNum) {
+        return findOutstandingPacketAtOrBelow(conn, from, packetNum);
+      });
+    } else {
+      eraseAcked(packets, frame, [&](auto from, PacketNum packetNum) {
+        return lowerBoundAtOrBelow(from, packets.rend(), packetNum);
+      });
+    }
+    folly::doNotOptimizeAway(packets.size());
+    suspender.rehire();
+  }
+}
+} // namespace
+
+BENCHMARK(deque_ack_contiguous, iters) {
+  runDequeAck(iters, 0);
+}
+
+BENCHMARK_RELATIVE(ring_ack_contiguous, iters) {
+  runRingAck(iters, 0, false);
+}
+
+BENCHMARK_RELATIVE(ring_indexed_ack_contiguous, iters) {
+  runRingAck(iters, 0, true);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(deque_ack_reordered, iters) {
+  runDequeAck(iters, 10);
+}
+
+BENCHMARK_RELATIVE(ring_ack_reordered, iters) {
+  runRingAck(iters, 10, false);
+}
+
+BENCHMARK_RELATIVE(ring_indexed_ack_reordered, iters) {
+  runRingAck(iters, 10, true);
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
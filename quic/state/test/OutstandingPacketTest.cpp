@@ -43,7 +43,7 @@ TEST(OutstandingPacketTest, BasicPacketDestructionCallback) {
   // Mock packet processor to test packet callbacks.
   auto mockPacketProcessor = std::make_unique<MockPacketProcessor>();
   auto rawPacketProcessor = mockPacketProcessor.get();
-  std::deque<OutstandingPacketWrapper> packets;
+  OutstandingPacketContainer packets;
 
   StreamId currentStreamId = 10;
   auto sentTime = Clock::now();
@@ -91,7 +91,7 @@ TEST(OutstandingPacketTest, BasicPacketDestructionDequeDestroy) {
   auto rawPacketProcessor = mockPacketProcessor.get();
 
   {
-    std::deque<OutstandingPacketWrapper> packets;
+    OutstandingPacketContainer packets;
 
     StreamId currentStreamId = 10;
     auto sentTime = Clock::now();
@@ -134,7 +134,7 @@ TEST(OutstandingPacketTest, BasicPacketDestructionDequeDestroy) {
 
 TEST(OutstandingPacketTest, BasicPacketDestructionNoCallback) {
   {
-    std::deque<OutstandingPacketWrapper> packets;
+    OutstandingPacketContainer packets;
     StreamId currentStreamId = 10;
     auto sentTime = Clock::now();
 
@@ -319,7 +319,7 @@ TEST(OutstandingPacketTest, DequeMoveAssignPacketDestructionCallback) {
   DestroyCallbackWithCounter callbackContext{
       rawPacketProcessor, &numDestroyCallbacks};
   {
-    std::deque<OutstandingPacketWrapper> packets;
+    OutstandingPacketContainer packets;
     StreamId currentStreamId = 10;
     auto sentTime = Clock::now();
 
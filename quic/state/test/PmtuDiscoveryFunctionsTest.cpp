@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/state/PmtuDiscoveryFunctions.h>
+
+#include <folly/portability/GTest.h>
+
+using namespace testing;
+
+namespace quic::test {
+
+using Phase = QuicConnectionStateBase::PmtuDiscoveryState::Phase;
+
+class PmtuDiscoveryFunctionsTest : public Test {
+ public:
+  void SetUp() override {
+    conn_.udpSendPacketLen = 1200;
+    conn_.transportSettings.pmtuDiscoveryConfig.enabled = true;
+    conn_.transportSettings.pmtuDiscoveryConfig.maxPacketSize = 1500;
+  }
+
+ protected:
+  // Sends the next probe and returns its size.
+  uint64_t sendProbe() {
+    EXPECT_TRUE(shouldSendPmtuProbe(conn_, now_));
+    auto size = nextPmtuProbeSize(conn_, now_);
+    onPmtuProbeSent(conn_, nextPacketNum_++);
+    EXPECT_FALSE(shouldSendPmtuProbe(conn_, now_));
+    return size;
+  }
+
+  void loseProbe() {
+    onPmtuProbeLost(conn_, nextPacketNum_ - 1, now_);
+  }
+
+  void ackProbe() {
+    onPmtuProbeAcked(conn_, nextPacketNum_ - 1, now_);
+  }
+
+  QuicConnectionStateBase conn_{QuicNodeType::Client};
+  TimePoint now_{Clock::now()};
+  PacketNum nextPacketNum_{1};
+};
+
+TEST_F(PmtuDiscoveryFunctionsTest, Disabled) {
+  conn_.transportSettings.pmtuDiscoveryConfig.enabled = false;
+  maybeInitPmtuDiscovery(conn_, kMaxUDPPayload);
+  EXPECT_FALSE(conn_.pmtuDiscovery.has_value());
+}
+
+TEST_F(PmtuDiscoveryFunctionsTest, ContinuousMemoryUnsupported) {
+  conn_.transportSettings.dataPathType = DataPathType::ContinuousMemory;
+  maybeInitPmtuDiscovery(conn_, kMaxUDPPayload);
+  EXPECT_FALSE(conn_.pmtuDiscovery.has_value());
+}
+
+TEST_F(PmtuDiscoveryFunctionsTest, PeerLimitLeavesNoRoom) {
+  maybeInitPmtuDiscovery(conn_, 1200);
+  EXPECT_FALSE(conn_.pmtuDiscovery.has_value());
+}
+
+TEST_F(PmtuDiscoveryFunctionsTest, CeilingIsSmallestLimit) {
+  maybeInitPmtuDiscovery(conn_, 1400);
+  ASSERT_TRUE(conn_.pmtuDiscovery.has_value());
+  EXPECT_EQ(conn_.pmtuDiscovery->maxPacketSize, 1400);
+}
+
+TEST_F(PmtuDiscoveryFunctionsTest, NoProbesBeforeStart) {
+  maybeInitPmtuDiscovery(conn_, kMaxUDPPayload);
+  ASSERT_TRUE(conn_.pmtuDiscovery.has_value());
+  EXPECT_FALSE(shouldSendPmtuProbe(conn_, now_));
+}
+
+TEST_F(PmtuDiscoveryFunctionsTest, CeilingProbedFirst) {
+  maybeInitPmtuDiscovery(conn_, kMaxUDPPayload);
+  startPmtuDiscovery(conn_, now_);
+  EXPECT_EQ(sendProbe(), 1500);
+  ackProbe();
+  EXPECT_EQ(conn_.udpSendPacketLen, 1500);
+  EXPECT_EQ(conn_.pmtuDiscovery->phase, Phase::SearchComplete);
+  EXPECT_FALSE(shouldSendPmtuProbe(conn_, now_));
+}
+
+TEST_F(PmtuDiscoveryFunctionsTest, BisectsAfterRepeatedLoss) {
+  conn_.transportSettings.pmtuDiscoveryConfig.maxProbes = 2;
+  maybeInitPmtuDiscovery(conn_, kMaxUDPPayload);
+  startPmtuDiscovery(conn_, now_);
+
+  EXPECT_EQ(sendProbe(), 1500);
+  loseProbe();
+  // A single loss retries the same size.
+  EXPECT_EQ(sendProbe(), 1500);
+  loseProbe();
+  EXPECT_EQ(conn_.udpSendPacketLen, 1200);
+
+  EXPECT_EQ(sendProbe(), 1350);
+  ackProbe();
+  EXPECT_EQ(conn_.udpSendPacketLen, 1350);
+
+  EXPECT_EQ(sendProbe(), 1425);
+  loseProbe();
+  EXPECT_EQ(sendProbe(), 1425);
+  loseProbe();
+
+  EXPECT_EQ(sendProbe(), 1387);
+  ackProbe();
+  EXPECT_EQ(sendProbe(), 1406);
+  ackProbe();
+
+  // [1406, 1424] is narrower than the default granularity.
+  EXPECT_EQ(conn_.pmtuDiscovery->phase, Phase::SearchComplete);
+  EXPECT_EQ(conn_.udpSendPacketLen, 1406);
+  EXPECT_FALSE(shouldSendPmtuProbe(conn_, now_));
+}
+
+TEST_F(PmtuDiscoveryFunctionsTest, StaleProbeIgnored) {
+  maybeInitPmtuDiscovery(conn_, kMaxUDPPayload);
+  startPmtuDiscovery(conn_, now_);
+  sendProbe();
+  onPmtuProbeAcked(conn_, nextPacketNum_ + 10, now_);
+  onPmtuProbeLost(conn_, nextPacketNum_ + 10, now_);
+  EXPECT_EQ(conn_.udpSendPacketLen, 1200);
+  EXPECT_EQ(conn_.pmtuDiscovery->probesLost, 0);
+  EXPECT_FALSE(shouldSendPmtuProbe(conn_, now_));
+}
+
+TEST_F(PmtuDiscoveryFunctionsTest, RaiseTimerRestartsSearch) {
+  conn_.transportSettings.pmtuDiscoveryConfig.maxProbes = 1;
+  maybeInitPmtuDiscovery(conn_, kMaxUDPPayload);
+  startPmtuDiscovery(conn_, now_);
+  while (conn_.pmtuDiscovery->phase == Phase::Searching) {
+    sendProbe();
+    loseProbe();
+  }
+  EXPECT_EQ(conn_.udpSendPacketLen, 1200);
+  EXPECT_FALSE(shouldSendPmtuProbe(conn_, now_));
+
+  now_ += conn_.transportSettings.pmtuDiscoveryConfig.raiseTimer;
+  EXPECT_EQ(sendProbe(), 1500);
+  EXPECT_EQ(conn_.pmtuDiscovery->phase, Phase::Searching);
+  ackProbe();
+  EXPECT_EQ(conn_.udpSendPacketLen, 1500);
+}
+
+TEST_F(PmtuDiscoveryFunctionsTest, BlackHoleFallsBack) {
+  maybeInitPmtuDiscovery(conn_, kMaxUDPPayload);
+  startPmtuDiscovery(conn_, now_);
+  sendProbe();
+  ackProbe();
+  ASSERT_EQ(conn_.udpSendPacketLen, 1500);
+
+  onPmtuBlackHoleSuspected(conn_, now_);
+  EXPECT_EQ(conn_.udpSendPacketLen, 1200);
+  EXPECT_EQ(conn_.pmtuDiscovery->searchHigh, 1499);
+  EXPECT_EQ(sendProbe(), 1350);
+
+  // Already at the base size, nothing more to fall back from.
+  onPmtuBlackHoleSuspected(conn_, now_);
+  EXPECT_EQ(conn_.udpSendPacketLen, 1200);
+}
+
+} // namespace quic::test
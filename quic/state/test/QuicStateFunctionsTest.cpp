@@ -1445,6 +1445,118 @@ TEST_P(QuicStateFunctionsTest, CloseTranportStateChange) {
   EXPECT_TRUE(conn.pendingEvents.closeTransport);
 }
 
+void addOutstandingPackets(
+    QuicConnectionStateBase& conn,
+    const std::vector<PacketNum>& packetNums) {
+  for (auto packetNum : packetNums) {
+    conn.outstandings.packets.push_back(
+        makeTestingWritePacket(packetNum, 100, 0));
+  }
+}
+
+TEST_F(QuicStateFunctionsTest, FindOutstandingPacketAtOrBelowEmpty) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  auto& packets = conn.outstandings.packets;
+  EXPECT_EQ(
+      findOutstandingPacketAtOrBelow(conn, packets.rbegin(), 10),
+      packets.rend());
+}
+
+TEST_F(QuicStateFunctionsTest, FindOutstandingPacketAtOrBelowAllAbove) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  addOutstandingPackets(conn, {10, 11, 12, 13, 14});
+  auto& packets = conn.outstandings.packets;
+  EXPECT_EQ(
+      findOutstandingPacketAtOrBelow(conn, packets.rbegin(), 9),
+      packets.rend());
+  EXPECT_EQ(
+      findOutstandingPacketAtOrBelow(conn, packets.rbegin() + 2, 0),
+      packets.rend());
+}
+
+TEST_F(QuicStateFunctionsTest, FindOutstandingPacketAtOrBelowAllBelow) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  addOutstandingPackets(conn, {10, 11, 12, 13, 14});
+  auto& packets = conn.outstandings.packets;
+  EXPECT_EQ(
+      findOutstandingPacketAtOrBelow(conn, packets.rbegin(), 100),
+      packets.rbegin());
+  // The search never moves towards newer packets than from.
+  auto from = packets.rbegin() + 3;
+  EXPECT_EQ(findOutstandingPacketAtOrBelow(conn, from, 14), from);
+}
+
+TEST_F(QuicStateFunctionsTest, FindOutstandingPacketAtOrBelowExactMatch) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  addOutstandingPackets(conn, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  auto& packets = conn.outstandings.packets;
+  for (size_t fromOffset = 0; fromOffset < packets.size(); fromOffset++) {
+    auto from = packets.rbegin() + fromOffset;
+    for (PacketNum packetNum = 0; packetNum <= from->getPacketSequenceNum();
+         packetNum++) {
+      auto iter = findOutstandingPacketAtOrBelow(conn, from, packetNum);
+      ASSERT_NE(iter, packets.rend());
+      EXPECT_EQ(iter->getPacketSequenceNum(), packetNum);
+    }
+  }
+}
+
+TEST_F(QuicStateFunctionsTest, FindOutstandingPacketAtOrBelowWithGaps) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  // The packet number delta overshoots or undershoots the index here, so the
+  // lookup has to fall back to the binary search on both sides.
+  addOutstandingPackets(conn, {1, 2, 5, 6, 7, 20, 21, 22, 23, 24});
+  auto& packets = conn.outstandings.packets;
+  auto expectFound = [&](size_t fromOffset,
+                         PacketNum packetNum,
+                         PacketNum expected) {
+    auto iter = findOutstandingPacketAtOrBelow(
+        conn, packets.rbegin() + fromOffset, packetNum);
+    ASSERT_NE(iter, packets.rend());
+    EXPECT_EQ(iter->getPacketSequenceNum(), expected) << packetNum;
+  };
+  expectFound(0, 22, 22);
+  expectFound(0, 19, 7);
+  expectFound(0, 7, 7);
+  expectFound(0, 4, 2);
+  expectFound(0, 1, 1);
+  // From 7 the delta to 3 lands on 1, past the answer.
+  expectFound(5, 3, 2);
+  expectFound(5, 5, 5);
+  EXPECT_EQ(
+      findOutstandingPacketAtOrBelow(conn, packets.rbegin(), 0),
+      packets.rend());
+}
+
+TEST_F(QuicStateFunctionsTest, FindOutstandingPacketAtOrBelowLostInterleaved) {
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  addOutstandingPackets(conn, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  auto& packets = conn.outstandings.packets;
+  // Lost and acked packets stay in the list until they are reaped, and the
+  // lookup is purely positional, so they are still found.
+  for (auto index : {2, 3, 7}) {
+    packets[index].declaredLost = true;
+    conn.outstandings.declaredLostCount++;
+  }
+  packets[5].metadata.scheduledForDestruction = true;
+  conn.outstandings.scheduledForDestructionCount++;
+  for (PacketNum packetNum = 0; packetNum < 10; packetNum++) {
+    auto iter =
+        findOutstandingPacketAtOrBelow(conn, packets.rbegin(), packetNum);
+    ASSERT_NE(iter, packets.rend());
+    EXPECT_EQ(iter->getPacketSequenceNum(), packetNum);
+  }
+  // Reaping the lost packets leaves gaps, which the lookup steps over.
+  packets.erase(packets.begin() + 7);
+  packets.erase(packets.begin() + 2, packets.begin() + 4);
+  auto iter = findOutstandingPacketAtOrBelow(conn, packets.rbegin(), 7);
+  ASSERT_NE(iter, packets.rend());
+  EXPECT_EQ(iter->getPacketSequenceNum(), 6);
+  iter = findOutstandingPacketAtOrBelow(conn, packets.rbegin(), 3);
+  ASSERT_NE(iter, packets.rend());
+  EXPECT_EQ(iter->getPacketSequenceNum(), 1);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     QuicStateFunctionsTests,
     QuicStateFunctionsTest,
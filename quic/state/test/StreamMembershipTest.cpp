@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <quic/state/StreamMembership.h>
+
+using namespace quic;
+using namespace testing;
+
+namespace quic::test {
+
+namespace {
+
+struct TestState {
+  explicit TestState(StreamId idIn) : id(idIn) {}
+
+  StreamId id;
+  StreamMembership membership;
+};
+
+using Table = StreamStateTable<TestState>;
+using ReadableSet = StreamMembershipSet<TestState, StreamSetKind::Readable>;
+using TxSet = StreamMembershipSet<TestState, StreamSetKind::Tx>;
+using BlockedMap = StreamMembershipSet<TestState, StreamSetKind::Blocked>;
+
+} // namespace
+
+TEST(StreamMembershipTest, InsertEraseContains) {
+  Table table;
+  ReadableSet readable(table);
+  TxSet tx(table);
+  for (StreamId id = 0; id < 16; id += 4) {
+    table.tryEmplace(id, id);
+  }
+
+  EXPECT_TRUE(readable.insert(4));
+  EXPECT_FALSE(readable.insert(4));
+  EXPECT_TRUE(readable.emplace(8));
+  EXPECT_TRUE(tx.insert(4));
+  EXPECT_EQ(readable.size(), 2);
+  EXPECT_TRUE(readable.contains(4));
+  EXPECT_EQ(readable.count(8), 1);
+  EXPECT_FALSE(readable.contains(0));
+  EXPECT_TRUE(table.find(4)->membership.in(StreamSetKind::Readable));
+  EXPECT_TRUE(table.find(4)->membership.in(StreamSetKind::Tx));
+
+  EXPECT_EQ(readable.erase(4), 1);
+  EXPECT_EQ(readable.erase(4), 0);
+  EXPECT_FALSE(readable.contains(4));
+  // Membership in one set is independent of the others.
+  EXPECT_TRUE(tx.contains(4));
+  EXPECT_FALSE(table.find(4)->membership.in(StreamSetKind::Readable));
+}
+
+TEST(StreamMembershipTest, IterationOrderAndErase) {
+  Table table;
+  ReadableSet readable(table);
+  for (StreamId id = 0; id < 40; id += 4) {
+    table.tryEmplace(id, id);
+  }
+  std::vector<StreamId> order = {12, 0, 36, 4, 20};
+  for (auto id : order) {
+    readable.insert(id);
+  }
+  EXPECT_THAT(std::vector<StreamId>(readable.begin(), readable.end()), order);
+
+  // Erasing through the iterator returns the following element.
+  auto it = readable.begin();
+  ++it;
+  it = readable.erase(it);
+  EXPECT_EQ(*it, 36);
+  EXPECT_THAT(
+      std::vector<StreamId>(readable.begin(), readable.end()),
+      ElementsAre(12, 36, 4, 20));
+
+  readable.clear();
+  EXPECT_TRUE(readable.empty());
+  EXPECT_EQ(readable.begin(), readable.end());
+  for (auto id : order) {
+    EXPECT_FALSE(table.find(id)->membership.in(StreamSetKind::Readable));
+  }
+  EXPECT_TRUE(readable.insert(0));
+}
+
+TEST(StreamMembershipTest, MapKeepsFirstValue) {
+  Table table;
+  BlockedMap blocked(table);
+  table.tryEmplace(4, 4);
+  table.tryEmplace(8, 8);
+
+  EXPECT_TRUE(blocked.emplace(4, 100));
+  EXPECT_FALSE(blocked.emplace(4, 200));
+  EXPECT_TRUE(blocked.emplace(8, 300));
+  std::vector<std::pair<StreamId, uint64_t>> entries(
+      blocked.begin(), blocked.end());
+  EXPECT_THAT(entries, ElementsAre(Pair(4, 100), Pair(8, 300)));
+}
+
+TEST(StreamMembershipTest, StreamWithoutState) {
+  Table table;
+  ReadableSet readable(table);
+  BlockedMap blocked(table);
+  table.tryEmplace(0, 0);
+
+  EXPECT_TRUE(readable.insert(0));
+  EXPECT_TRUE(readable.insert(100));
+  EXPECT_FALSE(readable.insert(100));
+  EXPECT_TRUE(blocked.emplace(100, 7));
+  EXPECT_EQ(readable.size(), 2);
+  EXPECT_TRUE(readable.contains(100));
+  EXPECT_THAT(
+      std::vector<StreamId>(readable.begin(), readable.end()),
+      ElementsAre(0, 100));
+  EXPECT_EQ((*blocked.begin()).second, 7);
+
+  // The state showing up later does not duplicate the entry.
+  table.tryEmplace(100, 100);
+  EXPECT_FALSE(readable.insert(100));
+  EXPECT_EQ(readable.size(), 2);
+  EXPECT_EQ(readable.erase(100), 1);
+  EXPECT_FALSE(readable.contains(100));
+  EXPECT_EQ(readable.size(), 1);
+}
+
+TEST(StreamMembershipTest, AdoptAfterMigration) {
+  Table table;
+  ReadableSet readable(table);
+  for (StreamId id = 0; id < 12; id += 4) {
+    table.tryEmplace(id, id);
+    readable.insert(id);
+  }
+  readable.insert(400);
+
+  Table newTable;
+  table.forEach(
+      [&](TestState& state) { newTable.tryEmplace(state.id, state); });
+  ReadableSet newReadable(newTable);
+  newReadable.adopt(readable);
+
+  EXPECT_TRUE(readable.empty());
+  EXPECT_THAT(
+      std::vector<StreamId>(newReadable.begin(), newReadable.end()),
+      ElementsAre(0, 4, 8, 400));
+  EXPECT_EQ(newReadable.erase(4), 1);
+  EXPECT_THAT(
+      std::vector<StreamId>(newReadable.begin(), newReadable.end()),
+      ElementsAre(0, 8, 400));
+}
+
+} // namespace quic::test
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <quic/state/StateData.h>
+#include <quic/state/StreamStateTable.h>
+
+using namespace quic;
+
+namespace {
+constexpr size_t kNumStreams = 1000;
+// How many streams are concurrently open while the connection churns.
+constexpr size_t kConcurrentStreams = 100;
+
+StreamId nthStream(size_t n) {
+  // Client initiated bidirectional streams, as opened by an HTTP/3 client.
+  return n * 4;
+}
+
+/**
+ * Opens kNumStreams streams with at most kConcurrentStreams open at a time.
+ * Every open stream is looked up lookupsPerStream times before it is closed,
+ * which is roughly what the read and write paths do per packet.
+ */
+template <typename Open, typename Find, typename Close>
+void churn(
+    size_t iters,
+    size_t lookupsPerStream,
+    Open&& open,
+    Find&& find,
+    Close&& close) {
+  while (iters--) {
+    for (size_t n = 0; n < kNumStreams + kConcurrentStreams; n++) {
+      if (n < kNumStreams) {
+        open(nthStream(n));
+      }
+      if (n >= kConcurrentStreams) {
+        auto id = nthStream(n - kConcurrentStreams);
+        for (size_t i = 0; i < lookupsPerStream; i++) {
+          folly::doNotOptimizeAway(find(id));
+        }
+        close(id);
+      }
+    }
+  }
+}
+
+void runMap(size_t iters, size_t lookupsPerStream) {
+  folly::BenchmarkSuspender suspender;
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  UnorderedMap<StreamId, QuicStreamState> streams;
+  suspender.dismiss();
+  churn(
+      iters,
+      lookupsPerStream,
+      [&](StreamId id) { streams.try_emplace(id, id, conn); },
+      [&](StreamId id) -> QuicStreamState* {
+        auto it = streams.find(id);
+        return it == streams.end() ? nullptr : &it->second;
+      },
+      [&](StreamId id) { streams.erase(id); });
+}
+
+void runTable(size_t iters, size_t lookupsPerStream) {
+  folly::BenchmarkSuspender suspender;
+  QuicConnectionStateBase conn(QuicNodeType::Server);
+  StreamStateTable<QuicStreamState> streams;
+  suspender.dismiss();
+  churn(
+      iters,
+      lookupsPerStream,
+      [&](StreamId id) { streams.tryEmplace(id, id, conn); },
+      [&](StreamId id) { return streams.find(id); },
+      [&](StreamId id) { streams.erase(id); });
+}
+} // namespace
+
+BENCHMARK(map_open_close, iters) {
+  runMap(iters, 1);
+}
+
+BENCHMARK_RELATIVE(table_open_close, iters) {
+  runTable(iters, 1);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(map_open_lookup_close, iters) {
+  runMap(iters, 20);
+}
+
+BENCHMARK_RELATIVE(table_open_lookup_close, iters) {
+  runTable(iters, 20);
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
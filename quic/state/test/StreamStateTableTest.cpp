@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <quic/state/StreamStateTable.h>
+
+using namespace quic;
+using namespace testing;
+
+namespace quic::test {
+
+namespace {
+
+struct TestState {
+  explicit TestState(StreamId idIn, size_t* liveIn = nullptr)
+      : id(idIn), live(liveIn) {
+    if (live) {
+      (*live)++;
+    }
+  }
+
+  ~TestState() {
+    if (live) {
+      (*live)--;
+    }
+  }
+
+  StreamId id;
+  size_t* live;
+};
+
+} // namespace
+
+TEST(StreamStateTableTest, EmplaceAndFind) {
+  StreamStateTable<TestState> table;
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.find(0), nullptr);
+
+  auto [state, inserted] = table.tryEmplace(4, 4);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(state->id, 4);
+  EXPECT_EQ(table.find(4), state);
+  EXPECT_EQ(table.size(), 1);
+
+  auto [again, insertedAgain] = table.tryEmplace(4, 100);
+  EXPECT_FALSE(insertedAgain);
+  EXPECT_EQ(again, state);
+  EXPECT_EQ(again->id, 4);
+
+  // Same index in the other three stream spaces is a different stream.
+  EXPECT_EQ(table.find(5), nullptr);
+  EXPECT_EQ(table.find(6), nullptr);
+  EXPECT_EQ(table.find(7), nullptr);
+}
+
+TEST(StreamStateTableTest, ReferencesStayStable) {
+  StreamStateTable<TestState> table;
+  auto* first = table.tryEmplace(0, 0).first;
+  for (StreamId id = 4; id < 4 * 1000; id += 4) {
+    table.tryEmplace(id, id);
+  }
+  // Grow the window downwards as well.
+  table.erase(0);
+  for (StreamId id = 4; id < 4 * 500; id += 4) {
+    table.erase(id);
+  }
+  auto* late = table.find(4 * 999);
+  ASSERT_NE(late, nullptr);
+  first = table.tryEmplace(1, 1).first;
+  table.tryEmplace(8, 8);
+  EXPECT_EQ(table.find(4 * 999), late);
+  EXPECT_EQ(table.find(1), first);
+  EXPECT_EQ(table.find(8)->id, 8);
+}
+
+TEST(StreamStateTableTest, EraseDestroysState) {
+  size_t live = 0;
+  StreamStateTable<TestState> table;
+  for (StreamId id = 0; id < 400; id++) {
+    table.tryEmplace(id, id, &live);
+  }
+  EXPECT_EQ(live, 400);
+  EXPECT_EQ(table.size(), 400);
+
+  EXPECT_TRUE(table.erase(17));
+  EXPECT_FALSE(table.erase(17));
+  EXPECT_EQ(table.find(17), nullptr);
+  EXPECT_EQ(live, 399);
+
+  for (StreamId id = 0; id < 200; id++) {
+    table.erase(id);
+  }
+  EXPECT_EQ(live, 200);
+  EXPECT_EQ(table.size(), 200);
+  EXPECT_EQ(table.find(199), nullptr);
+  EXPECT_NE(table.find(200), nullptr);
+
+  table.clear();
+  EXPECT_EQ(live, 0);
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.find(200), nullptr);
+}
+
+TEST(StreamStateTableTest, ForEachVisitsAll) {
+  StreamStateTable<TestState> table;
+  std::vector<StreamId> expected = {0, 1, 2, 3, 4, 400, 1000, 1003};
+  for (auto id : expected) {
+    table.tryEmplace(id, id);
+  }
+  table.erase(400);
+  expected.erase(std::find(expected.begin(), expected.end(), 400));
+
+  std::vector<StreamId> visited;
+  table.forEach([&](TestState& state) { visited.push_back(state.id); });
+  std::sort(visited.begin(), visited.end());
+  EXPECT_EQ(visited, expected);
+}
+
+TEST(StreamStateTableTest, Move) {
+  size_t live = 0;
+  StreamStateTable<TestState> table;
+  table.tryEmplace(8, 8, &live);
+  auto* state = table.find(8);
+
+  StreamStateTable<TestState> moved(std::move(table));
+  EXPECT_EQ(moved.find(8), state);
+  EXPECT_EQ(moved.size(), 1);
+  EXPECT_EQ(live, 1);
+
+  moved = StreamStateTable<TestState>();
+  EXPECT_EQ(live, 0);
+  EXPECT_TRUE(moved.empty());
+}
+
+} // namespace quic::test
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/common/MvfstLogging.h>
+#include <quic/logging/BinaryQLogReader.h>
+
+#include <folly/FileUtil.h>
+#include <folly/init/Init.h>
+#include <folly/portability/GFlags.h>
+
+DEFINE_string(input, "", "Binary qlog (.bqlog) file written by BinaryQLogger");
+DEFINE_string(
+    output_dir,
+    ".",
+    "Directory the JSON qlog is written to, as <CID>.qlog");
+DEFINE_bool(pretty, true, "Pretty print the JSON output");
+
+int main(int argc, char* argv[]) {
+#if FOLLY_HAVE_LIBGFLAGS
+  // Enable glog logging to stderr by default.
+  gflags::SetCommandLineOptionWithMode(
+      "logtostderr", "1", gflags::SET_FLAGS_DEFAULT);
+#endif
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+  folly::Init init(&argc, &argv);
+
+  if (FLAGS_input.empty()) {
+    MVLOG_ERROR << "--input is required";
+    return 1;
+  }
+  std::string data;
+  if (!folly::readFile(FLAGS_input.c_str(), data)) {
+    MVLOG_ERROR << "Can't read " << FLAGS_input;
+    return 1;
+  }
+  auto logger = quic::readBinaryQLog(quic::ByteRange(
+      reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+  if (logger.hasError()) {
+    MVLOG_ERROR << "Can't convert " << FLAGS_input << ": "
+                << logger.error().message;
+    return 1;
+  }
+  if (!(*logger)->dcid.has_value()) {
+    MVLOG_ERROR << FLAGS_input << " has no dcid record";
+    return 1;
+  }
+  (*logger)->outputLogsToFile(FLAGS_output_dir, FLAGS_pretty);
+  return 0;
+}
@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <sstream>
 
 #include <fizz/crypto/Utils.h>
@@ -12,11 +13,94 @@
 #include <quic/common/MvfstLogging.h>
 #include <quic/common/test/TestClientUtils.h>
 #include <quic/common/udpsocket/FollyQuicAsyncUDPSocket.h>
+#include <quic/common/udpsocket/IoUringQuicAsyncUDPSocket.h>
 #include <quic/fizz/client/handshake/FizzClientQuicHandshakeContext.h>
+#include <quic/observer/SocketObserverTypes.h>
 #include <quic/tools/tperf/TperfClient.h>
 
 namespace quic::tperf {
 
+namespace {
+// How often flood connections are opened.
+constexpr auto kHandshakeFloodInterval = std::chrono::milliseconds(10);
+} // namespace
+
+class TPerfClient::RttSampleObserver : public quic::LegacyObserver {
+ public:
+  explicit RttSampleObserver(folly::Histogram<uint64_t>& rttSamplesUs)
+      : quic::LegacyObserver(makeEventSet()), rttSamplesUs_(rttSamplesUs) {}
+
+  void rttSampleGenerated(
+      quic::QuicSocketLite*, /* socket */
+      const PacketRTT& rttSample) override {
+    rttSamplesUs_.addValue(rttSample.rttSample.count());
+  }
+
+ private:
+  static EventSet makeEventSet() {
+    EventSet eventSet;
+    eventSet.enable(quic::SocketObserverInterface::Events::rttSamples);
+    return eventSet;
+  }
+
+  folly::Histogram<uint64_t>& rttSamplesUs_;
+};
+
+class TPerfClient::FloodConnection
+    : public quic::QuicSocket::ConnectionSetupCallback,
+      public quic::QuicSocket::ConnectionCallback {
+ public:
+  FloodConnection(
+      TPerfClient& client,
+      std::shared_ptr<quic::QuicClientTransport> transport)
+      : client_(client), transport_(std::move(transport)) {}
+
+  void start() {
+    transport_->start(this, this);
+  }
+
+  void close() {
+    transport_->closeNow(std::nullopt);
+  }
+
+  void onTransportReady() noexcept override {
+    done(true);
+  }
+
+  void onConnectionSetupError(QuicError /* error */) noexcept override {
+    done(false);
+  }
+
+  void onConnectionError(QuicError /* error */) noexcept override {
+    done(false);
+  }
+
+  void onConnectionEnd() noexcept override {
+    done(false);
+  }
+
+  void onNewBidirectionalStream(quic::StreamId /* id */) noexcept override {}
+
+  void onNewUnidirectionalStream(quic::StreamId /* id */) noexcept override {}
+
+  void onStopSending(
+      quic::StreamId /* id */,
+      quic::ApplicationErrorCode /* error */) noexcept override {}
+
+ private:
+  void done(bool handshakeDone) {
+    if (done_) {
+      return;
+    }
+    done_ = true;
+    client_.onFloodConnectionDone(this, handshakeDone);
+  }
+
+  TPerfClient& client_;
+  std::shared_ptr<quic::QuicClientTransport> transport_;
+  bool done_{false};
+};
+
 TPerfClient::TPerfClient(
     const std::string& host,
     uint16_t port,
@@ -36,7 +120,10 @@ TPerfClient::TPerfClient(
     uint32_t maxAckReceiveTimestampsToSend,
     bool useL4sEcn,
     bool readEcn,
-    uint32_t dscp)
+    uint32_t dscp,
+    bool ioUringSocket,
+    uint32_t handshakeFloodRate,
+    bool recvmmsg)
     : host_(host),
       port_(port),
       fEvb_(transportTimerResolution),
@@ -56,13 +143,19 @@ TPerfClient::TPerfClient(
       maxAckReceiveTimestampsToSend_(maxAckReceiveTimestampsToSend),
       useL4sEcn_(useL4sEcn),
       readEcn_(readEcn),
-      dscp_(dscp) {
+      dscp_(dscp),
+      ioUringSocket_(ioUringSocket),
+      recvmmsg_(recvmmsg),
+      handshakeFloodRate_(handshakeFloodRate) {
   fizz::Error err;
   FIZZ_THROW_ON_ERROR(fizz::CryptoUtils::init(err), err);
   fEvb_.setName("tperf_client");
 }
 
+TPerfClient::~TPerfClient() = default;
+
 void TPerfClient::timeoutExpired() noexcept {
+  stopHandshakeFlood();
   quicClient_->closeNow(std::nullopt);
   constexpr double bytesPerMegabit = 131072;
   MVLOG_INFO << "Received " << receivedBytes_ << " bytes in "
@@ -75,6 +168,14 @@ void TPerfClient::timeoutExpired() noexcept {
              << ((receivedBytes_ / receivedStreams_) / bytesPerMegabit) /
           duration_.count()
              << "Mb/s over " << receivedStreams_ << " streams";
+  MVLOG_INFO << "RTT us p50=" << rttSamplesUs_.getPercentileEstimate(0.5)
+             << " p99=" << rttSamplesUs_.getPercentileEstimate(0.99)
+             << " p999=" << rttSamplesUs_.getPercentileEstimate(0.999);
+  if (handshakeFloodRate_) {
+    MVLOG_INFO << "Handshake flood of " << handshakeFloodRate_
+               << " connections/s: " << floodHandshakes_ << " handshakes, "
+               << floodFailures_ << " failures";
+  }
   if (receivedStreams_ != 1) {
     MVLOG_INFO << "Histogram per Stream bytes: " << std::endl;
     MVLOG_INFO << "Lo\tHi\tNum\tSum";
@@ -130,6 +231,9 @@ void TPerfClient::onNewUnidirectionalStream(quic::StreamId id) noexcept {
   if (!timerScheduled_) {
     timerScheduled_ = true;
     fEvb_.timer().scheduleTimeout(this, duration_);
+    if (handshakeFloodRate_) {
+      scheduleHandshakeFlood();
+    }
   }
   quicClient_->setReadCallback(id, this);
   receivedStreams_++;
@@ -174,29 +278,38 @@ void TPerfClient::onStreamWriteError(
               << " error=" << toString(error);
 }
 
-void TPerfClient::start() {
+std::shared_ptr<quic::QuicClientTransport> TPerfClient::makeQuicClient() {
   quic::SocketAddress addr(host_.c_str(), port_);
-  auto sock = std::make_unique<folly::AsyncUDPSocket>(&fEvb_);
-  auto sockWrapper =
-      std::make_unique<FollyQuicAsyncUDPSocket>(qEvb_, std::move(sock));
+  std::unique_ptr<QuicAsyncUDPSocket> sockWrapper;
+  if (ioUringSocket_) {
+    sockWrapper = makeIoUringQuicAsyncUDPSocket(qEvb_);
+    if (!sockWrapper) {
+      MVLOG_WARNING << "io_uring sockets are not supported on this host";
+    }
+  }
+  if (!sockWrapper) {
+    auto sock = std::make_unique<folly::AsyncUDPSocket>(&fEvb_);
+    sockWrapper =
+        std::make_unique<FollyQuicAsyncUDPSocket>(qEvb_, std::move(sock));
+  }
 
   auto fizzClientContext =
       FizzClientQuicHandshakeContext::Builder()
           .setCertificateVerifier(test::createTestCertificateVerifier())
           .build();
-  quicClient_ = std::make_shared<quic::QuicClientTransport>(
+  auto quicClient = std::make_shared<quic::QuicClientTransport>(
       qEvb_, std::move(sockWrapper), std::move(fizzClientContext));
-  quicClient_->setHostname("tperf");
-  quicClient_->addNewPeerAddress(addr);
-  quicClient_->setCongestionControllerFactory(
+  quicClient->setHostname("tperf");
+  quicClient->addNewPeerAddress(addr);
+  quicClient->setCongestionControllerFactory(
       std::make_shared<DefaultCongestionControllerFactory>());
-  auto settings = quicClient_->getTransportSettings();
+  auto settings = quicClient->getTransportSettings();
   settings.advertisedInitialUniStreamFlowControlWindow =
       std::numeric_limits<uint32_t>::max();
   settings.advertisedInitialConnectionFlowControlWindow = window_;
   settings.autotuneReceiveConnFlowControl = autotuneWindow_;
   settings.connectUDP = true;
-  settings.shouldUseRecvmmsgForBatchRecv = true;
+  settings.shouldUseRecvmmsgForBatchRecv = recvmmsg_;
   settings.maxRecvBatchSize = 64;
   settings.numGROBuffers_ = 64;
   settings.defaultCongestionController = congestionControlType_;
@@ -247,11 +360,72 @@ void TPerfClient::start() {
   settings.readEcnOnIngress = readEcn_;
   settings.dscpValue = dscp_;
 
-  quicClient_->setTransportSettings(settings);
+  quicClient->setTransportSettings(settings);
+  return quicClient;
+}
 
-  MVLOG_INFO << "TPerfClient connecting to " << addr.describe();
+void TPerfClient::start() {
+  quicClient_ = makeQuicClient();
+  rttObserver_ = std::make_shared<RttSampleObserver>(rttSamplesUs_);
+  quicClient_->addObserver(rttObserver_);
+  MVLOG_INFO << "TPerfClient connecting to " << host_ << ":" << port_;
   quicClient_->start(this, this);
   fEvb_.loopForever();
 }
 
+void TPerfClient::scheduleHandshakeFlood() {
+  fEvb_.runAfterDelay(
+      [this]() { openFloodConnections(); }, kHandshakeFloodInterval.count());
+}
+
+void TPerfClient::openFloodConnections() {
+  if (handshakeFloodStopped_) {
+    return;
+  }
+  floodConnectionsDue_ += handshakeFloodRate_ *
+      std::chrono::duration<double>(kHandshakeFloodInterval).count();
+  for (; floodConnectionsDue_ >= 1; floodConnectionsDue_--) {
+    floodConnections_.push_back(
+        std::make_unique<FloodConnection>(*this, makeQuicClient()));
+    floodConnections_.back()->start();
+  }
+  scheduleHandshakeFlood();
+}
+
+void TPerfClient::onFloodConnectionDone(
+    FloodConnection* connection,
+    bool handshakeDone) {
+  if (handshakeFloodStopped_) {
+    // Closed by stopHandshakeFlood().
+    return;
+  }
+  if (handshakeDone) {
+    floodHandshakes_++;
+  } else {
+    floodFailures_++;
+  }
+  connection->close();
+  // Called from the transport's callbacks, so the transport goes later.
+  fEvb_.runInLoop([this, connection]() {
+    auto it = std::find_if(
+        floodConnections_.begin(),
+        floodConnections_.end(),
+        [connection](const auto& floodConnection) {
+          return floodConnection.get() == connection;
+        });
+    if (it != floodConnections_.end()) {
+      floodConnections_.erase(it);
+    }
+  });
+}
+
+void TPerfClient::stopHandshakeFlood() {
+  handshakeFloodStopped_ = true;
+  auto floodConnections = std::move(floodConnections_);
+  floodConnections_.clear();
+  for (auto& floodConnection : floodConnections) {
+    floodConnection->close();
+  }
+}
+
 } // namespace quic::tperf
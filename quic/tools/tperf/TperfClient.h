@@ -40,8 +40,11 @@ class TPerfClient : public quic::QuicSocket::ConnectionSetupCallback,
       uint32_t maxAckReceiveTimestampsToSend,
       bool useL4sEcn,
       bool readEcn,
-      uint32_t dscp);
-  ~TPerfClient() override = default;
+      uint32_t dscp,
+      bool ioUringSocket,
+      uint32_t handshakeFloodRate = 0,
+      bool recvmmsg = true);
+  ~TPerfClient() override;
 
   void timeoutExpired() noexcept override;
 
@@ -68,6 +71,15 @@ class TPerfClient : public quic::QuicSocket::ConnectionSetupCallback,
   void start();
 
  private:
+  class RttSampleObserver;
+  class FloodConnection;
+
+  std::shared_ptr<quic::QuicClientTransport> makeQuicClient();
+  void scheduleHandshakeFlood();
+  void openFloodConnections();
+  void onFloodConnectionDone(FloodConnection* connection, bool handshakeDone);
+  void stopHandshakeFlood();
+
   bool timerScheduled_{false};
   std::string host_;
   uint16_t port_;
@@ -97,6 +109,23 @@ class TPerfClient : public quic::QuicSocket::ConnectionSetupCallback,
   bool useL4sEcn_{false};
   bool readEcn_{false};
   uint32_t dscp_;
+  bool ioUringSocket_{false};
+  // Whether QuicClientTransport reads with recvmmsg() or recvmsg().
+  bool recvmmsg_{true};
+
+  // Connections opened per second next to the bulk one, 0 for none. Each is
+  // closed once its handshake completes, so the server keeps handshaking
+  // while it serves the bulk connection.
+  uint32_t handshakeFloodRate_{0};
+  bool handshakeFloodStopped_{false};
+  // Connections due but not opened yet, carried across timer ticks.
+  double floodConnectionsDue_{0};
+  uint64_t floodHandshakes_{0};
+  uint64_t floodFailures_{0};
+  std::vector<std::unique_ptr<FloodConnection>> floodConnections_;
+  // RTT samples of the bulk connection.
+  folly::Histogram<uint64_t> rttSamplesUs_{100, 0, 1000 * 1000};
+  std::shared_ptr<RttSampleObserver> rttObserver_;
 };
 
 } // namespace quic::tperf
@@ -7,6 +7,8 @@
 
 #include <fizz/crypto/Utils.h>
 #include <fizz/record/Types.h>
+#include <fizz/server/DefaultCertManager.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
 #include <folly/io/IOBuf.h>
 #include <folly/io/async/AsyncUDPSocket.h>
 #include <folly/stats/Histogram.h>
@@ -16,6 +18,7 @@
 #include <quic/common/test/TestUtils.h>
 #include <quic/common/udpsocket/FollyQuicAsyncUDPSocket.h>
 #include <quic/congestion_control/StaticCwndCongestionController.h>
+#include <quic/fizz/server/handshake/OffloadedSelfCert.h>
 #include <quic/logging/FileQLogger.h>
 #include <quic/logging/oops_logger/GlogOopsLogger.h>
 #include <quic/tools/tperf/PacingObserver.h>
@@ -988,6 +991,7 @@ TPerfServer::TPerfServer(
     bool gso,
     uint32_t maxCwndInMss,
     bool pacing,
+    quic::PacingMode pacingMode,
     uint32_t numStreams,
     uint64_t maxBytesPerStream,
     uint32_t maxReceivePacketSize,
@@ -1008,7 +1012,11 @@ TPerfServer::TPerfServer(
     bool logAppRateLimited,
     bool logLoss,
     bool logRttSample,
+    bool logReadBatches,
     TPerfUdpGsoZerocopyConfig udpGsoZerocopyConfig,
+    bool workerEgressBatching,
+    bool ioUringSocket,
+    uint32_t handshakeThreads,
     std::string qloggerPath,
     const std::string& pacingObserver,
     DoneCallback* doneCallback,
@@ -1016,11 +1024,14 @@ TPerfServer::TPerfServer(
     : host_(host),
       port_(port),
       writeStats_(std::make_shared<TPerfWriteStats>()),
+      readStats_(
+          logReadBatches ? std::make_shared<TPerfReadStats>() : nullptr),
       acceptObserver_(
           std::make_unique<TPerfAcceptObserver>(
               logAppRateLimited,
               logLoss,
-              logRttSample)),
+              logRttSample,
+              readStats_)),
       latencyFactor_(latencyFactor),
       useAckReceiveTimestamps_(useAckReceiveTimestamps),
       useDraft02AckReceiveTimestamps_(useDraft02AckReceiveTimestamps),
@@ -1033,7 +1044,9 @@ TPerfServer::TPerfServer(
       numServerWorkers_(numServerWorkers),
       burstDeadlineMs_(burstDeadlineMs),
       maxPacingRate_(maxPacingRate),
-      udpGsoZerocopyConfig_(udpGsoZerocopyConfig) {
+      udpGsoZerocopyConfig_(udpGsoZerocopyConfig),
+      workerEgressBatching_(workerEgressBatching),
+      ioUringSocket_(ioUringSocket) {
   fizz::Error err;
   FIZZ_THROW_ON_ERROR(fizz::CryptoUtils::init(err), err);
   eventBase_.setName("tperf_server");
@@ -1050,12 +1063,23 @@ TPerfServer::TPerfServer(
   if (pacing) {
     settings.pacingTickInterval = 200us;
     settings.writeLimitRttFraction = 0;
+    settings.pacingMode = pacingMode;
   }
 
   if (gso) {
     settings.batchingMode = QuicBatchingMode::BATCHING_MODE_GSO;
     settings.maxBatchSize = writesPerLoop;
   }
+  if (workerEgressBatching_) {
+    settings.batchingMode = QuicBatchingMode::BATCHING_MODE_WORKER_SENDMMSG_GSO;
+    settings.maxBatchSize = writesPerLoop;
+  }
+  if (ioUringSocket_) {
+    // The worker only reads through a QuicAsyncUDPSocket on the wrapper
+    // receive path.
+    settings.useIoUringSocket = true;
+    settings.shouldUseWrapperRecvmmsgForBatchRecv = true;
+  }
   settings.maxRecvPacketSize = maxReceivePacketSize;
   settings.canIgnorePathMTU = overridePacketSize;
   settings.copaDeltaParam = latencyFactor_;
@@ -1107,6 +1131,23 @@ TPerfServer::TPerfServer(
   }
 
   server_ = QuicServer::createQuicServer(settings);
+  if (workerEgressBatching_) {
+    // Connections never call the batch writer's write() in this mode, so the
+    // write stats are fed from the worker batcher's flushes instead.
+    server_->setEgressBatchFlushObserver(
+        [writeStats = writeStats_](
+            const QuicServerEgressBatcher::FlushStats& stats) {
+          writeStats->recordWrite(
+              TPerfWriteStats::WriteSample{
+                  .durationUs = static_cast<uint64_t>(stats.duration.count()),
+                  .ret = stats.lastErrno ? -1
+                                         : static_cast<ssize_t>(stats.bytes),
+                  .errnoValue = stats.lastErrno,
+                  .bufferedPackets = stats.packets,
+                  .bufferedBytes = stats.bytes,
+                  .syscalls = stats.syscalls});
+        });
+  }
   server_->setQuicServerTransportFactory(
       std::make_unique<TPerfServerTransportFactory>(
           blockSize,
@@ -1119,6 +1160,19 @@ TPerfServer::TPerfServer(
           doneCallback));
   auto serverCtx = quic::test::createServerCtx();
   serverCtx->setClock(std::make_shared<fizz::SystemClock>());
+  if (handshakeThreads > 0) {
+    handshakeExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        handshakeThreads,
+        std::make_shared<folly::NamedThreadFactory>("tperf_handshake"));
+    auto certManager = std::make_unique<fizz::server::DefaultCertManager>();
+    certManager->addCertAndSetDefault(
+        std::make_shared<OffloadedSelfCert>(
+            quic::test::readCert(),
+            folly::getKeepAliveToken(handshakeExecutor_.get())));
+    serverCtx->setCertManager(std::move(certManager));
+    MVLOG_INFO << "tperf server signing handshakes on " << handshakeThreads
+               << " threads";
+  }
   server_->setFizzContext(serverCtx);
 
   if (congestionControlType == quic::CongestionControlType::StaticCwnd) {
@@ -1159,6 +1213,9 @@ void TPerfServer::start() {
 }
 
 void TPerfServer::maybeLogWriteStats() {
+  if (readStats_) {
+    readStats_->maybeLog();
+  }
   if (!writeStats_) {
     return;
   }
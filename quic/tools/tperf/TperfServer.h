@@ -7,13 +7,17 @@
 
 #pragma once
 
+#include <sys/resource.h>
+
 #include <array>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
 
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/io/async/AsyncUDPSocket.h>
 #include <quic/api/QuicBatchWriterFactory.h>
 #include <quic/common/MvfstLogging.h>
@@ -49,11 +53,15 @@ class TPerfWriteStats {
     int errnoValue{0};
     uint64_t bufferedPackets{0};
     uint64_t bufferedBytes{0};
+    // Socket writes the batch took. The worker egress batcher can flush a
+    // batch with several sendmmsg calls.
+    uint64_t syscalls{1};
   };
 
   void recordWrite(const WriteSample& sample) {
     std::lock_guard<std::mutex> lock(mutex_);
     writeCalls_++;
+    writeSyscalls_ += sample.syscalls;
     totalDurationUs_ += sample.durationUs;
     maxDurationUs_ = std::max(maxDurationUs_, sample.durationUs);
     if (sample.ret < 0) {
@@ -104,6 +112,7 @@ class TPerfWriteStats {
     // send and contends on the same mutex; blocking it for the duration of
     // string formatting and MVLOG_INFO once per second is unnecessary.
     uint64_t writeCallsSnap{};
+    uint64_t writeSyscallsSnap{};
     uint64_t writeErrorsSnap{};
     uint64_t totalBufferedPacketsSnap{};
     uint64_t totalBufferedBytesSnap{};
@@ -131,6 +140,7 @@ class TPerfWriteStats {
       }
       lastLoggedWriteCalls_ = writeCalls_;
       writeCallsSnap = writeCalls_;
+      writeSyscallsSnap = writeSyscalls_;
       writeErrorsSnap = writeErrors_;
       totalBufferedPacketsSnap = totalBufferedPackets_;
       totalBufferedBytesSnap = totalBufferedBytes_;
@@ -199,6 +209,7 @@ class TPerfWriteStats {
                   << (listenerKernelZeroCopyEnabledSnap ? 1 : 0);
     }
     MVLOG_INFO << "tperf batch write latency writes=" << writeCallsSnap
+               << " syscalls=" << writeSyscallsSnap
                << " errors=" << writeErrorsSnap
                << " packets=" << totalBufferedPacketsSnap
                << " bytes=" << totalBufferedBytesSnap
@@ -401,6 +412,7 @@ class TPerfWriteStats {
 
   std::mutex mutex_;
   uint64_t writeCalls_{0};
+  uint64_t writeSyscalls_{0};
   uint64_t lastLoggedWriteCalls_{0};
   uint64_t writeErrors_{0};
   std::map<int, uint64_t> writeErrnos_;
@@ -427,6 +439,77 @@ class TPerfWriteStats {
   bool listenerKernelZeroCopyEnabled_{false};
 };
 
+// Per-server counters for the packets transports get handed per
+// onNetworkData() call, fed by the packetsReceived() observer event. The
+// server worker groups the packets of a read batch per transport, so
+// packets_per_read shows how much of that batching a workload gets, and
+// packets_per_cpu_sec what it buys. The CPU time is that of the whole
+// process, the send path included.
+class TPerfReadStats {
+ public:
+  // Called from worker threads, once per onNetworkData().
+  void recordRead(uint64_t packets) {
+    reads_.fetch_add(1, std::memory_order_relaxed);
+    packets_.fetch_add(packets, std::memory_order_relaxed);
+  }
+
+  // Logs the reads since the previous call. Only called from the main
+  // EventBase.
+  void maybeLog() {
+    auto cpuTimeUs = processCpuTimeUs();
+    auto reads = reads_.load(std::memory_order_relaxed);
+    auto packets = packets_.load(std::memory_order_relaxed);
+    auto intervalReads = reads - lastLoggedReads_;
+    auto intervalPackets = packets - lastLoggedPackets_;
+    auto intervalCpuTimeUs = cpuTimeUs - lastLoggedCpuTimeUs_;
+    lastLoggedReads_ = reads;
+    lastLoggedPackets_ = packets;
+    lastLoggedCpuTimeUs_ = cpuTimeUs;
+    if (intervalReads == 0) {
+      return;
+    }
+    MVLOG_INFO << "tperf rx reads=" << intervalReads
+               << " packets=" << intervalPackets << " packets_per_read="
+               << static_cast<double>(intervalPackets) / intervalReads
+               << " cpu_us=" << intervalCpuTimeUs << " packets_per_cpu_sec="
+               << (intervalCpuTimeUs
+                       ? intervalPackets * 1000000 / intervalCpuTimeUs
+                       : 0);
+  }
+
+  // Test-only accessors.
+  uint64_t getReadsForTest() const {
+    return reads_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getPacketsForTest() const {
+    return packets_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getLastLoggedReadsForTest() const {
+    return lastLoggedReads_;
+  }
+
+ private:
+  static uint64_t processCpuTimeUs() {
+    rusage usage{};
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+      return 0;
+    }
+    auto toUs = [](const timeval& tv) {
+      return static_cast<uint64_t>(tv.tv_sec) * 1000000 +
+          static_cast<uint64_t>(tv.tv_usec);
+    };
+    return toUs(usage.ru_utime) + toUs(usage.ru_stime);
+  }
+
+  std::atomic<uint64_t> reads_{0};
+  std::atomic<uint64_t> packets_{0};
+  uint64_t lastLoggedReads_{0};
+  uint64_t lastLoggedPackets_{0};
+  uint64_t lastLoggedCpuTimeUs_{0};
+};
+
 // Configuration for the UDP MSG_ZEROCOPY inplace batch writer. Only the
 // fields relevant to the inplace path are exposed; the broader
 // non-inplace MSG_ZEROCOPY backend and the iouring/devmem backends live
@@ -455,11 +538,13 @@ class TPerfObserver : public quic::LegacyObserver {
       EventSet eventSet,
       bool logAppRateLimited,
       bool logLoss,
-      bool logRttSample)
+      bool logRttSample,
+      std::shared_ptr<quic::tperf::TPerfReadStats> readStats)
       : quic::LegacyObserver(eventSet),
         logAppRateLimited_(logAppRateLimited),
         logLoss_(logLoss),
-        logRttSample_(logRttSample) {}
+        logRttSample_(logRttSample),
+        readStats_(std::move(readStats)) {}
 
   void appRateLimited(
       quic::QuicSocketLite* /* socket */,
@@ -486,10 +571,19 @@ class TPerfObserver : public quic::LegacyObserver {
     }
   }
 
+  void packetsReceived(
+      quic::QuicSocketLite*, /* socket */
+      const PacketsReceivedEvent& event) override {
+    if (readStats_) {
+      readStats_->recordRead(event.numPacketsReceived);
+    }
+  }
+
  private:
   bool logAppRateLimited_;
   bool logLoss_;
   bool logRttSample_;
+  std::shared_ptr<quic::tperf::TPerfReadStats> readStats_;
 };
 
 /**
@@ -498,7 +592,11 @@ class TPerfObserver : public quic::LegacyObserver {
  */
 class TPerfAcceptObserver : public quic::AcceptObserver {
  public:
-  TPerfAcceptObserver(bool logAppRateLimited, bool logLoss, bool logRttSample) {
+  TPerfAcceptObserver(
+      bool logAppRateLimited,
+      bool logLoss,
+      bool logRttSample,
+      std::shared_ptr<quic::tperf::TPerfReadStats> readStats) {
     // Create an observer config, only enabling events we are interested in
     // receiving.
     quic::LegacyObserver::EventSet eventSet;
@@ -506,8 +604,17 @@ class TPerfAcceptObserver : public quic::AcceptObserver {
         quic::SocketObserverInterface::Events::appRateLimitedEvents,
         quic::SocketObserverInterface::Events::rttSamples,
         quic::SocketObserverInterface::Events::lossEvents);
+    if (readStats) {
+      // Not free, the transport builds a per-packet event for every read.
+      eventSet.enable(
+          quic::SocketObserverInterface::Events::packetsReceivedEvents);
+    }
     tperfObserver_ = std::make_unique<TPerfObserver>(
-        eventSet, logAppRateLimited, logLoss, logRttSample);
+        eventSet,
+        logAppRateLimited,
+        logLoss,
+        logRttSample,
+        std::move(readStats));
   }
 
   void accept(quic::QuicTransportBase* transport) noexcept override {
@@ -564,6 +671,7 @@ class TPerfServer {
       bool gso,
       uint32_t maxCwndInMss,
       bool pacing,
+      quic::PacingMode pacingMode,
       uint32_t numStreams,
       uint64_t maxBytesPerStream,
       uint32_t maxReceivePacketSize,
@@ -584,7 +692,11 @@ class TPerfServer {
       bool logAppRateLimited,
       bool logLoss,
       bool logRttSample,
+      bool logReadBatches,
       TPerfUdpGsoZerocopyConfig udpGsoZerocopyConfig,
+      bool workerEgressBatching,
+      bool ioUringSocket,
+      uint32_t handshakeThreads,
       std::string qloggerPath,
       const std::string& pacingObserver,
       DoneCallback* doneCallback = nullptr,
@@ -600,7 +712,12 @@ class TPerfServer {
   uint16_t port_;
   folly::EventBase eventBase_;
   std::shared_ptr<TPerfWriteStats> writeStats_;
+  // Only set with logReadBatches.
+  std::shared_ptr<TPerfReadStats> readStats_;
   std::unique_ptr<TPerfAcceptObserver> acceptObserver_;
+  // Signs CertificateVerify off the workers with handshakeThreads > 0.
+  // Declared before server_ so that it outlives the server's handshakes.
+  std::unique_ptr<folly::CPUThreadPoolExecutor> handshakeExecutor_;
   std::shared_ptr<quic::QuicServer> server_;
   double latencyFactor_;
   bool useAckReceiveTimestamps_{false};
@@ -615,6 +732,8 @@ class TPerfServer {
   uint32_t burstDeadlineMs_;
   uint64_t maxPacingRate_;
   TPerfUdpGsoZerocopyConfig udpGsoZerocopyConfig_;
+  bool workerEgressBatching_{false};
+  bool ioUringSocket_{false};
   quic::BatchWriterFactoryOverride batchWriterFactoryOverride_;
 };
 
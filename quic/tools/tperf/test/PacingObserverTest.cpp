@@ -31,7 +31,7 @@ TEST_F(QLogPacingObserverTest, Basic) {
   for (size_t i = 0; i < 20; i++) {
     auto event =
         quic::SocketObserverInterface::PacketsWrittenEvent::Builder()
-            .setOutstandingPackets(std::deque<OutstandingPacketWrapper>())
+            .setOutstandingPackets(OutstandingPacketContainer())
             .setWriteCount(i + 1)
             .setNumAckElicitingPacketsWritten(i + 1)
             .setNumBytesWritten(1024)
@@ -194,4 +194,21 @@ TEST(TperfWriteStatsTest, RecordListenerSnapshotAcceptsStruct) {
   EXPECT_TRUE(stats.getListenerKernelSnapshotValidForTest());
 }
 
+// Each onNetworkData() is one read; maybeLog() reports the reads since the
+// previous call.
+TEST(TperfWriteStatsTest, ReadStatsCountPacketsPerRead) {
+  TPerfReadStats stats;
+  stats.recordRead(3);
+  stats.recordRead(1);
+  EXPECT_EQ(stats.getReadsForTest(), 2);
+  EXPECT_EQ(stats.getPacketsForTest(), 4);
+
+  stats.maybeLog();
+  EXPECT_EQ(stats.getLastLoggedReadsForTest(), 2);
+  stats.recordRead(5);
+  stats.maybeLog();
+  EXPECT_EQ(stats.getLastLoggedReadsForTest(), 3);
+  EXPECT_EQ(stats.getPacketsForTest(), 9);
+}
+
 } // namespace quic::tperf::test
@@ -31,6 +31,12 @@ DEFINE_uint64(window, 1024 * 1024, "Flow control window size");
 DEFINE_bool(autotune_window, true, "Automatically increase the receive window");
 DEFINE_string(congestion, "cubic", "newreno/cubic/bbr/std::nullopt");
 DEFINE_bool(pacing, false, "Enable pacing");
+DEFINE_string(
+    pacing_mode,
+    "timer",
+    "timer/edt: Hold paced packets back with the pacing timer, or stamp them "
+    "with an earliest departure time for the fq qdisc (server only, needs "
+    "--gso or --tx_backend=udp_worker_batch)");
 DEFINE_uint64(
     max_pacing_rate,
     std::numeric_limits<uint64_t>::max(),
@@ -76,6 +82,10 @@ DEFINE_uint32(
 DEFINE_bool(log_rtt_sample, false, "Log rtt sample events");
 DEFINE_bool(log_loss, false, "Log packet loss events");
 DEFINE_bool(log_app_rate_limited, false, "Log app rate limited events");
+DEFINE_bool(
+    log_read_batches,
+    false,
+    "Log packets per transport read and received packets per CPU second");
 DEFINE_string(
     transport_knob_params,
     "",
@@ -136,10 +146,40 @@ DEFINE_string(
 DEFINE_string(
     tx_backend,
     "udp",
-    "Server-side UDP TX backend: 'udp' (default) or 'udp_gso_zerocopy_inplace'. "
+    "Server-side UDP TX backend: 'udp' (default), 'udp_gso_zerocopy_inplace' "
+    "or 'udp_worker_batch'. "
     "The inplace MSG_ZEROCOPY backend requires --use_inplace_write and --gso; "
     "mvfst encrypts directly into pool-borrowed slabs that the kernel zerocopies, "
-    "with per-fd completion bookkeeping returning slabs to the pool.");
+    "with per-fd completion bookkeeping returning slabs to the pool. "
+    "The worker batch backend requires --use_inplace_write=false; each server "
+    "worker sends the packets of all its connections with one sendmmsg per "
+    "event loop iteration.");
+DEFINE_bool(
+    io_uring_socket,
+    false,
+    "Do UDP I/O through io_uring. On the client this is the connection's "
+    "socket, on the server the worker's listening socket, which receives for "
+    "all connections and sends for them with --tx_backend=udp_worker_batch. "
+    "Falls back to regular sockets if io_uring is not available.");
+DEFINE_uint32(
+    handshake_threads,
+    0,
+    "Server only. Sign handshakes on a pool of this many threads instead of "
+    "on the worker threads. 0 signs inline.");
+DEFINE_bool(
+    client_recvmmsg,
+    true,
+    "Client only. Read up to 64 datagrams with one recvmmsg() per socket "
+    "read instead of one recvmsg() each. Compare the receive throughput the "
+    "client reports with both settings. This switches the read path of the "
+    "full QuicClientTransport that tperf uses. It does not cover the "
+    "batched read mode of QuicClientTransportLite.");
+DEFINE_uint32(
+    handshake_flood_rate,
+    0,
+    "Client only. Next to the bulk connection, open this many connections "
+    "per second, each closed once its handshake completes. Compare the bulk "
+    "connection's RTT percentiles the client reports with and without it.");
 DEFINE_uint64(
     udp_zerocopy_min_bytes,
     1500,
@@ -212,6 +252,7 @@ int main(int argc, char* argv[]) {
       return 0;
     }
     TPerfUdpGsoZerocopyConfig udpGsoZerocopyConfig;
+    bool workerEgressBatching = false;
     if (FLAGS_tx_backend == "udp") {
       // Default backend: no override, plain GSO writer.
     } else if (FLAGS_tx_backend == "udp_gso_zerocopy_inplace") {
@@ -243,9 +284,31 @@ int main(int argc, char* argv[]) {
       udpGsoZerocopyConfig.inplace = true;
       udpGsoZerocopyConfig.minBytes = FLAGS_udp_zerocopy_min_bytes;
       udpGsoZerocopyConfig.poolBuffers = FLAGS_udp_zerocopy_pool_buffers;
+    } else if (FLAGS_tx_backend == "udp_worker_batch") {
+      // Only the ChainedMemory data path can be batched across connections,
+      // the inplace path shares one write buffer per worker.
+      if (FLAGS_use_inplace_write) {
+        MVLOG_ERROR << "--tx_backend=udp_worker_batch requires "
+                    << "--use_inplace_write=false";
+        return 1;
+      }
+      workerEgressBatching = true;
     } else {
       MVLOG_ERROR << "Unknown --tx_backend value: " << FLAGS_tx_backend
-                  << " (expected 'udp' or 'udp_gso_zerocopy_inplace')";
+                  << " (expected 'udp', 'udp_gso_zerocopy_inplace' or "
+                  << "'udp_worker_batch')";
+      return 1;
+    }
+    quic::PacingMode pacingMode = quic::PacingMode::Timer;
+    if (FLAGS_pacing_mode == "edt") {
+      if (!FLAGS_pacing) {
+        MVLOG_ERROR << "--pacing_mode=edt requires --pacing";
+        return 1;
+      }
+      pacingMode = quic::PacingMode::EarliestDepartureTime;
+    } else if (FLAGS_pacing_mode != "timer") {
+      MVLOG_ERROR << "Unknown --pacing_mode value: " << FLAGS_pacing_mode
+                  << " (expected 'timer' or 'edt')";
       return 1;
     }
     TPerfServer server(
@@ -257,6 +320,7 @@ int main(int argc, char* argv[]) {
         FLAGS_gso,
         FLAGS_max_cwnd_mss,
         FLAGS_pacing,
+        pacingMode,
         FLAGS_num_streams,
         FLAGS_bytes_per_stream,
         FLAGS_max_receive_packet_size,
@@ -277,7 +341,11 @@ int main(int argc, char* argv[]) {
         FLAGS_log_app_rate_limited,
         FLAGS_log_loss,
         FLAGS_log_rtt_sample,
+        FLAGS_log_read_batches,
         udpGsoZerocopyConfig,
+        workerEgressBatching,
+        FLAGS_io_uring_socket,
+        FLAGS_handshake_threads,
         FLAGS_server_qlogger_path,
         FLAGS_pacing_observer,
         nullptr, // DoneCallback
@@ -322,7 +390,10 @@ int main(int argc, char* argv[]) {
         FLAGS_max_ack_receive_timestamps_to_send,
         FLAGS_use_l4s_ecn,
         FLAGS_read_ecn,
-        FLAGS_dscp);
+        FLAGS_dscp,
+        FLAGS_io_uring_socket,
+        FLAGS_handshake_flood_rate,
+        FLAGS_client_recvmmsg);
     client.start();
   } else {
     MVLOG_ERROR << "Unknown mode " << FLAGS_mode;
@@ -28,7 +28,8 @@ quic::Expected<void, std::runtime_error> HashingXskContainer::init(
         .zeroCopyEnabled = xskContainerConfig.zeroCopyEnabled,
         .useNeedWakeup = xskContainerConfig.useNeedWakeup,
         .useChecksumOffload = xskContainerConfig.useChecksumOffload,
-        .sharedState = std::make_shared<SharedState>(numOwners)};
+        .sharedState = std::make_shared<SharedState>(numOwners),
+        .interfaceName = xskContainerConfig.interfaceName};
     auto createResult = createXskSender(queueId, xskSenderConfig);
     if (createResult.hasError()) {
       // TODO: Clean up the already-created XDP sockets if we fail at this
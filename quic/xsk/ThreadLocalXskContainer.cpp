@@ -38,7 +38,8 @@ quic::Expected<void, std::runtime_error> ThreadLocalXskContainer::init(
         .useNeedWakeup = xskContainerConfig.useNeedWakeup,
         .useChecksumOffload = xskContainerConfig.useChecksumOffload,
         .sharedState = std::make_shared<SharedState>(groupSize),
-        .xskPerThread = true};
+        .xskPerThread = true,
+        .interfaceName = xskContainerConfig.interfaceName};
 
     for (uint32_t i = 0;
          i < groupSize && (socketId + i) < xskContainerConfig.numSockets;
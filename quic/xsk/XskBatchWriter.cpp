@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#if defined(__linux__) && !defined(ANDROID)
+
+#include <quic/common/BufUtil.h>
+#include <quic/common/MvfstLogging.h>
+#include <quic/xsk/XskBatchWriter.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace facebook::xdpsocket {
+
+namespace {
+
+// The frame stays owned by the XskSender, the IOBuf only points into it.
+void noopFreeFrame(void* /*buf*/, void* /*userData*/) {}
+
+quic::BufPtr wrapFrame(const XskBuffer& frame, uint32_t capacity) {
+  return folly::IOBuf::takeOwnership(
+      frame.buffer, capacity, 0, 0, noopFreeFrame);
+}
+
+} // namespace
+
+XskBatchWriter::XskBatchWriter(
+    std::shared_ptr<BaseXskContainer> xskContainer,
+    size_t maxFallbackBufs)
+    : xskContainer_(std::move(xskContainer)),
+      fallbackWriter_(std::max<size_t>(maxFallbackBufs, 1)) {}
+
+XskBatchWriter::~XskBatchWriter() {
+  flushXsk();
+}
+
+bool XskBatchWriter::empty() const {
+  return xskBytes_ == 0 && fallbackWriter_.empty();
+}
+
+size_t XskBatchWriter::size() const {
+  return xskBytes_ + fallbackWriter_.size();
+}
+
+void XskBatchWriter::reset() {
+  flushXsk();
+  xskBytes_ = 0;
+  fallbackWriter_.reset();
+}
+
+bool XskBatchWriter::append(
+    quic::BufPtr&& buf,
+    size_t size,
+    const quic::SocketAddress& addr,
+    quic::QuicAsyncUDPSocket* sock) {
+  if (appendToXsk(buf, addr, sock)) {
+    numXskPackets_++;
+    xskBytes_ += size;
+    return false;
+  }
+  numFallbackPackets_++;
+  return fallbackWriter_.append(std::move(buf), size, addr, sock);
+}
+
+ssize_t XskBatchWriter::write(
+    quic::QuicAsyncUDPSocket& sock,
+    const quic::SocketAddress& address) {
+  flushXsk();
+  if (fallbackWriter_.empty()) {
+    return static_cast<ssize_t>(xskBytes_);
+  }
+  auto ret = fallbackWriter_.write(sock, address);
+  if (ret < 0) {
+    return ret;
+  }
+  return static_cast<ssize_t>(xskBytes_) + ret;
+}
+
+bool XskBatchWriter::appendToXsk(
+    const quic::BufPtr& buf,
+    const quic::SocketAddress& addr,
+    quic::QuicAsyncUDPSocket* sock) {
+  if (!srcResolved_ && sock) {
+    srcResolved_ = true;
+    auto addressResult = sock->address();
+    // Frames need a concrete source address in their IP header.
+    if (addressResult.has_value() &&
+        !addressResult->getIPAddress().isZero()) {
+      src_ = std::move(addressResult.value());
+    }
+  }
+  if (!src_ || src_->getFamily() != addr.getFamily()) {
+    return false;
+  }
+  auto* xsk = xskContainer_->pickXsk(*src_, addr);
+  if (!xsk) {
+    return false;
+  }
+  bool isIpV6 = addr.getIPAddress().isV6();
+  size_t len = buf->computeChainDataLength();
+  if (len > xsk->getMaxPayloadLength(isIpV6)) {
+    return false;
+  }
+  // Empty until the XskSender reclaimed frames of completed sends.
+  auto xskBuffer = xsk->getXskBuffer(isIpV6);
+  if (!xskBuffer) {
+    return false;
+  }
+  auto* payload = static_cast<uint8_t*>(xskBuffer->buffer);
+  for (const auto& range : *buf) {
+    std::memcpy(payload, range.data(), range.size());
+    payload += range.size();
+  }
+  xskBuffer->payloadLength = static_cast<uint16_t>(len);
+  if (pendingXsk_ && pendingXsk_ != xsk) {
+    flushXsk();
+  }
+  xsk->writeXskBuffer(*xskBuffer, addr, *src_);
+  pendingXsk_ = xsk;
+  return true;
+}
+
+void XskBatchWriter::flushXsk() {
+  if (!pendingXsk_) {
+    return;
+  }
+  // The descriptors stay on the TX ring if the wakeup fails, and go out
+  // with the next one.
+  if (pendingXsk_->flush() != FlushResult::SUCCESS) {
+    MVVLOG(4) << "Failed to wake up the AF_XDP socket";
+  }
+  pendingXsk_ = nullptr;
+}
+
+XskInplaceBatchWriter::XskInplaceBatchWriter(
+    quic::QuicConnectionStateBase& conn,
+    XskSender& xsk,
+    const XskBuffer& frame,
+    const quic::SocketAddress& src)
+    : conn_(conn),
+      xsk_(xsk),
+      src_(src),
+      isIpV6_(src.getIPAddress().isV6()),
+      frameCapacity_(xsk.getMaxPayloadLength(isIpV6_)),
+      frame_(frame),
+      frameAccessor_(wrapFrame(frame, frameCapacity_)),
+      connAccessor_(conn.bufAccessor) {
+  conn_.bufAccessor = &frameAccessor_;
+}
+
+XskInplaceBatchWriter::~XskInplaceBatchWriter() {
+  flushXsk();
+  if (frame_) {
+    frameAccessor_.obtain();
+    xsk_.returnBuffer(*frame_);
+  }
+  conn_.bufAccessor = connAccessor_;
+}
+
+bool XskInplaceBatchWriter::empty() const {
+  return xskBytes_ == 0 && (frame_ || connAccessor_->length() == 0);
+}
+
+size_t XskInplaceBatchWriter::size() const {
+  return xskBytes_ + (frame_ ? 0 : connAccessor_->length());
+}
+
+void XskInplaceBatchWriter::reset() {
+  flushXsk();
+  xskBytes_ = 0;
+  if (!frame_) {
+    connAccessor_->clear();
+  }
+}
+
+bool XskInplaceBatchWriter::append(
+    quic::BufPtr&& /* buf */,
+    size_t /*size*/,
+    const quic::SocketAddress& addr,
+    quic::QuicAsyncUDPSocket* /*sock*/) {
+  if (!frame_) {
+    // Built in the connection's bufAccessor, written on the flush.
+    numFallbackPackets_++;
+    return true;
+  }
+  auto frameBuf = frameAccessor_.obtain();
+  MVCHECK(frameBuf->data() == frame_->buffer);
+  frame_->payloadLength = static_cast<uint16_t>(frameBuf->length());
+  xskBytes_ += frameBuf->length();
+  frameBuf.reset();
+  xsk_.writeXskBuffer(*frame_, addr, src_);
+  pendingXsk_ = true;
+  numXskPackets_++;
+
+  frame_ = xsk_.getXskBuffer(isIpV6_);
+  if (frame_) {
+    frameAccessor_.release(wrapFrame(*frame_, frameCapacity_));
+    return false;
+  }
+  // Out of frames until the completion ring hands some back.
+  connAccessor_->clear();
+  conn_.bufAccessor = connAccessor_;
+  return true;
+}
+
+ssize_t XskInplaceBatchWriter::write(
+    quic::QuicAsyncUDPSocket& sock,
+    const quic::SocketAddress& address) {
+  flushXsk();
+  if (frame_ || connAccessor_->length() == 0) {
+    return static_cast<ssize_t>(xskBytes_);
+  }
+  iovec vec[quic::kNumIovecBufferChains];
+  size_t iovec_len = quic::fillIovec(connAccessor_->buf(), vec);
+  auto ret = sock.write(address, vec, iovec_len);
+  if (ret < 0) {
+    return ret;
+  }
+  return static_cast<ssize_t>(xskBytes_) + ret;
+}
+
+void XskInplaceBatchWriter::flushXsk() {
+  if (!pendingXsk_) {
+    return;
+  }
+  if (xsk_.flush() != FlushResult::SUCCESS) {
+    MVVLOG(4) << "Failed to wake up the AF_XDP socket";
+  }
+  pendingXsk_ = false;
+}
+
+quic::BatchWriterFactoryOverride makeXskBatchWriterFactory(
+    std::shared_ptr<BaseXskContainer> xskContainer,
+    quic::BatchWriterFactoryOverride next) {
+  return [xskContainer = std::move(xskContainer), next = std::move(next)](
+             const quic::QuicBatchingMode& batchingMode,
+             uint32_t batchSize,
+             quic::DataPathType dataPathType,
+             quic::QuicConnectionStateBase& conn,
+             bool gsoSupported) -> quic::BatchWriterPtr {
+    if (next) {
+      auto batchWriter =
+          next(batchingMode, batchSize, dataPathType, conn, gsoSupported);
+      if (batchWriter) {
+        return batchWriter;
+      }
+    }
+    if (dataPathType == quic::DataPathType::ChainedMemory) {
+      return quic::BatchWriterPtr(new XskBatchWriter(xskContainer, batchSize));
+    }
+    if (conn.transportSettings.isPriming || !conn.bufAccessor ||
+        !conn.pathManager) {
+      return nullptr;
+    }
+    const auto* path = conn.pathManager->getPath(conn.currentPathId);
+    if (!path || path->localAddress.getIPAddress().isZero() ||
+        path->localAddress.getFamily() != conn.peerAddress.getFamily()) {
+      return nullptr;
+    }
+    auto* xsk = xskContainer->pickXsk(path->localAddress, conn.peerAddress);
+    if (!xsk) {
+      return nullptr;
+    }
+    bool isIpV6 = conn.peerAddress.getIPAddress().isV6();
+    if (xsk->getMaxPayloadLength(isIpV6) < conn.udpSendPacketLen) {
+      return nullptr;
+    }
+    auto frame = xsk->getXskBuffer(isIpV6);
+    if (!frame) {
+      return nullptr;
+    }
+    return quic::BatchWriterPtr(
+        new XskInplaceBatchWriter(conn, *xsk, *frame, path->localAddress));
+  };
+}
+
+} // namespace facebook::xdpsocket
+
+#endif
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#if defined(__linux__) && !defined(ANDROID)
+
+#include <quic/api/QuicBatchWriter.h>
+#include <quic/api/QuicBatchWriterFactory.h>
+#include <quic/common/BufAccessor.h>
+#include <quic/common/Optional.h>
+#include <quic/xsk/BaseXskContainer.h>
+
+#include <memory>
+
+namespace facebook::xdpsocket {
+
+/**
+ * BatchWriter that sends a connection's packets over AF_XDP. Every appended
+ * packet is copied into a UMEM frame of the XskSender the container picks for
+ * the socket's local address and the peer, and the TX ring is kicked on
+ * write().
+ *
+ * Frames are reclaimed from the completion ring by the XskSender as it hands
+ * out new ones. A packet that can't go over AF_XDP, because the container has
+ * no XskSender for this thread or flow, no frame is free yet, the packet
+ * doesn't fit a frame or the socket isn't bound to a concrete address, is
+ * sent through the UDP socket instead with sendmmsg.
+ */
+class XskBatchWriter : public quic::BatchWriter {
+ public:
+  XskBatchWriter(
+      std::shared_ptr<BaseXskContainer> xskContainer,
+      size_t maxFallbackBufs);
+
+  // Kicks the TX ring for packets appended since the last write().
+  ~XskBatchWriter() override;
+
+  [[nodiscard]] bool empty() const override;
+
+  [[nodiscard]] size_t size() const override;
+
+  void reset() override;
+
+  // Packets are copied into UMEM frames when appended.
+  [[nodiscard]] bool handsOffOnAppend() const override {
+    return true;
+  }
+
+  // AF_XDP frames leave when the TX ring is kicked, they carry no departure
+  // time.
+  void setTxTime(std::chrono::microseconds /*txTime*/) override {}
+
+  bool append(
+      quic::BufPtr&& buf,
+      size_t size,
+      const quic::SocketAddress& addr,
+      quic::QuicAsyncUDPSocket* sock) override;
+
+  ssize_t write(
+      quic::QuicAsyncUDPSocket& sock,
+      const quic::SocketAddress& address) override;
+
+  [[nodiscard]] uint64_t numXskPackets() const {
+    return numXskPackets_;
+  }
+
+  [[nodiscard]] uint64_t numFallbackPackets() const {
+    return numFallbackPackets_;
+  }
+
+ private:
+  // Returns false when the packet has to take the UDP socket.
+  bool appendToXsk(
+      const quic::BufPtr& buf,
+      const quic::SocketAddress& addr,
+      quic::QuicAsyncUDPSocket* sock);
+
+  void flushXsk();
+
+  std::shared_ptr<BaseXskContainer> xskContainer_;
+  quic::SendmmsgPacketBatchWriter fallbackWriter_;
+  // Local address the frames are sent from, resolved on the first append.
+  // Empty when the socket has no usable address.
+  quic::Optional<quic::SocketAddress> src_;
+  bool srcResolved_{false};
+  // XskSender with descriptors in its TX ring that weren't kicked yet.
+  XskSender* pendingXsk_{nullptr};
+  size_t xskBytes_{0};
+  uint64_t numXskPackets_{0};
+  uint64_t numFallbackPackets_{0};
+};
+
+/**
+ * BatchWriter for the continuous memory data path that has the connection
+ * build its packets straight into UMEM frames. While it lives, the
+ * connection's bufAccessor is swapped for one over a free frame, right behind
+ * the room XskSender::writeXskBuffer() fills with the Ethernet, IP and UDP
+ * headers. The packet builder writes into the frame and the packet is
+ * encrypted there in place, so appending it only has to post the frame to the
+ * TX ring and swap in the next one.
+ *
+ * When no frame is free, the connection gets its own bufAccessor back and the
+ * remaining packets are sent through the UDP socket one at a time.
+ */
+class XskInplaceBatchWriter : public quic::BatchWriter {
+ public:
+  XskInplaceBatchWriter(
+      quic::QuicConnectionStateBase& conn,
+      XskSender& xsk,
+      const XskBuffer& frame,
+      const quic::SocketAddress& src);
+
+  // Kicks the TX ring, returns the unused frame and gives the connection its
+  // bufAccessor back.
+  ~XskInplaceBatchWriter() override;
+
+  [[nodiscard]] bool empty() const override;
+
+  [[nodiscard]] size_t size() const override;
+
+  void reset() override;
+
+  // The frame is posted to the TX ring when the packet is appended.
+  [[nodiscard]] bool handsOffOnAppend() const override {
+    return true;
+  }
+
+  void setTxTime(std::chrono::microseconds /*txTime*/) override {}
+
+  bool append(
+      quic::BufPtr&& buf,
+      size_t size,
+      const quic::SocketAddress& addr,
+      quic::QuicAsyncUDPSocket* sock) override;
+
+  ssize_t write(
+      quic::QuicAsyncUDPSocket& sock,
+      const quic::SocketAddress& address) override;
+
+  [[nodiscard]] uint64_t numXskPackets() const {
+    return numXskPackets_;
+  }
+
+  [[nodiscard]] uint64_t numFallbackPackets() const {
+    return numFallbackPackets_;
+  }
+
+ private:
+  void flushXsk();
+
+  quic::QuicConnectionStateBase& conn_;
+  XskSender& xsk_;
+  quic::SocketAddress src_;
+  bool isIpV6_;
+  uint32_t frameCapacity_;
+  // The frame the connection builds its next packet into. Empty once the
+  // XskSender ran out of frames.
+  quic::Optional<XskBuffer> frame_;
+  quic::BufAccessor frameAccessor_;
+  // The connection's own bufAccessor, used again after falling back.
+  quic::BufAccessor* connAccessor_;
+  bool pendingXsk_{false};
+  size_t xskBytes_{0};
+  uint64_t numXskPackets_{0};
+  uint64_t numFallbackPackets_{0};
+};
+
+/**
+ * Wraps next so that connections write their packets over AF_XDP through
+ * xskContainer. next, when set, is consulted first. Install it with
+ * QuicServer::setBatchWriterFactoryOverride. With a ThreadLocalXskContainer,
+ * setOwnerForXsk() has to run on every worker thread, connections on a thread
+ * without an XskSender keep using their UDP socket.
+ *
+ * The chained memory data path gets an XskBatchWriter. The continuous memory
+ * path gets an XskInplaceBatchWriter when the connection's path has a
+ * concrete local address and a free frame fits udpSendPacketLen, and the
+ * default writers otherwise.
+ */
+quic::BatchWriterFactoryOverride makeXskBatchWriterFactory(
+    std::shared_ptr<BaseXskContainer> xskContainer,
+    quic::BatchWriterFactoryOverride next);
+
+} // namespace facebook::xdpsocket
+
+#endif
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#if defined(__linux__) && !defined(ANDROID)
+
+#include <folly/ScopeGuard.h>
+#include <netinet/udp.h>
+#include <quic/common/MvfstLogging.h>
+#include <quic/xsk/XskReceiver.h>
+#include <quic/xsk/packet_utils.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <mutex>
+
+namespace facebook::xdpsocket {
+
+// More fragments flag and fragment offset of the IPv4 frag_off field.
+constexpr uint16_t kIpFragmentMask = 0x3fff;
+
+struct XskReceiver::Umem {
+  Umem(void* areaIn, uint32_t numFramesIn, uint32_t frameSizeIn)
+      : area(static_cast<uint8_t*>(areaIn)),
+        numFrames(numFramesIn),
+        frameSize(frameSizeIn) {}
+
+  ~Umem() {
+    free_umem(area, numFrames, frameSize);
+  }
+
+  uint8_t* area;
+  uint32_t numFrames;
+  uint32_t frameSize;
+  std::atomic<uint32_t> numHeld{0};
+  std::mutex mutex;
+  // Frames freed since the receiver last reclaimed them.
+  std::vector<uint64_t> returnedFrames;
+  bool receiverAlive{true};
+};
+
+quic::Optional<ParsedUdpFrame> parseUdpFrame(
+    const uint8_t* frame,
+    uint32_t len) {
+  if (len < sizeof(ethhdr)) {
+    return std::nullopt;
+  }
+  ethhdr eth;
+  std::memcpy(&eth, frame, sizeof(eth));
+  uint32_t offset = sizeof(ethhdr);
+  ParsedUdpFrame parsed;
+  uint32_t udpLen;
+  if (eth.h_proto == htons(ETH_P_IP)) {
+    if (len < offset + sizeof(iphdr)) {
+      return std::nullopt;
+    }
+    iphdr ip;
+    std::memcpy(&ip, frame + offset, sizeof(ip));
+    uint32_t ipHeaderLen = ip.ihl * 4;
+    uint32_t ipTotalLen = ntohs(ip.tot_len);
+    if (ip.version != 4 || ip.ihl < 5 || ip.protocol != IPPROTO_UDP ||
+        (ip.frag_off & htons(kIpFragmentMask)) != 0 ||
+        ipTotalLen < ipHeaderLen + sizeof(udphdr) ||
+        len < offset + ipTotalLen) {
+      return std::nullopt;
+    }
+    sockaddr_in peer{};
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = ip.saddr;
+    std::memcpy(
+        &peer.sin_port,
+        frame + offset + ipHeaderLen + offsetof(udphdr, source),
+        sizeof(peer.sin_port));
+    parsed.peerAddress.setFromSockaddr(
+        reinterpret_cast<const sockaddr*>(&peer), sizeof(peer));
+    parsed.tosValue = ip.tos;
+    offset += ipHeaderLen;
+    udpLen = ipTotalLen - ipHeaderLen;
+  } else if (eth.h_proto == htons(ETH_P_IPV6)) {
+    if (len < offset + sizeof(ipv6hdr)) {
+      return std::nullopt;
+    }
+    ipv6hdr ip;
+    std::memcpy(&ip, frame + offset, sizeof(ip));
+    uint32_t ipPayloadLen = ntohs(ip.payload_len);
+    if (ip.version != 6 || ip.nexthdr != IPPROTO_UDP ||
+        ipPayloadLen < sizeof(udphdr) ||
+        len < offset + sizeof(ipv6hdr) + ipPayloadLen) {
+      return std::nullopt;
+    }
+    sockaddr_in6 peer{};
+    peer.sin6_family = AF_INET6;
+    std::memcpy(&peer.sin6_addr, &ip.saddr, sizeof(peer.sin6_addr));
+    std::memcpy(
+        &peer.sin6_port,
+        frame + offset + sizeof(ipv6hdr) + offsetof(udphdr, source),
+        sizeof(peer.sin6_port));
+    parsed.peerAddress.setFromSockaddr(
+        reinterpret_cast<const sockaddr*>(&peer), sizeof(peer));
+    parsed.tosValue = (ip.priority << 4) | (ip.flow_lbl[0] >> 4);
+    offset += sizeof(ipv6hdr);
+    udpLen = ipPayloadLen;
+  } else {
+    return std::nullopt;
+  }
+  udphdr udp;
+  std::memcpy(&udp, frame + offset, sizeof(udp));
+  // Anything past the UDP length is padding.
+  uint32_t udpHeaderLen = ntohs(udp.len);
+  if (udpHeaderLen < sizeof(udphdr) || udpHeaderLen > udpLen) {
+    return std::nullopt;
+  }
+  parsed.dstPort = ntohs(udp.dest);
+  parsed.payloadOffset = static_cast<uint16_t>(offset + sizeof(udphdr));
+  parsed.payloadLength = static_cast<uint16_t>(udpHeaderLen - sizeof(udphdr));
+  return parsed;
+}
+
+XskReceiver::XskReceiver(XskReceiverConfig config)
+    : config_(std::move(config)) {}
+
+XskReceiver::~XskReceiver() {
+  if (rxMap_) {
+    unmap_rx_ring(rxMap_, &xskOffsets_, config_.numFrames);
+  }
+  if (fillMap_) {
+    unmap_fill_ring(fillMap_, &xskOffsets_, config_.numFrames);
+  }
+  if (xskFd_ >= 0) {
+    close_xsk(xskFd_);
+  }
+  if (!umem_) {
+    return;
+  }
+  std::unique_lock<std::mutex> guard(umem_->mutex);
+  umem_->receiverAlive = false;
+  if (umem_->numHeld.load() == 0) {
+    guard.unlock();
+    delete umem_;
+  }
+}
+
+quic::Expected<void, std::runtime_error> XskReceiver::init() {
+  if ((config_.numFrames & (config_.numFrames - 1)) != 0 ||
+      (config_.frameSize & (config_.frameSize - 1)) != 0) {
+    return quic::make_unexpected(std::runtime_error(
+        "Number of frames and frame size have to be powers of 2"));
+  }
+
+  xskFd_ = create_xsk();
+  if (xskFd_ < 0) {
+    return quic::make_unexpected(
+        std::runtime_error("Failed to create xdp socket"));
+  }
+
+  auto g = folly::makeGuard([&]() {
+    if (rxMap_) {
+      unmap_rx_ring(rxMap_, &xskOffsets_, config_.numFrames);
+      rxMap_ = nullptr;
+    }
+    if (fillMap_) {
+      unmap_fill_ring(fillMap_, &xskOffsets_, config_.numFrames);
+      fillMap_ = nullptr;
+    }
+    close_xsk(xskFd_);
+    xskFd_ = -1;
+    delete umem_;
+    umem_ = nullptr;
+  });
+
+  void* umemArea = create_umem(
+      xskFd_,
+      UmemConfig{
+          .numFrames = config_.numFrames,
+          .frameSize = config_.frameSize,
+          .txMetadataLen = 0,
+      });
+  if (!umemArea) {
+    return quic::make_unexpected(std::runtime_error("Failed to create umem"));
+  }
+  umem_ = new Umem(umemArea, config_.numFrames, config_.frameSize);
+
+  // Every frame fits in the fill ring, so refilling it never has to wait for
+  // the kernel.
+  if (set_fill_ring_size(xskFd_, config_.numFrames) < 0) {
+    return quic::make_unexpected(std::runtime_error("Failed to set fill ring"));
+  }
+
+  // Nothing is sent, but binding needs a completion ring.
+  if (set_completion_ring(xskFd_, 1) < 0) {
+    return quic::make_unexpected(
+        std::runtime_error("Failed to set completion ring"));
+  }
+
+  if (set_rx_ring(xskFd_, config_.numFrames) < 0) {
+    return quic::make_unexpected(std::runtime_error("Failed to set rx ring"));
+  }
+
+  if (xsk_get_mmap_offsets(xskFd_, &xskOffsets_) < 0) {
+    return quic::make_unexpected(
+        std::runtime_error("Failed to get mmap offsets"));
+  }
+
+  fillMap_ = map_fill_ring(xskFd_, &xskOffsets_, config_.numFrames);
+  if (!fillMap_) {
+    return quic::make_unexpected(std::runtime_error("Failed to map fill ring"));
+  }
+
+  rxMap_ = map_rx_ring(xskFd_, &xskOffsets_, config_.numFrames);
+  if (!rxMap_) {
+    return quic::make_unexpected(std::runtime_error("Failed to map rx ring"));
+  }
+
+  // The kernel only delivers packets into frames on the fill ring.
+  freeFrames_.reserve(config_.numFrames);
+  for (uint32_t i = 0; i < config_.numFrames; i++) {
+    freeFrames_.push_back(static_cast<uint64_t>(i) * config_.frameSize);
+  }
+  refillFillRing();
+
+  if (bind_xsk(
+          xskFd_,
+          config_.interfaceName.c_str(),
+          config_.queueId,
+          config_.zeroCopyEnabled,
+          config_.useNeedWakeup) < 0) {
+    return quic::make_unexpected(std::runtime_error("Failed to bind xsk"));
+  }
+
+  if (config_.xskMapFd >= 0 &&
+      register_xsk_in_map(config_.xskMapFd, config_.queueId, xskFd_) < 0) {
+    return quic::make_unexpected(
+        std::runtime_error("Failed to register xsk in xskmap"));
+  }
+
+  g.dismiss();
+  return {};
+}
+
+size_t XskReceiver::receive(std::vector<quic::ReceivedUdpPacket>& packets) {
+  reclaimFrames();
+
+  auto* producerPtr = (uint32_t*)((char*)rxMap_ + xskOffsets_.rx.producer);
+  uint32_t rxProducerIndex = __atomic_load_n(producerPtr, __ATOMIC_ACQUIRE);
+  uint32_t numEntries =
+      std::min(rxProducerIndex - rxConsumerIndex_, config_.batchSize);
+  auto* baseDesc = (xdp_desc*)((char*)rxMap_ + xskOffsets_.rx.desc);
+  auto receiveTimePoint = quic::Clock::now();
+  size_t numPackets = 0;
+
+  for (uint32_t i = 0; i < numEntries; i++) {
+    const xdp_desc& desc =
+        baseDesc[(rxConsumerIndex_ + i) & (config_.numFrames - 1)];
+    // In aligned mode the packet starts after the headroom of its frame.
+    uint64_t frameAddr = desc.addr & ~uint64_t(config_.frameSize - 1);
+    uint32_t frameOffset = desc.addr - frameAddr;
+    uint8_t* frame = umem_->area + frameAddr;
+    auto parsed = parseUdpFrame(frame + frameOffset, desc.len);
+    if (!parsed || (config_.port != 0 && parsed->dstPort != config_.port)) {
+      numDropped_++;
+      freeFrames_.push_back(frameAddr);
+      continue;
+    }
+    const uint8_t* payload = frame + frameOffset + parsed->payloadOffset;
+    quic::BufPtr buf;
+    if (umem_->numHeld.load(std::memory_order_relaxed) >=
+        config_.numFrames / 2) {
+      buf = folly::IOBuf::copyBuffer(payload, parsed->payloadLength);
+      freeFrames_.push_back(frameAddr);
+      numCopied_++;
+    } else {
+      umem_->numHeld.fetch_add(1, std::memory_order_relaxed);
+      buf = folly::IOBuf::takeOwnership(
+          frame,
+          config_.frameSize,
+          frameOffset + parsed->payloadOffset,
+          parsed->payloadLength,
+          recycleFrame,
+          umem_);
+    }
+    auto& packet = packets.emplace_back(std::move(buf));
+    packet.timings.receiveTimePoint = receiveTimePoint;
+    packet.tosValue = parsed->tosValue;
+    packet.peerAddress = std::move(parsed->peerAddress);
+    numPackets++;
+  }
+  rxConsumerIndex_ += numEntries;
+  numReceived_ += numPackets;
+
+  auto* consumerPtr = (uint32_t*)((char*)rxMap_ + xskOffsets_.rx.consumer);
+  __atomic_store_n(consumerPtr, rxConsumerIndex_, __ATOMIC_RELEASE);
+
+  refillFillRing();
+  return numPackets;
+}
+
+uint32_t XskReceiver::getNumHeldFrames() const {
+  return umem_ ? umem_->numHeld.load() : 0;
+}
+
+void XskReceiver::recycleFrame(void* buf, void* userData) {
+  auto* umem = static_cast<Umem*>(userData);
+  uint64_t frameAddr = static_cast<uint8_t*>(buf) - umem->area;
+  std::unique_lock<std::mutex> guard(umem->mutex);
+  umem->returnedFrames.push_back(frameAddr);
+  if (umem->numHeld.fetch_sub(1) == 1 && !umem->receiverAlive) {
+    guard.unlock();
+    delete umem;
+  }
+}
+
+void XskReceiver::reclaimFrames() {
+  {
+    std::lock_guard<std::mutex> guard(umem_->mutex);
+    reclaimedFrames_.swap(umem_->returnedFrames);
+  }
+  freeFrames_.insert(
+      freeFrames_.end(), reclaimedFrames_.begin(), reclaimedFrames_.end());
+  reclaimedFrames_.clear();
+}
+
+void XskReceiver::refillFillRing() {
+  if (!freeFrames_.empty()) {
+    auto* baseDesc = (uint64_t*)((char*)fillMap_ + xskOffsets_.fr.desc);
+    for (uint64_t frameAddr : freeFrames_) {
+      baseDesc[fillProducerIndex_ & (config_.numFrames - 1)] = frameAddr;
+      fillProducerIndex_++;
+    }
+    freeFrames_.clear();
+    auto* producerPtr = (uint32_t*)((char*)fillMap_ + xskOffsets_.fr.producer);
+    __atomic_store_n(producerPtr, fillProducerIndex_, __ATOMIC_RELEASE);
+  }
+
+  if (!config_.useNeedWakeup) {
+    return;
+  }
+  auto* flagsPtr = (uint32_t*)((char*)fillMap_ + xskOffsets_.fr.flags);
+  uint32_t flags = __atomic_load_n(flagsPtr, __ATOMIC_ACQUIRE);
+  if (flags & XDP_RING_NEED_WAKEUP) {
+    // Has the driver pick up the fill ring again.
+    int ret = ::recvfrom(xskFd_, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+    if (ret < 0 && errno != EAGAIN && errno != EBUSY) {
+      MVVLOG(4) << "Failed to wake up the AF_XDP socket for receiving";
+    }
+  }
+}
+
+} // namespace facebook::xdpsocket
+
+#endif
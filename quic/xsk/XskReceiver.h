@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#if defined(__linux__) && !defined(ANDROID)
+
+#include <quic/common/Expected.h>
+#include <quic/common/NetworkData.h>
+#include <quic/common/Optional.h>
+#include <quic/xsk/xsk_lib.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace facebook::xdpsocket {
+
+struct XskReceiverConfig {
+  std::string interfaceName;
+  uint32_t queueId{0};
+  // Both must be powers of 2. The fill and RX rings hold numFrames entries.
+  uint32_t numFrames;
+  uint32_t frameSize;
+  // Most packets one receive() call returns.
+  uint32_t batchSize;
+  // UDP port packets must be sent to, 0 accepts any.
+  uint16_t port{0};
+  // XSKMAP the socket registers itself in at queueId, or -1 when the XDP
+  // program redirecting to it is set up otherwise.
+  int xskMapFd{-1};
+  bool zeroCopyEnabled{false};
+  bool useNeedWakeup{true};
+};
+
+struct ParsedUdpFrame {
+  quic::SocketAddress peerAddress;
+  uint16_t dstPort;
+  uint8_t tosValue;
+  // Where the UDP payload starts in the frame, and its length.
+  uint16_t payloadOffset;
+  uint16_t payloadLength;
+};
+
+/**
+ * Validates the Ethernet, IP and UDP headers of a received frame. Returns
+ * nothing for anything but an unfragmented UDP datagram over IPv4 or IPv6
+ * without extension headers whose lengths are consistent with the frame. UDP
+ * checksums are not verified, the AEAD rejects corrupted QUIC packets anyway.
+ */
+quic::Optional<ParsedUdpFrame> parseUdpFrame(const uint8_t* frame, uint32_t len);
+
+/**
+ * Receives UDP datagrams over an AF_XDP socket bound to one queue of an
+ * interface. The payload of each datagram is handed out in an IOBuf that
+ * points into its UMEM frame, so nothing is copied on the way to the
+ * transport. The frame goes back to the fill ring once the last IOBuf
+ * referencing it is freed, which may happen on any thread.
+ *
+ * Transports may hold on to received data, e.g. out of order stream data.
+ * So that the fill ring never runs dry, packets are copied out of their
+ * frame while more than half of the frames are held.
+ *
+ * Not thread safe, receive() must always be called from the same thread.
+ */
+class XskReceiver {
+ public:
+  explicit XskReceiver(XskReceiverConfig config);
+
+  // Frames still held stay valid until they are freed.
+  ~XskReceiver();
+
+  XskReceiver(const XskReceiver&) = delete;
+  XskReceiver& operator=(const XskReceiver&) = delete;
+
+  quic::Expected<void, std::runtime_error> init();
+
+  // Readable when the RX ring has packets.
+  [[nodiscard]] int getFd() const {
+    return xskFd_;
+  }
+
+  /**
+   * Appends up to batchSize packets from the RX ring to packets, with their
+   * peerAddress and receive time set. Returns how many were appended.
+   * Frames that fail validation are dropped.
+   */
+  size_t receive(std::vector<quic::ReceivedUdpPacket>& packets);
+
+  [[nodiscard]] uint64_t getNumReceived() const {
+    return numReceived_;
+  }
+
+  [[nodiscard]] uint64_t getNumDropped() const {
+    return numDropped_;
+  }
+
+  [[nodiscard]] uint64_t getNumCopied() const {
+    return numCopied_;
+  }
+
+  // Frames handed out with a packet and not freed yet.
+  [[nodiscard]] uint32_t getNumHeldFrames() const;
+
+ private:
+  // The UMEM area and the frames returned to it, shared with every IOBuf
+  // pointing into it. Deleted by the last of them and the receiver.
+  struct Umem;
+
+  static void recycleFrame(void* buf, void* userData);
+
+  void reclaimFrames();
+
+  void refillFillRing();
+
+  XskReceiverConfig config_;
+  Umem* umem_{nullptr};
+  int xskFd_{-1};
+  xdp_mmap_offsets xskOffsets_{};
+  void* fillMap_{nullptr};
+  void* rxMap_{nullptr};
+  uint32_t fillProducerIndex_{0};
+  uint32_t rxConsumerIndex_{0};
+  // Frames that are neither in the fill ring nor held.
+  std::vector<uint64_t> freeFrames_;
+  std::vector<uint64_t> reclaimedFrames_;
+  uint64_t numReceived_{0};
+  uint64_t numDropped_{0};
+  uint64_t numCopied_{0};
+};
+
+} // namespace facebook::xdpsocket
+
+#endif
@@ -229,6 +229,11 @@ SendResult XskSender::writeUdpPacket(
   return writeUdpPacket(peer, src, data->data(), len);
 }
 
+uint32_t XskSender::getMaxPayloadLength(bool isIpV6) const {
+  return xskSenderConfig_.frameSize - txMetadataLen_ - sizeof(udphdr) -
+      (isIpV6 ? sizeof(ipv6hdr) : sizeof(iphdr)) - sizeof(ethhdr);
+}
+
 quic::Expected<void, std::runtime_error> XskSender::init() {
   checksumOffloadEnabled_ = xskSenderConfig_.useChecksumOffload &&
       quic::isLinuxKernelAtLeast(kMinKernelForTxMetadata);
@@ -246,20 +251,33 @@ quic::Expected<void, std::runtime_error> XskSender::init() {
 }
 
 quic::Expected<void, std::runtime_error> XskSender::bind(int queueId) {
+  if (xskSenderConfig_.interfaceName.empty()) {
+    MVLOG_ERROR << "Not binding xdp socket to queue " << queueId
+                << ": XskSenderConfig::interfaceName is empty";
+    return quic::make_unexpected(
+        std::runtime_error("XskSenderConfig::interfaceName must be set"));
+  }
   int bind_result = 0;
   if (isPrimaryOwner()) {
     bind_result = bind_xsk(
         xskFd_,
+        xskSenderConfig_.interfaceName.c_str(),
         queueId,
         xskSenderConfig_.zeroCopyEnabled,
         xskSenderConfig_.useNeedWakeup);
   } else {
     bind_result = bind_xsk_shared_umem(
-        xskFd_, queueId, xskSenderConfig_.sharedState->sharedXskFd);
+        xskFd_,
+        xskSenderConfig_.interfaceName.c_str(),
+        queueId,
+        xskSenderConfig_.sharedState->sharedXskFd);
   }
   if (bind_result < 0) {
-    std::string errorMsg =
-        fmt::format("Failed to bind xdp socket: {}", quic::errnoStr(errno));
+    std::string errorMsg = fmt::format(
+        "Failed to bind xdp socket to {} queue {}: {}",
+        xskSenderConfig_.interfaceName,
+        queueId,
+        quic::errnoStr(errno));
     return quic::make_unexpected(std::runtime_error(errorMsg));
   }
 
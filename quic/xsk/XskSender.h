@@ -23,6 +23,7 @@
 #include <quic/xsk/xsk_lib.h>
 #include <queue>
 #include <stdexcept>
+#include <string>
 
 namespace facebook::xdpsocket {
 
@@ -93,6 +94,11 @@ struct XskSenderConfig {
   // Set this to true if we're using one AF_XDP socket per thread. This
   // will ensure that we do no locking apart from UMEM sharing use cases.
   bool xskPerThread{false};
+
+  // Interface the socket is bound to. Must be set: there is no default, and
+  // bind() fails when it is empty. Before this field existed, sockets were
+  // always bound to eth0.
+  std::string interfaceName;
 };
 
 class XskSender {
@@ -145,6 +151,10 @@ class XskSender {
       std::unique_ptr<folly::IOBuf>& data,
       uint16_t len);
 
+  // Largest UDP payload that fits a UMEM frame behind the headers. Only
+  // valid after init().
+  [[nodiscard]] uint32_t getMaxPayloadLength(bool isIpV6) const;
+
   quic::Expected<void, std::runtime_error> init();
 
   quic::Expected<void, std::runtime_error> bind(int queueId);
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#if defined(__linux__) && !defined(ANDROID)
+
+#include <quic/xsk/XskServerIngress.h>
+
+namespace facebook::xdpsocket {
+
+XskServerIngress::XskServerIngress(
+    folly::EventBase* evb,
+    quic::QuicServerWorker& worker,
+    std::unique_ptr<XskReceiver> xskReceiver)
+    : folly::EventHandler(evb),
+      worker_(worker),
+      xskReceiver_(std::move(xskReceiver)) {}
+
+XskServerIngress::~XskServerIngress() {
+  unregisterHandler();
+}
+
+void XskServerIngress::start() {
+  changeHandlerFD(folly::NetworkSocket::fromFd(xskReceiver_->getFd()));
+  registerHandler(folly::EventHandler::READ | folly::EventHandler::PERSIST);
+}
+
+void XskServerIngress::handlerReady(uint16_t /*events*/) noexcept {
+  // One batch per wakeup, the fd stays readable while the RX ring has more.
+  if (xskReceiver_->receive(packets_) == 0) {
+    return;
+  }
+  worker_.handleReceivedPackets(packets_);
+  // Drops what the transports didn't take, returning its frames.
+  packets_.clear();
+}
+
+} // namespace facebook::xdpsocket
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#if defined(__linux__) && !defined(ANDROID)
+
+#include <folly/io/async/EventHandler.h>
+#include <quic/server/QuicServerWorker.h>
+#include <quic/xsk/XskReceiver.h>
+
+#include <memory>
+#include <vector>
+
+namespace facebook::xdpsocket {
+
+/**
+ * Feeds a QuicServerWorker the packets of an XskReceiver, next to what it
+ * reads from its listening socket. Runs on the worker's event base: the
+ * receiver's fd is watched there and every time it is readable one batch is
+ * received and handed to QuicServerWorker::handleReceivedPackets().
+ *
+ * Create and destroy it on the worker's thread, e.g. with
+ * QuicServer::runOnAllWorkersSync(), and destroy it before the worker.
+ */
+class XskServerIngress : public folly::EventHandler {
+ public:
+  XskServerIngress(
+      folly::EventBase* evb,
+      quic::QuicServerWorker& worker,
+      std::unique_ptr<XskReceiver> xskReceiver);
+
+  ~XskServerIngress() override;
+
+  XskServerIngress(const XskServerIngress&) = delete;
+  XskServerIngress& operator=(const XskServerIngress&) = delete;
+
+  // xskReceiver has to be initialized.
+  void start();
+
+  void handlerReady(uint16_t events) noexcept override;
+
+  [[nodiscard]] const XskReceiver& getXskReceiver() const {
+    return *xskReceiver_;
+  }
+
+ private:
+  quic::QuicServerWorker& worker_;
+  std::unique_ptr<XskReceiver> xskReceiver_;
+  // Reused across batches.
+  std::vector<quic::ReceivedUdpPacket> packets_;
+};
+
+} // namespace facebook::xdpsocket
+
+#endif
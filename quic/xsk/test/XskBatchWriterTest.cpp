@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#if defined(__linux__) && !defined(ANDROID)
+
+#include <quic/xsk/XskBatchWriter.h>
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+#include <netinet/in.h>
+#include <quic/common/udpsocket/test/QuicAsyncUDPSocketMock.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace facebook::xdpsocket;
+using namespace testing;
+
+namespace {
+
+// Hands out the one XskSender init() binds to a queue, or none before that.
+class FixedXskContainer : public BaseXskContainer {
+ public:
+  quic::Expected<void, std::runtime_error> init(
+      const XskContainerConfig& xskContainerConfig) override {
+    XskSenderConfig xskSenderConfig{
+        .numFrames = xskContainerConfig.numFrames,
+        .frameSize = xskContainerConfig.frameSize,
+        .batchSize = xskContainerConfig.batchSize,
+        .ownerId = 0,
+        .numOwners = 1,
+        .localMac = xskContainerConfig.localMac,
+        .gatewayMac = xskContainerConfig.gatewayMac,
+        .zeroCopyEnabled = xskContainerConfig.zeroCopyEnabled,
+        .useNeedWakeup = xskContainerConfig.useNeedWakeup,
+        .useChecksumOffload = xskContainerConfig.useChecksumOffload,
+        .sharedState = std::make_shared<SharedState>(1),
+        .interfaceName = xskContainerConfig.interfaceName};
+    auto createResult = createXskSender(queueId_, xskSenderConfig);
+    if (createResult.hasError()) {
+      return quic::make_unexpected(createResult.error());
+    }
+    xskSender_ = std::move(createResult.value());
+    return {};
+  }
+
+  XskSender* pickXsk(
+      const quic::SocketAddress& /*src*/,
+      const quic::SocketAddress& /*dst*/) override {
+    numPicks++;
+    return xskSender_.get();
+  }
+
+  void setQueueId(int queueId) {
+    queueId_ = queueId;
+  }
+
+  uint64_t numPicks{0};
+
+ private:
+  int queueId_{0};
+  std::unique_ptr<XskSender> xskSender_;
+};
+
+std::string getEnv(const char* name) {
+  const char* value = std::getenv(name);
+  return value ? value : "";
+}
+
+} // namespace
+
+class XskBatchWriterTest : public Test {
+ protected:
+  void SetUp() override {
+    ON_CALL(sock_, address()).WillByDefault(Return(localAddr_));
+  }
+
+  quic::SocketAddress localAddr_{"10.0.0.1", 4433};
+  quic::SocketAddress peerAddr_{"10.0.0.2", 5000};
+  std::shared_ptr<FixedXskContainer> container_{
+      std::make_shared<FixedXskContainer>()};
+  NiceMock<quic::test::QuicAsyncUDPSocketMock> sock_;
+};
+
+TEST_F(XskBatchWriterTest, FallsBackToSocketWithoutXsk) {
+  XskBatchWriter writer(container_, 4);
+  EXPECT_TRUE(writer.empty());
+  EXPECT_FALSE(writer.append(
+      folly::IOBuf::copyBuffer("hello"), 5, peerAddr_, &sock_));
+  EXPECT_FALSE(writer.append(
+      folly::IOBuf::copyBuffer("quic!"), 5, peerAddr_, &sock_));
+  EXPECT_EQ(container_->numPicks, 2);
+  EXPECT_EQ(writer.numXskPackets(), 0);
+  EXPECT_EQ(writer.numFallbackPackets(), 2);
+  EXPECT_FALSE(writer.empty());
+  EXPECT_EQ(writer.size(), 10);
+
+  EXPECT_CALL(sock_, writem(_, _, _, 2)).WillOnce(Return(2));
+  EXPECT_EQ(writer.write(sock_, peerAddr_), 10);
+  writer.reset();
+  EXPECT_TRUE(writer.empty());
+}
+
+TEST_F(XskBatchWriterTest, FallbackFlushesWhenFull) {
+  XskBatchWriter writer(container_, 2);
+  EXPECT_FALSE(writer.append(
+      folly::IOBuf::copyBuffer("hello"), 5, peerAddr_, &sock_));
+  EXPECT_TRUE(writer.append(
+      folly::IOBuf::copyBuffer("quic!"), 5, peerAddr_, &sock_));
+}
+
+TEST_F(XskBatchWriterTest, WildcardAddressSkipsXsk) {
+  ON_CALL(sock_, address())
+      .WillByDefault(Return(quic::SocketAddress("0.0.0.0", 4433)));
+  XskBatchWriter writer(container_, 4);
+  EXPECT_FALSE(writer.append(
+      folly::IOBuf::copyBuffer("hello"), 5, peerAddr_, &sock_));
+  EXPECT_EQ(container_->numPicks, 0);
+  EXPECT_EQ(writer.numFallbackPackets(), 1);
+
+  EXPECT_CALL(sock_, write(peerAddr_, _, 1)).WillOnce(Return(5));
+  EXPECT_EQ(writer.write(sock_, peerAddr_), 5);
+}
+
+TEST_F(XskBatchWriterTest, FactoryPrefersNextAndChainedMemory) {
+  quic::QuicConnectionStateBase conn(quic::QuicNodeType::Server);
+  bool nextCalled = false;
+  auto factory = makeXskBatchWriterFactory(
+      container_,
+      [&](const quic::QuicBatchingMode&,
+          uint32_t,
+          quic::DataPathType,
+          quic::QuicConnectionStateBase&,
+          bool) -> quic::BatchWriterPtr {
+        nextCalled = true;
+        return nullptr;
+      });
+  auto batchWriter = factory(
+      quic::QuicBatchingMode::BATCHING_MODE_NONE,
+      1,
+      quic::DataPathType::ChainedMemory,
+      conn,
+      false);
+  EXPECT_TRUE(nextCalled);
+  EXPECT_NE(dynamic_cast<XskBatchWriter*>(batchWriter.get()), nullptr);
+
+  EXPECT_EQ(
+      factory(
+          quic::QuicBatchingMode::BATCHING_MODE_NONE,
+          1,
+          quic::DataPathType::ContinuousMemory,
+          conn,
+          false),
+      nullptr);
+}
+
+/**
+ * Sends over a real AF_XDP socket. Needs CAP_NET_ADMIN and a veth pair, and
+ * is skipped unless MVFST_XSK_TEST_INTERFACE is set, e.g. in a network
+ * namespace set up with
+ *
+ *   ip link add veth0 type veth peer name veth1
+ *   ip addr add 10.11.0.1/24 dev veth0 && ip link set veth0 up
+ *   ip addr add 10.11.0.2/24 dev veth1 && ip link set veth1 up
+ *   sysctl -w net.ipv4.conf.veth1.accept_local=1
+ *
+ * and MVFST_XSK_TEST_INTERFACE=veth0, MVFST_XSK_TEST_LOCAL_IP=10.11.0.1,
+ * MVFST_XSK_TEST_PEER_IP=10.11.0.2 and the MAC addresses of veth0 and veth1
+ * in MVFST_XSK_TEST_LOCAL_MAC and MVFST_XSK_TEST_PEER_MAC.
+ */
+class XskBatchWriterVethTest : public XskBatchWriterTest {
+ protected:
+  void SetUp() override {
+    auto interfaceName = getEnv("MVFST_XSK_TEST_INTERFACE");
+    if (interfaceName.empty()) {
+      GTEST_SKIP() << "MVFST_XSK_TEST_INTERFACE is not set";
+    }
+    localAddr_ = quic::SocketAddress(getEnv("MVFST_XSK_TEST_LOCAL_IP"), 4433);
+    ON_CALL(sock_, address()).WillByDefault(Return(localAddr_));
+
+    receiver_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(receiver_, 0);
+    timeval timeout{.tv_sec = 1, .tv_usec = 0};
+    ::setsockopt(
+        receiver_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    receiverAddr_ = quic::SocketAddress(getEnv("MVFST_XSK_TEST_PEER_IP"), 0);
+    sockaddr_storage storage{};
+    auto len = receiverAddr_.getAddress(&storage);
+    ASSERT_EQ(
+        ::bind(receiver_, reinterpret_cast<sockaddr*>(&storage), len), 0);
+    receiverAddr_.setFromLocalAddress(receiver_);
+
+    container_->setQueueId(0);
+    auto initResult = container_->init(XskContainerConfig{
+        .interfaceName = interfaceName,
+        .localMac = folly::MacAddress(getEnv("MVFST_XSK_TEST_LOCAL_MAC")),
+        .gatewayMac = folly::MacAddress(getEnv("MVFST_XSK_TEST_PEER_MAC")),
+        .numFrames = 64,
+        .frameSize = 4096,
+        .batchSize = 16,
+        .numSockets = 1,
+        .zeroCopyEnabled = false});
+    ASSERT_FALSE(initResult.hasError()) << initResult.error().what();
+  }
+
+  void TearDown() override {
+    if (receiver_ >= 0) {
+      ::close(receiver_);
+    }
+  }
+
+  std::string receive() {
+    char received[2048];
+    auto receivedLen = ::recv(receiver_, received, sizeof(received), 0);
+    return receivedLen > 0 ? std::string(received, receivedLen) : "";
+  }
+
+  int receiver_{-1};
+  quic::SocketAddress receiverAddr_;
+};
+
+TEST_F(XskBatchWriterVethTest, CopiesChainIntoFrame) {
+  XskBatchWriter writer(container_, 16);
+  // A chain, to check the payload is copied across buffers.
+  auto buf = folly::IOBuf::copyBuffer("hello ");
+  buf->appendToChain(folly::IOBuf::copyBuffer("xsk"));
+  EXPECT_FALSE(writer.append(std::move(buf), 9, receiverAddr_, &sock_));
+  EXPECT_EQ(writer.numXskPackets(), 1);
+  EXPECT_EQ(writer.write(sock_, receiverAddr_), 9);
+  writer.reset();
+  EXPECT_EQ(receive(), "hello xsk");
+}
+
+TEST_F(XskBatchWriterVethTest, BuildsInFrame) {
+  quic::QuicConnectionStateBase conn(quic::QuicNodeType::Server);
+  quic::BufAccessor connAccessor(quic::kDefaultUDPSendPacketLen);
+  conn.bufAccessor = &connAccessor;
+  auto* xsk = container_->pickXsk(localAddr_, receiverAddr_);
+  ASSERT_NE(xsk, nullptr);
+  auto frame = xsk->getXskBuffer(false /* isIpV6 */);
+  ASSERT_TRUE(frame.has_value());
+  {
+    XskInplaceBatchWriter writer(conn, *xsk, *frame, localAddr_);
+    ASSERT_NE(conn.bufAccessor, &connAccessor);
+    for (const std::string payload : {"first", "second"}) {
+      // What the packet builder does with the connection's bufAccessor.
+      EXPECT_EQ(conn.bufAccessor->headroom(), 0);
+      std::memcpy(
+          conn.bufAccessor->writableTail(), payload.data(), payload.size());
+      conn.bufAccessor->append(payload.size());
+      EXPECT_FALSE(
+          writer.append(nullptr, payload.size(), receiverAddr_, &sock_));
+    }
+    EXPECT_EQ(writer.numXskPackets(), 2);
+    EXPECT_EQ(writer.write(sock_, receiverAddr_), 11);
+    writer.reset();
+    EXPECT_EQ(conn.bufAccessor->length(), 0);
+  }
+  EXPECT_EQ(conn.bufAccessor, &connAccessor);
+  EXPECT_EQ(receive(), "first");
+  EXPECT_EQ(receive(), "second");
+}
+
+#endif
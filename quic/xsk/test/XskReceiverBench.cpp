@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#if defined(__linux__) && !defined(ANDROID)
+
+#include <folly/Benchmark.h>
+#include <folly/io/IOBuf.h>
+#include <quic/common/MvfstLogging.h>
+#include <quic/xsk/XskReceiver.h>
+#include <quic/xsk/packet_utils.h>
+
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <array>
+#include <vector>
+
+using namespace facebook::xdpsocket;
+
+namespace {
+// Packets per recvmmsg() call or XskReceiver::receive() batch.
+constexpr size_t kBatchSize = 16;
+// A full size QUIC packet.
+constexpr size_t kPayloadSize = 1252;
+constexpr size_t kFrameSize = 2048;
+
+void noopFree(void* /*buf*/, void* /*userData*/) {}
+
+// kBatchSize Ethernet frames laid out like in a UMEM.
+std::vector<uint8_t> makeUmem() {
+  std::vector<uint8_t> umem(kBatchSize * kFrameSize);
+  quic::SocketAddress src("10.0.0.2", 5000);
+  quic::SocketAddress dst("10.0.0.1", 4433);
+  std::array<char, kPayloadSize> payload{};
+  uint16_t udpLen = sizeof(udphdr) + kPayloadSize;
+  for (size_t i = 0; i < kBatchSize; i++) {
+    auto* buffer = reinterpret_cast<char*>(umem.data() + i * kFrameSize);
+    ethhdr eth{};
+    eth.h_proto = htons(ETH_P_IP);
+    writeMacHeader(&eth, buffer);
+    iphdr ip{};
+    ip.version = 4;
+    ip.ihl = 5;
+    ip.protocol = IPPROTO_UDP;
+    ip.ttl = 64;
+    writeIpHeader(dst.getIPAddress(), src.getIPAddress(), &ip, udpLen, buffer);
+    writeUdpHeader(src.getPort(), dst.getPort(), 0, udpLen, buffer);
+    writeUdpPayload(payload.data(), payload.size(), buffer);
+  }
+  return umem;
+}
+} // namespace
+
+// What the worker's listening socket does per packet: recvmmsg() into read
+// buffers and an IOBuf per datagram, over loopback. Includes the sendmmsg()
+// feeding it.
+BENCHMARK(recvmmsg_loopback, iters) {
+  folly::BenchmarkSuspender suspender;
+  int receiver = ::socket(AF_INET, SOCK_DGRAM, 0);
+  int sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  MVCHECK(
+      ::bind(receiver, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+  socklen_t addrLen = sizeof(addr);
+  ::getsockname(receiver, reinterpret_cast<sockaddr*>(&addr), &addrLen);
+  MVCHECK(
+      ::connect(sender, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) ==
+      0);
+
+  std::array<char, kPayloadSize> payload{};
+  std::array<iovec, kBatchSize> sendIov;
+  std::array<mmsghdr, kBatchSize> sendMsgs{};
+  for (size_t i = 0; i < kBatchSize; i++) {
+    sendIov[i] = {payload.data(), payload.size()};
+    sendMsgs[i].msg_hdr.msg_iov = &sendIov[i];
+    sendMsgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  std::vector<std::unique_ptr<folly::IOBuf>> readBufs(kBatchSize);
+  std::array<iovec, kBatchSize> recvIov;
+  std::array<sockaddr_storage, kBatchSize> peers;
+  std::array<mmsghdr, kBatchSize> recvMsgs{};
+  suspender.dismiss();
+
+  for (size_t done = 0; done < iters; done += kBatchSize) {
+    MVCHECK(
+        ::sendmmsg(sender, sendMsgs.data(), kBatchSize, 0) ==
+        static_cast<int>(kBatchSize));
+    for (size_t i = 0; i < kBatchSize; i++) {
+      readBufs[i] = folly::IOBuf::create(kFrameSize);
+      recvIov[i] = {readBufs[i]->writableData(), kFrameSize};
+      recvMsgs[i].msg_hdr.msg_name = &peers[i];
+      recvMsgs[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+      recvMsgs[i].msg_hdr.msg_iov = &recvIov[i];
+      recvMsgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int received = 0;
+    while (received < static_cast<int>(kBatchSize)) {
+      int ret = ::recvmmsg(
+          receiver,
+          recvMsgs.data() + received,
+          kBatchSize - received,
+          0,
+          nullptr);
+      MVCHECK(ret > 0);
+      received += ret;
+    }
+    for (size_t i = 0; i < kBatchSize; i++) {
+      readBufs[i]->append(recvMsgs[i].msg_len);
+      folly::doNotOptimizeAway(readBufs[i]);
+    }
+  }
+
+  suspender.rehire();
+  ::close(sender);
+  ::close(receiver);
+}
+
+// What XskReceiver does per packet once the kernel put it in a UMEM frame:
+// validate the headers and wrap the payload in place.
+BENCHMARK_RELATIVE(xsk_parse_and_wrap, iters) {
+  folly::BenchmarkSuspender suspender;
+  auto umem = makeUmem();
+  std::vector<std::unique_ptr<folly::IOBuf>> bufs(kBatchSize);
+  suspender.dismiss();
+
+  for (size_t done = 0; done < iters; done += kBatchSize) {
+    for (size_t i = 0; i < kBatchSize; i++) {
+      auto* frame = umem.data() + i * kFrameSize;
+      auto parsed = parseUdpFrame(frame, kFrameSize);
+      MVCHECK(parsed.has_value());
+      bufs[i] = folly::IOBuf::takeOwnership(
+          frame,
+          kFrameSize,
+          parsed->payloadOffset,
+          parsed->payloadLength,
+          noopFree);
+      folly::doNotOptimizeAway(bufs[i]);
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
+
+#endif
@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#if defined(__linux__) && !defined(ANDROID)
+
+#include <quic/xsk/XskReceiver.h>
+
+#include <folly/portability/GTest.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <quic/xsk/XskSender.h>
+#include <quic/xsk/packet_utils.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace facebook::xdpsocket;
+
+namespace {
+
+// An Ethernet frame carrying payload from src to dst.
+std::vector<uint8_t> buildFrame(
+    const quic::SocketAddress& src,
+    const quic::SocketAddress& dst,
+    const std::string& payload) {
+  bool isV6 = dst.getIPAddress().isV6();
+  std::vector<uint8_t> frame(
+      sizeof(ethhdr) + (isV6 ? sizeof(ipv6hdr) : sizeof(iphdr)) +
+      sizeof(udphdr) + payload.size());
+  auto* buffer = reinterpret_cast<char*>(frame.data());
+  ethhdr eth{};
+  eth.h_proto = htons(isV6 ? ETH_P_IPV6 : ETH_P_IP);
+  writeMacHeader(&eth, buffer);
+  uint16_t udpLen = sizeof(udphdr) + payload.size();
+  if (isV6) {
+    ipv6hdr ip{};
+    ip.version = 6;
+    ip.priority = 0xb;
+    ip.flow_lbl[0] = 0x80;
+    ip.nexthdr = IPPROTO_UDP;
+    ip.hop_limit = 64;
+    writeIpHeader(dst.getIPAddress(), src.getIPAddress(), &ip, udpLen, buffer);
+  } else {
+    iphdr ip{};
+    ip.version = 4;
+    ip.ihl = 5;
+    ip.tos = 0xb8;
+    ip.protocol = IPPROTO_UDP;
+    ip.ttl = 64;
+    ip.frag_off = htons(0x4000);
+    writeIpHeader(dst.getIPAddress(), src.getIPAddress(), &ip, udpLen, buffer);
+  }
+  writeUdpHeader(src.getPort(), dst.getPort(), 0, udpLen, buffer);
+  writeUdpPayload(payload.data(), payload.size(), buffer);
+  return frame;
+}
+
+std::string getEnv(const char* name) {
+  const char* value = std::getenv(name);
+  return value ? value : "";
+}
+
+int bpf(int cmd, bpf_attr& attr) {
+  return syscall(__NR_bpf, cmd, &attr, sizeof(attr));
+}
+
+// Redirects every packet of an interface to the AF_XDP socket of its queue in
+// an XSKMAP, or lets it pass when the queue has none. Attached in generic
+// mode, which veth supports without any driver setup.
+class XdpRedirectProgram {
+ public:
+  ~XdpRedirectProgram() {
+    for (int fd : {linkFd_, progFd_, mapFd_}) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+  }
+
+  bool attach(const std::string& interfaceName) {
+    bpf_attr mapAttr{};
+    mapAttr.map_type = BPF_MAP_TYPE_XSKMAP;
+    mapAttr.key_size = sizeof(uint32_t);
+    mapAttr.value_size = sizeof(uint32_t);
+    mapAttr.max_entries = 64;
+    mapFd_ = bpf(BPF_MAP_CREATE, mapAttr);
+    if (mapFd_ < 0) {
+      return false;
+    }
+
+    bpf_insn insns[] = {
+        // r2 = ctx->rx_queue_index
+        {.code = BPF_LDX | BPF_MEM | BPF_W,
+         .dst_reg = BPF_REG_2,
+         .src_reg = BPF_REG_1,
+         .off = offsetof(xdp_md, rx_queue_index)},
+        // r1 = map
+        {.code = BPF_LD | BPF_DW | BPF_IMM,
+         .dst_reg = BPF_REG_1,
+         .src_reg = BPF_PSEUDO_MAP_FD,
+         .imm = mapFd_},
+        {},
+        // r3 = XDP_PASS, what bpf_redirect_map() returns without a socket
+        {.code = BPF_ALU64 | BPF_MOV | BPF_K, .dst_reg = BPF_REG_3, .imm = 2},
+        {.code = BPF_JMP | BPF_CALL, .imm = BPF_FUNC_redirect_map},
+        {.code = BPF_JMP | BPF_EXIT},
+    };
+    const char license[] = "GPL";
+    bpf_attr progAttr{};
+    progAttr.prog_type = BPF_PROG_TYPE_XDP;
+    progAttr.insns = reinterpret_cast<uintptr_t>(insns);
+    progAttr.insn_cnt = sizeof(insns) / sizeof(insns[0]);
+    progAttr.license = reinterpret_cast<uintptr_t>(license);
+    progFd_ = bpf(BPF_PROG_LOAD, progAttr);
+    if (progFd_ < 0) {
+      return false;
+    }
+
+    bpf_attr linkAttr{};
+    linkAttr.link_create.prog_fd = progFd_;
+    linkAttr.link_create.target_ifindex = if_nametoindex(interfaceName.c_str());
+    linkAttr.link_create.attach_type = BPF_XDP;
+    linkAttr.link_create.flags = XDP_FLAGS_SKB_MODE;
+    linkFd_ = bpf(BPF_LINK_CREATE, linkAttr);
+    return linkFd_ >= 0;
+  }
+
+  [[nodiscard]] int getMapFd() const {
+    return mapFd_;
+  }
+
+ private:
+  int mapFd_{-1};
+  int progFd_{-1};
+  int linkFd_{-1};
+};
+
+} // namespace
+
+class ParseUdpFrameTest : public ::testing::Test {
+ protected:
+  quic::SocketAddress peerV4_{"10.0.0.2", 5000};
+  quic::SocketAddress localV4_{"10.0.0.1", 4433};
+  quic::SocketAddress peerV6_{"2001:db8::2", 5000};
+  quic::SocketAddress localV6_{"2001:db8::1", 4433};
+};
+
+TEST_F(ParseUdpFrameTest, IPv4) {
+  auto frame = buildFrame(peerV4_, localV4_, "hello");
+  auto parsed = parseUdpFrame(frame.data(), frame.size());
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->peerAddress, peerV4_);
+  EXPECT_EQ(parsed->dstPort, 4433);
+  EXPECT_EQ(parsed->tosValue, 0xb8);
+  EXPECT_EQ(parsed->payloadLength, 5);
+  EXPECT_EQ(
+      std::string(
+          reinterpret_cast<const char*>(frame.data()) + parsed->payloadOffset,
+          parsed->payloadLength),
+      "hello");
+}
+
+TEST_F(ParseUdpFrameTest, IPv6) {
+  auto frame = buildFrame(peerV6_, localV6_, "hello");
+  auto parsed = parseUdpFrame(frame.data(), frame.size());
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->peerAddress, peerV6_);
+  EXPECT_EQ(parsed->dstPort, 4433);
+  EXPECT_EQ(parsed->tosValue, 0xb8);
+  EXPECT_EQ(parsed->payloadOffset, frame.size() - 5);
+  EXPECT_EQ(parsed->payloadLength, 5);
+}
+
+TEST_F(ParseUdpFrameTest, IgnoresPadding) {
+  // Short frames are padded to the Ethernet minimum.
+  auto frame = buildFrame(peerV4_, localV4_, "hi");
+  frame.resize(60);
+  auto parsed = parseUdpFrame(frame.data(), frame.size());
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->payloadLength, 2);
+}
+
+TEST_F(ParseUdpFrameTest, RejectsTruncated) {
+  for (const auto& [peer, local] :
+       {std::make_pair(peerV4_, localV4_), std::make_pair(peerV6_, localV6_)}) {
+    auto frame = buildFrame(peer, local, "hello");
+    for (size_t len = 0; len < frame.size(); len++) {
+      EXPECT_FALSE(parseUdpFrame(frame.data(), len).has_value()) << len;
+    }
+  }
+}
+
+TEST_F(ParseUdpFrameTest, RejectsNonUdp) {
+  auto frame = buildFrame(peerV4_, localV4_, "hello");
+  reinterpret_cast<iphdr*>(frame.data() + sizeof(ethhdr))->protocol =
+      IPPROTO_TCP;
+  EXPECT_FALSE(parseUdpFrame(frame.data(), frame.size()).has_value());
+
+  frame = buildFrame(peerV6_, localV6_, "hello");
+  // A hop-by-hop options extension header.
+  reinterpret_cast<ipv6hdr*>(frame.data() + sizeof(ethhdr))->nexthdr = 0;
+  EXPECT_FALSE(parseUdpFrame(frame.data(), frame.size()).has_value());
+
+  frame = buildFrame(peerV4_, localV4_, "hello");
+  reinterpret_cast<ethhdr*>(frame.data())->h_proto = htons(ETH_P_ARP);
+  EXPECT_FALSE(parseUdpFrame(frame.data(), frame.size()).has_value());
+}
+
+TEST_F(ParseUdpFrameTest, RejectsFragments) {
+  auto frame = buildFrame(peerV4_, localV4_, "hello");
+  auto* ip = reinterpret_cast<iphdr*>(frame.data() + sizeof(ethhdr));
+  // More fragments.
+  ip->frag_off = htons(0x2000);
+  EXPECT_FALSE(parseUdpFrame(frame.data(), frame.size()).has_value());
+  // A later fragment.
+  ip->frag_off = htons(0x0010);
+  EXPECT_FALSE(parseUdpFrame(frame.data(), frame.size()).has_value());
+}
+
+TEST_F(ParseUdpFrameTest, RejectsBadUdpLength) {
+  auto frame = buildFrame(peerV4_, localV4_, "hello");
+  auto* udp = reinterpret_cast<udphdr*>(
+      frame.data() + sizeof(ethhdr) + sizeof(iphdr));
+  udp->len = htons(sizeof(udphdr) + 6);
+  EXPECT_FALSE(parseUdpFrame(frame.data(), frame.size()).has_value());
+  udp->len = htons(sizeof(udphdr) - 1);
+  EXPECT_FALSE(parseUdpFrame(frame.data(), frame.size()).has_value());
+}
+
+TEST(XskReceiverTest, RejectsFramesNotPowerOfTwo) {
+  XskReceiver xskReceiver(XskReceiverConfig{
+      .interfaceName = "lo",
+      .numFrames = 48,
+      .frameSize = 4096,
+      .batchSize = 16});
+  EXPECT_TRUE(xskReceiver.init().hasError());
+}
+
+/**
+ * Receives over a real AF_XDP socket. Needs CAP_NET_ADMIN, CAP_BPF and a veth
+ * pair set up as described in XskBatchWriterTest.cpp, and is skipped unless
+ * MVFST_XSK_TEST_INTERFACE and MVFST_XSK_TEST_PEER_INTERFACE are set. An XDP
+ * program on MVFST_XSK_TEST_INTERFACE redirects to the receiver what an
+ * XskSender on MVFST_XSK_TEST_PEER_INTERFACE sends.
+ */
+class XskReceiverVethTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto interfaceName = getEnv("MVFST_XSK_TEST_INTERFACE");
+    auto peerInterfaceName = getEnv("MVFST_XSK_TEST_PEER_INTERFACE");
+    if (interfaceName.empty() || peerInterfaceName.empty()) {
+      GTEST_SKIP() << "MVFST_XSK_TEST_INTERFACE or "
+                   << "MVFST_XSK_TEST_PEER_INTERFACE is not set";
+    }
+    localAddr_ = quic::SocketAddress(getEnv("MVFST_XSK_TEST_LOCAL_IP"), 4433);
+    peerAddr_ = quic::SocketAddress(getEnv("MVFST_XSK_TEST_PEER_IP"), 5000);
+
+    ASSERT_TRUE(xdpProgram_.attach(interfaceName));
+    xskReceiver_ = std::make_unique<XskReceiver>(XskReceiverConfig{
+        .interfaceName = interfaceName,
+        .queueId = 0,
+        .numFrames = kNumFrames,
+        .frameSize = 4096,
+        .batchSize = 16,
+        .port = 4433,
+        .xskMapFd = xdpProgram_.getMapFd()});
+    auto initResult = xskReceiver_->init();
+    ASSERT_FALSE(initResult.hasError()) << initResult.error().what();
+
+    xskSender_ = std::make_unique<XskSender>(XskSenderConfig{
+        .numFrames = 64,
+        .frameSize = 4096,
+        .batchSize = 16,
+        .ownerId = 0,
+        .numOwners = 1,
+        .localMac = folly::MacAddress(getEnv("MVFST_XSK_TEST_PEER_MAC")),
+        .gatewayMac = folly::MacAddress(getEnv("MVFST_XSK_TEST_LOCAL_MAC")),
+        .zeroCopyEnabled = false,
+        .useNeedWakeup = true,
+        .sharedState = std::make_shared<SharedState>(1),
+        .interfaceName = peerInterfaceName});
+    auto senderInitResult = xskSender_->init();
+    ASSERT_FALSE(senderInitResult.hasError())
+        << senderInitResult.error().what();
+    auto bindResult = xskSender_->bind(0);
+    ASSERT_FALSE(bindResult.hasError()) << bindResult.error().what();
+  }
+
+  void send(const std::string& payload, uint16_t port = 4433) {
+    quic::SocketAddress dst(localAddr_.getIPAddress(), port);
+    ASSERT_EQ(
+        xskSender_->writeUdpPacket(
+            dst, peerAddr_, payload.data(), payload.size()),
+        SendResult::SUCCESS);
+    ASSERT_EQ(xskSender_->flush(), FlushResult::SUCCESS);
+  }
+
+  // Polls until numPackets were received or a second passed.
+  std::vector<quic::ReceivedUdpPacket> receive(size_t numPackets) {
+    std::vector<quic::ReceivedUdpPacket> packets;
+    for (int i = 0; i < 1000 && packets.size() < numPackets; i++) {
+      if (xskReceiver_->receive(packets) == 0) {
+        ::usleep(1000);
+      }
+    }
+    return packets;
+  }
+
+  static constexpr uint32_t kNumFrames = 64;
+  quic::SocketAddress localAddr_;
+  quic::SocketAddress peerAddr_;
+  XdpRedirectProgram xdpProgram_;
+  std::unique_ptr<XskReceiver> xskReceiver_;
+  std::unique_ptr<XskSender> xskSender_;
+};
+
+TEST_F(XskReceiverVethTest, ReceivesFromUmem) {
+  send("hello");
+  send("xsk");
+  auto packets = receive(2);
+  ASSERT_EQ(packets.size(), 2);
+  EXPECT_EQ(packets[0].buf.front()->to<std::string>(), "hello");
+  EXPECT_EQ(packets[1].buf.front()->to<std::string>(), "xsk");
+  for (const auto& packet : packets) {
+    ASSERT_TRUE(packet.peerAddress.has_value());
+    EXPECT_EQ(*packet.peerAddress, peerAddr_);
+  }
+  EXPECT_EQ(xskReceiver_->getNumReceived(), 2);
+  EXPECT_EQ(xskReceiver_->getNumCopied(), 0);
+  EXPECT_EQ(xskReceiver_->getNumHeldFrames(), 2);
+
+  packets.clear();
+  EXPECT_EQ(xskReceiver_->getNumHeldFrames(), 0);
+}
+
+TEST_F(XskReceiverVethTest, DropsOtherPorts) {
+  send("other", 4434);
+  send("hello");
+  auto packets = receive(1);
+  ASSERT_EQ(packets.size(), 1);
+  EXPECT_EQ(packets[0].buf.front()->to<std::string>(), "hello");
+  EXPECT_EQ(xskReceiver_->getNumDropped(), 1);
+}
+
+TEST_F(XskReceiverVethTest, RecyclesFrames) {
+  // Several times as many packets as there are frames, so that every frame
+  // has to be recycled a few times.
+  for (uint32_t i = 0; i < kNumFrames * 4; i++) {
+    send(std::to_string(i));
+    auto packets = receive(1);
+    ASSERT_EQ(packets.size(), 1) << i;
+    EXPECT_EQ(packets[0].buf.front()->to<std::string>(), std::to_string(i));
+  }
+  EXPECT_EQ(xskReceiver_->getNumCopied(), 0);
+  EXPECT_EQ(xskReceiver_->getNumHeldFrames(), 0);
+}
+
+TEST_F(XskReceiverVethTest, CopiesWhileFramesAreHeld) {
+  std::vector<quic::ReceivedUdpPacket> held;
+  for (uint32_t i = 0; i < kNumFrames; i++) {
+    send(std::to_string(i));
+    auto packets = receive(1);
+    ASSERT_EQ(packets.size(), 1) << i;
+    held.push_back(std::move(packets[0]));
+  }
+  // Half of the frames stay on the fill ring.
+  EXPECT_EQ(xskReceiver_->getNumHeldFrames(), kNumFrames / 2);
+  EXPECT_EQ(xskReceiver_->getNumCopied(), kNumFrames / 2);
+  EXPECT_EQ(
+      held.back().buf.front()->to<std::string>(),
+      std::to_string(kNumFrames - 1));
+}
+
+#endif
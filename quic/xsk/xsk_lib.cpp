@@ -8,11 +8,14 @@
 #if defined(__linux__) && !defined(ANDROID)
 
 #include <folly/net/NetOps.h>
+#include <linux/bpf.h>
 #include <net/if.h>
 #include <quic/xsk/xsk_lib.h>
 #include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/syscall.h>
 #include <unistd.h>
+#include <cerrno>
 #include <cstring>
 
 #ifndef SOL_XDP
@@ -169,14 +172,79 @@ int unmap_tx_ring(
   return munmap(tx_ring, off->tx.desc + num_frames * sizeof(struct xdp_desc));
 }
 
+int set_fill_ring_size(int xsk_fd, __u32 num_entries) {
+  int err = setsockopt(
+      xsk_fd, SOL_XDP, XDP_UMEM_FILL_RING, &num_entries, sizeof(num_entries));
+  return err;
+}
+
+int set_rx_ring(int xsk_fd, __u32 num_entries) {
+  int err = setsockopt(
+      xsk_fd, SOL_XDP, XDP_RX_RING, &num_entries, sizeof(num_entries));
+  return err;
+}
+
+void* map_fill_ring(
+    int xsk_fd,
+    struct xdp_mmap_offsets* off,
+    __u32 num_entries) {
+  void* map = mmap(
+      nullptr,
+      off->fr.desc + num_entries * sizeof(__u64),
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      xsk_fd,
+      XDP_UMEM_PGOFF_FILL_RING);
+  if (map == MAP_FAILED) {
+    return nullptr;
+  }
+
+  return map;
+}
+
+int unmap_fill_ring(
+    void* fill_ring,
+    struct xdp_mmap_offsets* off,
+    __u32 num_entries) {
+  return munmap(fill_ring, off->fr.desc + num_entries * sizeof(__u64));
+}
+
+void* map_rx_ring(int xsk_fd, struct xdp_mmap_offsets* off, __u32 num_entries) {
+  void* map = mmap(
+      nullptr,
+      off->rx.desc + num_entries * sizeof(struct xdp_desc),
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      xsk_fd,
+      XDP_PGOFF_RX_RING);
+  if (map == MAP_FAILED) {
+    return nullptr;
+  }
+
+  return map;
+}
+
+int unmap_rx_ring(
+    void* rx_ring,
+    struct xdp_mmap_offsets* off,
+    __u32 num_entries) {
+  return munmap(rx_ring, off->rx.desc + num_entries * sizeof(struct xdp_desc));
+}
+
 int bind_xsk(
     int xsk_fd,
+    const char* if_name,
     int queue_id,
     bool zeroCopyEnabled,
     bool useNeedWakeup) {
+  unsigned int if_index = if_nametoindex(if_name);
+  if (if_index == 0) {
+    errno = ENODEV;
+    return -1;
+  }
   struct sockaddr_xdp sxdp = {};
   sxdp.sxdp_family = AF_XDP;
-  sxdp.sxdp_ifindex = if_nametoindex("eth0");
+  sxdp.sxdp_ifindex = if_index;
   sxdp.sxdp_queue_id = queue_id;
 
   if (zeroCopyEnabled) {
@@ -194,10 +262,19 @@ int bind_xsk(
   return 0;
 }
 
-int bind_xsk_shared_umem(int xsk_fd, int queue_id, int sharedXskFd) {
+int bind_xsk_shared_umem(
+    int xsk_fd,
+    const char* if_name,
+    int queue_id,
+    int sharedXskFd) {
+  unsigned int if_index = if_nametoindex(if_name);
+  if (if_index == 0) {
+    errno = ENODEV;
+    return -1;
+  }
   struct sockaddr_xdp sxdp = {};
   sxdp.sxdp_family = AF_XDP;
-  sxdp.sxdp_ifindex = if_nametoindex("eth0");
+  sxdp.sxdp_ifindex = if_index;
   sxdp.sxdp_queue_id = queue_id;
   sxdp.sxdp_flags = XDP_SHARED_UMEM;
   sxdp.sxdp_shared_umem_fd = sharedXskFd;
@@ -209,4 +286,19 @@ int bind_xsk_shared_umem(int xsk_fd, int queue_id, int sharedXskFd) {
   return 0;
 }
 
+int register_xsk_in_map(int xsk_map_fd, int queue_id, int xsk_fd) {
+  __u32 key = queue_id;
+  __u32 value = xsk_fd;
+  union bpf_attr attr{};
+  attr.map_fd = xsk_map_fd;
+  attr.key = (uintptr_t)&key;
+  attr.value = (uintptr_t)&value;
+  attr.flags = BPF_ANY;
+  int err = syscall(__NR_bpf, BPF_MAP_UPDATE_ELEM, &attr, sizeof(attr));
+  if (err) {
+    return -1;
+  }
+  return 0;
+}
+
 #endif
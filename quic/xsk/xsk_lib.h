@@ -72,13 +72,55 @@ int unmap_tx_ring(
     struct xdp_mmap_offsets* off,
     __u32 num_frames);
 
+// Sizes the fill ring for a socket that receives. num_entries must be a
+// power of 2. Returns 0 on success, negative value on failure
+int set_fill_ring_size(int xsk_fd, __u32 num_entries);
+
+// Returns 0 on success, negative value on failure
+int set_rx_ring(int xsk_fd, __u32 num_entries);
+
+// Returns fill ring on success, nullptr on failure
+void* map_fill_ring(
+    int xsk_fd,
+    struct xdp_mmap_offsets* off,
+    __u32 num_entries);
+
 // Returns 0 on success, negative value on failure
+int unmap_fill_ring(
+    void* fill_ring,
+    struct xdp_mmap_offsets* off,
+    __u32 num_entries);
+
+// Returns rx ring on success, nullptr on failure
+void* map_rx_ring(int xsk_fd, struct xdp_mmap_offsets* off, __u32 num_entries);
+
+// Returns 0 on success, negative value on failure
+int unmap_rx_ring(
+    void* rx_ring,
+    struct xdp_mmap_offsets* off,
+    __u32 num_entries);
+
+// Binds the socket to queue_id of interface if_name. Returns 0 on success,
+// negative value on failure with errno set. errno is ENODEV when if_name
+// does not exist
 int bind_xsk(
     int xsk_fd,
+    const char* if_name,
     int queue_id,
     bool zeroCopyEnabled,
     bool useNeedWakeup);
 
-int bind_xsk_shared_umem(int xsk_fd, int queue_id, int sharedXskFd);
+// Like bind_xsk, but shares the UMEM of sharedXskFd. Returns 0 on success,
+// negative value on failure
+int bind_xsk_shared_umem(
+    int xsk_fd,
+    const char* if_name,
+    int queue_id,
+    int sharedXskFd);
+
+// Points the XSKMAP entry of queue_id at the socket, so that an XDP program
+// redirecting into the map delivers that queue's packets to it. Returns 0 on
+// success, negative value on failure
+int register_xsk_in_map(int xsk_map_fd, int queue_id, int xsk_fd);
 
 #endif